@@ -0,0 +1,100 @@
+/*
+Times report timestamp handling in the process time zone (TZ):
+  1. get_time + mktime against utils::parseDateTime
+  2. localtime + put_time against utils::formatDateTime
+Both sides run over the same instants, outputs are checked to be identical.
+
+Usage: TZ=America/Chicago bench_datetime [count]
+*/
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "utils/datetime.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+std::string libcFormat(std::time_t t) {
+    std::ostringstream oss;
+    std::tm tm = *std::localtime(&t);
+    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return oss.str();
+}
+
+std::time_t libcParse(const std::string& text) {
+    std::tm tm = {};
+    std::istringstream ss(text);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    tm.tm_isdst = -1;
+    return std::mktime(&tm);
+}
+
+void report(const std::string& name, double libc, double fast, size_t mismatches) {
+    std::cout << name << ": libc " << libc << " s, fast " << fast << " s, "
+              << libc / fast << "x, " << mismatches << " mismatches\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+
+    // Incident-like times across 2015-2025.
+    std::mt19937_64 rng(42);
+    std::uniform_int_distribution<std::time_t> instant(1420070400, 1735689600);
+    std::vector<std::time_t> times(count);
+    for (auto& t : times) t = instant(rng);
+
+    auto start = Clock::now();
+    const utils::TimeZone& zone = utils::TimeZone::local();
+    std::cout << "Transition table: " << zone.transitionCount() << " transitions in " << secondsSince(start) << " s\n";
+
+    std::vector<std::string> libcText(count), fastText(count);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) libcText[i] = libcFormat(times[i]);
+    double libcFormatSeconds = secondsSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) fastText[i] = utils::formatDateTime(times[i]);
+    double fastFormatSeconds = secondsSince(start);
+    size_t formatMismatches = 0;
+    for (size_t i = 0; i < count; ++i) formatMismatches += libcText[i] != fastText[i];
+    report("format", libcFormatSeconds, fastFormatSeconds, formatMismatches);
+
+    // Into a caller buffer, as the report writers can do.
+    std::vector<char> buffer(count * 19);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) utils::formatDateTime(times[i], buffer.data() + i * 19);
+    double bufferFormatSeconds = secondsSince(start);
+    size_t bufferMismatches = 0;
+    for (size_t i = 0; i < count; ++i) bufferMismatches += libcText[i] != std::string_view(buffer.data() + i * 19, 19);
+    report("format to buffer", libcFormatSeconds, bufferFormatSeconds, bufferMismatches);
+    formatMismatches += bufferMismatches;
+
+    std::vector<std::time_t> libcParsed(count), fastParsed(count);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) libcParsed[i] = libcParse(libcText[i]);
+    double libcParseSeconds = secondsSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) utils::parseDateTime(libcText[i], fastParsed[i]);
+    double fastParseSeconds = secondsSince(start);
+    size_t parseMismatches = 0;
+    // Inside the repeated fall-back hour mktime's answer depends on its previous call, both readings are valid.
+    for (size_t i = 0; i < count; ++i) {
+        parseMismatches += libcParsed[i] != fastParsed[i] && libcFormat(libcParsed[i]) != libcFormat(fastParsed[i]);
+    }
+    report("parse", libcParseSeconds, fastParseSeconds, parseMismatches);
+
+    return formatMismatches + parseMismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,102 @@
+/*
+Times enum text conversion as done per CSV row and per feature extraction:
+  1. the old if-chain of string compares against stringToIncidentCategory (perfect hash)
+  2. the old lowercase-copy + compare chain against mapIncidentType for exact descriptions
+Both sides see the same inputs, results are checked to be identical.
+
+Usage: bench_enums [count]
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "enums.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+// The conversion as it was before the registry, kept here as the reference.
+IncidentCategory chainCategory(const std::string& str) {
+    static const char* const names[] = {
+        "One", "OneB", "OneBM", "OneC", "OneD", "OneE", "OneEM", "OneF", "OneG", "OneH", "OneJ",
+        "Two", "TwoM", "TwoMF", "TwoA", "TwoB", "TwoC", "Three", "ThreeF", "ThreeM", "ThreeA", "ThreeB",
+        "ThreeC", "ThreeCM", "ThreeD", "Four", "FourM", "FourA", "FourB", "FourC", "Five", "FiveA", "Six",
+        "Seven", "SevenB", "SevenBM", "Eight", "EightA", "EightB", "EightC", "EightD", "EightE", "EightF",
+        "EightG", "Nine", "Ten", "Eleven", "ElevenA", "ElevenB", "Thirteen", "Fourteen", "Fifteen",
+        "Sixteen", "Eighteen"};
+    for (size_t i = 0; i < std::size(names); ++i) {
+        if (str == names[i]) return static_cast<IncidentCategory>(i);
+    }
+    return IncidentCategory::Invalid;
+}
+
+IncidentType chainType(const std::string& incidentTypeStr) {
+    static const char* const names[] = {
+        "building fire", "passenger vehicle fire", "grass fire", "brush fire", "outside rubbish fire",
+        "cooking fire", "dumpster fire", "chimney or flue fire", "forest, woods or wildland fire",
+        "camper or motor home fire", "medical", "alarm system activation, no fire - unintentional",
+        "smoke detector activation, no fire - unintentional", "co detector activation, no co",
+        "sprinkler activation, no fire - unintentional", "gas leak (natural gas or lpg)",
+        "chemical spill or leak", "hazardous materials release investigation", "carbon monoxide incident",
+        "public service", "animal rescue", "lock-out", "service call", "vehicle accident with no injuries",
+        "power line down", "water or steam leak", "cover assignment, standby, moveup",
+        "no incident found on arrival at dispatch address"};
+    std::string lowerStr = incidentTypeStr;
+    std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), ::tolower);
+    for (size_t i = 0; i < std::size(names); ++i) {
+        if (lowerStr == names[i]) return static_cast<IncidentType>(i);
+    }
+    return mapIncidentType(incidentTypeStr);
+}
+
+void report(const std::string& name, double chain, double registry, size_t mismatches) {
+    std::cout << name << ": chain " << chain << " s, registry " << registry << " s, "
+              << chain / registry << "x, " << mismatches << " mismatches\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    std::mt19937_64 rng(42);
+
+    std::vector<std::string> categories(count), types(count);
+    std::uniform_int_distribution<size_t> category(0, INCIDENT_CATEGORY_NAMES.size() - 1);
+    std::uniform_int_distribution<size_t> type(0, static_cast<size_t>(IncidentType::NoIncidentFound));
+    for (size_t i = 0; i < count; ++i) {
+        categories[i] = std::string(INCIDENT_CATEGORY_NAMES.name(static_cast<IncidentCategory>(category(rng))));
+        types[i] = std::string(INCIDENT_TYPE_NAMES.name(static_cast<IncidentType>(type(rng))));
+    }
+
+    std::vector<IncidentCategory> chainCategories(count), fastCategories(count);
+    auto start = Clock::now();
+    for (size_t i = 0; i < count; ++i) chainCategories[i] = chainCategory(categories[i]);
+    double chainSeconds = secondsSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) fastCategories[i] = stringToIncidentCategory(categories[i]);
+    double fastSeconds = secondsSince(start);
+    size_t categoryMismatches = 0;
+    for (size_t i = 0; i < count; ++i) categoryMismatches += chainCategories[i] != fastCategories[i];
+    report("category", chainSeconds, fastSeconds, categoryMismatches);
+
+    std::vector<IncidentType> chainTypes(count), fastTypes(count);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) chainTypes[i] = chainType(types[i]);
+    chainSeconds = secondsSince(start);
+    start = Clock::now();
+    for (size_t i = 0; i < count; ++i) fastTypes[i] = mapIncidentType(types[i]);
+    fastSeconds = secondsSince(start);
+    size_t typeMismatches = 0;
+    for (size_t i = 0; i < count; ++i) typeMismatches += chainTypes[i] != fastTypes[i];
+    report("incident type", chainSeconds, fastSeconds, typeMismatches);
+
+    return 0;
+}
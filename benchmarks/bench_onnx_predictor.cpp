@@ -0,0 +1,106 @@
+/*
+Times the resolution time model through ONNXPredictor on random standardized feature rows:
+  1. predict(), one row per Run, as computeResolutionTime calls it (mean, p50 and p99 latency)
+  2. predictBatch() at several batch sizes (rows per second)
+Batched predictions are compared against the per-row ones.
+
+Usage: bench_onnx_predictor --ENV_PATH=../.env [rows]
+       (MODEL_PATH, FEATURES_PATH, ONNX_GRAPH_OPTIMIZATION, ONNX_INTRA_OP_THREADS, ONNX_INTER_OP_THREADS)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "config/EnvLoader.h"
+#include "models/onnx_predictor.h"
+#include "utils/logger.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+double percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0.0;
+    size_t k = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+    std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(k), values.end());
+    return values[k];
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string env_path = "../.env";
+    size_t rows = 20000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--ENV_PATH=", 0) == 0) {
+            env_path = arg.substr(std::string("--ENV_PATH=").size());
+        } else {
+            rows = std::max<size_t>(1, std::strtoul(argv[i], nullptr, 10));
+        }
+    }
+    EnvLoader::init(env_path, "file");
+    utils::Logger::init("boilerplate_app");
+    utils::Logger::setLevel("warn");
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+
+    std::string model_path = env->get("MODEL_PATH", "../models/fire_incident_gb_model.onnx");
+    std::string features_path = env->get("FEATURES_PATH", "../models/fire_model_features_mapping.json");
+    std::ifstream features_file(features_path);
+    if (!features_file) {
+        std::cerr << "Cannot open " << features_path << "\n";
+        return 1;
+    }
+    size_t width = nlohmann::json::parse(features_file)["model_info"]["input_features"].get<size_t>();
+
+    ONNXPredictor predictor;
+    if (!predictor.loadModel(model_path)) {
+        return 1;
+    }
+
+    std::mt19937_64 rng(42);
+    std::normal_distribution<float> standardized(0.0f, 1.0f);
+    std::vector<float> matrix(rows * width);
+    for (float& value : matrix) value = standardized(rng);
+
+    std::vector<float> single(rows);
+    std::vector<double> latencies(rows);
+    std::vector<float> row(width);
+    auto start = Clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        std::copy_n(matrix.begin() + static_cast<std::ptrdiff_t>(i * width), width, row.begin());
+        auto rowStart = Clock::now();
+        single[i] = predictor.predict(row);
+        latencies[i] = secondsSince(rowStart) * 1e6;
+    }
+    double seconds = secondsSince(start);
+    std::cout << "predict: " << rows / seconds << " rows/s, latency mean " << seconds * 1e6 / rows
+              << " us, p50 " << percentile(latencies, 0.5) << " us, p99 " << percentile(latencies, 0.99) << " us\n";
+
+    if (!predictor.acceptsBatches()) {
+        std::cout << "predictBatch: the model has a fixed batch dimension, rows run one at a time\n";
+    }
+    for (size_t batch : {1, 16, 128, 1024, 4096}) {
+        start = Clock::now();
+        std::vector<float> batched = predictor.predictBatch(matrix, rows, batch);
+        seconds = secondsSince(start);
+        double maxDiff = 0.0;
+        for (size_t i = 0; i < rows; ++i) {
+            maxDiff = std::max(maxDiff, static_cast<double>(std::abs(batched[i] - single[i])));
+        }
+        std::cout << "predictBatch(" << batch << "): " << rows / seconds << " rows/s, "
+                  << seconds * 1e6 / rows << " us/row, max diff vs predict " << maxDiff << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+Times station x incident matrix builds on the Nashville extract:
+  1. NativeRouter, one bounded Dijkstra per station
+  2. Contraction hierarchy preprocessing, then the bucket many-to-many query
+  3. OSRM table requests, when BASE_OSRM_URL answers
+Durations of 2 and 3 are compared against 1.
+
+Usage: bench_router --ENV_PATH=../.env   (ROAD_GRAPH_*, STATIONS_CSV_PATH, INCIDENTS_CSV_PATH, BASE_OSRM_URL)
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+#include "config/EnvLoader.h"
+#include "services/chunks.h"
+#include "services/contraction_hierarchy.h"
+#include "services/native_router.h"
+#include "services/queries.h"
+#include "utils/loaders.h"
+#include "utils/logger.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+void report(const std::string& name, double seconds, const FlatMatrix& durations, const FlatMatrix* reference) {
+    std::cout << name << ": " << seconds << " s";
+    if (reference) {
+        double maxDiff = 0.0, sumDiff = 0.0;
+        for (int i = 0; i < durations.height(); ++i) {
+            for (int j = 0; j < durations.width(); ++j) {
+                double diff = std::abs(durations.at(i, j) - reference->at(i, j));
+                maxDiff = std::max(maxDiff, diff);
+                sumDiff += diff;
+            }
+        }
+        size_t cells = static_cast<size_t>(durations.width()) * durations.height();
+        std::cout << " (duration diff vs Dijkstra: mean " << (cells ? sumDiff / cells : 0.0)
+                  << " s, max " << maxDiff << " s)";
+    }
+    std::cout << "\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string env_path = "../.env";
+    if (argc > 1 && std::string(argv[1]).rfind("--ENV_PATH=", 0) == 0) {
+        env_path = std::string(argv[1]).substr(std::string("--ENV_PATH=").size());
+    }
+    EnvLoader::init(env_path, "file");
+    utils::Logger::init("boilerplate_app");
+    utils::Logger::setLevel("warn");
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+
+    std::vector<Location> sources, destinations;
+    for (const auto& station : loader::loadStationsFromCSV()) sources.push_back(station.getLocation());
+    for (const auto& incident : loader::loadIncidentsFromCSV()) destinations.push_back(incident.getLocation());
+    std::cout << sources.size() << " stations x " << destinations.size() << " incidents\n";
+
+    auto start = Clock::now();
+    NativeRouter router(RoadGraph::loadCsv(env->get("ROAD_GRAPH_NODES_PATH", "../data/road_nodes.csv"),
+                                           env->get("ROAD_GRAPH_EDGES_PATH", "../data/road_edges.csv")));
+    std::cout << "Graph load + snapping index: " << secondsSince(start) << " s ("
+              << router.graph().nodeCount() << " nodes, " << router.graph().edgeCount() << " edges)\n";
+
+    start = Clock::now();
+    auto dijkstra = router.tableMatrices(sources, destinations);
+    report("Dijkstra table", secondsSince(start), dijkstra.second, nullptr);
+
+    start = Clock::now();
+    ContractionHierarchy ch = ContractionHierarchy::build(router.graph());
+    std::cout << "CH preprocessing: " << secondsSince(start) << " s (" << ch.upEdgeCount() << " upward arcs)\n";
+    const std::string ch_path = "bench_router.ch";
+    ch.save(ch_path);
+    start = Clock::now();
+    router.useHierarchy(ContractionHierarchy::open(ch_path));
+    std::cout << "CH open (mmap): " << secondsSince(start) << " s\n";
+
+    start = Clock::now();
+    auto hierarchy = router.tableMatrices(sources, destinations);
+    report("CH bucket table", secondsSince(start), hierarchy.second, &dijkstra.second);
+    std::remove(ch_path.c_str());
+
+    std::string osrm_url = env->get("BASE_OSRM_URL", "http://localhost:8080");
+    if (checkOSRM(osrm_url)) {
+        start = Clock::now();
+        auto osrm = generate_osrm_table_chunks(sources, destinations);
+        report("OSRM table", secondsSince(start), osrm.second, &dijkstra.second);
+    } else {
+        std::cout << "OSRM table: skipped, " << osrm_url << " is not reachable\n";
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+Checks and times the native tree ensemble against ONNX Runtime on the resolution time model:
+  1. both evaluate the same random standardized feature rows, predictions are compared
+     (exact matches, max absolute difference)
+  2. per-row predict() latency and predictBatch() throughput of each
+
+Usage: bench_tree_ensemble --ENV_PATH=../.env [rows]   (MODEL_PATH, FEATURES_PATH, ONNX_* session options)
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "config/EnvLoader.h"
+#include "models/onnx_predictor.h"
+#include "models/tree_ensemble.h"
+#include "utils/logger.h"
+
+namespace {
+using Clock = std::chrono::steady_clock;
+
+double secondsSince(Clock::time_point start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+template <typename Predict>
+std::vector<float> timeRows(const std::string& name, const std::vector<float>& matrix, size_t rows, size_t width,
+                            Predict predict) {
+    std::vector<float> predictions(rows);
+    std::vector<float> row(width);
+    auto start = Clock::now();
+    for (size_t i = 0; i < rows; ++i) {
+        std::copy_n(matrix.begin() + static_cast<std::ptrdiff_t>(i * width), width, row.begin());
+        predictions[i] = predict(row);
+    }
+    double seconds = secondsSince(start);
+    std::cout << name << " predict: " << seconds * 1e6 / rows << " us/row\n";
+    return predictions;
+}
+
+template <typename PredictBatch>
+std::vector<float> timeBatch(const std::string& name, size_t rows, PredictBatch predictBatch) {
+    auto start = Clock::now();
+    std::vector<float> predictions = predictBatch();
+    double seconds = secondsSince(start);
+    std::cout << name << " predictBatch: " << rows / seconds << " rows/s\n";
+    return predictions;
+}
+
+void compare(const std::string& name, const std::vector<float>& native, const std::vector<float>& onnx) {
+    size_t exact = 0;
+    double maxDiff = 0.0;
+    for (size_t i = 0; i < native.size(); ++i) {
+        exact += native[i] == onnx[i];
+        maxDiff = std::max(maxDiff, static_cast<double>(std::abs(native[i] - onnx[i])));
+    }
+    std::cout << name << ": " << exact << "/" << native.size() << " identical, max diff " << maxDiff << "\n";
+}
+}
+
+int main(int argc, char* argv[]) {
+    std::string env_path = "../.env";
+    size_t rows = 20000;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--ENV_PATH=", 0) == 0) {
+            env_path = arg.substr(std::string("--ENV_PATH=").size());
+        } else {
+            rows = std::max<size_t>(1, std::strtoul(argv[i], nullptr, 10));
+        }
+    }
+    EnvLoader::init(env_path, "file");
+    utils::Logger::init("boilerplate_app");
+    utils::Logger::setLevel("warn");
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+
+    std::string model_path = env->get("MODEL_PATH", "../models/fire_incident_gb_model.onnx");
+    std::string features_path = env->get("FEATURES_PATH", "../models/fire_model_features_mapping.json");
+    std::ifstream features_file(features_path);
+    if (!features_file) {
+        std::cerr << "Cannot open " << features_path << "\n";
+        return 1;
+    }
+    size_t width = nlohmann::json::parse(features_file)["model_info"]["input_features"].get<size_t>();
+
+    auto start = Clock::now();
+    TreeEnsemble ensemble = TreeEnsemble::loadOnnx(model_path);
+    std::cout << "import: " << ensemble.treeCount() << " trees, " << ensemble.nodeCount() << " nodes in "
+              << secondsSince(start) << " s\n";
+    ONNXPredictor predictor;
+    if (!predictor.loadModel(model_path)) {
+        return 1;
+    }
+
+    // Standardized rows, with a share of exact zeros and ones like the one-hot columns.
+    std::mt19937_64 rng(42);
+    std::normal_distribution<float> standardized(0.0f, 1.0f);
+    std::uniform_int_distribution<int> kind(0, 3);
+    std::vector<float> matrix(rows * width);
+    for (float& value : matrix) {
+        int k = kind(rng);
+        value = k == 0 ? 0.0f : k == 1 ? 1.0f : standardized(rng);
+    }
+
+    auto nativeRows = timeRows("native", matrix, rows, width, [&](const std::vector<float>& row) {
+        return ensemble.predict(row);
+    });
+    auto onnxRows = timeRows("onnx", matrix, rows, width, [&](const std::vector<float>& row) {
+        return predictor.predict(row);
+    });
+    auto nativeBatch = timeBatch("native", rows, [&]() { return ensemble.predictBatch(matrix, rows); });
+    auto onnxBatch = timeBatch("onnx", rows, [&]() { return predictor.predictBatch(matrix, rows); });
+    compare("per row", nativeRows, onnxRows);
+    compare("batched", nativeBatch, onnxBatch);
+    return 0;
+}
@@ -16,9 +16,60 @@ bool isPointOnSegment(const Location& p, const Location& p1, const Location& p2)
 int windingNumber(const std::vector<Location>& polygon, const Location& point);
 bool isPointInPolygon(const std::vector<Location>& polygon, const Location& point);
 std::vector<Location> loadPolygonFromGeoJSON(const std::string& filename);
+
+/**
+ * @brief A polygon prepared for many point-in-polygon tests, same answers as windingNumber.
+ *
+ * A uniform grid covers the polygon's bounding box. Cells no edge comes near hold their
+ * winding number outright. Boundary cells hold the winding of the edges that cross their
+ * whole row band away from the cell, plus the short list of edges that can change it:
+ * edges passing through the cell and edges ending inside the row band. A query is one
+ * array read for most points and a handful of edge tests near the boundary.
+ *
+ * Cells are padded by a margin far above the rounding error of crossProduct, so every
+ * edge left out of a cell's list gives the same result anywhere in the cell.
+ */
+class PreparedPolygon {
+public:
+    PreparedPolygon() = default;
+    // targetCells = 0 sizes the grid from the vertex count.
+    explicit PreparedPolygon(std::vector<Location> polygon, size_t targetCells = 0);
+
+    int windingNumber(const Location& point) const;
+    bool contains(const Location& point) const { return windingNumber(point) != 0; }
+
+    const std::vector<Location>& vertices() const noexcept { return vertices_; }
+    size_t columns() const noexcept { return columns_; }
+    size_t rows() const noexcept { return rows_; }
+    size_t boundaryCellCount() const noexcept;
+
+private:
+    std::vector<Location> vertices_;
+    // Grid over lat (columns) and lon (rows), the axes windingNumber sweeps along.
+    double minLat_ = 0.0, minLon_ = 0.0, maxLat_ = 0.0, maxLon_ = 0.0;
+    double cellLat_ = 1.0, cellLon_ = 1.0;
+    double margin_ = 0.0;
+    size_t columns_ = 0, rows_ = 0;
+
+    std::vector<int32_t> winding_;        // per cell: the winding, or the base winding of a boundary cell
+    std::vector<uint8_t> boundary_;
+    std::vector<uint32_t> cellEdgeBegin_;  // cells + 1 offsets into cellEdges_
+    std::vector<uint32_t> cellEdges_;
+    std::vector<uint32_t> rowEdgeBegin_;   // rows + 1 offsets into rowEdges_
+    std::vector<uint32_t> rowEdges_;
+
+    size_t cellOf(double value, double origin, double size, size_t count) const;
+    int edgeWinding(uint32_t edge, const Location& point, bool& onEdge) const;
+};
+/**
+ * @brief Index of a polygon covering each point (boundaries included), nullopt when none does.
+ * Points are looked up in Hilbert order against a bulk-loaded R-tree of the polygon envelopes,
+ * split across threads (0 = hardware concurrency).
+ */
 std::vector<std::optional<size_t>> getPointToPolygonIndices(
     const std::vector<Point>& points,
-    const std::vector<Polygon>& polygons
+    const std::vector<Polygon>& polygons,
+    size_t threads = 0
 );
 std::vector<std::pair<int, Polygon>> loadServiceZonesFromGeojson(const std::string& filename);
 #endif // GEOMETRY_H
\ No newline at end of file
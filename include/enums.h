@@ -2,8 +2,17 @@
 #define ENUMS_H
 
 #include <string>
+#include <string_view>
 #include <algorithm>
+#include <array>
 #include <cctype>
+#include <cstdint>
+#include "utils/enum_registry.h"
+
+// The enums converted to and from text are listed once as X(value, text); the lists expand into
+// the enum and into a utils::EnumRegistry holding the names and the perfect hash parsing them.
+#define ENUM_REGISTRY_ID(id, text) id,
+#define ENUM_REGISTRY_TEXT(id, text) std::string_view(text),
 
 enum class EventType : uint8_t {
     Incident,
@@ -18,127 +27,124 @@ enum class StationActionType : uint8_t {
     DoNothing
 };
 
-enum class IncidentLevel : uint8_t {
-    Invalid,
-    Low,
-    Moderate,
-    High,
-    Critical
-};
+#define INCIDENT_LEVEL_VALUES(X) \
+    X(Invalid, "Invalid") \
+    X(Low, "Low") \
+    X(Moderate, "Moderate") \
+    X(High, "High") \
+    X(Critical, "Critical")
 
-enum class IncidentCategory : uint8_t {
-    One,
-    OneB,
-    OneBM,
-    OneC,
-    OneD,
-    OneE,
-    OneEM,
-    OneF,
-    OneG,
-    OneH,
-    OneJ,
-    Two,
-    TwoM,
-    TwoMF,
-    TwoA,
-    TwoB,
-    TwoC,
-    Three,
-    ThreeF,
-    ThreeM,
-    ThreeA,
-    ThreeB,
-    ThreeC,
-    ThreeCM,
-    ThreeD,
-    Four,
-    FourM,
-    FourA,
-    FourB,
-    FourC,
-    Five,
-    FiveA,
-    Six,
-    Seven,
-    SevenB,
-    SevenBM,
-    Eight,
-    EightA,
-    EightB,
-    EightC,
-    EightD,
-    EightE,
-    EightF,
-    EightG,
-    Nine,
-    Ten,
-    Eleven,
-    ElevenA,
-    ElevenB,
-    Thirteen,
-    Fourteen,
-    Fifteen,
-    Sixteen,
-    Eighteen,
-    Invalid
-};
+enum class IncidentLevel : uint8_t { INCIDENT_LEVEL_VALUES(ENUM_REGISTRY_ID) };
 
-enum class IncidentType : uint8_t {
-    // Fire-related incidents
-    BuildingFire,
-    PassengerVehicleFire,
-    GrassFire,
-    BrushFire,
-    OutsideRubbishFire,
-    CookingFire,
-    DumpsterFire,
-    ChimneyFire,
-    ForestFire,
-    CamperFire,
-    
-    // Medical incidents
-    Medical,
-    
-    // Alarm-related incidents
-    AlarmSystemActivation,
-    SmokeDetectorActivation,
-    CODetectorActivation,
-    SprinklerActivation,
-    
-    // Hazmat incidents
-    GasLeak,
-    ChemicalSpill,
-    HazmatRelease,
-    CarbonMonoxideIncident,
-    
-    // Service calls
-    PublicService,
-    AnimalRescue,
-    LockOut,
-    ServiceCall,
-    
-    // Other incidents
-    VehicleAccident,
-    PowerLineDown,
-    WaterLeak,
-    
-    // Special categories
-    CoverAssignment,
-    NoIncidentFound,
-    Cancelled,
-    
-    // Fallback
-    Other,
-    Invalid
-};
+#define INCIDENT_CATEGORY_VALUES(X) \
+    X(One, "One") \
+    X(OneB, "OneB") \
+    X(OneBM, "OneBM") \
+    X(OneC, "OneC") \
+    X(OneD, "OneD") \
+    X(OneE, "OneE") \
+    X(OneEM, "OneEM") \
+    X(OneF, "OneF") \
+    X(OneG, "OneG") \
+    X(OneH, "OneH") \
+    X(OneJ, "OneJ") \
+    X(Two, "Two") \
+    X(TwoM, "TwoM") \
+    X(TwoMF, "TwoMF") \
+    X(TwoA, "TwoA") \
+    X(TwoB, "TwoB") \
+    X(TwoC, "TwoC") \
+    X(Three, "Three") \
+    X(ThreeF, "ThreeF") \
+    X(ThreeM, "ThreeM") \
+    X(ThreeA, "ThreeA") \
+    X(ThreeB, "ThreeB") \
+    X(ThreeC, "ThreeC") \
+    X(ThreeCM, "ThreeCM") \
+    X(ThreeD, "ThreeD") \
+    X(Four, "Four") \
+    X(FourM, "FourM") \
+    X(FourA, "FourA") \
+    X(FourB, "FourB") \
+    X(FourC, "FourC") \
+    X(Five, "Five") \
+    X(FiveA, "FiveA") \
+    X(Six, "Six") \
+    X(Seven, "Seven") \
+    X(SevenB, "SevenB") \
+    X(SevenBM, "SevenBM") \
+    X(Eight, "Eight") \
+    X(EightA, "EightA") \
+    X(EightB, "EightB") \
+    X(EightC, "EightC") \
+    X(EightD, "EightD") \
+    X(EightE, "EightE") \
+    X(EightF, "EightF") \
+    X(EightG, "EightG") \
+    X(Nine, "Nine") \
+    X(Ten, "Ten") \
+    X(Eleven, "Eleven") \
+    X(ElevenA, "ElevenA") \
+    X(ElevenB, "ElevenB") \
+    X(Thirteen, "Thirteen") \
+    X(Fourteen, "Fourteen") \
+    X(Fifteen, "Fifteen") \
+    X(Sixteen, "Sixteen") \
+    X(Eighteen, "Eighteen") \
+    X(Invalid, "Invalid")
 
-enum class IncidentStatus : uint8_t {
-    hasBeenReported,
-    hasBeenRespondedTo,
-    isBeingResolved,
-    hasBeenResolved
-};
+enum class IncidentCategory : uint8_t { INCIDENT_CATEGORY_VALUES(ENUM_REGISTRY_ID) };
+
+#define INCIDENT_TYPE_VALUES(X) \
+    /* Fire-related incidents */ \
+    X(BuildingFire, "Building fire") \
+    X(PassengerVehicleFire, "Passenger vehicle fire") \
+    X(GrassFire, "Grass fire") \
+    X(BrushFire, "Brush fire") \
+    X(OutsideRubbishFire, "Outside rubbish fire") \
+    X(CookingFire, "Cooking fire") \
+    X(DumpsterFire, "Dumpster fire") \
+    X(ChimneyFire, "Chimney or flue fire") \
+    X(ForestFire, "Forest, woods or wildland fire") \
+    X(CamperFire, "Camper or motor home fire") \
+    /* Medical incidents */ \
+    X(Medical, "Medical") \
+    /* Alarm-related incidents */ \
+    X(AlarmSystemActivation, "Alarm system activation, no fire - unintentional") \
+    X(SmokeDetectorActivation, "Smoke detector activation, no fire - unintentional") \
+    X(CODetectorActivation, "CO detector activation, no CO") \
+    X(SprinklerActivation, "Sprinkler activation, no fire - unintentional") \
+    /* Hazmat incidents */ \
+    X(GasLeak, "Gas leak (natural gas or LPG)") \
+    X(ChemicalSpill, "Chemical spill or leak") \
+    X(HazmatRelease, "Hazardous materials release investigation") \
+    X(CarbonMonoxideIncident, "Carbon monoxide incident") \
+    /* Service calls */ \
+    X(PublicService, "Public service") \
+    X(AnimalRescue, "Animal rescue") \
+    X(LockOut, "Lock-out") \
+    X(ServiceCall, "Service call") \
+    /* Other incidents */ \
+    X(VehicleAccident, "Vehicle accident with no injuries") \
+    X(PowerLineDown, "Power line down") \
+    X(WaterLeak, "Water or steam leak") \
+    /* Special categories */ \
+    X(CoverAssignment, "Cover assignment, standby, moveup") \
+    X(NoIncidentFound, "No incident found on arrival at dispatch address") \
+    X(Cancelled, "Dispatched and cancelled en route") \
+    /* Fallback */ \
+    X(Other, "Good intent call -  other") \
+    X(Invalid, "Invalid")
+
+enum class IncidentType : uint8_t { INCIDENT_TYPE_VALUES(ENUM_REGISTRY_ID) };
+
+#define INCIDENT_STATUS_VALUES(X) \
+    X(hasBeenReported, "hasBeenReported") \
+    X(hasBeenRespondedTo, "hasBeenRespondedTo") \
+    X(isBeingResolved, "isBeingResolved") \
+    X(hasBeenResolved, "hasBeenResolved")
+
+enum class IncidentStatus : uint8_t { INCIDENT_STATUS_VALUES(ENUM_REGISTRY_ID) };
 
 enum class ApparatusStatus : uint8_t {
     Available,
@@ -148,113 +154,52 @@ enum class ApparatusStatus : uint8_t {
     ReturningToStation
 };
 
-enum class ApparatusType : uint8_t {
-    Pumper,
-    Engine,
-    Truck,
-    Rescue,
-    Hazard,
-    Chief,
-    Squad,
-    Fast,
-    Medic,
-    Brush,
-    Boat,
-    UTV,
-    Reach,
-    Invalid // Added for safety, should not be used in practice
-};
+#define APPARATUS_TYPE_VALUES(X) \
+    X(Pumper, "Pumper") \
+    X(Engine, "Engine") \
+    X(Truck, "Truck") \
+    X(Rescue, "Rescue") \
+    X(Hazard, "Hazard") \
+    X(Chief, "Chief") \
+    X(Squad, "Squad") \
+    X(Fast, "Fast") \
+    X(Medic, "Medic") \
+    X(Brush, "Brush") \
+    X(Boat, "Boat") \
+    X(UTV, "UTV") \
+    X(Reach, "Reach") \
+    X(Invalid, "Invalid") /* Added for safety, should not be used in practice */
+
+enum class ApparatusType : uint8_t { APPARATUS_TYPE_VALUES(ENUM_REGISTRY_ID) };
+
+inline constexpr auto INCIDENT_LEVEL_NAMES =
+    utils::makeEnumRegistry<IncidentLevel>(std::array{INCIDENT_LEVEL_VALUES(ENUM_REGISTRY_TEXT)});
+inline constexpr auto INCIDENT_CATEGORY_NAMES =
+    utils::makeEnumRegistry<IncidentCategory>(std::array{INCIDENT_CATEGORY_VALUES(ENUM_REGISTRY_TEXT)});
+// Incident type descriptions are matched case-insensitively.
+inline constexpr auto INCIDENT_TYPE_NAMES =
+    utils::makeEnumRegistry<IncidentType, true>(std::array{INCIDENT_TYPE_VALUES(ENUM_REGISTRY_TEXT)});
+inline constexpr auto INCIDENT_STATUS_NAMES =
+    utils::makeEnumRegistry<IncidentStatus>(std::array{INCIDENT_STATUS_VALUES(ENUM_REGISTRY_TEXT)});
+inline constexpr auto APPARATUS_TYPE_NAMES =
+    utils::makeEnumRegistry<ApparatusType>(std::array{APPARATUS_TYPE_VALUES(ENUM_REGISTRY_TEXT)});
 
 // to_string for IncidentType
 inline std::string to_string(IncidentType type) {
-    switch (type) {
-        // Fire-related incidents
-        case IncidentType::BuildingFire: return "Building fire";
-        case IncidentType::PassengerVehicleFire: return "Passenger vehicle fire";
-        case IncidentType::GrassFire: return "Grass fire";
-        case IncidentType::BrushFire: return "Brush fire";
-        case IncidentType::OutsideRubbishFire: return "Outside rubbish fire";
-        case IncidentType::CookingFire: return "Cooking fire";
-        case IncidentType::DumpsterFire: return "Dumpster fire";
-        case IncidentType::ChimneyFire: return "Chimney or flue fire";
-        case IncidentType::ForestFire: return "Forest, woods or wildland fire";
-        case IncidentType::CamperFire: return "Camper or motor home fire";
-        
-        // Medical incidents
-        case IncidentType::Medical: return "Medical";
-        
-        // Alarm-related incidents
-        case IncidentType::AlarmSystemActivation: return "Alarm system activation, no fire - unintentional";
-        case IncidentType::SmokeDetectorActivation: return "Smoke detector activation, no fire - unintentional";
-        case IncidentType::CODetectorActivation: return "CO detector activation, no CO";
-        case IncidentType::SprinklerActivation: return "Sprinkler activation, no fire - unintentional";
-        
-        // Hazmat incidents
-        case IncidentType::GasLeak: return "Gas leak (natural gas or LPG)";
-        case IncidentType::ChemicalSpill: return "Chemical spill or leak";
-        case IncidentType::HazmatRelease: return "Hazardous materials release investigation";
-        case IncidentType::CarbonMonoxideIncident: return "Carbon monoxide incident";
-        
-        // Service calls
-        case IncidentType::PublicService: return "Public service";
-        case IncidentType::AnimalRescue: return "Animal rescue";
-        case IncidentType::LockOut: return "Lock-out";
-        case IncidentType::ServiceCall: return "Service call";
-        
-        // Other incidents
-        case IncidentType::VehicleAccident: return "Vehicle accident with no injuries";
-        case IncidentType::PowerLineDown: return "Power line down";
-        case IncidentType::WaterLeak: return "Water or steam leak";
-        
-        // Special categories
-        case IncidentType::CoverAssignment: return "Cover assignment, standby, moveup";
-        case IncidentType::NoIncidentFound: return "No incident found on arrival at dispatch address";
-        case IncidentType::Cancelled: return "Dispatched and cancelled en route";
-        
-        // Fallback
-        case IncidentType::Other: return "Good intent call -  other";
-        case IncidentType::Invalid: return "Invalid";
-        default: return "Unknown";
-    }
+    return std::string(INCIDENT_TYPE_NAMES.name(type));
 }
 
 // Function to map incident type strings to IncidentType enum
-inline IncidentType mapIncidentType(const std::string& incidentTypeStr) {
+inline IncidentType mapIncidentType(std::string_view incidentTypeStr) {
+    // Direct matches (case-insensitive)
+    if (auto type = INCIDENT_TYPE_NAMES.parse(incidentTypeStr); type && *type != IncidentType::Invalid) {
+        return *type;
+    }
+
     // Convert to lowercase for case-insensitive comparison
-    std::string lowerStr = incidentTypeStr;
+    std::string lowerStr(incidentTypeStr);
     std::transform(lowerStr.begin(), lowerStr.end(), lowerStr.begin(), ::tolower);
-    
-    // Direct matches (case-insensitive)
-    if (lowerStr == "building fire") return IncidentType::BuildingFire;
-    if (lowerStr == "passenger vehicle fire") return IncidentType::PassengerVehicleFire;
-    if (lowerStr == "grass fire") return IncidentType::GrassFire;
-    if (lowerStr == "brush fire") return IncidentType::BrushFire;
-    if (lowerStr == "outside rubbish fire") return IncidentType::OutsideRubbishFire;
-    if (lowerStr == "cooking fire") return IncidentType::CookingFire;
-    if (lowerStr == "dumpster fire") return IncidentType::DumpsterFire;
-    if (lowerStr == "chimney or flue fire") return IncidentType::ChimneyFire;
-    if (lowerStr == "forest, woods or wildland fire") return IncidentType::ForestFire;
-    if (lowerStr == "camper or motor home fire") return IncidentType::CamperFire;
-    if (lowerStr == "medical") return IncidentType::Medical;
-    if (lowerStr == "alarm system activation, no fire - unintentional") return IncidentType::AlarmSystemActivation;
-    if (lowerStr == "smoke detector activation, no fire - unintentional") return IncidentType::SmokeDetectorActivation;
-    if (lowerStr == "co detector activation, no co") return IncidentType::CODetectorActivation;
-    if (lowerStr == "sprinkler activation, no fire - unintentional") return IncidentType::SprinklerActivation;
-    if (lowerStr == "gas leak (natural gas or lpg)") return IncidentType::GasLeak;
-    if (lowerStr == "chemical spill or leak") return IncidentType::ChemicalSpill;
-    if (lowerStr == "hazardous materials release investigation") return IncidentType::HazmatRelease;
-    if (lowerStr == "carbon monoxide incident") return IncidentType::CarbonMonoxideIncident;
-    if (lowerStr == "public service") return IncidentType::PublicService;
-    if (lowerStr == "animal rescue") return IncidentType::AnimalRescue;
-    if (lowerStr == "lock-out") return IncidentType::LockOut;
-    if (lowerStr == "service call") return IncidentType::ServiceCall;
-    if (lowerStr == "vehicle accident with no injuries") return IncidentType::VehicleAccident;
-    if (lowerStr == "power line down") return IncidentType::PowerLineDown;
-    if (lowerStr == "water or steam leak") return IncidentType::WaterLeak;
-    if (lowerStr == "cover assignment, standby, moveup") return IncidentType::CoverAssignment;
-    if (lowerStr == "no incident found on arrival at dispatch address") return IncidentType::NoIncidentFound;
-    if (lowerStr == "cancelled en route") return IncidentType::Cancelled;
-    
+
     // Pattern matching for similar types (case-insensitive)
     if (lowerStr.find("fire") != std::string::npos) {
         if (lowerStr.find("vehicle") != std::string::npos || lowerStr.find("car") != std::string::npos || 
@@ -337,64 +282,12 @@ inline IncidentType mapIncidentType(const std::string& incidentTypeStr) {
 
 // to_string for IncidentCategory
 inline std::string to_string(IncidentCategory category) {
-    switch (category) {
-        case IncidentCategory::One: return "One";
-        case IncidentCategory::OneB: return "OneB";
-        case IncidentCategory::OneBM: return "OneBM";
-        case IncidentCategory::OneC: return "OneC";
-        case IncidentCategory::OneD: return "OneD";
-        case IncidentCategory::OneE: return "OneE";
-        case IncidentCategory::OneEM: return "OneEM";
-        case IncidentCategory::OneF: return "OneF";
-        case IncidentCategory::OneG: return "OneG";
-        case IncidentCategory::OneH: return "OneH";
-        case IncidentCategory::OneJ: return "OneJ";
-        case IncidentCategory::Two: return "Two";
-        case IncidentCategory::TwoM: return "TwoM";
-        case IncidentCategory::TwoMF: return "TwoMF";
-        case IncidentCategory::TwoA: return "TwoA";
-        case IncidentCategory::TwoB: return "TwoB";
-        case IncidentCategory::TwoC: return "TwoC";
-        case IncidentCategory::Three: return "Three";
-        case IncidentCategory::ThreeF: return "ThreeF";
-        case IncidentCategory::ThreeM: return "ThreeM";
-        case IncidentCategory::ThreeA: return "ThreeA";
-        case IncidentCategory::ThreeB: return "ThreeB";
-        case IncidentCategory::ThreeC: return "ThreeC";
-        case IncidentCategory::ThreeCM: return "ThreeCM";
-        case IncidentCategory::ThreeD: return "ThreeD";
-        case IncidentCategory::Four: return "Four";
-        case IncidentCategory::FourM: return "FourM";
-        case IncidentCategory::FourA: return "FourA";
-        case IncidentCategory::FourB: return "FourB";
-        case IncidentCategory::FourC: return "FourC";
-        case IncidentCategory::Five: return "Five";
-        case IncidentCategory::FiveA: return "FiveA";
-        case IncidentCategory::Six: return "Six";
-        case IncidentCategory::Seven: return "Seven";
-        case IncidentCategory::SevenB: return "SevenB";
-        case IncidentCategory::SevenBM: return "SevenBM";
-        case IncidentCategory::Eight: return "Eight";
-        case IncidentCategory::EightA: return "EightA";
-        case IncidentCategory::EightB: return "EightB";
-        case IncidentCategory::EightC: return "EightC";
-        case IncidentCategory::EightD: return "EightD";
-        case IncidentCategory::EightE: return "EightE";
-        case IncidentCategory::EightF: return "EightF";
-        case IncidentCategory::EightG: return "EightG";
-        case IncidentCategory::Nine: return "Nine";
-        case IncidentCategory::Ten: return "Ten";
-        case IncidentCategory::Eleven: return "Eleven";
-        case IncidentCategory::ElevenA: return "ElevenA";
-        case IncidentCategory::ElevenB: return "ElevenB";
-        case IncidentCategory::Thirteen: return "Thirteen";
-        case IncidentCategory::Fourteen: return "Fourteen";
-        case IncidentCategory::Fifteen: return "Fifteen";
-        case IncidentCategory::Sixteen: return "Sixteen";
-        case IncidentCategory::Eighteen: return "Eighteen";
-        case IncidentCategory::Invalid: return "Invalid";
-        default: return "Unknown";
-    }
+    return std::string(INCIDENT_CATEGORY_NAMES.name(category));
+}
+
+// Category codes are case-sensitive, anything unknown is Invalid.
+inline IncidentCategory stringToIncidentCategory(std::string_view str) {
+    return INCIDENT_CATEGORY_NAMES.parse(str).value_or(IncidentCategory::Invalid);
 }
 
 // to_string for EventType
@@ -419,43 +312,15 @@ inline std::string to_string(StationActionType type) {
 
 // to_string for IncidentLevel
 inline std::string to_string(IncidentLevel level) {
-    switch (level) {
-        case IncidentLevel::Invalid: return "Invalid";
-        case IncidentLevel::Low: return "Low";
-        case IncidentLevel::Moderate: return "Moderate";
-        case IncidentLevel::High: return "High";
-        case IncidentLevel::Critical: return "Critical";
-        default: return "Unknown";
-    }
+    return std::string(INCIDENT_LEVEL_NAMES.name(level));
 }
 
 inline const char* to_string(IncidentStatus status) {
-    switch (status) {
-        case IncidentStatus::hasBeenRespondedTo:    return "hasBeenRespondedTo";
-        case IncidentStatus::hasBeenReported:       return "hasBeenReported";
-        case IncidentStatus::isBeingResolved:       return "isBeingResolved";
-        case IncidentStatus::hasBeenResolved:       return "hasBeenResolved";
-        default:                                    return "Invalid";
-    }
+    return INCIDENT_STATUS_NAMES.name(status, "Invalid").data();
 }
 
 
 inline const char* to_string(ApparatusType type) {
-    switch (type) {
-        case ApparatusType::Pumper: return "Pumper";
-        case ApparatusType::Engine: return "Engine";
-        case ApparatusType::Truck: return "Truck";
-        case ApparatusType::Rescue: return "Rescue";
-        case ApparatusType::Hazard: return "Hazard";
-        case ApparatusType::Chief: return "Chief";
-        case ApparatusType::Squad: return "Squad";
-        case ApparatusType::Fast: return "Fast";
-        case ApparatusType::Medic: return "Medic";
-        case ApparatusType::Brush: return "Brush";
-        case ApparatusType::Boat: return "Boat";
-        case ApparatusType::UTV: return "UTV";
-        case ApparatusType::Reach: return "Reach";
-        default: return "Invalid";
-    }
+    return APPARATUS_TYPE_NAMES.name(type, "Invalid").data();
 }
 #endif // ENUMS_H
@@ -1,10 +1,14 @@
 #ifndef FIRE_H
 #define FIRE_H
 
+#include <array>
 #include <random>
 #include "simulator/state.h"
+#include "utils/philox.h"
 #include "utils/util.h"
 #include "models/onnx_predictor.h"
+#include "models/tree_ensemble.h"
+#include "services/building_index.h"
 #include <nlohmann/json.hpp>
 
 // Create a parent class for all fire-related models
@@ -13,6 +17,35 @@ public:
     virtual ~FireModel() = default;
     virtual double computeResolutionTime(State& state, const Incident& incident) = 0;
     virtual std::unordered_map<ApparatusType, int> calculateApparatusCount(const Incident& incident) = 0; // Calculate the number of apparatus needed for an incident
+
+    // Draws for an incident then come from the counter-based stream keyed by (seed, replication,
+    // incidentIndex, draw number) instead of the model's generator, so an incident's samples no
+    // longer depend on the order incidents are resolved in.
+    void useCounterStreams(uint32_t seed, uint32_t replication);
+
+protected:
+    // Calls draw with the incident's counter stream, or with sequential when counter streams are
+    // off (or the incident has no index), and remembers how far the stream got.
+    template <typename Draw>
+    auto drawFor(const Incident& incident, std::mt19937& sequential, Draw&& draw) {
+        if (!counter_streams_ || incident.incidentIndex < 0) {
+            return draw(sequential);
+        }
+        auto index = static_cast<size_t>(incident.incidentIndex);
+        if (index >= stream_positions_.size()) {
+            stream_positions_.resize(index + 1, 0);
+        }
+        utils::CounterRng stream(stream_seed_, replication_, index, stream_positions_[index]);
+        auto result = draw(stream);
+        stream_positions_[index] = stream.position();
+        return result;
+    }
+
+private:
+    bool counter_streams_ = false;
+    uint32_t stream_seed_ = 0;
+    uint32_t replication_ = 0;
+    std::vector<uint64_t> stream_positions_;  // by incidentIndex
 };
 
 /*
@@ -44,6 +77,8 @@ struct ResolutionStats {
     double mean;
     double variance;
     int count; 
+    std::array<double, 5> quantiles{};  // min, 25%, 50%, 75%, max
+    bool hasQuantiles = false;
 };
 
 class DepartmentFireModel : public FireModel {
@@ -61,6 +96,27 @@ private:
     std::unordered_map<IncidentCategory, ResolutionStats> resolution_stats_;
     void loadApparatusRequirements(const std::string& csv_path);
     void loadResolutionStats(const std::string& resolutionStats_path);
+
+    // RESOLUTION_SAMPLER=NORMAL draws from each category's normal, QUANTILE interpolates linearly
+    // between its min, quartiles and max (categories without quantiles stay normal).
+    enum class ResolutionSampler { Normal, Quantile };
+    struct CategorySampler {
+        bool known = false;
+        std::normal_distribution<double>::param_type normal;
+        std::array<double, 5> quantiles{};
+        bool hasQuantiles = false;
+    };
+    ResolutionSampler sampler_ = ResolutionSampler::Normal;
+    // Built once from resolution_stats_: samplers by IncidentCategory, the count-weighted normal for
+    // unknown categories, and for QUANTILE the cumulative counts to pick a category from instead.
+    std::vector<CategorySampler> samplers_;
+    CategorySampler fallback_;
+    std::vector<double> mixture_counts_;
+    std::vector<size_t> mixture_categories_;
+    std::normal_distribution<double> normal_;
+    void buildSamplers();
+    template <typename Rng>
+    double sample(const CategorySampler& sampler, Rng& rng);
 };
 class MLFireModel : public FireModel {
 public:
@@ -69,9 +125,16 @@ public:
     double computeResolutionTime(State& state, const Incident& incident) override;
     void validateFeatureOrder() const;
     void printFeatureOrder(size_t max_features = 50) const;
+    // Adds building_count, building_max_levels and nearest_building_m within radius to the features.
+    void useBuildings(std::shared_ptr<const BuildingIndex> buildings, double radiusMeters);
+    // Predicts every incident's resolution time up front: feature rows go into one matrix that is
+    // inferred in batches of batchRows across threads (0 = hardware concurrency). Afterwards
+    // computeResolutionTime reads the table by incidentIndex instead of running the model.
+    void precomputeResolutionTimes(const std::vector<Incident>& incidents, size_t batchRows = 4096, size_t threads = 0);
 private:
-    // ONNX predictor for ML inference
+    // ONNX predictor for ML inference, or the model's trees evaluated natively (ML_EVALUATOR=NATIVE)
     std::unique_ptr<ONNXPredictor> onnx_predictor_;
+    std::unique_ptr<TreeEnsemble> tree_ensemble_;
     
     // Model configuration from JSON
     nlohmann::json feature_config_;
@@ -85,13 +148,48 @@ private:
     int expected_input_features_;
     std::string model_type_;
 
+    std::shared_ptr<const BuildingIndex> buildings_;
+    double building_radius_m_ = 50.0;
+
+    std::vector<double> precomputed_times_;  // by incidentIndex, NaN where not precomputed
+
+    // Compiled form of feature_order_: one slot per model input, each reading a numeric value
+    // (scaled with the config's mean and scale) or testing a one-hot position of a categorical.
+    enum class FeatureSource : uint8_t {
+        Hour, DayOfWeek, Month, Quarter, DayOfYear, IsWeekend, IsNight, IsRushHour, IsBusinessHours,
+        Lat, Lon, DistanceFromCenter, BuildingCount, BuildingMaxLevels, NearestBuildingM,
+        NumericCount,
+        Shift = NumericCount, Season, Category, Zone, Type,
+        Zero
+    };
+    struct FeatureSlot {
+        FeatureSource source = FeatureSource::Zero;
+        int oneHot = 0;          // categoricals: 1 when the value's encoded index equals this
+        bool scaled = false;
+        double mean = 0.0;
+        double scale = 1.0;
+    };
+    // Encoded index of every value a categorical can take, -1 when the config does not know it.
+    struct CategoricalCodes {
+        std::string name;        // config feature name, empty when the config has no encoding
+        std::vector<int> codes;
+    };
+    std::vector<FeatureSlot> feature_plan_;
+    CategoricalCodes shift_codes_, season_codes_, category_codes_, zone_codes_, type_codes_;
+    int zone_nan_code_ = -1;
+    bool plan_uses_buildings_ = false;
+    std::vector<float> feature_buffer_;
+
     void loadONNXModel(const std::string& model_path);
     void loadFeatureConfig(const std::string& config_path);
+    void compileFeaturePlan();
     std::unordered_map<IncidentCategory, std::unordered_map<ApparatusType, int>> apparatus_requirements_;
     void loadApparatusRequirements(const std::string& csv_path);
 
     // Feature extraction methods
-    std::vector<float> extractFeatures(const State& state, const Incident& incident);
+    void extractFeatures(const Incident& incident, std::vector<float>& features);
+    void writePlannedFeatures(const Incident& incident, float* out) const;
+    double toResolutionTime(float predicted_time, const Incident& incident) const;
     std::vector<float> extractTemporalFeatures(const Incident& incident);
     std::vector<float> extractGeographicFeatures(const Incident& incident);
     std::vector<float> extractCategoricalFeatures(const Incident& incident);
@@ -4,25 +4,68 @@
 
 #include <onnxruntime/onnxruntime_cxx_api.h>
 #include <vector>
+#include <span>
 #include <string>
 #include <memory>
+#include <mutex>
+
+/**
+ * @brief Session tuning for ONNXPredictor.
+ */
+struct OnnxPredictorOptions {
+    GraphOptimizationLevel graphOptimization = ORT_ENABLE_ALL;
+    int intraOpThreads = 1;
+    int interOpThreads = 0;  // 0 lets ONNX Runtime choose
+
+    // Reads ONNX_GRAPH_OPTIMIZATION (DISABLE/BASIC/EXTENDED/ALL), ONNX_INTRA_OP_THREADS and ONNX_INTER_OP_THREADS.
+    static OnnxPredictorOptions fromEnv();
+};
 
 class ONNXPredictor {
 public:
-    ONNXPredictor();
+    explicit ONNXPredictor(const OnnxPredictorOptions& options = OnnxPredictorOptions::fromEnv());
     ~ONNXPredictor();
     
     bool loadModel(const std::string& model_path);
     float predict(const std::vector<float>& features);
+    // One prediction per row of the row-major rows x (features.size() / rows) matrix, run in batches
+    // of up to maxBatchRows (one row at a time if the model's batch dimension is fixed). Rows of a
+    // failed batch come back as -1, like predict(). Safe to call from several threads at once.
+    std::vector<float> predictBatch(std::span<const float> features, size_t rows, size_t maxBatchRows = 4096);
+    bool acceptsBatches() const;
     
 private:
+    // Input and output tensors bound once over buffers that stay put, rebound only when the
+    // row count changes. A Run copies rows into input and reads predictions from output.
+    struct Binding {
+        explicit Binding(Ort::Session& session) : io(session) {}
+        Ort::IoBinding io;
+        std::vector<float> input;
+        std::vector<float> output;
+        Ort::Value input_tensor{nullptr};
+        Ort::Value output_tensor{nullptr};
+        size_t rows = 0;
+    };
+
     std::unique_ptr<Ort::Env> env_;
     std::unique_ptr<Ort::Session> session_;
     std::unique_ptr<Ort::SessionOptions> session_options_;
+    Ort::MemoryInfo memory_info_;
     
     std::vector<const char*> input_names_;
     std::vector<const char*> output_names_;
     std::vector<int64_t> input_dims_;
+    std::vector<int64_t> output_dims_;
+
+    // Idle bindings; each concurrent caller takes its own.
+    std::mutex bindings_mutex_;
+    std::vector<std::unique_ptr<Binding>> bindings_;
+
+    std::unique_ptr<Binding> acquireBinding();
+    void releaseBinding(std::unique_ptr<Binding> binding);
+    void bind(Binding& binding, size_t rows, size_t width);
+    // Writes one prediction per row of the rows x width features, leaves predictions untouched and returns false on failure.
+    bool run(Binding& binding, const float* features, size_t rows, size_t width, float* predictions);
 };
 
-#endif // ONNX_PREDICTOR_H
\ No newline at end of file
+#endif // ONNX_PREDICTOR_H
@@ -0,0 +1,63 @@
+#ifndef TREE_ENSEMBLE_H
+#define TREE_ENSEMBLE_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Regression tree ensemble imported from an ONNX TreeEnsembleRegressor, evaluated natively.
+ *
+ * Every tree is stored breadth-first in one flat node array, 16 bytes per node. A leaf's
+ * children point back at itself and its threshold field holds the leaf value, so every
+ * tree is walked a fixed depth times without testing for leaves. Rows are evaluated in
+ * blocks: each tree is walked for the whole block at once, one level at a time, which
+ * keeps the tree's nodes in cache and leaves a branch-free loop over the rows to vectorize.
+ *
+ * Comparisons match ONNX Runtime's: features are floats, BRANCH_LEQ/LT/GTE/GT with
+ * nodes_missing_value_tracks_true for NaN. Double thresholds are rounded to the float
+ * that splits float inputs the same way. Tree outputs are summed in float in tree id
+ * order, then averaged for AVERAGE, then base_values is added.
+ */
+class TreeEnsemble {
+public:
+    static constexpr size_t BLOCK_ROWS = 16;
+
+    TreeEnsemble() = default;
+
+    // Parses a serialized ONNX ModelProto. Throws InvalidValueError if it holds no single-target
+    // TreeEnsembleRegressor with SUM/AVERAGE aggregation and no post transform.
+    static TreeEnsemble fromOnnx(std::string_view model);
+    static TreeEnsemble loadOnnx(const std::string& path);
+
+    float predict(std::span<const float> features) const;
+    // One prediction per row of the row-major rows x (features.size() / rows) matrix.
+    std::vector<float> predictBatch(std::span<const float> features, size_t rows) const;
+
+    size_t treeCount() const noexcept { return roots_.size(); }
+    size_t nodeCount() const noexcept { return nodes_.size(); }
+    // Smallest row width the trees read from, one past the highest feature id.
+    size_t featureCount() const noexcept { return feature_count_; }
+
+private:
+    struct Node {
+        uint32_t feature;    // high bit set: NaN takes the true (left) branch
+        float threshold;     // go left when feature value <= threshold; leaves: the leaf value
+        uint32_t left;
+        uint32_t right;
+    };
+    static constexpr uint32_t NAN_LEFT = 0x80000000u;
+
+    std::vector<Node> nodes_;
+    std::vector<uint32_t> roots_;
+    std::vector<uint32_t> depths_;
+    size_t feature_count_ = 0;
+    bool average_ = false;
+    float base_value_ = 0.0f;
+
+    void evaluateBlock(const float* rows, size_t width, size_t count, float* out) const;
+};
+
+#endif // TREE_ENSEMBLE_H
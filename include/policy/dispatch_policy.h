@@ -4,6 +4,7 @@
 #include "simulator/state.h"
 #include "simulator/event.h"
 #include "simulator/action.h"
+#include "services/matrix_store.h"
 
 class DispatchPolicy {
 public:
@@ -11,6 +12,9 @@ public:
 
     // Handle dispatching logic given the state and an event
     virtual std::vector<Action> getAction(const State& state) = 0;
+
+    // Incident indices in the order they will be dispatched, lets matrix-backed policies read ahead.
+    virtual void setIncidentOrder(const std::vector<int>& incidentIndices) { (void)incidentIndices; }
     
     // Dispatch apparatus by type priority (you can customize this order)
     std::vector<ApparatusType> dispatchOrder = {
@@ -33,8 +37,10 @@ protected:
     int getNextIncidentIndex(const State& state) const;
     std::vector<int> getSortedIndicesByDuration(const std::vector<double>& durations);
     int findMinIndex(const std::vector<double>& durations);
-    std::vector<double> getColumn(double* matrix, int width, int height, int col_index) const;
+    std::vector<double> getColumn(const MatrixView& matrix, int col_index) const;
     std::vector<int> getColumn(int* matrix, int width, int height, int col_index) const;
+    std::unordered_map<ApparatusType, int> getRemainingApparatusNeeded(const Incident& incident) const;
+    bool canCoverFrom(const Incident& incident, const State& state, const std::vector<int>& stationOrder) const;
     std::vector<Action> getAction_(const Incident& incident, 
         const State& state, 
         const std::vector<int>& stationOrder, 
@@ -11,17 +11,19 @@ public:
     FireBeatsDispatch(const std::string& distanceMatrixPath="", 
                       const std::string& durationMatrixPath="",
                       const std::string& fireBeatsMatrixPath="",
-                      const std::string& zoneIDToNameMapPath="");
+                      const std::string& zoneIDToNameMapPath="",
+                      size_t matrixCacheTiles=64);
 
     std::vector<Action> getAction(const State& state) override;
+    void setIncidentOrder(const std::vector<int>& incidentIndices) override;
 
     ~FireBeatsDispatch();
 private:
     // Distance and duration matrices
     std::string distanceMatrixPath_;
     std::string durationMatrixPath_;
-    double* distanceMatrix_;
-    double* durationMatrix_;
+    std::unique_ptr<MatrixView> distanceMatrix_;
+    std::unique_ptr<MatrixView> durationMatrix_;
     int width_;
     int height_;
     // FireBeats matrix
@@ -5,21 +5,35 @@
 #include "dispatch_policy.h"
 #include "data/incident.h"
 #include "services/queries.h" // You should have an OSRM query utility class or function
+#include "services/station_order.h"
+#include "services/travel_time_oracle.h"
     
 class NearestDispatch : public DispatchPolicy {
 public:
-    NearestDispatch(const std::string& distanceMatrixPath="", const std::string& durationMatrixPath="");
+    NearestDispatch(const std::string& distanceMatrixPath="",
+                    const std::string& durationMatrixPath="",
+                    const std::string& stationOrderPath="",
+                    int stationOrderTopK=5,
+                    size_t matrixCacheTiles=64,
+                    const std::string& travelTimeOraclePath="");
 
     std::vector<Action> getAction(const State& state) override;
+    void setIncidentOrder(const std::vector<int>& incidentIndices) override;
 
-    ~NearestDispatch();
 private:
     std::string distanceMatrixPath_;
     std::string durationMatrixPath_;
-    double* distanceMatrix_;
-    double* durationMatrix_;
+    // Flat matrices are held in memory, tiled ones are paged in through an LRU cache.
+    std::unique_ptr<MatrixView> distanceMatrix_;
+    std::unique_ptr<MatrixView> durationMatrix_;
     int width_;
     int height_;
+    // Top-K nearest stations per incident, replaces the per-call sort.
+    StationOrderIndex stationOrder_;
+    // Grid travel times for incidents that are not a column of the matrix.
+    TravelTimeOracle travelTimeOracle_;
+
+    std::vector<Action> getActionFromOracle(const Incident& incident, const State& state);
 };
 
 #endif // NEAREST_DISPATCH_H
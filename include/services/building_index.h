@@ -0,0 +1,97 @@
+#ifndef BUILDING_INDEX_H
+#define BUILDING_INDEX_H
+
+#include <cstdint>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data/location.h"
+#include "utils/util.h"
+
+/**
+ * @brief One OSM building, at its node position or the center of its way/relation.
+ */
+struct Building {
+    int64_t id = 0;
+    Location location;
+    int levels = 1;          // building:levels, 1 when missing or unparsable
+    std::string type;        // building=* value, "yes" when untyped
+};
+
+/**
+ * @brief Buildings of an Overpass "[out:json] ... out center;" response. Elements without
+ * coordinates or a building tag are skipped.
+ */
+std::vector<Building> parseOverpassBuildings(const std::string& response);
+
+/**
+ * @brief Local building lookup around incidents, filled from Overpass one map tile at a time.
+ *
+ * Buildings are downloaded per slippy-map tile (zoom 15 is ~1 km here) the first time
+ * any location needs that tile, and kept in a binary cache file together with the
+ * list of tiles already covered, empty tiles included. Lookups are R-tree queries on
+ * the loaded buildings, so feature extraction never waits on the network.
+ */
+class BuildingIndex {
+public:
+    /**
+     * @brief Aggregate of the buildings within a radius, as used for model features.
+     */
+    struct Summary {
+        int count = 0;
+        int maxLevels = 0;
+        double nearestMeters = 0.0;  // radius when there is no building in range
+    };
+
+    BuildingIndex() = default;
+    explicit BuildingIndex(int zoom) : zoom_(zoom) {}
+
+    using Tile = std::pair<uint32_t, uint32_t>;  // x, y
+    static Tile tileOf(const Location& location, int zoom);
+    // South-west and north-east corners of a tile.
+    static std::pair<Location, Location> tileBounds(const Tile& tile, int zoom);
+
+    /**
+     * @brief Loads path, downloads the tiles the locations need (radius included) that it
+     * does not cover yet and writes the grown cache back. Download failures are logged and
+     * leave those tiles uncovered, so they are retried on the next run.
+     */
+    static BuildingIndex openOrFetch(const std::string& path,
+                                     const std::vector<Location>& locations,
+                                     double radiusMeters,
+                                     const std::string& overpassUrl,
+                                     int zoom = 15);
+
+    /**
+     * @throws InvalidValueError if the file is truncated or of another format.
+     */
+    static BuildingIndex load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Tiles the locations need that are not covered yet.
+    std::vector<Tile> missingTiles(const std::vector<Location>& locations, double radiusMeters) const;
+    // Adds buildings for a tile; buildings outside it are dropped, the next tile adds them.
+    void addTile(const Tile& tile, const std::vector<Building>& buildings);
+    bool covers(const Tile& tile) const { return tiles_.count(tile) > 0; }
+
+    std::vector<Building> within(const Location& center, double radiusMeters) const;
+    Summary summarize(const Location& center, double radiusMeters) const;
+
+    int zoom() const noexcept { return zoom_; }
+    size_t size() const noexcept { return buildings_.size(); }
+    size_t tileCount() const noexcept { return tiles_.size(); }
+
+private:
+    using Entry = std::pair<Point, uint32_t>;  // lon/lat point, index into buildings_
+
+    int zoom_ = 15;
+    std::set<Tile> tiles_;
+    std::vector<Building> buildings_;
+    bgi::rtree<Entry, bgi::quadratic<16>> rtree_;
+
+    template <typename Visit>
+    void visitWithin(const Location& center, double radiusMeters, Visit&& visit) const;
+};
+
+#endif // BUILDING_INDEX_H
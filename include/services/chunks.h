@@ -7,14 +7,18 @@
 #include <curl/curl.h>
 #include <nlohmann/json.hpp>
 #include "data/location.h"
+#include "services/matrix_store.h"
 
 using json = nlohmann::json;
 
 // Coordinate pair: lat, lon
-std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>> generate_osrm_table_chunks(
+// Returns {distances, durations} with rows = sources, fetched concurrently (see OsrmFetcher).
+// Requests are tiled over sources and destinations by TablePlanner; chunk_size only seeds
+// the destinations of the first requests (0 starts at OSRM_MAX_TABLE_SIZE).
+std::pair<FlatMatrix, FlatMatrix> generate_osrm_table_chunks(
     const std::vector<Location>& sources,
     const std::vector<Location>& destinations,
-    size_t chunk_size=100
+    size_t chunk_size=0
 );
 
 void print_matrix(const std::vector<std::vector<double>>& matrix,
@@ -26,9 +30,14 @@ void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
                          const std::string& filename,
                          int precision = 2,
                          bool add_headers = true);
+void write_matrix_to_csv(const MatrixView& matrix,
+                         const std::string& filename,
+                         int precision = 2,
+                         bool add_headers = true);
 
 void save_matrix_binary(const std::vector<std::vector<double>>& matrix,
                         const std::string& filename);
+void save_matrix_binary(const FlatMatrix& matrix, const std::string& filename);
 
 double* load_matrix_binary_flat(const std::string& filename, int& height, int& width);
 
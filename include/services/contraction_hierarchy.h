@@ -0,0 +1,78 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+#include "services/matrix_store.h"
+#include "services/road_graph.h"
+
+/**
+ * @brief Contraction hierarchy over a RoadGraph's durations, with a bucket many-to-many query.
+ *
+ * Nodes are contracted in edge-difference order; a shortcut is only added when a
+ * bounded witness search finds no path that is at least as fast. The result is an
+ * upward graph (searched forward from sources) and a downward graph stored reversed
+ * (searched backward from targets), both CSR, each arc carrying duration and distance.
+ *
+ * The file written by save() has the in-memory layout, so open() maps it read-only
+ * instead of parsing it: later runs pay neither the preprocessing nor a copy.
+ */
+class ContractionHierarchy {
+public:
+    ContractionHierarchy() = default;
+    ~ContractionHierarchy();
+    ContractionHierarchy(ContractionHierarchy&& other) noexcept;
+    ContractionHierarchy& operator=(ContractionHierarchy&& other) noexcept;
+    ContractionHierarchy(const ContractionHierarchy&) = delete;
+    ContractionHierarchy& operator=(const ContractionHierarchy&) = delete;
+
+    static ContractionHierarchy build(const RoadGraph& graph);
+
+    /**
+     * @brief Memory-maps a hierarchy written by save().
+     * @throws InvalidValueError if the file is missing, truncated or of another format.
+     */
+    static ContractionHierarchy open(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Opens path if it was built for this graph, otherwise builds and saves it there.
+    static ContractionHierarchy openOrBuild(const RoadGraph& graph, const std::string& path);
+
+    // Hash of the graph's topology and weights, to reject a hierarchy built for another graph.
+    static uint64_t fingerprint(const RoadGraph& graph);
+    uint64_t graphFingerprint() const noexcept;
+
+    size_t nodeCount() const noexcept;
+    size_t upEdgeCount() const noexcept { return upHeads_.size(); }
+    size_t downEdgeCount() const noexcept { return downHeads_.size(); }
+
+    /**
+     * @brief Fastest durations and their distances between graph nodes.
+     * One backward search per target fills per-node buckets, one forward search per
+     * source then scans the buckets of the nodes it settles. Both run in parallel.
+     * @return {distance matrix, duration matrix}, rows = sources, cols = targets.
+     * @throws InvalidValueError if a target is unreachable from a source.
+     */
+    std::pair<FlatMatrix, FlatMatrix> manyToMany(const std::vector<uint32_t>& sources,
+                                                 const std::vector<uint32_t>& targets,
+                                                 size_t threads = 0) const;
+
+private:
+    struct Header;
+
+    std::vector<uint64_t> owned_;  // 8-byte aligned backing store when built in memory
+    void* map_ = nullptr;
+    size_t mapSize_ = 0;
+
+    const Header* header_ = nullptr;
+    std::span<const uint32_t> upOffsets_, upHeads_, downOffsets_, downHeads_;
+    std::span<const double> upDurations_, upDistances_, downDurations_, downDistances_;
+
+    void bind(const void* base, size_t size);
+    void release() noexcept;
+};
+
+#endif // CONTRACTION_HIERARCHY_H
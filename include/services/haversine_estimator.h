@@ -0,0 +1,74 @@
+#ifndef HAVERSINE_ESTIMATOR_H
+#define HAVERSINE_ESTIMATOR_H
+
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "data/location.h"
+#include "services/matrix_store.h"
+
+/**
+ * @brief Road circuity and driving speeds learned from an OSRM matrix.
+ * Road distance = circuity * great-circle distance, duration = road distance / zone speed.
+ */
+struct EstimatorCalibration {
+    double circuity = 1.3;
+    double defaultSpeedMps = 13.4;  // ~30 mph
+    std::unordered_map<int, double> zoneSpeedMps;
+
+    /**
+     * @brief Fits the calibration against OSRM matrices (rows = sources, cols = destinations).
+     * Circuity is the median road / great-circle ratio, speeds are distance-weighted per zone.
+     * @param destinationZones Zone index per destination, -1 for none.
+     */
+    static EstimatorCalibration fit(const std::vector<Location>& sources,
+                                    const std::vector<Location>& destinations,
+                                    const std::vector<int>& destinationZones,
+                                    const MatrixView& distances,
+                                    const MatrixView& durations);
+
+    double speedForZone(int zone) const;
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+};
+
+/**
+ * @brief Station x incident distance and duration estimates without a routing server.
+ *
+ * Locations are converted once to unit vectors (precomputed sin/cos) stored as
+ * structure-of-arrays. A matrix row then only needs multiply-adds, one sqrt and a
+ * polynomial asin per destination, a branch-free loop the compiler vectorizes for
+ * AVX2 or NEON. The great-circle distance uses constants::EARTH_RADIUS_KM.
+ */
+class HaversineEstimator {
+public:
+    HaversineEstimator(const std::vector<Location>& sources,
+                       const std::vector<Location>& destinations,
+                       const std::vector<int>& destinationZones = {},
+                       const EstimatorCalibration& calibration = {});
+
+    size_t sources() const noexcept { return sx_.size(); }
+    size_t destinations() const noexcept { return dx_.size(); }
+
+    // Great-circle distances in meters from source to every destination.
+    void greatCircleRow(size_t source, double* meters) const;
+
+    // Calibrated road distances (meters) and durations (seconds) from source to every destination.
+    void estimateRow(size_t source, double* distances, double* durations) const;
+
+    /**
+     * @brief Full matrices in the layout returned by generate_osrm_table_chunks.
+     * @return {distance matrix, duration matrix}, rows = sources.
+     */
+    std::pair<FlatMatrix, FlatMatrix> estimateMatrices(size_t numThreads = 0) const;
+
+private:
+    double circuity_;
+    std::vector<double> sx_, sy_, sz_;
+    std::vector<double> dx_, dy_, dz_;
+    std::vector<double> invSpeed_;  // seconds per meter for each destination
+};
+
+#endif // HAVERSINE_ESTIMATOR_H
@@ -0,0 +1,90 @@
+#ifndef INPUT_SNAPSHOT_H
+#define INPUT_SNAPSHOT_H
+
+#include <array>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "data/apparatus.h"
+#include "data/incident.h"
+#include "data/station.h"
+
+/**
+ * @brief Columnar binary snapshot of the loaded stations, incidents and apparatus.
+ *
+ * Holds what the CSV loaders produce after the bounds filter and zone assignment,
+ * one array per field (incident lat, lon, report time, zone, type, ...), each 8-byte
+ * aligned. The header records a hash of every source file, so a run whose inputs
+ * are unchanged maps the snapshot read-only instead of parsing anything.
+ */
+class InputSnapshot {
+public:
+    // Hashed inputs, in header order. LocalTimeZone stands for the zone report times were parsed in.
+    enum Source : size_t { StationsCsv, IncidentsCsv, ApparatusCsv, BoundsGeojson, BeatsGeojson, LocalTimeZone, SourceCount };
+    using SourceHashes = std::array<uint64_t, SourceCount>;
+
+    InputSnapshot() = default;
+    ~InputSnapshot();
+    InputSnapshot(InputSnapshot&& other) noexcept;
+    InputSnapshot& operator=(InputSnapshot&& other) noexcept;
+    InputSnapshot(const InputSnapshot&) = delete;
+    InputSnapshot& operator=(const InputSnapshot&) = delete;
+
+    // 64-bit hash of a file's bytes, 0 when it cannot be read.
+    static uint64_t hashFile(const std::string& path);
+    // Hashes of the files named by STATIONS_CSV_PATH, INCIDENTS_CSV_PATH, APPARATUS_CSV_PATH,
+    // BOUNDS_GEOJSON_PATH and BEATS_SHAPEFILE_PATH, and of the local UTC offsets.
+    static SourceHashes sourceHashesFromEnv();
+
+    static bool save(const std::string& path, const SourceHashes& sources, const std::vector<Station>& stations,
+                     const std::vector<Incident>& incidents, const std::vector<Apparatus>& apparatuses);
+
+    /**
+     * @brief Memory-maps a snapshot written by save().
+     * @throws InvalidValueError if the file is missing, truncated or of another format.
+     */
+    static InputSnapshot open(const std::string& path);
+
+    const SourceHashes& sourceHashes() const noexcept { return sources_; }
+
+    size_t stationCount() const noexcept { return stationIds_.size(); }
+    size_t incidentCount() const noexcept { return incidentIds_.size(); }
+    size_t apparatusCount() const noexcept { return apparatusStations_.size(); }
+
+    // Columns, valid while the snapshot is alive.
+    std::span<const int32_t> incidentIds() const noexcept { return incidentIds_; }
+    std::span<const double> incidentLats() const noexcept { return incidentLats_; }
+    std::span<const double> incidentLons() const noexcept { return incidentLons_; }
+    std::span<const int64_t> reportTimes() const noexcept { return reportTimes_; }
+    std::span<const int32_t> zoneIndices() const noexcept { return zones_; }
+
+    // The objects the loaders would have returned, indices as they assigned them.
+    std::vector<Station> stations() const;
+    std::vector<Incident> incidents() const;
+    std::vector<Apparatus> apparatuses() const;
+
+private:
+    struct Header;
+
+    void* map_ = nullptr;
+    size_t mapSize_ = 0;
+
+    SourceHashes sources_{};
+    std::span<const int32_t> stationIds_, stationTrucks_, stationAmbulances_;
+    std::span<const double> stationLons_, stationLats_;
+    std::span<const uint32_t> nameOffsets_;
+    std::span<const char> names_;
+    std::span<const int32_t> incidentIds_;
+    std::span<const double> incidentLats_, incidentLons_;
+    std::span<const int64_t> reportTimes_;
+    std::span<const int32_t> zones_;
+    std::span<const uint8_t> types_, levels_, categories_;
+    std::span<const int32_t> apparatusStations_;
+    std::span<const uint8_t> apparatusTypes_;
+
+    void bind(const void* base, size_t size);
+    void release() noexcept;
+};
+
+#endif // INPUT_SNAPSHOT_H
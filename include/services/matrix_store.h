@@ -0,0 +1,151 @@
+#ifndef MATRIX_STORE_H
+#define MATRIX_STORE_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+/**
+ * @brief Read-only view of a station x incident matrix.
+ * Rows are stations, columns are incidents, matching the binary matrix files.
+ */
+class MatrixView {
+public:
+    virtual ~MatrixView() = default;
+
+    virtual int width() const = 0;   // number of incidents (columns)
+    virtual int height() const = 0;  // number of stations (rows)
+    virtual double at(int row, int col) const = 0;
+
+    // Copies the height() values of column col into out.
+    virtual void column(int col, double* out) const = 0;
+
+    // Order in which columns are expected to be read, used for read-ahead. No-op by default.
+    virtual void setAccessPlan(const std::vector<int>& cols) { (void)cols; }
+};
+
+/**
+ * @brief In-memory row-major matrix, the layout written by save_matrix_binary.
+ */
+class FlatMatrix : public MatrixView {
+public:
+    FlatMatrix() = default;
+    FlatMatrix(int width, int height, double fill = -1.0)
+        : width_(width), height_(height), data_(static_cast<size_t>(width) * height, fill) {}
+
+    static FlatMatrix load(const std::string& filename);
+
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    double at(int row, int col) const override { return data_[static_cast<size_t>(row) * width_ + col]; }
+    void column(int col, double* out) const override;
+
+    double& operator()(int row, int col) { return data_[static_cast<size_t>(row) * width_ + col]; }
+    double* data() noexcept { return data_.data(); }
+    const double* data() const noexcept { return data_.data(); }
+    bool empty() const noexcept { return data_.empty(); }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    std::vector<double> data_;
+};
+
+/**
+ * @brief Out-of-core matrix stored as tiles of incident columns, read through an LRU tile cache.
+ *
+ * File layout: char magic[4] = "FSTM", uint32 version, int width, int height, int tileCols,
+ * then tiles in order. Tile t holds columns [t * tileCols, (t + 1) * tileCols), each column
+ * stored contiguously (height doubles), so a column read touches a single tile.
+ *
+ * Incidents arrive in time order, so after each access the store schedules the tiles of
+ * the next columns in the access plan on a background thread.
+ */
+class TiledMatrixStore : public MatrixView {
+public:
+    static constexpr char MAGIC[4] = {'F', 'S', 'T', 'M'};
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @param filename Tiled matrix file.
+     * @param cacheTiles Maximum number of tiles kept in memory.
+     * @param readAheadCols How many upcoming columns of the access plan to prefetch.
+     */
+    TiledMatrixStore(const std::string& filename, size_t cacheTiles = 64, size_t readAheadCols = 256);
+    ~TiledMatrixStore() override;
+
+    TiledMatrixStore(const TiledMatrixStore&) = delete;
+    TiledMatrixStore& operator=(const TiledMatrixStore&) = delete;
+
+    int width() const override { return width_; }
+    int height() const override { return height_; }
+    int tileCols() const noexcept { return tileCols_; }
+    double at(int row, int col) const override;
+    void column(int col, double* out) const override;
+    void setAccessPlan(const std::vector<int>& cols) override;
+
+    // Schedules the tiles holding cols for background loading.
+    void prefetch(const std::vector<int>& cols) const;
+
+    size_t cachedTiles() const;
+    size_t cacheMisses() const;
+
+private:
+    using Tile = std::shared_ptr<const std::vector<double>>;
+
+    std::string filename_;
+    int width_ = 0;
+    int height_ = 0;
+    int tileCols_ = 0;
+    std::streamoff dataOffset_ = 0;
+    size_t capacity_;
+    size_t readAheadCols_;
+
+    // Access plan: plan_[i] is the i-th column to be read, planPos_[col] its position.
+    std::vector<int> plan_;
+    std::vector<int> planPos_;
+
+    mutable std::mutex ioMutex_;
+    mutable std::ifstream file_;
+
+    mutable std::mutex cacheMutex_;
+    mutable std::list<int> lru_;  // front is most recently used
+    mutable std::unordered_map<int, std::pair<Tile, std::list<int>::iterator>> cache_;
+    mutable size_t misses_ = 0;
+
+    mutable std::deque<int> pending_;
+    mutable std::unordered_set<int> queued_;
+    mutable std::condition_variable pendingCv_;
+    bool stop_ = false;
+    std::thread prefetcher_;
+
+    Tile getTile(int tile) const;
+    Tile readTile(int tile) const;
+    Tile insertTile(int tile, Tile data) const;
+    void scheduleReadAhead(int col) const;
+    void prefetchLoop();
+};
+
+/**
+ * @brief Opens a matrix file, detecting the tiled format by its magic header.
+ * Flat files are loaded fully into memory.
+ */
+std::unique_ptr<MatrixView> openMatrix(const std::string& filename, size_t cacheTiles = 64);
+
+/**
+ * @brief Writes any matrix view in the tiled format.
+ * @return true on success.
+ */
+bool writeTiledMatrix(const MatrixView& matrix, const std::string& filename, int tileCols = 4096);
+bool writeTiledMatrix(const std::vector<std::vector<double>>& matrix, const std::string& filename, int tileCols = 4096);
+
+#endif // MATRIX_STORE_H
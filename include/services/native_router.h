@@ -0,0 +1,60 @@
+#ifndef NATIVE_ROUTER_H
+#define NATIVE_ROUTER_H
+
+#include <memory>
+#include <utility>
+#include <vector>
+#include "data/location.h"
+#include "services/contraction_hierarchy.h"
+#include "services/matrix_store.h"
+#include "services/road_graph.h"
+#include "utils/util.h"
+
+struct NativeRouterOptions {
+    double snapSpeedMps = 5.0;  // speed of the leg between a location and its snapped node
+    size_t threads = 0;         // 0 uses all hardware threads
+};
+
+/**
+ * @brief Builds station x incident matrices from a local RoadGraph, no OSRM server needed.
+ *
+ * Locations snap to the nearest node of the graph's largest strongly connected
+ * component (R-tree). Each source then runs one Dijkstra on durations that stops
+ * once every destination node is settled; sources run in parallel, each thread
+ * with its own labels. Distances follow the fastest path, as OSRM's table does.
+ * With a contraction hierarchy attached, tables use its bucket query instead.
+ */
+class NativeRouter {
+public:
+    struct Snap {
+        uint32_t node;
+        double meters;  // great-circle length of the leg to the node
+    };
+
+    explicit NativeRouter(RoadGraph graph, const NativeRouterOptions& options = {});
+
+    const RoadGraph& graph() const noexcept { return graph_; }
+
+    // @throws MismatchError if the hierarchy was built for another graph.
+    void useHierarchy(ContractionHierarchy hierarchy);
+
+    Snap snap(const Location& location) const;
+
+    /**
+     * @brief Same layout as generate_osrm_table_chunks.
+     * @return {distance matrix, duration matrix}, rows = sources.
+     */
+    std::pair<FlatMatrix, FlatMatrix> tableMatrices(const std::vector<Location>& sources,
+                                                    const std::vector<Location>& destinations) const;
+
+private:
+    using NodeEntry = std::pair<Point, uint32_t>;
+
+    RoadGraph graph_;
+    NativeRouterOptions options_;
+    double lonScale_ = 1.0;
+    bgi::rtree<NodeEntry, bgi::quadratic<16>> rtree_;
+    std::unique_ptr<ContractionHierarchy> hierarchy_;
+};
+
+#endif // NATIVE_ROUTER_H
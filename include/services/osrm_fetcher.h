@@ -0,0 +1,81 @@
+#ifndef OSRM_FETCHER_H
+#define OSRM_FETCHER_H
+
+#include <functional>
+#include <string>
+#include <vector>
+#include <curl/curl.h>
+
+/**
+ * @brief Tuning for OsrmFetcher. maxInFlight should match the OSRM server's worker threads.
+ */
+struct OsrmFetchOptions {
+    size_t maxInFlight = 4;
+    long timeoutMs = 60000;
+    long connectTimeoutMs = 5000;
+    int maxRetries = 3;
+    long retryBackoffMs = 250;  // doubled after every failed attempt
+
+    // Reads OSRM_MAX_IN_FLIGHT, OSRM_TIMEOUT_MS, OSRM_MAX_RETRIES and OSRM_RETRY_BACKOFF_MS.
+    static OsrmFetchOptions fromEnv();
+};
+
+/**
+ * @brief Latency of the successful responses of the last fetchAll().
+ */
+struct OsrmFetchStats {
+    size_t responses = 0;
+    double totalLatencyMs = 0.0;
+    double maxLatencyMs = 0.0;
+
+    double meanLatencyMs() const { return responses ? totalLatencyMs / responses : 0.0; }
+};
+
+/**
+ * @brief Concurrent HTTP GETs against OSRM on a single curl multi handle.
+ *
+ * A fixed pool of easy handles is reused for every request, so connections stay
+ * alive between chunks instead of reconnecting per request. Transport errors, 5xx
+ * and 429 responses are retried with exponential backoff; other failures throw.
+ */
+class OsrmFetcher {
+public:
+    using ResponseHandler = std::function<void(size_t index, const std::string& body)>;
+    using RejectionHandler = std::function<void(size_t index, long status, const std::string& body)>;
+
+    explicit OsrmFetcher(const OsrmFetchOptions& options = {});
+    ~OsrmFetcher();
+
+    OsrmFetcher(const OsrmFetcher&) = delete;
+    OsrmFetcher& operator=(const OsrmFetcher&) = delete;
+
+    /**
+     * @brief Fetches every URL, keeping at most maxInFlight requests open.
+     * @param onResponse Called on the calling thread with the URL index and body of each
+     *        successful response, in completion order.
+     * @param onRejected Receives non-retryable 4xx responses while the other requests carry on.
+     * @throws OSRMRequestRejectedError on a non-retryable 4xx response when onRejected is empty.
+     * @throws OSRMError when a request fails after all retries.
+     */
+    void fetchAll(const std::vector<std::string>& urls, const ResponseHandler& onResponse,
+                  const RejectionHandler& onRejected = nullptr);
+
+    const OsrmFetchStats& lastStats() const { return stats_; }
+
+private:
+    struct Slot {
+        CURL* handle = nullptr;
+        size_t index = 0;
+        std::string body;
+        bool busy = false;
+    };
+
+    OsrmFetchOptions options_;
+    CURLM* multi_ = nullptr;
+    std::vector<Slot> slots_;
+    OsrmFetchStats stats_;
+
+    void release(Slot& slot);
+};
+
+#endif // OSRM_FETCHER_H
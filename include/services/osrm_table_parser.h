@@ -0,0 +1,30 @@
+#ifndef OSRM_TABLE_PARSER_H
+#define OSRM_TABLE_PARSER_H
+
+#include <string>
+#include "services/matrix_store.h"
+
+/**
+ * @brief Streams an OSRM /table response into preallocated matrices.
+ *
+ * Uses the nlohmann SAX interface, so no JSON DOM is built: every duration and
+ * distance is written straight to (sourceOffset + row, destinationOffset + col)
+ * of the target matrix as it is scanned. Other fields (sources, destinations
+ * waypoints, ...) are skipped.
+ *
+ * @param body Raw response body.
+ * @param distances Matrix receiving the "distances" annotation (rows = sources).
+ * @param durations Matrix receiving the "durations" annotation (rows = sources).
+ * @param destinationOffset Column of the chunk's first destination.
+ * @param sourceOffset Row of the chunk's first source.
+ * @return false if OSRM answered with a code other than "Ok".
+ * @throws OSRMError on unreachable pairs (null entries) or values outside the matrix.
+ * @throws std::runtime_error on malformed JSON.
+ */
+bool parseOsrmTableResponse(const std::string& body,
+                            FlatMatrix& distances,
+                            FlatMatrix& durations,
+                            size_t destinationOffset,
+                            size_t sourceOffset = 0);
+
+#endif // OSRM_TABLE_PARSER_H
@@ -0,0 +1,62 @@
+#ifndef ROAD_GRAPH_H
+#define ROAD_GRAPH_H
+
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+#include "data/location.h"
+
+/**
+ * @brief Directed road network in compressed sparse row form.
+ *
+ * Outgoing edges of node v are [edgeBegin(v), edgeEnd(v)) in heads(), distances()
+ * and durations(), so a search touches one contiguous block per settled node.
+ */
+class RoadGraph {
+public:
+    struct Edge {
+        uint32_t from;
+        uint32_t to;
+        double distance;  // meters
+        double duration;  // seconds
+    };
+
+    RoadGraph() = default;
+    RoadGraph(std::vector<Location> nodes, const std::vector<Edge>& edges);
+
+    /**
+     * @brief Loads a preprocessed edge list (see scripts/extract_road_graph.py).
+     * @param nodesPath CSV "id,lat,lon" with a header, ids are any 64-bit integers.
+     * @param edgesPath CSV "from,to,distance_m,duration_s" with a header, one line per direction.
+     * @throws InvalidValueError on unreadable files, malformed lines or unknown node ids.
+     */
+    static RoadGraph loadCsv(const std::string& nodesPath, const std::string& edgesPath);
+
+    size_t nodeCount() const noexcept { return nodes_.size(); }
+    size_t edgeCount() const noexcept { return heads_.size(); }
+    const Location& node(uint32_t v) const { return nodes_[v]; }
+    const std::vector<Location>& nodes() const noexcept { return nodes_; }
+
+    uint32_t edgeBegin(uint32_t v) const { return offsets_[v]; }
+    uint32_t edgeEnd(uint32_t v) const { return offsets_[v + 1]; }
+    std::span<const uint32_t> heads() const noexcept { return heads_; }
+    std::span<const double> distances() const noexcept { return distances_; }
+    std::span<const double> durations() const noexcept { return durations_; }
+
+    /**
+     * @brief Marks the nodes of the largest strongly connected component.
+     * Snapping only to these keeps every source/destination pair routable, stray
+     * one-way stubs and disconnected islands in OSM extracts are common.
+     */
+    std::vector<uint8_t> largestComponent() const;
+
+private:
+    std::vector<Location> nodes_;
+    std::vector<uint32_t> offsets_;
+    std::vector<uint32_t> heads_;
+    std::vector<double> distances_;
+    std::vector<double> durations_;
+};
+
+#endif // ROAD_GRAPH_H
@@ -0,0 +1,77 @@
+#ifndef ROUTE_GEOMETRY_H
+#define ROUTE_GEOMETRY_H
+
+#include <ctime>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "data/location.h"
+#include "services/osrm_fetcher.h"
+
+/**
+ * @brief Full OSRM /route overview of one origin-destination pair.
+ */
+struct RouteGeometry {
+    double duration = 0.0;  // seconds
+    double distance = 0.0;  // meters
+    std::vector<std::pair<double, double>> coordinates;  // lon, lat
+};
+
+/**
+ * @brief Route geometries persisted across runs, keyed by the coordinates OSRM was asked for.
+ *
+ * The file holds one JSON object per line and is only ever appended to, so an
+ * interrupted run keeps everything it fetched and a torn last line is skipped on load.
+ */
+class RouteGeometryCache {
+public:
+    // Loads path when it exists; an empty path keeps the cache in memory only.
+    explicit RouteGeometryCache(std::string path = "");
+
+    // Key of a pair, locationToString of both ends as in an OSRM URL.
+    static std::string key(const Location& from, const Location& to);
+
+    const RouteGeometry* find(const Location& from, const Location& to) const;
+    size_t size() const noexcept { return routes_.size(); }
+
+    /**
+     * @brief Fetches the pairs that are not cached yet, concurrently and each distinct pair once.
+     * Pairs OSRM rejects (NoRoute, ...) are logged and left out.
+     * @return Number of routes added.
+     * @throws OSRMError when a request fails after all retries.
+     */
+    size_t fetchMissing(const std::vector<std::pair<Location, Location>>& pairs,
+                        const std::string& baseUrl,
+                        const OsrmFetchOptions& options = OsrmFetchOptions::fromEnv());
+
+private:
+    std::string path_;
+    std::unordered_map<std::string, RouteGeometry> routes_;
+};
+
+/**
+ * @brief One apparatus movement drawn in the routes GeoJSON.
+ */
+struct RouteTrip {
+    int incidentId = 0;
+    int stationId = 0;
+    std::string direction;  // "to_fire" or "from_fire"
+    std::time_t departure = 0;
+    Location from;
+    Location to;
+};
+
+/**
+ * @brief Writes the trips as the FeatureCollection the route viewer reads.
+ *
+ * One LineString per (incident, station, direction) with [lon, lat, 0, timestamp]
+ * points, the route duration spread evenly over its points, trips of the same key
+ * chained after the first departure. Trips without a cached route are skipped.
+ * @return Number of features written.
+ */
+size_t writeRoutesGeoJson(const std::vector<RouteTrip>& trips,
+                          const RouteGeometryCache& cache,
+                          const std::string& path);
+
+#endif // ROUTE_GEOMETRY_H
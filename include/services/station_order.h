@@ -0,0 +1,104 @@
+#ifndef STATION_ORDER_H
+#define STATION_ORDER_H
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <string>
+#include <vector>
+#include "services/matrix_store.h"
+#include "utils/parallel.h"
+
+/**
+ * @brief Precomputed top-K nearest stations for every incident column of a duration matrix.
+ *
+ * For each incident the K closest stations are stored as (station index, duration)
+ * pairs sorted by duration, ties broken by station index. Policies walk this short
+ * list instead of sorting the whole column on every call, and only fall back to a
+ * full order when the first K stations cannot cover the request.
+ *
+ * Binary layout (same header convention as the matrix files):
+ * int width, int height, int k, int32 stations[width * k], double durations[width * k]
+ */
+class StationOrderIndex {
+public:
+    StationOrderIndex() = default;
+
+    /**
+     * @brief Builds the index from a flat row-major duration matrix (rows = stations, cols = incidents).
+     * @param numThreads Worker threads, 0 means hardware concurrency.
+     */
+    StationOrderIndex(const double* durationMatrix, int width, int height, int k, size_t numThreads = 0);
+    StationOrderIndex(const std::vector<std::vector<double>>& durationMatrix, int k, size_t numThreads = 0);
+    StationOrderIndex(const MatrixView& durationMatrix, int k, size_t numThreads = 0);
+
+    /**
+     * @brief Builds the index from any accessor at(row, col) -> duration.
+     */
+    template <typename At>
+    void build(int width, int height, int k, At at, size_t numThreads = 0);
+
+    /**
+     * @brief Builds the index from a column loader fill(col, double* out) writing height values.
+     */
+    template <typename Fill>
+    void buildFromColumns(int width, int height, int k, Fill fill, size_t numThreads = 0);
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    bool empty() const noexcept { return width_ == 0; }
+    int width() const noexcept { return width_; }
+    int height() const noexcept { return height_; }
+    int k() const noexcept { return k_; }
+
+    // K station indices for the incident, nearest first.
+    const int32_t* stations(int incidentIndex) const { return stations_.data() + static_cast<size_t>(incidentIndex) * k_; }
+    // K durations matching stations(incidentIndex).
+    const double* durations(int incidentIndex) const { return durations_.data() + static_cast<size_t>(incidentIndex) * k_; }
+
+private:
+    int width_ = 0;
+    int height_ = 0;
+    int k_ = 0;
+    std::vector<int32_t> stations_;
+    std::vector<double> durations_;
+};
+
+template <typename At>
+void StationOrderIndex::build(int width, int height, int k, At at, size_t numThreads) {
+    buildFromColumns(width, height, k, [&at, height](int col, double* out) {
+        for (int row = 0; row < height; ++row) {
+            out[row] = at(row, col);
+        }
+    }, numThreads);
+}
+
+template <typename Fill>
+void StationOrderIndex::buildFromColumns(int width, int height, int k, Fill fill, size_t numThreads) {
+    width_ = width;
+    height_ = height;
+    k_ = std::clamp(k, 0, height);
+    stations_.assign(static_cast<size_t>(width_) * k_, -1);
+    durations_.assign(static_cast<size_t>(width_) * k_, -1.0);
+    if (k_ == 0) return;
+
+    utils::parallelFor(static_cast<size_t>(width_), [&](size_t begin, size_t end) {
+        std::vector<double> column(height_);
+        std::vector<int32_t> order(height_);
+        for (size_t col = begin; col < end; ++col) {
+            fill(static_cast<int>(col), column.data());
+            std::iota(order.begin(), order.end(), 0);
+            std::partial_sort(order.begin(), order.begin() + k_, order.end(),
+                [&column](int32_t a, int32_t b) {
+                    return column[a] < column[b] || (column[a] == column[b] && a < b);
+                });
+            for (int i = 0; i < k_; ++i) {
+                stations_[col * k_ + i] = order[i];
+                durations_[col * k_ + i] = column[order[i]];
+            }
+        }
+    }, numThreads);
+}
+
+#endif // STATION_ORDER_H
@@ -0,0 +1,92 @@
+#ifndef TABLE_PLANNER_H
+#define TABLE_PLANNER_H
+
+#include <deque>
+#include <string>
+#include <utility>
+#include <vector>
+#include "data/location.h"
+
+/**
+ * @brief A block of an OSRM table request: sources [sourceBegin, sourceEnd) x destinations [destinationBegin, destinationEnd).
+ */
+struct TableTile {
+    size_t sourceBegin = 0;
+    size_t sourceEnd = 0;
+    size_t destinationBegin = 0;
+    size_t destinationEnd = 0;
+
+    size_t sources() const { return sourceEnd - sourceBegin; }
+    size_t destinations() const { return destinationEnd - destinationBegin; }
+};
+
+/**
+ * @brief Limits for TablePlanner, see fromEnv().
+ */
+struct TablePlannerOptions {
+    size_t maxCoordinates = 1000;   // osrm-routed --max-table-size, sources + destinations per request
+    size_t maxUrlLength = 8192;     // request line limit of OSRM or any proxy in front of it
+    long targetLatencyMs = 2000;    // tiles grow while responses are faster than half of this
+    size_t initialDestinations = 0; // destinations of the first tiles, 0 starts at the coordinate limit
+
+    // Reads OSRM_MAX_TABLE_SIZE, OSRM_MAX_URL_LENGTH and OSRM_TARGET_LATENCY_MS.
+    static TablePlannerOptions fromEnv();
+};
+
+/**
+ * @brief Distinct coordinates of a location list, as OSRM sees them (locationToString).
+ * index[i] is the position of locations[i] in coordinates.
+ */
+struct UniqueCoordinates {
+    std::vector<std::string> coordinates;
+    std::vector<int> index;
+
+    static UniqueCoordinates from(const std::vector<Location>& locations);
+};
+
+/**
+ * @brief Tiles a sources x destinations table into OSRM requests and adapts the tile size.
+ *
+ * Tiles are cut from the pending area with a guillotine cut, so the whole table is
+ * covered exactly once. Each tile holds at most budget() coordinates: all sources
+ * while they fit in half the budget, the rest of the budget goes to destinations.
+ * The budget grows while responses come back well under the target latency,
+ * shrinks when they are slower, and halves when OSRM rejects a request.
+ */
+class TablePlanner {
+public:
+    TablePlanner(size_t sources, size_t destinations, size_t coordinateLimit, const TablePlannerOptions& options);
+
+    /**
+     * @brief Largest coordinate count whose table URL stays under maxUrlLength.
+     * @param overhead Length of the URL without coordinates and indices.
+     * @param coordinateLength Length of the longest "lon,lat" string.
+     */
+    static size_t urlCoordinateLimit(size_t maxUrlLength, size_t overhead, size_t coordinateLength);
+
+    // Cuts up to maxTiles tiles of the current shape from the pending area.
+    std::vector<TableTile> nextWave(size_t maxTiles);
+
+    // Puts a tile that was not filled back in front of the pending area.
+    void requeue(const TableTile& tile);
+
+    // Adjusts the budget from the mean latency of a successful wave.
+    void recordLatency(double meanLatencyMs);
+
+    // Halves the budget after a rejection, false if it is already at the minimum.
+    bool shrink();
+
+    bool done() const { return pending_.empty(); }
+    size_t budget() const { return budget_; }
+    std::pair<size_t, size_t> tileShape() const;
+
+private:
+    size_t sources_;
+    size_t destinations_;
+    size_t limit_;
+    long targetLatencyMs_;
+    size_t budget_;
+    std::deque<TableTile> pending_;
+};
+
+#endif // TABLE_PLANNER_H
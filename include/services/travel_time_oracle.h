@@ -0,0 +1,80 @@
+#ifndef TRAVEL_TIME_ORACLE_H
+#define TRAVEL_TIME_ORACLE_H
+
+#include <string>
+#include <vector>
+#include "data/location.h"
+#include "services/matrix_store.h"
+
+/**
+ * @brief Regular lat/lon grid over the service area.
+ * Cells are numbered row-major from (minLat, minLon).
+ */
+struct GridSpec {
+    double minLat = 0.0;
+    double minLon = 0.0;
+    double cellLat = 0.0;  // cell height in degrees
+    double cellLon = 0.0;  // cell width in degrees
+    int rows = 0;
+    int cols = 0;
+
+    /**
+     * @brief Covers the bounding box with roughly square cells of the given size.
+     * @param cellSizeMeters Cell edge length, converted to degrees at the box's mid latitude.
+     */
+    static GridSpec fromBounds(double minLat, double minLon, double maxLat, double maxLon, double cellSizeMeters);
+
+    int cellCount() const noexcept { return rows * cols; }
+    // Cell containing the point, or -1 if it falls outside the grid.
+    int cellIndex(double lat, double lon) const noexcept;
+    Location cellCenter(int cell) const noexcept;
+};
+
+/**
+ * @brief Station -> grid cell travel times, answering durations for arbitrary locations.
+ *
+ * Incidents that are not a column of the precomputed matrix (synthetic or live ones)
+ * are snapped to their grid cell, whose durations to every station were computed from
+ * the cell centre. Durations are stored cell-major so a lookup reads one contiguous
+ * block of stations() values.
+ *
+ * Binary layout: int rows, int cols, int stations,
+ * double minLat, minLon, cellLat, cellLon, double durations[rows * cols * stations]
+ */
+class TravelTimeOracle {
+public:
+    TravelTimeOracle() = default;
+
+    /**
+     * @param grid The grid the durations were computed on.
+     * @param stationToCell Durations with rows = stations, cols = cells (the OSRM table layout).
+     */
+    TravelTimeOracle(const GridSpec& grid, const std::vector<std::vector<double>>& stationToCell);
+    TravelTimeOracle(const GridSpec& grid, const MatrixView& stationToCell);
+
+    /**
+     * @brief Queries OSRM for the durations from every station to every cell centre.
+     * @throws OSRMError if a route cannot be computed.
+     */
+    static TravelTimeOracle buildFromOSRM(const std::vector<Location>& stations, const GridSpec& grid, size_t chunkSize = 0);
+
+    bool save(const std::string& filename) const;
+    bool load(const std::string& filename);
+
+    bool empty() const noexcept { return durations_.empty(); }
+    int stations() const noexcept { return stations_; }
+    const GridSpec& grid() const noexcept { return grid_; }
+
+    // stations() durations for the cell containing the location, nullptr outside the grid.
+    const double* durations(const Location& location) const noexcept;
+    const double* cellDurations(int cell) const noexcept {
+        return durations_.data() + static_cast<size_t>(cell) * stations_;
+    }
+
+private:
+    GridSpec grid_;
+    int stations_ = 0;
+    std::vector<double> durations_;
+};
+
+#endif // TRAVEL_TIME_ORACLE_H
@@ -0,0 +1,60 @@
+#ifndef ZONE_RASTER_H
+#define ZONE_RASTER_H
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "utils/util.h"
+
+/**
+ * @brief Raster of the service zone polygons for point-to-zone lookups.
+ *
+ * A 2^levels x 2^levels grid over the polygons' extent. A cell lying inside one polygon
+ * and touching no other stores that polygon's index, a cell touching none stores "none",
+ * and a mixed cell lists the polygons crossing it, which are then tested exactly with
+ * covered_by in index order. The grid is built by quadrant subdivision, so only cells
+ * near polygon borders cost polygon tests to classify.
+ *
+ * Cells are classified with a small padding, a point rounding into a neighbouring
+ * cell still gets that cell's exact answer.
+ */
+class ZoneRaster {
+public:
+    static constexpr unsigned DEFAULT_LEVELS = 9;
+
+    ZoneRaster() = default;
+    explicit ZoneRaster(std::vector<Polygon> polygons, unsigned levels = DEFAULT_LEVELS);
+
+    /**
+     * @brief Loads the raster at path if it was built from the same source (hash and polygon
+     * count), otherwise builds it and saves it there. An empty path only builds.
+     */
+    static ZoneRaster openOrBuild(const std::string& path, std::vector<Polygon> polygons, uint64_t sourceHash,
+                                  unsigned levels = DEFAULT_LEVELS);
+    bool save(const std::string& path, uint64_t sourceHash) const;
+
+    // Index of the polygon covering point, boundaries included.
+    std::optional<size_t> locate(const Point& point) const;
+    // locate() for every point, split across threads (0 = hardware concurrency).
+    std::vector<std::optional<size_t>> locate(const std::vector<Point>& points, size_t threads = 0) const;
+
+    size_t side() const noexcept { return side_; }
+    size_t mixedCellCount() const noexcept { return mixedBegin_.empty() ? 0 : mixedBegin_.size() - 1; }
+
+private:
+    static constexpr int32_t NONE = -1;  // cells <= -2 are mixed, entry -(cell + 2)
+
+    std::vector<Polygon> polygons_;
+    double minX_ = 0.0, minY_ = 0.0, cellX_ = 1.0, cellY_ = 1.0, margin_ = 0.0;
+    size_t side_ = 0;
+    std::vector<int32_t> cells_;
+    std::vector<uint32_t> mixedBegin_;  // offsets into mixedPolygons_
+    std::vector<uint32_t> mixedPolygons_;
+
+    void classify(size_t col, size_t row, size_t size, const std::vector<uint32_t>& candidates);
+    Box cellBox(size_t col, size_t row, size_t size) const;
+    bool load(const std::string& path, uint64_t sourceHash);
+};
+
+#endif // ZONE_RASTER_H
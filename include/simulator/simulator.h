@@ -22,6 +22,8 @@ public:
 
     void writeActions();
     void writeReportToCSV();
+    // Routes of every dispatch and return trip as GeoJSON, geometries from the route cache.
+    void writeRoutes();
 
 private:
     State& state_;
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "utils/parallel.h"
+
+namespace utils {
+
+/**
+ * @brief Splits one CSV line on commas, like repeated std::getline(ss, token, ',').
+ * Once the line is used up every further field is empty. No quoting support,
+ * the input files never quote.
+ */
+class CsvFields {
+public:
+    explicit CsvFields(std::string_view line) : rest_(line) {}
+
+    std::string_view next() {
+        if (done_) return {};
+        size_t comma = rest_.find(',');
+        std::string_view field = rest_.substr(0, comma);
+        if (comma == std::string_view::npos) {
+            done_ = true;
+        } else {
+            rest_.remove_prefix(comma + 1);
+        }
+        return field;
+    }
+
+    void skip(size_t count) {
+        for (size_t i = 0; i < count; ++i) next();
+    }
+
+private:
+    std::string_view rest_;
+    bool done_ = false;
+};
+
+// Leading-number parses with std::from_chars; leading blanks are skipped and trailing text
+// ignored, as std::stoi / std::stod did. Return false when there is no number at all.
+bool parseInt(std::string_view token, int& value);
+bool parseDouble(std::string_view token, double& value);
+
+/**
+ * @brief Read-only memory map of a CSV file whose data lines are parsed in parallel.
+ *
+ * The lines after the header are cut into newline-aligned chunks, one per worker; each
+ * worker parses its chunk into its own vector and the vectors are joined in chunk order,
+ * so results come back in file order whatever the thread count.
+ */
+class CsvFile {
+public:
+    explicit CsvFile(const std::string& path);
+    ~CsvFile();
+    CsvFile(const CsvFile&) = delete;
+    CsvFile& operator=(const CsvFile&) = delete;
+
+    bool isOpen() const noexcept { return open_; }
+    std::string_view header() const noexcept { return header_; }
+
+    /**
+     * @brief Calls parse(std::string_view line) -> T on every non-empty data line.
+     * Line ends ("\n" or "\r\n") are not part of the line. The first exception
+     * thrown by parse is rethrown once all workers finished.
+     */
+    template <typename T, typename Parse>
+    std::vector<T> parseLines(Parse&& parse, size_t threads = 0) const {
+        std::vector<std::string_view> chunks = split(workerCount(threads));
+        std::vector<std::vector<T>> parts(chunks.size());
+        parallelFor(chunks.size(), [&](size_t begin, size_t end) {
+            for (size_t c = begin; c < end; ++c) {
+                forEachLine(chunks[c], [&](std::string_view line) { parts[c].push_back(parse(line)); });
+            }
+        }, chunks.size());
+
+        size_t total = 0;
+        for (const auto& part : parts) total += part.size();
+        std::vector<T> rows;
+        rows.reserve(total);
+        for (auto& part : parts) {
+            for (auto& row : part) rows.push_back(std::move(row));
+        }
+        return rows;
+    }
+
+private:
+    bool open_ = false;
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+    std::string_view header_;
+    std::string_view body_;
+
+    // At most `count` newline-aligned pieces of the body, small files stay in one piece.
+    std::vector<std::string_view> split(size_t count) const;
+
+    template <typename Visit>
+    static void forEachLine(std::string_view chunk, Visit&& visit) {
+        while (!chunk.empty()) {
+            size_t newline = chunk.find('\n');
+            std::string_view line = chunk.substr(0, newline);
+            chunk.remove_prefix(newline == std::string_view::npos ? chunk.size() : newline + 1);
+            if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+            if (!line.empty()) visit(line);
+        }
+    }
+};
+
+} // namespace utils
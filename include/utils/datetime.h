@@ -0,0 +1,66 @@
+#pragma once
+
+#include <ctime>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief Broken-down local time, the fields of std::tm the simulator uses.
+ */
+struct CivilTime {
+    int year = 1970;
+    int month = 1;    // 1-12
+    int day = 1;      // 1-31
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    int weekday = 4;  // 0 = Sunday
+    int yearDay = 0;  // 0-365
+};
+
+/**
+ * @brief UTC offsets of a time zone as a table of transitions.
+ *
+ * The table is sampled once from the C library (localtime_r) for 1950-2080, so
+ * conversions agree with localtime/mktime but cost a binary search instead of a
+ * zone lookup per call. Times outside the table are handed to the C library.
+ *
+ * mktime resolves the hour repeated when clocks go back from state left by earlier
+ * calls; fromLocal always picks its first occurrence, and moves skipped times forward
+ * by the jump as mktime does.
+ */
+class TimeZone {
+public:
+    // Zone the C library currently uses (TZ), sampled now.
+    static TimeZone current();
+    // current() of the first call, shared by the whole process.
+    static const TimeZone& local();
+
+    int utcOffset(std::time_t t) const;           // seconds east of UTC
+    CivilTime toLocal(std::time_t t) const;       // like std::localtime
+    std::time_t fromLocal(const CivilTime& local) const;  // like std::mktime with tm_isdst = -1
+
+    size_t transitionCount() const noexcept { return transitions_.size(); }
+
+private:
+    std::time_t first_ = 0;
+    std::time_t last_ = 0;
+    std::vector<std::time_t> transitions_;  // offsets_[i + 1] applies from transitions_[i]
+    std::vector<int> offsets_;
+    std::vector<int> distinctOffsets_;
+};
+
+/**
+ * @brief Parses "YYYY-MM-DD HH:MM:SS" as local time; text after the seconds is ignored.
+ * @return false when the text does not start with such a timestamp.
+ */
+bool parseDateTime(std::string_view text, std::time_t& out, const TimeZone& zone = TimeZone::local());
+
+// Writes the 19 characters of "YYYY-MM-DD HH:MM:SS" (local time, years 1000-9999) to out, no terminator.
+void formatDateTime(std::time_t t, char* out, const TimeZone& zone = TimeZone::local());
+std::string formatDateTime(std::time_t t, const TimeZone& zone = TimeZone::local());
+
+} // namespace utils
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+namespace utils {
+
+/**
+ * @brief Names of an enum whose values are 0..N-1, and a perfect hash from the names back to values.
+ *
+ * Built at compile time: seeds are tried until every name lands in its own slot of a table with
+ * 8 or more slots per name, so parse() is one hash, one slot read and one string compare.
+ * FoldCase hashes and compares ASCII case-insensitively.
+ */
+template <typename E, size_t N, bool FoldCase = false>
+class EnumRegistry {
+public:
+    static_assert(N > 0 && N < 255, "slots store value + 1 in a byte");
+    static constexpr size_t SLOTS = std::bit_ceil(N * 8);
+
+    consteval explicit EnumRegistry(const std::array<std::string_view, N>& names) : names_(names) {
+        for (seed_ = 1; seed_ < 100000; ++seed_) {
+            if (tryBuild()) return;
+        }
+        throw "EnumRegistry: no perfect hash, are the names unique?";
+    }
+
+    static constexpr size_t size() noexcept { return N; }
+
+    constexpr bool contains(E value) const noexcept { return static_cast<size_t>(value) < N; }
+
+    // Name of value, or fallback outside 0..N-1. Names are string literals, data() is null-terminated.
+    constexpr std::string_view name(E value, std::string_view fallback = "Unknown") const noexcept {
+        return contains(value) ? names_[static_cast<size_t>(value)] : fallback;
+    }
+
+    constexpr std::optional<E> parse(std::string_view text) const noexcept {
+        uint8_t slot = slots_[hash(text, seed_)];
+        if (slot == 0 || !equal(names_[slot - 1], text)) {
+            return std::nullopt;
+        }
+        return static_cast<E>(slot - 1);
+    }
+
+private:
+    std::array<std::string_view, N> names_;
+    std::array<uint8_t, SLOTS> slots_{};  // value + 1, 0 is empty
+    uint64_t seed_ = 0;
+
+    static constexpr char fold(char c) noexcept {
+        return FoldCase && c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+
+    // Seeded FNV-1a with the high half folded in.
+    static constexpr size_t hash(std::string_view text, uint64_t seed) noexcept {
+        uint64_t h = 0xcbf29ce484222325ull ^ (seed * 0x9e3779b97f4a7c15ull);
+        for (char c : text) {
+            h ^= static_cast<uint8_t>(fold(c));
+            h *= 0x100000001b3ull;
+        }
+        h ^= h >> 29;
+        return static_cast<size_t>(h & (SLOTS - 1));
+    }
+
+    static constexpr bool equal(std::string_view a, std::string_view b) noexcept {
+        if (a.size() != b.size()) return false;
+        for (size_t i = 0; i < a.size(); ++i) {
+            if (fold(a[i]) != fold(b[i])) return false;
+        }
+        return true;
+    }
+
+    constexpr bool tryBuild() {
+        slots_.fill(0);
+        for (size_t i = 0; i < N; ++i) {
+            size_t h = hash(names_[i], seed_);
+            if (slots_[h] != 0) return false;
+            slots_[h] = static_cast<uint8_t>(i + 1);
+        }
+        return true;
+    }
+};
+
+template <typename E, bool FoldCase = false, size_t N>
+consteval EnumRegistry<E, N, FoldCase> makeEnumRegistry(const std::array<std::string_view, N>& names) {
+    return EnumRegistry<E, N, FoldCase>(names);
+}
+
+} // namespace utils
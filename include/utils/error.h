@@ -9,6 +9,15 @@ public:
         : std::runtime_error(msg) {}
 };
 
+// OSRM refused the request itself (e.g. TooBig, URI too long), retrying it unchanged will not help.
+class OSRMRequestRejectedError : public OSRMError {
+public:
+    explicit OSRMRequestRejectedError(const std::string& msg="OSRM request rejected", long status=400)
+        : OSRMError(msg), status(status) {}
+
+    long status;
+};
+
 class MismatchError : public std::runtime_error {
 public:
     explicit MismatchError(const std::string& msg="Mismatch error")
@@ -7,12 +7,10 @@
 #include <string>
 #include <queue>
 #include "data/incident.h"
+#include "utils/datetime.h"
 
 namespace utils {
 inline std::string formatTime(std::time_t t) {
-    std::ostringstream oss;
-    std::tm tm = *std::localtime(&t);
-    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
-    return oss.str();
+    return formatDateTime(t);
 }
 } // namespace utils
\ No newline at end of file
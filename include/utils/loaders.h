@@ -1,19 +1,38 @@
+#include <memory>
 #include <string>
 #include <vector>
 #include "config/EnvLoader.h"
 #include "data/station.h"
 #include "data/incident.h"
 #include "data/apparatus.h"
+#include "data/geometry.h"
 #include "simulator/event.h"
 
+class NativeRouter;
+class BuildingIndex;
+
 namespace loader {
+// BOUNDS_GEOJSON_PATH's polygon, prepared once; stations and incidents outside it are not loaded.
+PreparedPolygon loadBounds();
 std::vector<Station> loadStationsFromCSV();
+std::vector<Station> loadStationsFromCSV(const PreparedPolygon& bounds);
 std::vector<Incident> loadIncidentsFromCSV();
+std::vector<Incident> loadIncidentsFromCSV(const PreparedPolygon& bounds);
 std::vector<Apparatus> loadApparatusFromCSV();
+void assignServiceZones(std::vector<Incident>& incidents);
+// The three loaders plus zone assignment, served from INPUT_SNAPSHOT_PATH while its sources are unchanged.
+void loadInputs(std::vector<Station>& stations,
+                std::vector<Incident>& incidents,
+                std::vector<Apparatus>& apparatuses);
 
 EventQueue generateEvents(const std::vector<Incident>& incidents);
+std::vector<int> upcomingIncidentIndices(EventQueue events);
 void preComputingMatrices(std::vector<Station>& stations, 
                           std::vector<Incident>& incidents,
                           std::vector<Apparatus>& apparatuses,
-                          size_t chunk_size = 100);
+                          size_t chunk_size = 0);
+void buildTravelTimeOracle(const std::vector<Station>& stations, size_t chunk_size = 0,
+                           const NativeRouter* router = nullptr);
+// Buildings around the incidents from BUILDING_CACHE_PATH, fetching uncovered tiles; nullptr when the path is empty.
+std::shared_ptr<const BuildingIndex> loadBuildingIndex(const std::vector<Incident>& incidents);
 }
\ No newline at end of file
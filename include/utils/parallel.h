@@ -0,0 +1,69 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief Resolves how many worker threads a data-parallel loop should use.
+ * @param requested Desired thread count, 0 means "use all hardware threads".
+ * @return A thread count of at least 1.
+ */
+inline size_t workerCount(size_t requested = 0) {
+    if (requested > 0) return requested;
+    size_t hw = std::thread::hardware_concurrency();
+    return hw > 0 ? hw : 1;
+}
+
+/**
+ * @brief Splits [0, n) into contiguous blocks and runs fn(begin, end) on each block.
+ * Blocks run on their own threads; the calling thread handles the last block.
+ * The first exception thrown by any block is rethrown once all threads joined.
+ * @param n Number of items.
+ * @param fn Callable taking (size_t begin, size_t end).
+ * @param numThreads Thread count, 0 means hardware concurrency.
+ */
+template <typename Fn>
+void parallelFor(size_t n, Fn&& fn, size_t numThreads = 0) {
+    if (n == 0) return;
+    size_t threads = std::min(workerCount(numThreads), n);
+    if (threads == 1) {
+        fn(size_t{0}, n);
+        return;
+    }
+
+    size_t block = (n + threads - 1) / threads;
+    threads = (n + block - 1) / block;
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> workers;
+    workers.reserve(threads - 1);
+
+    for (size_t t = 0; t + 1 < threads; ++t) {
+        size_t begin = t * block;
+        size_t end = std::min(begin + block, n);
+        workers.emplace_back([&fn, &errors, t, begin, end]() {
+            try {
+                fn(begin, end);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+
+    try {
+        fn((threads - 1) * block, n);
+    } catch (...) {
+        errors[threads - 1] = std::current_exception();
+    }
+
+    for (auto& worker : workers) worker.join();
+    for (auto& error : errors) {
+        if (error) std::rethrow_exception(error);
+    }
+}
+
+} // namespace utils
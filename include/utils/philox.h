@@ -0,0 +1,72 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <limits>
+
+namespace utils {
+
+/**
+ * @brief Philox4x32-10 block function (Salmon et al., "Parallel Random Numbers: As Easy as 1, 2, 3").
+ *
+ * Maps a 128-bit counter under a 64-bit key to 128 random bits. Any block can be computed
+ * directly, so a stream is just a key and a counter to advance.
+ */
+struct Philox4x32 {
+    using Counter = std::array<uint32_t, 4>;
+    using Key = std::array<uint32_t, 2>;
+
+    static constexpr Counter generate(Counter counter, Key key) noexcept {
+        for (int round = 0; round < 10; ++round) {
+            if (round > 0) {
+                key[0] += 0x9E3779B9u;
+                key[1] += 0xBB67AE85u;
+            }
+            uint64_t p0 = static_cast<uint64_t>(0xD2511F53u) * counter[0];
+            uint64_t p1 = static_cast<uint64_t>(0xCD9E8D57u) * counter[2];
+            counter = {static_cast<uint32_t>(p1 >> 32) ^ counter[1] ^ key[0], static_cast<uint32_t>(p1),
+                       static_cast<uint32_t>(p0 >> 32) ^ counter[3] ^ key[1], static_cast<uint32_t>(p0)};
+        }
+        return counter;
+    }
+};
+
+/**
+ * @brief UniformRandomBitGenerator over the Philox stream of one (seed, replication, incident).
+ *
+ * The n-th value is word n % 4 of the block with counter (n / 4, incident), so a stream can be
+ * opened at any draw number and two streams never share a block.
+ */
+class CounterRng {
+public:
+    using result_type = uint32_t;
+
+    constexpr CounterRng(uint32_t seed, uint32_t replication, uint64_t incident, uint64_t draw = 0) noexcept
+        : key_{seed, replication}, incident_(incident), draw_(draw) {}
+
+    static constexpr result_type min() noexcept { return 0; }
+    static constexpr result_type max() noexcept { return std::numeric_limits<result_type>::max(); }
+
+    constexpr result_type operator()() noexcept {
+        if (draw_ % 4 == 0 || !cached_) {
+            uint64_t block = draw_ / 4;
+            block_ = Philox4x32::generate({static_cast<uint32_t>(block), static_cast<uint32_t>(block >> 32),
+                                           static_cast<uint32_t>(incident_), static_cast<uint32_t>(incident_ >> 32)},
+                                          key_);
+            cached_ = true;
+        }
+        return block_[draw_++ % 4];
+    }
+
+    // Number of values drawn since draw 0, where a stream reopened later continues.
+    constexpr uint64_t position() const noexcept { return draw_; }
+
+private:
+    Philox4x32::Key key_;
+    uint64_t incident_;
+    uint64_t draw_;
+    Philox4x32::Counter block_{};
+    bool cached_ = false;
+};
+
+} // namespace utils
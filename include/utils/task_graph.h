@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace utils {
+
+/**
+ * @brief Runs named tasks on worker threads as soon as the tasks they depend on finished.
+ *
+ * Dependencies may only name tasks added earlier, so the graph is acyclic by construction.
+ * When a task throws, the tasks depending on it are skipped, independent ones still run,
+ * and the first exception is rethrown by run() once every worker is done.
+ */
+class TaskGraph {
+public:
+    using TaskId = size_t;
+
+    struct Timing {
+        std::string name;
+        double startSeconds = 0.0;  // since run() started
+        double seconds = 0.0;
+        bool skipped = false;
+    };
+
+    TaskId add(std::string name, std::function<void()> task, std::vector<TaskId> dependencies = {});
+
+    // Runs every task once, at most `threads` at a time (0 = one thread per task).
+    void run(size_t threads = 0);
+
+    // One entry per task in the order they were added, filled by run().
+    const std::vector<Timing>& timings() const noexcept { return timings_; }
+    double wallSeconds() const noexcept { return wallSeconds_; }
+    void logTimings(const std::string& title) const;
+
+    size_t size() const noexcept { return tasks_.size(); }
+
+private:
+    struct Task {
+        std::string name;
+        std::function<void()> run;
+        std::vector<TaskId> dependents;
+        size_t dependencyCount = 0;
+    };
+
+    std::vector<Task> tasks_;
+    std::vector<Timing> timings_;
+    double wallSeconds_ = 0.0;
+};
+
+} // namespace utils
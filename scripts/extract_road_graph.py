@@ -0,0 +1,150 @@
+#!/usr/bin/env python3
+"""
+Extract a drivable road graph from an OSM PBF file for ROUTER=NATIVE.
+
+Writes the two CSVs read by RoadGraph::loadCsv:
+    nodes: id,lat,lon
+    edges: from,to,distance_m,duration_s   (one line per travel direction)
+
+Only nodes that are way endpoints or shared between ways are kept, the geometry in
+between is folded into the edge length. Speeds come from maxspeed when it is set,
+otherwise from the highway type.
+
+Usage:
+    pip install osmium
+    python extract_road_graph.py nashville.osm.pbf ../data/road_nodes.csv ../data/road_edges.csv
+"""
+
+import argparse
+import csv
+import math
+
+import osmium
+
+# km/h per highway type, roughly what OSRM's car profile assumes.
+DEFAULT_SPEEDS_KMH = {
+    'motorway': 90, 'motorway_link': 45,
+    'trunk': 85, 'trunk_link': 40,
+    'primary': 65, 'primary_link': 30,
+    'secondary': 55, 'secondary_link': 25,
+    'tertiary': 40, 'tertiary_link': 20,
+    'unclassified': 25, 'residential': 25,
+    'living_street': 10, 'service': 15,
+}
+
+EARTH_RADIUS_M = 6371000.0
+
+
+def haversine_m(lat1, lon1, lat2, lon2):
+    p1, p2 = math.radians(lat1), math.radians(lat2)
+    dp, dl = p2 - p1, math.radians(lon2 - lon1)
+    h = math.sin(dp / 2) ** 2 + math.cos(p1) * math.cos(p2) * math.sin(dl / 2) ** 2
+    return 2 * EARTH_RADIUS_M * math.asin(min(1.0, math.sqrt(h)))
+
+
+def parse_speed_kmh(tags, highway):
+    maxspeed = tags.get('maxspeed', '')
+    try:
+        if maxspeed.endswith('mph'):
+            return float(maxspeed[:-3]) * 1.609344
+        if maxspeed:
+            return float(maxspeed)
+    except ValueError:
+        pass
+    return DEFAULT_SPEEDS_KMH[highway]
+
+
+def direction(tags, highway):
+    """Returns (forward, backward) travel permissions of a way."""
+    oneway = tags.get('oneway', '')
+    if oneway in ('yes', 'true', '1') or highway in ('motorway', 'motorway_link') or tags.get('junction') == 'roundabout':
+        return True, False
+    if oneway == '-1':
+        return False, True
+    return True, True
+
+
+class WayCollector(osmium.SimpleHandler):
+    """First pass: drivable ways and how often each node is used."""
+
+    def __init__(self):
+        super().__init__()
+        self.ways = []
+        self.node_uses = {}
+
+    def way(self, w):
+        highway = w.tags.get('highway')
+        if highway not in DEFAULT_SPEEDS_KMH or w.tags.get('access') in ('no', 'private'):
+            return
+        refs = [n.ref for n in w.nodes]
+        if len(refs) < 2:
+            return
+        tags = {k: w.tags.get(k, '') for k in ('maxspeed', 'oneway', 'junction')}
+        self.ways.append((refs, parse_speed_kmh(tags, highway), direction(tags, highway)))
+        for i, ref in enumerate(refs):
+            # Endpoints always count as intersections.
+            self.node_uses[ref] = self.node_uses.get(ref, 0) + (2 if i in (0, len(refs) - 1) else 1)
+
+
+class NodeCollector(osmium.SimpleHandler):
+    """Second pass: coordinates of every node used by a drivable way."""
+
+    def __init__(self, wanted):
+        super().__init__()
+        self.wanted = wanted
+        self.coords = {}
+
+    def node(self, n):
+        if n.id in self.wanted:
+            self.coords[n.id] = (n.location.lat, n.location.lon)
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Extract a road graph for the native router.')
+    parser.add_argument('pbf')
+    parser.add_argument('nodes_csv')
+    parser.add_argument('edges_csv')
+    args = parser.parse_args()
+
+    ways = WayCollector()
+    ways.apply_file(args.pbf)
+    nodes = NodeCollector(ways.node_uses)
+    nodes.apply_file(args.pbf)
+
+    graph_nodes = set()
+    edges = []
+    for refs, speed_kmh, (forward, backward) in ways.ways:
+        speed_mps = speed_kmh / 3.6
+        start, length = refs[0], 0.0
+        for prev, ref in zip(refs, refs[1:]):
+            if prev not in nodes.coords or ref not in nodes.coords:
+                start, length = ref, 0.0
+                continue
+            length += haversine_m(*nodes.coords[prev], *nodes.coords[ref])
+            if ways.node_uses[ref] > 1 and ref != start:
+                duration = length / speed_mps
+                if forward:
+                    edges.append((start, ref, length, duration))
+                if backward:
+                    edges.append((ref, start, length, duration))
+                graph_nodes.update((start, ref))
+                start, length = ref, 0.0
+
+    with open(args.nodes_csv, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['id', 'lat', 'lon'])
+        for node_id in graph_nodes:
+            lat, lon = nodes.coords[node_id]
+            writer.writerow([node_id, f'{lat:.7f}', f'{lon:.7f}'])
+
+    with open(args.edges_csv, 'w', newline='') as f:
+        writer = csv.writer(f)
+        writer.writerow(['from', 'to', 'distance_m', 'duration_s'])
+        for a, b, distance, duration in edges:
+            writer.writerow([a, b, f'{distance:.1f}', f'{duration:.2f}'])
+
+    print(f'Wrote {len(graph_nodes)} nodes and {len(edges)} edges.')
+
+
+if __name__ == '__main__':
+    main()
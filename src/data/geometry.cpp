@@ -1,8 +1,11 @@
 #include "data/geometry.h"
+#include <algorithm>
 #include <cmath>
 #include <iostream>
 #include <fstream>
+#include <limits>
 #include <nlohmann/json.hpp>
+#include "utils/parallel.h"
 using json = nlohmann::json;
 
 double crossProduct(const Location& p1, const Location& p2, const Location& p3)
@@ -20,25 +23,37 @@ bool isPointOnSegment(const Location& p, const Location& p1, const Location& p2)
            && p.lon <= std::max(p1.lon, p2.lon);
 }
 
+namespace {
+// What the edge p1 -> p2 adds to the winding number of point; onEdge is set when the point is on it.
+int edgeCrossing(const Location& p1, const Location& p2, const Location& point, bool& onEdge)
+{
+    if (isPointOnSegment(point, p1, p2)) {
+        onEdge = true;
+        return 0;
+    }
+    if (p1.lon <= point.lon) {
+        if (p2.lon > point.lon && crossProduct(p1, p2, point) > 0) {
+            return 1;
+        }
+    } else {
+        if (p2.lon <= point.lon && crossProduct(p1, p2, point) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+}
+
 int windingNumber(const std::vector<Location>& polygon, const Location& point)
 {
     int n = polygon.size();
     int windingNumber = 0;
     for (int i = 0; i < n; i++) {
-        Location p1 = polygon[i];
-        Location p2 = polygon[(i + 1) % n];
-        if (isPointOnSegment(point, p1, p2)) {
+        bool onEdge = false;
+        windingNumber += edgeCrossing(polygon[i], polygon[(i + 1) % n], point, onEdge);
+        if (onEdge) {
             return 0;
         }
-        if (p1.lon <= point.lon) {
-            if (p2.lon > point.lon && crossProduct(p1, p2, point) > 0) {
-                windingNumber++;
-            }
-        } else {
-            if (p2.lon <= point.lon && crossProduct(p1, p2, point) < 0) {
-                windingNumber--;
-            }
-        }
     }
     return windingNumber;
 }
@@ -77,38 +92,251 @@ std::vector<Location> loadPolygonFromGeoJSON(const std::string& filename)
     return polygon;
 }
 
+PreparedPolygon::PreparedPolygon(std::vector<Location> polygon, size_t targetCells)
+    : vertices_(std::move(polygon))
+{
+    const size_t n = vertices_.size();
+    if (n == 0) {
+        return;
+    }
+    minLat_ = maxLat_ = vertices_[0].lat;
+    minLon_ = maxLon_ = vertices_[0].lon;
+    double scale = 1.0;
+    for (const auto& vertex : vertices_) {
+        minLat_ = std::min(minLat_, vertex.lat);
+        maxLat_ = std::max(maxLat_, vertex.lat);
+        minLon_ = std::min(minLon_, vertex.lon);
+        maxLon_ = std::max(maxLon_, vertex.lon);
+        scale = std::max({scale, std::abs(vertex.lat), std::abs(vertex.lon)});
+    }
+    margin_ = scale * 1e-9;
+    minLat_ -= margin_;
+    maxLat_ += margin_;
+    minLon_ -= margin_;
+    maxLon_ += margin_;
+
+    if (targetCells == 0) {
+        targetCells = std::clamp<size_t>(4 * n, 16, size_t{1} << 20);
+    }
+    double spanLat = maxLat_ - minLat_;
+    double spanLon = maxLon_ - minLon_;
+    columns_ = std::clamp<size_t>(static_cast<size_t>(std::llround(std::sqrt(targetCells * spanLat / spanLon))),
+                                  1, targetCells);
+    rows_ = std::max<size_t>(1, targetCells / columns_);
+    cellLat_ = spanLat / static_cast<double>(columns_);
+    cellLon_ = spanLon / static_cast<double>(rows_);
+
+    const size_t cells = columns_ * rows_;
+    winding_.assign(cells, 0);
+    boundary_.assign(cells, 0);
+    std::vector<std::vector<uint32_t>> cellLists(cells);
+    rowEdgeBegin_.assign(1, 0);
+
+    struct Spanning {
+        uint32_t edge;
+        size_t first, last;  // columns the edge passes through
+    };
+    std::vector<Spanning> spanning;
+    for (size_t row = 0; row < rows_; ++row) {
+        double low = minLon_ + static_cast<double>(row) * cellLon_ - margin_;
+        double high = minLon_ + static_cast<double>(row + 1) * cellLon_ + margin_;
+        spanning.clear();
+        for (uint32_t e = 0; e < n; ++e) {
+            const Location& a = vertices_[e];
+            const Location& b = vertices_[(e + 1) % n];
+            double edgeLow = std::min(a.lon, b.lon), edgeHigh = std::max(a.lon, b.lon);
+            if (edgeHigh < low || edgeLow > high) {
+                continue;
+            }
+            // Lat range of the part of the edge inside this row.
+            double fromLat = a.lat, toLat = b.lat;
+            if (a.lon != b.lon) {
+                auto latAt = [&](double lon) {
+                    double t = (std::clamp(lon, edgeLow, edgeHigh) - a.lon) / (b.lon - a.lon);
+                    return a.lat + t * (b.lat - a.lat);
+                };
+                fromLat = latAt(low);
+                toLat = latAt(high);
+            }
+            size_t first = cellOf(std::min(fromLat, toLat) - margin_, minLat_, cellLat_, columns_);
+            size_t last = cellOf(std::max(fromLat, toLat) + margin_, minLat_, cellLat_, columns_);
+            bool spans = edgeLow < low && edgeHigh > high;
+            for (size_t col = first; col <= last; ++col) {
+                boundary_[row * columns_ + col] = 1;
+                if (spans) cellLists[row * columns_ + col].push_back(e);
+            }
+            if (spans) {
+                spanning.push_back({e, first, last});
+            } else {
+                rowEdges_.push_back(e);
+            }
+        }
+        rowEdgeBegin_.push_back(static_cast<uint32_t>(rowEdges_.size()));
+
+        // Edges crossing the whole row away from a cell add the same amount anywhere in it.
+        for (size_t col = 0; col < columns_; ++col) {
+            size_t cell = row * columns_ + col;
+            Location center(minLat_ + (static_cast<double>(col) + 0.5) * cellLat_,
+                            minLon_ + (static_cast<double>(row) + 0.5) * cellLon_);
+            bool onEdge = false;
+            int winding = 0;
+            for (const auto& edge : spanning) {
+                if (col < edge.first || col > edge.last) winding += edgeWinding(edge.edge, center, onEdge);
+            }
+            if (!boundary_[cell]) {
+                for (uint32_t i = rowEdgeBegin_[row]; i < rowEdgeBegin_[row + 1]; ++i) {
+                    winding += edgeWinding(rowEdges_[i], center, onEdge);
+                }
+            }
+            winding_[cell] = winding;
+        }
+    }
+
+    cellEdgeBegin_.reserve(cells + 1);
+    cellEdgeBegin_.push_back(0);
+    for (const auto& list : cellLists) {
+        cellEdges_.insert(cellEdges_.end(), list.begin(), list.end());
+        cellEdgeBegin_.push_back(static_cast<uint32_t>(cellEdges_.size()));
+    }
+}
+
+size_t PreparedPolygon::cellOf(double value, double origin, double size, size_t count) const
+{
+    if (!(value > origin)) {
+        return 0;
+    }
+    return std::min(static_cast<size_t>((value - origin) / size), count - 1);
+}
+
+int PreparedPolygon::edgeWinding(uint32_t edge, const Location& point, bool& onEdge) const
+{
+    return edgeCrossing(vertices_[edge], vertices_[(edge + 1) % vertices_.size()], point, onEdge);
+}
+
+int PreparedPolygon::windingNumber(const Location& point) const
+{
+    // Beyond the padded box no edge can be on, or counted around, the point.
+    if (vertices_.empty() || !(point.lat >= minLat_ && point.lat <= maxLat_
+                               && point.lon >= minLon_ && point.lon <= maxLon_)) {
+        return 0;
+    }
+    size_t row = cellOf(point.lon, minLon_, cellLon_, rows_);
+    size_t cell = row * columns_ + cellOf(point.lat, minLat_, cellLat_, columns_);
+    if (!boundary_[cell]) {
+        return winding_[cell];
+    }
+
+    bool onEdge = false;
+    int winding = winding_[cell];
+    for (uint32_t i = cellEdgeBegin_[cell]; i < cellEdgeBegin_[cell + 1]; ++i) {
+        winding += edgeWinding(cellEdges_[i], point, onEdge);
+    }
+    for (uint32_t i = rowEdgeBegin_[row]; i < rowEdgeBegin_[row + 1]; ++i) {
+        winding += edgeWinding(rowEdges_[i], point, onEdge);
+    }
+    return onEdge ? 0 : winding;
+}
+
+size_t PreparedPolygon::boundaryCellCount() const noexcept
+{
+    return static_cast<size_t>(std::count(boundary_.begin(), boundary_.end(), uint8_t{1}));
+}
+
+namespace {
+// Distance of (x, y) along a Hilbert curve filling the 2^16 x 2^16 grid.
+uint64_t hilbertIndex(uint32_t x, uint32_t y)
+{
+    constexpr uint32_t n = 1u << 16;
+    uint64_t d = 0;
+    for (uint32_t s = n / 2; s > 0; s /= 2) {
+        uint32_t rx = (x & s) ? 1 : 0;
+        uint32_t ry = (y & s) ? 1 : 0;
+        d += static_cast<uint64_t>(s) * s * ((3 * rx) ^ ry);
+        if (ry == 0) {
+            if (rx == 1) {
+                x = n - 1 - x;
+                y = n - 1 - y;
+            }
+            std::swap(x, y);
+        }
+    }
+    return d;
+}
+
+// Point indices sorted along a Hilbert curve over the points' extent, non-finite points last.
+std::vector<size_t> hilbertOrder(const std::vector<Point>& points, size_t threads)
+{
+    double minX = std::numeric_limits<double>::infinity(), minY = minX;
+    double maxX = -minX, maxY = -minX;
+    for (const auto& pt : points) {
+        if (!std::isfinite(pt.x()) || !std::isfinite(pt.y())) continue;
+        minX = std::min(minX, pt.x());
+        maxX = std::max(maxX, pt.x());
+        minY = std::min(minY, pt.y());
+        maxY = std::max(maxY, pt.y());
+    }
+    double scaleX = maxX > minX ? 65535.0 / (maxX - minX) : 0.0;
+    double scaleY = maxY > minY ? 65535.0 / (maxY - minY) : 0.0;
+
+    std::vector<std::pair<uint64_t, size_t>> keyed(points.size());
+    utils::parallelFor(points.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const Point& pt = points[i];
+            if (!std::isfinite(pt.x()) || !std::isfinite(pt.y())) {
+                keyed[i] = {std::numeric_limits<uint64_t>::max(), i};
+                continue;
+            }
+            auto x = static_cast<uint32_t>((pt.x() - minX) * scaleX);
+            auto y = static_cast<uint32_t>((pt.y() - minY) * scaleY);
+            keyed[i] = {hilbertIndex(x, y), i};
+        }
+    }, threads);
+    std::sort(keyed.begin(), keyed.end());
+
+    std::vector<size_t> order(points.size());
+    for (size_t i = 0; i < keyed.size(); ++i) order[i] = keyed[i].second;
+    return order;
+}
+}
+
 std::vector<std::optional<size_t>> getPointToPolygonIndices(
     const std::vector<Point>& points,
-    const std::vector<Polygon>& polygons
+    const std::vector<Polygon>& polygons,
+    size_t threads
 ) {
-    // Build R-tree from bounding boxes
+    std::vector<std::optional<size_t>> result(points.size());
+    if (points.empty() || polygons.empty()) {
+        return result;
+    }
+
+    // Build R-tree from bounding boxes. The range constructor bulk loads it with Boost's
+    // packing algorithm (STR style), giving full, barely overlapping nodes.
     std::vector<RTreeEntry> index_data;
+    index_data.reserve(polygons.size());
     for (size_t i = 0; i < polygons.size(); ++i) {
         bg::model::box<Point> box;
         bg::envelope(polygons[i], box);
         index_data.emplace_back(box, i);
     }
+    const bgi::rtree<RTreeEntry, bgi::quadratic<16>> rtree(index_data.begin(), index_data.end());
 
-    bgi::rtree<RTreeEntry, bgi::quadratic<16>> rtree(index_data.begin(), index_data.end());
-
-    std::vector<std::optional<size_t>> result;
-    result.reserve(points.size());
-
-    for (const auto& pt : points) {
+    // Each thread takes a run of Hilbert-ordered points, so consecutive queries walk the same
+    // tree nodes and polygons, and reuses one candidate buffer for all of them.
+    std::vector<size_t> order = hilbertOrder(points, threads);
+    utils::parallelFor(order.size(), [&](size_t begin, size_t end) {
         std::vector<RTreeEntry> candidates;
-        rtree.query(bgi::intersects(pt), std::back_inserter(candidates));  // changed here
-
-        std::optional<size_t> containing_polygon = std::nullopt;
-
-        for (const auto& [box, idx] : candidates) {
-            if (bg::covered_by(pt, polygons[idx])) {  // or use covered_by if you want boundary inclusive
-                containing_polygon = idx;
-                break;
+        for (size_t k = begin; k < end; ++k) {
+            const Point& pt = points[order[k]];
+            candidates.clear();
+            rtree.query(bgi::intersects(pt), std::back_inserter(candidates));
+            for (const auto& [box, idx] : candidates) {
+                if (bg::covered_by(pt, polygons[idx])) {  // boundary inclusive
+                    result[order[k]] = idx;
+                    break;
+                }
             }
         }
-
-        result.push_back(containing_polygon);
-    }
+    }, threads);
     return result;
 }
 
@@ -23,6 +23,8 @@ using json = nlohmann::json;
 void printUsage(const char* program_name) {
     std::cout << "Usage: " << program_name << " [OPTIONS]\n";
     std::cout << "\nOPTIONS:\n";
+    std::cout << "  --compile-inputs                Write the input snapshot from the CSV files and exit\n";
+    std::cout << "  --export-routes                 Write the routes GeoJSON natively after simulation\n";
     std::cout << "  --run-python                    Run Python post-processing script after simulation\n";
     std::cout << "  --OSRM_URL=URL                  OSRM table API URL (default: http://localhost:8080/table/v1/driving/)\n";
     std::cout << "  --BASE_OSRM_URL=URL             Base OSRM URL (default: http://localhost:8080)\n";
@@ -31,7 +33,39 @@ void printUsage(const char* program_name) {
     std::cout << "  --STATIONS_CSV_PATH=PATH        Path to stations CSV file (default: ../data/stations.csv)\n";
     std::cout << "  --APPARATUS_CSV_PATH=PATH       Path to apparatus CSV file (default: ../data/stations_with_apparatus.csv)\n";
     std::cout << "  --BOUNDS_GEOJSON_PATH=PATH      Path to bounds GeoJSON file (default: ../data/bounds.geojson)\n";
+    std::cout << "  --INPUT_SNAPSHOT_PATH=PATH      Columnar snapshot of the loaded inputs, empty disables (default: ../logs/inputs.bin)\n";
+    std::cout << "  --ZONE_ASSIGNMENT=STRING        Incident to beat lookup (options: RASTER/RTREE, default: RASTER)\n";
+    std::cout << "  --ZONE_RASTER_PATH=PATH         Beat raster cache for ZONE_ASSIGNMENT=RASTER, empty disables (default: ../logs/zone_raster.bin)\n";
     std::cout << "  --RANDOM_SEED=NUMBER            Random seed for simulation (default: 42)\n";
+    std::cout << "  --RNG_STREAMS=STRING            Fire model draws (options: SEQUENTIAL in call order, COUNTER per incident, default: SEQUENTIAL)\n";
+    std::cout << "  --REPLICATION=NUMBER            Replication number keying the COUNTER streams with RANDOM_SEED (default: 0)\n";
+    std::cout << "  --STATION_ORDER_TOP_K=NUMBER    Nearest stations precomputed per incident (default: 5)\n";
+    std::cout << "  --MATRIX_STORAGE=STRING         Matrix file layout (options: FLAT/TILED, default: FLAT)\n";
+    std::cout << "  --MATRIX_TILE_COLS=NUMBER       Incidents per tile for TILED matrices (default: 4096)\n";
+    std::cout << "  --MATRIX_CACHE_TILES=NUMBER     Tiles kept in memory for TILED matrices (default: 64)\n";
+    std::cout << "  --ORACLE_CELL_SIZE_M=NUMBER     Grid cell size of the travel time oracle (default: 500)\n";
+    std::cout << "  --ROUTER=STRING                 Matrix router (options: OSRM/NATIVE, default: OSRM)\n";
+    std::cout << "  --ROAD_GRAPH_NODES_PATH=PATH    Road graph nodes CSV for ROUTER=NATIVE (default: ../data/road_nodes.csv)\n";
+    std::cout << "  --ROAD_GRAPH_EDGES_PATH=PATH    Road graph edges CSV for ROUTER=NATIVE (default: ../data/road_edges.csv)\n";
+    std::cout << "  --ROAD_GRAPH_CH_PATH=PATH       Contraction hierarchy cache for ROUTER=NATIVE, empty disables (default: ../logs/road_graph.ch)\n";
+    std::cout << "  --MATRIX_FALLBACK=STRING        Matrix source when OSRM is down (options: NONE/HAVERSINE, default: NONE)\n";
+    std::cout << "  --OSRM_MAX_IN_FLIGHT=NUMBER     Concurrent OSRM table requests, match osrm-routed threads (default: 4)\n";
+    std::cout << "  --OSRM_TIMEOUT_MS=NUMBER        Timeout per OSRM request (default: 60000)\n";
+    std::cout << "  --OSRM_MAX_RETRIES=NUMBER       Retries per failed OSRM request (default: 3)\n";
+    std::cout << "  --OSRM_MAX_TABLE_SIZE=NUMBER    Coordinates per OSRM table request, match --max-table-size (default: 1000)\n";
+    std::cout << "  --OSRM_MAX_URL_LENGTH=NUMBER    Longest OSRM table request URL (default: 8192)\n";
+    std::cout << "  --OSRM_TARGET_LATENCY_MS=NUMBER Table requests shrink above and grow well below this latency (default: 2000)\n";
+    std::cout << "  --BUILDING_CACHE_PATH=PATH      Overpass buildings cached per map tile, empty disables (default: ../logs/buildings.bin)\n";
+    std::cout << "  --OVERPASS_URL=URL              Overpass interpreter for building tiles (default: https://overpass.private.coffee/api/interpreter/)\n";
+    std::cout << "  --BUILDING_TILE_ZOOM=NUMBER     Map tile zoom of the building cache (default: 15)\n";
+    std::cout << "  --BUILDING_RADIUS_M=NUMBER      Radius of the building features around an incident (default: 50)\n";
+    std::cout << "  --RESOLUTION_SAMPLER=STRING     Resolution time draws per category (options: NORMAL/QUANTILE, default: NORMAL)\n";
+    std::cout << "  --ML_EVALUATOR=STRING           Resolution time model runtime (options: ONNX/NATIVE for tree ensembles, default: ONNX)\n";
+    std::cout << "  --ONNX_GRAPH_OPTIMIZATION=STRING ONNX Runtime graph optimization (options: DISABLE/BASIC/EXTENDED/ALL, default: ALL)\n";
+    std::cout << "  --ONNX_INTRA_OP_THREADS=NUMBER  ONNX Runtime threads within an operator, 0 lets it choose (default: 1)\n";
+    std::cout << "  --ONNX_INTER_OP_THREADS=NUMBER  ONNX Runtime threads across operators, 0 lets it choose (default: 0)\n";
+    std::cout << "  --ROUTE_CACHE_PATH=PATH         Route geometries kept across runs (default: ../logs/route_cache.jsonl)\n";
+    std::cout << "  --ROUTES_GEOJSON_PATH=PATH      Routes GeoJSON written by --export-routes (default: ../logs/routes.json)\n";
     std::cout << "  --PYTHON_PATH=PATH              Path to Python executable (default: ../../venvBOC/bin/python)\n";
     std::cout << "  --ENV_PATH=PATH                 Path to .env file. Overrides all other arguments.\n";
     std::cout << "  --help                          Show this help message\n";
@@ -76,17 +110,53 @@ std::string parseArgumentsAndBuildConfig(int argc, char* argv[]) {
         {"STATIONS_CSV_PATH", "../data/stations.csv"},
         {"APPARATUS_CSV_PATH", "../data/stations_with_apparatus.csv"},
         {"BOUNDS_GEOJSON_PATH", "../data/bounds.geojson"},
+        {"INPUT_SNAPSHOT_PATH", "../logs/inputs.bin"},
+        {"ZONE_ASSIGNMENT", "RASTER"},
+        {"ZONE_RASTER_PATH", "../logs/zone_raster.bin"},
         {"NFD_RESPONSE_CSV_PATH", "../data/NFDResponse.csv"},
         {"RESOLUTION_STATS_CSV_PATH", "../data/response_time_summary.csv"},
+        {"RESOLUTION_SAMPLER", "NORMAL"},
         {"REPORT_CSV_PATH", "../logs/incident_report.csv"},
         {"STATION_REPORT_CSV_PATH", "../logs/station_report.csv"},
         {"DURATION_MATRIX_PATH", "../logs/duration_matrix.bin"},
         {"DISTANCE_MATRIX_PATH", "../logs/distance_matrix.bin"},
+        {"STATION_ORDER_PATH", "../logs/station_order.bin"},
+        {"STATION_ORDER_TOP_K", 5},
+        {"MATRIX_STORAGE", "FLAT"},
+        {"MATRIX_TILE_COLS", 4096},
+        {"MATRIX_CACHE_TILES", 64},
+        {"TRAVEL_TIME_ORACLE_PATH", "../logs/travel_time_oracle.bin"},
+        {"ORACLE_CELL_SIZE_M", 500},
+        {"MATRIX_FALLBACK", "NONE"},
+        {"ROUTER", "OSRM"},
+        {"ROAD_GRAPH_NODES_PATH", "../data/road_nodes.csv"},
+        {"ROAD_GRAPH_EDGES_PATH", "../data/road_edges.csv"},
+        {"ROAD_GRAPH_CH_PATH", "../logs/road_graph.ch"},
+        {"OSRM_MAX_IN_FLIGHT", 4},
+        {"OSRM_TIMEOUT_MS", 60000},
+        {"OSRM_MAX_RETRIES", 3},
+        {"OSRM_RETRY_BACKOFF_MS", 250},
+        {"OSRM_MAX_TABLE_SIZE", 1000},
+        {"OSRM_MAX_URL_LENGTH", 8192},
+        {"OSRM_TARGET_LATENCY_MS", 2000},
+        {"ESTIMATOR_CALIBRATION_PATH", "../logs/estimator_calibration.json"},
         {"MATRIX_CSV_PATH", "../logs/matrix.csv"},
         {"FIREBEATS_MATRIX_PATH", "../logs/beats.bin"},
         {"ZONE_MAP_PATH", "../data/zones.csv"},
         {"BEATS_SHAPEFILE_PATH", "../data/beats_shpfile.geojson"},
+        {"BUILDING_CACHE_PATH", "../logs/buildings.bin"},
+        {"OVERPASS_URL", "https://overpass.private.coffee/api/interpreter/"},
+        {"BUILDING_TILE_ZOOM", 15},
+        {"BUILDING_RADIUS_M", 50},
+        {"ML_EVALUATOR", "ONNX"},
+        {"ONNX_GRAPH_OPTIMIZATION", "ALL"},
+        {"ONNX_INTRA_OP_THREADS", 1},
+        {"ONNX_INTER_OP_THREADS", 0},
+        {"ROUTE_CACHE_PATH", "../logs/route_cache.jsonl"},
+        {"ROUTES_GEOJSON_PATH", "../logs/routes.json"},
         {"RANDOM_SEED", 42},
+        {"RNG_STREAMS", "SEQUENTIAL"},
+        {"REPLICATION", 0},
         {"PYTHON_PATH", "../../venvBOC/bin/python"}
     };
 
@@ -100,8 +170,8 @@ std::string parseArgumentsAndBuildConfig(int argc, char* argv[]) {
             exit(0);
         }
         
-        // Skip the --run-python flag as it's handled separately
-        if (arg == "--run-python") {
+        // Skip the --run-python, --export-routes and --compile-inputs flags as they're handled separately
+        if (arg == "--run-python" || arg == "--export-routes" || arg == "--compile-inputs") {
             continue;
         }
         
@@ -114,12 +184,19 @@ std::string parseArgumentsAndBuildConfig(int argc, char* argv[]) {
                 
                 // Check if this is a valid configuration key
                 if (config.contains(key)) {
-                    // Handle RANDOM_SEED as integer, others as string
-                    if (key == "RANDOM_SEED") {
+                    // Handle numeric keys as integers, others as string
+                    if (key == "RANDOM_SEED" || key == "REPLICATION" || key == "STATION_ORDER_TOP_K"
+                        || key == "MATRIX_TILE_COLS" || key == "MATRIX_CACHE_TILES"
+                        || key == "ORACLE_CELL_SIZE_M" || key == "OSRM_MAX_IN_FLIGHT"
+                        || key == "OSRM_TIMEOUT_MS" || key == "OSRM_MAX_RETRIES"
+                        || key == "OSRM_RETRY_BACKOFF_MS" || key == "OSRM_MAX_TABLE_SIZE"
+                        || key == "OSRM_MAX_URL_LENGTH" || key == "OSRM_TARGET_LATENCY_MS"
+                        || key == "BUILDING_TILE_ZOOM" || key == "BUILDING_RADIUS_M"
+                        || key == "ONNX_INTRA_OP_THREADS" || key == "ONNX_INTER_OP_THREADS") {
                         try {
                             config[key] = std::stoi(value);
                         } catch (const std::exception& e) {
-                            std::cerr << "Warning: Invalid value for RANDOM_SEED: " << value 
+                            std::cerr << "Warning: Invalid value for " << key << ": " << value 
                                       << ". Using default." << std::endl;
                         }
                     } else {
@@ -175,8 +252,14 @@ int main(int argc, char* argv[]) {
     std::vector<Incident> incidents = {};
     std::vector<Station> stations = {};
     std::vector<Apparatus> apparatuses = {};
-    size_t chunk_size = 500;
-    loader::preComputingMatrices(stations, incidents, apparatuses, chunk_size);
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--compile-inputs") {
+            loader::loadInputs(stations, incidents, apparatuses);
+            return 0;
+        }
+    }
+    // Request sizes come from OSRM_MAX_TABLE_SIZE / OSRM_MAX_URL_LENGTH and adapt to OSRM's latency.
+    loader::preComputingMatrices(stations, incidents, apparatuses);
 
     #ifdef HAVE_SPDLOG_STOPWATCH
     spdlog::stopwatch sw;
@@ -192,23 +275,30 @@ int main(int argc, char* argv[]) {
     initial_state.matchApparatusesWithStations(); // Match apparatuses with their respective stations
 
     std::string policy_name = env->get("DISPATCH_POLICY", "NEAREST");
+    size_t matrix_cache_tiles = std::stoul(env->get("MATRIX_CACHE_TILES", "64"));
     std::unique_ptr<DispatchPolicy> policy;
     if (policy_name == constants::POLICY_NEAREST) {
         LOG_INFO("Using {} dispatching policy", policy_name);
         policy = std::make_unique<NearestDispatch>(
             env->get("DISTANCE_MATRIX_PATH", "../logs/distance_matrix.bin"),
-            env->get("DURATION_MATRIX_PATH", "../logs/duration_matrix.bin"));
+            env->get("DURATION_MATRIX_PATH", "../logs/duration_matrix.bin"),
+            env->get("STATION_ORDER_PATH", "../logs/station_order.bin"),
+            std::stoi(env->get("STATION_ORDER_TOP_K", "5")),
+            matrix_cache_tiles,
+            env->get("TRAVEL_TIME_ORACLE_PATH", "../logs/travel_time_oracle.bin"));
     } else if (policy_name == constants::POLICY_FIREBEATS) {
         LOG_INFO("Using {} dispatching policy", policy_name);
         policy = std::make_unique<FireBeatsDispatch>(
             env->get("DISTANCE_MATRIX_PATH", "../logs/distance_matrix.bin"),
             env->get("DURATION_MATRIX_PATH", "../logs/duration_matrix.bin"),
             env->get("FIREBEATS_MATRIX_PATH", "../logs/firebeats_matrix.bin"),
-            env->get("ZONE_MAP_PATH", "../data/zones.csv")
+            env->get("ZONE_MAP_PATH", "../data/zones.csv"),
+            matrix_cache_tiles
         );
     } else {
         throw std::runtime_error("Only FIREBEATS or NEAREST policy supported");
     }
+    policy->setIncidentOrder(loader::upcomingIncidentIndices(events));
 
     int seed = std::stoi(env->get("RANDOM_SEED", "42"));
     std::string nfd_path = env->get("NFD_RESPONSE_CSV_PATH", "");
@@ -217,7 +307,13 @@ int main(int argc, char* argv[]) {
 
     // std::string model_path = env->get("MODEL_PATH", "../models/gradient_boost_fire_model.onnx");
     // std::string features_path = env->get("FEATURES_PATH", "../models/fire_model_features_mapping.json");
-    // std::unique_ptr<FireModel> fireModel = std::make_unique<MLFireModel>(seed, model_path, features_path, nfd_path);
+    // std::unique_ptr<MLFireModel> mlFireModel = std::make_unique<MLFireModel>(seed, model_path, features_path, nfd_path);
+    // mlFireModel->useBuildings(loader::loadBuildingIndex(incidents), std::stod(env->get("BUILDING_RADIUS_M", "50")));
+    // mlFireModel->precomputeResolutionTimes(incidents);
+    // std::unique_ptr<FireModel> fireModel = std::move(mlFireModel);
+    if (env->get("RNG_STREAMS", "SEQUENTIAL") == "COUNTER") {
+        fireModel->useCounterStreams(static_cast<uint32_t>(seed), static_cast<uint32_t>(std::stoul(env->get("REPLICATION", "0"))));
+    }
 
     EnvironmentModel environment_model(*fireModel);
     Simulator simulator(initial_state, events, environment_model, *policy);
@@ -229,6 +325,12 @@ int main(int argc, char* argv[]) {
 
     simulator.writeReportToCSV();
     simulator.writeActions();
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::string(argv[i]) == "--export-routes") {
+            simulator.writeRoutes();
+        }
+    }
     
     // No need to delete fireModel, unique_ptr handles it automatically
 
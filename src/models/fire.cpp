@@ -1,11 +1,29 @@
 #include "models/fire.h"
+#include "config/EnvLoader.h"
 #include "simulator/state.h"
 #include "utils/constants.h"
 #include "utils/error.h"
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <cstdlib>
+#include <chrono>
+#include <cmath>
+#include <limits>
 #include <random>
+#include <span>
+#include "utils/datetime.h"
 #include "utils/logger.h"
+#include "utils/parallel.h"
 #include "enums.h"
 
+void FireModel::useCounterStreams(uint32_t seed, uint32_t replication) {
+    counter_streams_ = true;
+    stream_seed_ = seed;
+    replication_ = replication;
+    stream_positions_.clear();
+}
+
 // TODO: All placeholders, not working yet.
 HardCodedFireModel::HardCodedFireModel(unsigned int seed)
     : rng_(seed), dist_(0.0, 1.0) {}
@@ -60,69 +78,18 @@ std::unordered_map<ApparatusType, int> HardCodedFireModel::calculateApparatusCou
     return apparatusCount; // Return the calculated apparatus count map
 }
 
-//TODO: Delete this function and put in loader.h
-IncidentCategory stringToIncidentCategory(const std::string& str) {
-    if (str == "One") return IncidentCategory::One;
-    if (str == "OneB") return IncidentCategory::OneB;
-    if (str == "OneBM") return IncidentCategory::OneBM;
-    if (str == "OneC") return IncidentCategory::OneC;
-    if (str == "OneD") return IncidentCategory::OneD;
-    if (str == "OneE") return IncidentCategory::OneE;
-    if (str == "OneEM") return IncidentCategory::OneEM;
-    if (str == "OneF") return IncidentCategory::OneF;
-    if (str == "OneG") return IncidentCategory::OneG;
-    if (str == "OneH") return IncidentCategory::OneH;
-    if (str == "OneJ") return IncidentCategory::OneJ;
-    if (str == "Two") return IncidentCategory::Two;
-    if (str == "TwoM") return IncidentCategory::TwoM;
-    if (str == "TwoMF") return IncidentCategory::TwoMF;
-    if (str == "TwoA") return IncidentCategory::TwoA;
-    if (str == "TwoB") return IncidentCategory::TwoB;
-    if (str == "TwoC") return IncidentCategory::TwoC;
-    if (str == "Three") return IncidentCategory::Three;
-    if (str == "ThreeF") return IncidentCategory::ThreeF;
-    if (str == "ThreeM") return IncidentCategory::ThreeM;
-    if (str == "ThreeA") return IncidentCategory::ThreeA;
-    if (str == "ThreeB") return IncidentCategory::ThreeB;
-    if (str == "ThreeC") return IncidentCategory::ThreeC;
-    if (str == "ThreeCM") return IncidentCategory::ThreeCM;
-    if (str == "ThreeD") return IncidentCategory::ThreeD;
-    if (str == "Four") return IncidentCategory::Four;
-    if (str == "FourM") return IncidentCategory::FourM;
-    if (str == "FourA") return IncidentCategory::FourA;
-    if (str == "FourB") return IncidentCategory::FourB;
-    if (str == "FourC") return IncidentCategory::FourC;
-    if (str == "Five") return IncidentCategory::Five;
-    if (str == "FiveA") return IncidentCategory::FiveA;
-    if (str == "Six") return IncidentCategory::Six;
-    if (str == "Seven") return IncidentCategory::Seven;
-    if (str == "SevenB") return IncidentCategory::SevenB;
-    if (str == "SevenBM") return IncidentCategory::SevenBM;
-    if (str == "Eight") return IncidentCategory::Eight;
-    if (str == "EightA") return IncidentCategory::EightA;
-    if (str == "EightB") return IncidentCategory::EightB;
-    if (str == "EightC") return IncidentCategory::EightC;
-    if (str == "EightD") return IncidentCategory::EightD;
-    if (str == "EightE") return IncidentCategory::EightE;
-    if (str == "EightF") return IncidentCategory::EightF;
-    if (str == "EightG") return IncidentCategory::EightG;
-    if (str == "Nine") return IncidentCategory::Nine;
-    if (str == "Ten") return IncidentCategory::Ten;
-    if (str == "Eleven") return IncidentCategory::Eleven;
-    if (str == "ElevenA") return IncidentCategory::ElevenA;
-    if (str == "ElevenB") return IncidentCategory::ElevenB;
-    if (str == "Thirteen") return IncidentCategory::Thirteen;
-    if (str == "Fourteen") return IncidentCategory::Fourteen;
-    if (str == "Fifteen") return IncidentCategory::Fifteen;
-    if (str == "Sixteen") return IncidentCategory::Sixteen;
-    if (str == "Eighteen") return IncidentCategory::Eighteen;
-    return IncidentCategory::Invalid;
-}
-
 DepartmentFireModel::DepartmentFireModel(unsigned int seed, const std::string& csv_path, const std::string& resolution_stats_path)
     : rng_(seed), dist_(0.0, 1.0) {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    std::string sampler = env ? env->get("RESOLUTION_SAMPLER", "NORMAL") : "NORMAL";
+    if (sampler == "QUANTILE") {
+        sampler_ = ResolutionSampler::Quantile;
+    } else if (sampler != "NORMAL") {
+        throw InvalidValueError("Unknown RESOLUTION_SAMPLER: " + sampler);
+    }
     loadApparatusRequirements(csv_path);
     loadResolutionStats(resolution_stats_path);
+    buildSamplers();
 }
 
 void DepartmentFireModel::loadApparatusRequirements(const std::string& csv_path) {
@@ -194,11 +161,17 @@ void DepartmentFireModel::loadResolutionStats(const std::string& csv_path) {
             stats.variance = std::stod(token) * std::stod(token); // variance is stddev squared
         }
 
-        std::getline(ss, token, ','); // min, not used
-        std::getline(ss, token, ','); // 25%, not used
-        std::getline(ss, token, ','); // 50%, not used
-        std::getline(ss, token, ','); // 75%, not used
-        std::getline(ss, token, ','); // max, not used
+        // min, 25%, 50%, 75% and max, used by the QUANTILE sampler when all are present and ordered
+        stats.hasQuantiles = true;
+        for (double& quantile : stats.quantiles) {
+            std::getline(ss, token, ',');
+            char* end = nullptr;
+            quantile = std::strtod(token.c_str(), &end);
+            if (token.empty() || end == token.c_str() || !std::isfinite(quantile)) {
+                stats.hasQuantiles = false;
+            }
+        }
+        stats.hasQuantiles = stats.hasQuantiles && std::is_sorted(stats.quantiles.begin(), stats.quantiles.end());
         if (category == IncidentCategory::Invalid) {
             LOG_ERROR("[DepartmentFireModel] Invalid category in resolution stats: {}", token);
             continue; // skip invalid categories
@@ -208,35 +181,71 @@ void DepartmentFireModel::loadResolutionStats(const std::string& csv_path) {
     }
 }
 
+void DepartmentFireModel::buildSamplers() {
+    samplers_.assign(INCIDENT_CATEGORY_NAMES.size(), CategorySampler{});
+    for (const auto& [category, stats] : resolution_stats_) {
+        CategorySampler& sampler = samplers_[static_cast<size_t>(category)];
+        sampler.known = true;
+        sampler.normal = std::normal_distribution<double>::param_type(stats.mean, std::sqrt(stats.variance));
+        sampler.quantiles = stats.quantiles;
+        sampler.hasQuantiles = stats.hasQuantiles;
+    }
+    if (resolution_stats_.empty()) {
+        return;
+    }
+
+    // Fallback: weighted mean and variance
+    double weighted_mean_sum = 0.0;
+    double weighted_variance_sum = 0.0;
+    int total_count = 0;
+    for (const auto& pair : resolution_stats_) {
+        weighted_mean_sum += pair.second.mean * pair.second.count;
+        weighted_variance_sum += pair.second.variance * pair.second.count;
+        total_count += pair.second.count;
+        if (pair.second.count > 0) {
+            double before = mixture_counts_.empty() ? 0.0 : mixture_counts_.back();
+            mixture_counts_.push_back(before + pair.second.count);
+            mixture_categories_.push_back(static_cast<size_t>(pair.first));
+        }
+    }
+    double weighted_mean = weighted_mean_sum / total_count;
+    double weighted_variance = weighted_variance_sum / total_count;
+    fallback_.known = true;
+    fallback_.normal = std::normal_distribution<double>::param_type(weighted_mean, std::sqrt(weighted_variance));
+}
+
+template <typename Rng>
+double DepartmentFireModel::sample(const CategorySampler& sampler, Rng& rng) {
+    if (sampler_ == ResolutionSampler::Quantile && sampler.hasQuantiles) {
+        double position = dist_(rng) * 4.0;
+        size_t segment = std::min<size_t>(static_cast<size_t>(position), 3);
+        const auto& q = sampler.quantiles;
+        return q[segment] + (position - static_cast<double>(segment)) * (q[segment + 1] - q[segment]);
+    }
+    // A fresh draw per call, as a new distribution each time would make.
+    normal_.reset();
+    return normal_(rng, sampler.normal);
+}
+
 double DepartmentFireModel::computeResolutionTime(State& state, const Incident& incident) {
     state.getSystemTime();
-    auto it = resolution_stats_.find(incident.category);
-    if (it != resolution_stats_.end()) {
-        std::normal_distribution<double> normal_dist(it->second.mean, std::sqrt(it->second.variance));
-        double sampled_time = normal_dist(rng_);
-        return std::max(sampled_time, 1.0);
-    }
-    
-    // Fallback: compute weighted mean and variance
-    if (!resolution_stats_.empty()) {
-        double weighted_mean_sum = 0.0;
-        double weighted_variance_sum = 0.0;
-        int total_count = 0;
-        
-        // Calculate weighted sums
-        for (const auto& pair : resolution_stats_) {
-            weighted_mean_sum += pair.second.mean * pair.second.count;
-            weighted_variance_sum += pair.second.variance * pair.second.count;
-            total_count += pair.second.count;
-        }
-        
-        double weighted_mean = weighted_mean_sum / total_count;
-        double weighted_variance = weighted_variance_sum / total_count;
-        
-        std::normal_distribution<double> fallback_dist(weighted_mean, std::sqrt(weighted_variance));
-        double sampled_time = fallback_dist(rng_);
+    size_t category = static_cast<size_t>(incident.category);
+    if (category < samplers_.size() && samplers_[category].known) {
+        return drawFor(incident, rng_, [&](auto& rng) { return std::max(sample(samplers_[category], rng), 1.0); });
+    }
 
-        return std::max(sampled_time, 1.0);
+    // Unknown category: the count-weighted normal of all categories, or for QUANTILE
+    // a category picked in proportion to its count.
+    if (fallback_.known) {
+        return drawFor(incident, rng_, [&](auto& rng) {
+            if (sampler_ == ResolutionSampler::Quantile && !mixture_counts_.empty()) {
+                double pick = dist_(rng) * mixture_counts_.back();
+                size_t k = static_cast<size_t>(std::upper_bound(mixture_counts_.begin(), mixture_counts_.end(), pick)
+                                               - mixture_counts_.begin());
+                return std::max(sample(samplers_[mixture_categories_[std::min(k, mixture_categories_.size() - 1)]], rng), 1.0);
+            }
+            return std::max(sample(fallback_, rng), 1.0);
+        });
     }
     
     // Last resort fallback
@@ -259,8 +268,10 @@ std::unordered_map<ApparatusType, int> DepartmentFireModel::calculateApparatusCo
 }
 
 MLFireModel::MLFireModel(unsigned int seed, const std::string& model_path, const std::string& config_path, const std::string& apparatus_csv_path){
-    // Initialize ONNX predictor
-    onnx_predictor_ = std::make_unique<ONNXPredictor>();
+    // Initialize ONNX predictor, unless the trees are evaluated natively without an ONNX Runtime session
+    if (EnvLoader::getInstance()->get("ML_EVALUATOR", "ONNX") != "NATIVE") {
+        onnx_predictor_ = std::make_unique<ONNXPredictor>();
+    }
     
     // Load components in order
     loadFeatureConfig(config_path);  // Load first to get feature info
@@ -272,6 +283,20 @@ MLFireModel::MLFireModel(unsigned int seed, const std::string& model_path, const
 
 
 
+void MLFireModel::useBuildings(std::shared_ptr<const BuildingIndex> buildings, double radiusMeters) {
+    bool modelUsesBuildings = std::any_of(feature_order_.begin(), feature_order_.end(), [](const std::string& name) {
+        return name == "building_count" || name == "building_max_levels" || name == "nearest_building_m";
+    });
+    if (!modelUsesBuildings) {
+        LOG_WARN("[MLFireModel] Model has no building features, ignoring the building cache");
+        return;
+    }
+    buildings_ = std::move(buildings);
+    building_radius_m_ = radiusMeters;
+    LOG_INFO("[MLFireModel] Using {} cached buildings within {} m of each incident",
+             buildings_ ? buildings_->size() : 0, radiusMeters);
+}
+
 void MLFireModel::loadApparatusRequirements(const std::string& csv_path) {
     std::ifstream file(csv_path);
     std::string line;
@@ -321,32 +346,27 @@ std::unordered_map<ApparatusType, int> MLFireModel::calculateApparatusCount(cons
 }
 
 double MLFireModel::computeResolutionTime(State& state, const Incident& incident) {
+    state.getSystemTime();
+    if (incident.incidentIndex >= 0 && static_cast<size_t>(incident.incidentIndex) < precomputed_times_.size()
+        && !std::isnan(precomputed_times_[incident.incidentIndex])) {
+        return precomputed_times_[incident.incidentIndex];
+    }
     try {
-        // Extract all features for the incident
-        std::vector<float> features = extractFeatures(state, incident);
+        // Extract all features for the incident into the reused buffer
+        extractFeatures(incident, feature_buffer_);
         
         // Validate feature count
-        if (features.size() != static_cast<size_t>(expected_input_features_)) {
+        if (feature_buffer_.size() != static_cast<size_t>(expected_input_features_)) {
             LOG_ERROR("[MLFireModel] Feature size mismatch. Expected: {}, Got: {}", 
-                     expected_input_features_, features.size());
+                     expected_input_features_, feature_buffer_.size());
             return 45 * constants::SECONDS_IN_MINUTE; // Fallback
         }
         
-        // Run ONNX inference
-        float predicted_time = onnx_predictor_->predict(features);
-        
-        if (predicted_time < 0) {
-            LOG_ERROR("[MLFireModel] ONNX prediction failed, using fallback");
-            return 45 * constants::SECONDS_IN_MINUTE; // Fallback
+        // Run inference
+        if (tree_ensemble_) {
+            return toResolutionTime(tree_ensemble_->predict(feature_buffer_), incident);
         }
-        
-        // Ensure minimum response time (clamp to at least 1 minute)
-        double response_time = std::max(static_cast<double>(predicted_time), 0.0);
-        
-        LOG_DEBUG("[MLFireModel] Predicted response time: {:.2f} seconds for incident category: {}", 
-                 response_time, to_string(incident.category));
-        
-        return response_time;
+        return toResolutionTime(onnx_predictor_->predict(feature_buffer_), incident);
         
     } catch (const std::exception& e) {
         LOG_ERROR("[MLFireModel] Error during prediction: {}", e.what());
@@ -354,8 +374,89 @@ double MLFireModel::computeResolutionTime(State& state, const Incident& incident
     }
 }
 
+double MLFireModel::toResolutionTime(float predicted_time, const Incident& incident) const {
+    if (predicted_time < 0) {
+        LOG_ERROR("[MLFireModel] ONNX prediction failed, using fallback");
+        return 45 * constants::SECONDS_IN_MINUTE; // Fallback
+    }
+    
+    // Ensure minimum response time (clamp to at least 1 minute)
+    double response_time = std::max(static_cast<double>(predicted_time), 0.0);
+    
+    LOG_DEBUG("[MLFireModel] Predicted response time: {:.2f} seconds for incident category: {}", 
+             response_time, to_string(incident.category));
+    
+    return response_time;
+}
+
+void MLFireModel::precomputeResolutionTimes(const std::vector<Incident>& incidents, size_t batchRows, size_t threads) {
+    auto start = std::chrono::steady_clock::now();
+    const size_t width = static_cast<size_t>(std::max(expected_input_features_, 0));
+    const size_t n = incidents.size();
+    batchRows = std::max<size_t>(batchRows, 1);
+
+    // Feature rows depend on the incident alone, so they are built in parallel into one matrix.
+    std::vector<float> matrix(n * width, 0.0f);
+    std::vector<uint8_t> complete(n, 0);
+    utils::parallelFor(n, [&](size_t begin, size_t end) {
+        std::vector<float> features;
+        for (size_t i = begin; i < end; ++i) {
+            extractFeatures(incidents[i], features);
+            if (features.size() == width) {
+                std::copy(features.begin(), features.end(), matrix.begin() + static_cast<std::ptrdiff_t>(i * width));
+                complete[i] = 1;
+            }
+        }
+    }, threads);
+
+    // Each thread runs whole batches; the session supports concurrent Run calls.
+    std::vector<float> predicted(n, -1.0f);
+    size_t batches = (n + batchRows - 1) / batchRows;
+    utils::parallelFor(batches, [&](size_t begin, size_t end) {
+        for (size_t batch = begin; batch < end; ++batch) {
+            size_t first = batch * batchRows;
+            size_t rows = std::min(batchRows, n - first);
+            std::span<const float> features = std::span<const float>(matrix).subspan(first * width, rows * width);
+            std::vector<float> out = tree_ensemble_ ? tree_ensemble_->predictBatch(features, rows)
+                                                    : onnx_predictor_->predictBatch(features, rows, batchRows);
+            std::copy(out.begin(), out.end(), predicted.begin() + static_cast<std::ptrdiff_t>(first));
+        }
+    }, threads);
+
+    int slots = 0;
+    for (const auto& incident : incidents) slots = std::max(slots, incident.incidentIndex + 1);
+    precomputed_times_.assign(static_cast<size_t>(slots), std::numeric_limits<double>::quiet_NaN());
+    size_t mismatched = 0;
+    for (size_t i = 0; i < n; ++i) {
+        if (incidents[i].incidentIndex < 0) continue;
+        double& time = precomputed_times_[incidents[i].incidentIndex];
+        if (complete[i]) {
+            time = toResolutionTime(predicted[i], incidents[i]);
+        } else {
+            time = 45 * constants::SECONDS_IN_MINUTE; // Fallback, as for a per-call size mismatch
+            mismatched++;
+        }
+    }
+    if (mismatched > 0) {
+        LOG_ERROR("[MLFireModel] {} incidents had a feature size mismatch, using the fallback time", mismatched);
+    }
+    LOG_INFO("[MLFireModel] Precomputed {} resolution times in {} batches in {:.3f} s", n, batches,
+             std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+}
+
 void MLFireModel::loadONNXModel(const std::string& model_path) {
     LOG_INFO("[MLFireModel] Loading ONNX model from: {}", model_path);
+
+    if (!onnx_predictor_) {
+        tree_ensemble_ = std::make_unique<TreeEnsemble>(TreeEnsemble::loadOnnx(model_path));
+        if (tree_ensemble_->featureCount() > static_cast<size_t>(std::max(expected_input_features_, 0))) {
+            LOG_ERROR("[MLFireModel] Tree ensemble reads {} features, the config has {}",
+                      tree_ensemble_->featureCount(), expected_input_features_);
+            throw std::runtime_error("Tree ensemble does not match the feature config");
+        }
+        LOG_INFO("[MLFireModel] Evaluating the model's trees natively");
+        return;
+    }
     
     if (!onnx_predictor_->loadModel(model_path)) {
         LOG_ERROR("[MLFireModel] Failed to load ONNX model: {}", model_path);
@@ -474,6 +575,8 @@ void MLFireModel::loadFeatureConfig(const std::string& config_path) {
                 LOG_INFO("  [{}] {}", i, feature_order_[i]);
             }
         }
+
+        compileFeaturePlan();
         
     } catch (const std::exception& e) {
         LOG_ERROR("[MLFireModel] Error parsing feature config: {}", e.what());
@@ -481,179 +584,235 @@ void MLFireModel::loadFeatureConfig(const std::string& config_path) {
     }
 }
 
-std::vector<float> MLFireModel:: extractFeatures(const State& state, const Incident& incident) {
-    std::vector<float> all_features;
-    
-    // Create a map of all possible features
-    std::map<std::string, float> feature_map;
-    
-    // Extract all individual features and store them in the map
-    
-    // 1. Extract temporal features
-    int hour = extractHour(incident.reportTime);
-    int day_of_week = extractDayOfWeek(incident.reportTime);
-    int month = extractMonth(incident.reportTime);
-    int quarter = extractQuarter(incident.reportTime);
-    int day_of_year = extractDayOfYear(incident.reportTime);
-    bool is_weekend = (day_of_week == 5 || day_of_week == 6);
-    bool is_night = (hour >= 22 || hour <= 6);
-    bool is_rush_hour = ((hour >= 7 && hour <= 9) || (hour >= 16 && hour <= 18));
-    bool is_business_hours = (hour >= 9 && hour <= 17 && day_of_week < 5);
-    
-    // Store numerical features
-    feature_map["hour"] = scaleNumericalFeature("hour", static_cast<float>(hour));
-    feature_map["day_of_week"] = scaleNumericalFeature("day_of_week", static_cast<float>(day_of_week));
-    feature_map["month"] = scaleNumericalFeature("month", static_cast<float>(month));
-    feature_map["quarter"] = scaleNumericalFeature("quarter", static_cast<float>(quarter));
-    feature_map["day_of_year"] = scaleNumericalFeature("day_of_year", static_cast<float>(day_of_year));
-    feature_map["is_weekend"] = scaleNumericalFeature("is_weekend", is_weekend ? 1.0f : 0.0f);
-    feature_map["is_night"] = scaleNumericalFeature("is_night", is_night ? 1.0f : 0.0f);
-    feature_map["is_rush_hour"] = scaleNumericalFeature("is_rush_hour", is_rush_hour ? 1.0f : 0.0f);
-    feature_map["is_business_hours"] = scaleNumericalFeature("is_business_hours", is_business_hours ? 1.0f : 0.0f);
-    
-    // 2. Extract geographic features
-    feature_map["lat"] = scaleNumericalFeature("lat", static_cast<float>(incident.lat));
-    feature_map["lon"] = scaleNumericalFeature("lon", static_cast<float>(incident.lon));
-    
-    double nashville_center_lat = 36.1627;
-    double nashville_center_lon = -86.7816;
-    double distance = calculateDistanceFromCenter(incident.lat, incident.lon, nashville_center_lat, nashville_center_lon);
-    feature_map["distance_from_center"] = scaleNumericalFeature("distance_from_center", static_cast<float>(distance));
-    
-    // 3. Extract categorical features and create one-hot encodings
-    
-    // Shift
-    std::string shift;
-    if (hour >= 6 && hour < 14) {
-        shift = "Day";
-    } else if (hour >= 14 && hour < 22) {
-        shift = "Evening";  
-    } else {
-        shift = "Night";
-    }
-    auto shift_encoded = encodeCategoricalFeature("shift", shift);
-    
-    // Season
-    std::string season;
-    if (month == 12 || month == 1 || month == 2) {
-        season = "Winter";
-    } else if (month >= 3 && month <= 5) {
-        season = "Spring";
-    } else if (month >= 6 && month <= 8) {
-        season = "Summer";
-    } else {
-        season = "Fall";
+void MLFireModel::compileFeaturePlan() {
+    feature_plan_.clear();
+    plan_uses_buildings_ = false;
+    if (feature_order_.empty()) {
+        return;
     }
-    auto season_encoded = encodeCategoricalFeature("season", season);
-    
-    // Category
-    std::string category_str = to_string(incident.category);
-    auto category_encoded = encodeCategoricalFeature("category", category_str);
-    
-    // Zone ID
-    std::string zone_id;
-    if (incident.zoneIndex >= 0) {
-        zone_id = std::to_string(incident.zoneIndex) + ".0"; // Use integer conversion, not float
-    } else {
-        zone_id = "nan";
+
+    // Every feature name the extraction can produce, bound to where its value comes from.
+    std::map<std::string, FeatureSlot> available;
+    static const std::pair<const char*, FeatureSource> numeric[] = {
+        {"hour", FeatureSource::Hour}, {"day_of_week", FeatureSource::DayOfWeek}, {"month", FeatureSource::Month},
+        {"quarter", FeatureSource::Quarter}, {"day_of_year", FeatureSource::DayOfYear},
+        {"is_weekend", FeatureSource::IsWeekend}, {"is_night", FeatureSource::IsNight},
+        {"is_rush_hour", FeatureSource::IsRushHour}, {"is_business_hours", FeatureSource::IsBusinessHours},
+        {"lat", FeatureSource::Lat}, {"lon", FeatureSource::Lon},
+        {"distance_from_center", FeatureSource::DistanceFromCenter},
+        {"building_count", FeatureSource::BuildingCount}, {"building_max_levels", FeatureSource::BuildingMaxLevels},
+        {"nearest_building_m", FeatureSource::NearestBuildingM}};
+    for (const auto& [name, source] : numeric) {
+        FeatureSlot slot;
+        slot.source = source;
+        auto scaling = numerical_scaling_.find(name);
+        if (scaling != numerical_scaling_.end()) {
+            slot.scaled = true;
+            slot.mean = scaling->second.first;
+            slot.scale = scaling->second.second;
+        }
+        available[name] = slot;
     }
-    auto zone_encoded = encodeCategoricalFeature("ZONE_ID", zone_id);
-    
-    // Incident type
-    std::string incident_type = to_string(incident.incident_type);
-    auto type_encoded = encodeCategoricalFeature("incident_type", incident_type);
-    
-    // Store categorical features in the map
-    // For categorical features, we need to store each one-hot encoded feature separately
-    
-    // Shift features
-    if (shift_encoded.size() >= 1) feature_map["shift_Evening"] = shift_encoded[0];
-    if (shift_encoded.size() >= 2) feature_map["shift_Night"] = shift_encoded[1];
-    
-    // Season features  
-    if (season_encoded.size() >= 1) feature_map["season_Spring"] = season_encoded[0];
-    if (season_encoded.size() >= 2) feature_map["season_Summer"] = season_encoded[1];
-    if (season_encoded.size() >= 3) feature_map["season_Winter"] = season_encoded[2];
-    
-    // Category features - map each encoded feature to its name
-    auto category_mapping = categorical_mappings_.find("category");
-    if (category_mapping != categorical_mappings_.end()) {
-        int idx = 0;
-        for (const auto& [cat_name, cat_idx] : category_mapping->second) {
-            if (cat_idx > 0) { // Skip dropped category (index 0)
-                std::string feature_name = "category_" + cat_name;
-                if (idx < category_encoded.size()) {
-                    feature_map[feature_name] = category_encoded[idx];
-                    idx++;
-                }
+
+    // Looks up each possible value once; returns the number of one-hot columns, -1 without an encoding.
+    auto compileCodes = [this](const std::string& feature, const std::vector<std::string>& values, CategoricalCodes& codes) {
+        codes = {};
+        auto mapping = categorical_mappings_.find(feature);
+        if (mapping == categorical_mappings_.end()) {
+            LOG_WARN("[MLFireModel] No encoding found for categorical feature: {}", feature);
+            return -1;
+        }
+        codes.name = feature;
+        for (const auto& value : values) {
+            auto code = mapping->second.find(value);
+            codes.codes.push_back(code != mapping->second.end() ? code->second : -1);
+        }
+        return static_cast<int>(mapping->second.size()) - 1;
+    };
+    auto oneHot = [&](FeatureSource source, int position) {
+        FeatureSlot slot;
+        slot.source = source;
+        slot.oneHot = position;
+        return slot;
+    };
+    // Columns named <prefix><value>: the k-th non-dropped value in name order reads one-hot position k + 1.
+    auto namedColumns = [&](const std::string& feature, const std::string& prefix, FeatureSource source, int columns) {
+        auto mapping = categorical_mappings_.find(feature);
+        if (mapping == categorical_mappings_.end()) return;
+        int position = 0;
+        for (const auto& [value, code] : mapping->second) {
+            if (code > 0 && position < columns) {
+                available[prefix + value] = oneHot(source, ++position);
             }
         }
+    };
+
+    // Without an encoding, shift and season still answer their first column with a zero.
+    int shiftColumns = compileCodes("shift", {"Day", "Evening", "Night"}, shift_codes_);
+    if (shiftColumns < 0) available["shift_Evening"] = FeatureSlot{};
+    if (shiftColumns >= 1) available["shift_Evening"] = oneHot(FeatureSource::Shift, 1);
+    if (shiftColumns >= 2) available["shift_Night"] = oneHot(FeatureSource::Shift, 2);
+    int seasonColumns = compileCodes("season", {"Winter", "Spring", "Summer", "Fall"}, season_codes_);
+    if (seasonColumns < 0) available["season_Spring"] = FeatureSlot{};
+    if (seasonColumns >= 1) available["season_Spring"] = oneHot(FeatureSource::Season, 1);
+    if (seasonColumns >= 2) available["season_Summer"] = oneHot(FeatureSource::Season, 2);
+    if (seasonColumns >= 3) available["season_Winter"] = oneHot(FeatureSource::Season, 3);
+
+    std::vector<std::string> categories, types;
+    for (size_t i = 0; i < INCIDENT_CATEGORY_NAMES.size(); ++i) {
+        categories.emplace_back(INCIDENT_CATEGORY_NAMES.name(static_cast<IncidentCategory>(i)));
     }
-    
-    // Zone ID features
-    auto zone_mapping = categorical_mappings_.find("ZONE_ID");
-    if (zone_mapping != categorical_mappings_.end()) {
-        int idx = 0;
-        for (const auto& [zone_name, zone_idx] : zone_mapping->second) {
-            if (zone_idx > 0) { // Skip dropped category
-                std::string feature_name = "ZONE_ID_" + zone_name;
-                if (idx < zone_encoded.size()) {
-                    feature_map[feature_name] = zone_encoded[idx];
-                    idx++;
-                }
+    for (size_t i = 0; i < INCIDENT_TYPE_NAMES.size(); ++i) {
+        types.emplace_back(INCIDENT_TYPE_NAMES.name(static_cast<IncidentType>(i)));
+    }
+    namedColumns("category", "category_", FeatureSource::Category, compileCodes("category", categories, category_codes_));
+
+    // Zone values are "<zoneIndex>.0", or "nan" without a zone; codes are indexed by zoneIndex.
+    std::vector<std::string> zones;
+    zone_nan_code_ = -1;
+    auto zoneMapping = categorical_mappings_.find("ZONE_ID");
+    if (zoneMapping != categorical_mappings_.end()) {
+        for (const auto& [value, code] : zoneMapping->second) {
+            int zone = -1;
+            if (value.size() > 2 && value.ends_with(".0")) {
+                auto [end, ec] = std::from_chars(value.data(), value.data() + value.size() - 2, zone);
+                if (ec != std::errc() || std::to_string(zone) + ".0" != value) zone = -1;
+            }
+            if (zone >= 0 && static_cast<size_t>(zone) >= zones.size()) {
+                for (int z = static_cast<int>(zones.size()); z <= zone; ++z) zones.push_back(std::to_string(z) + ".0");
             }
         }
+        auto nan = zoneMapping->second.find("nan");
+        if (nan != zoneMapping->second.end()) zone_nan_code_ = nan->second;
     }
-    
-    // Incident type features
-    auto type_mapping = categorical_mappings_.find("incident_type");
-    if (type_mapping != categorical_mappings_.end()) {
-        int idx = 0;
-        for (const auto& [type_name, type_idx] : type_mapping->second) {
-            if (type_idx > 0) { // Skip dropped category
-                std::string feature_name = "incident_type_" + type_name;
-                if (idx < type_encoded.size()) {
-                    feature_map[feature_name] = type_encoded[idx];
-                    idx++;
-                }
-            }
+    namedColumns("ZONE_ID", "ZONE_ID_", FeatureSource::Zone, compileCodes("ZONE_ID", zones, zone_codes_));
+    namedColumns("incident_type", "incident_type_", FeatureSource::Type, compileCodes("incident_type", types, type_codes_));
+
+    feature_plan_.reserve(feature_order_.size());
+    for (const std::string& feature_name : feature_order_) {
+        auto it = available.find(feature_name);
+        if (it == available.end()) {
+            LOG_WARN("[MLFireModel] Feature '{}' not found in feature map, using 0.0", feature_name);
+            feature_plan_.emplace_back();
+            continue;
+        }
+        const FeatureSlot& slot = it->second;
+        if (slot.source < FeatureSource::NumericCount && !slot.scaled) {
+            LOG_WARN("[MLFireModel] No scaling parameters found for feature: {}", feature_name);
         }
+        plan_uses_buildings_ |= slot.source == FeatureSource::BuildingCount
+            || slot.source == FeatureSource::BuildingMaxLevels || slot.source == FeatureSource::NearestBuildingM;
+        feature_plan_.push_back(slot);
     }
-    
-    // 4. Use the exact feature order from JSON to build the final feature vector
-    if (!feature_order_.empty()) {
-        all_features.reserve(feature_order_.size());
-        for (const std::string& feature_name : feature_order_) {
-            auto it = feature_map.find(feature_name);
-            if (it != feature_map.end()) {
-                all_features.push_back(it->second);
-            } else {
-                LOG_WARN("[MLFireModel] Feature '{}' not found in feature map, using 0.0", feature_name);
-                all_features.push_back(0.0f); // Default value for missing features
-            }
+    feature_buffer_.assign(feature_plan_.size(), 0.0f);
+
+    if (static_cast<int>(feature_plan_.size()) != expected_input_features_) {
+        LOG_ERROR("[MLFireModel] Feature count mismatch! Got {}, expected {}",
+                  feature_plan_.size(), expected_input_features_);
+    }
+    LOG_INFO("[MLFireModel] Compiled feature plan with {} slots", feature_plan_.size());
+}
+
+namespace {
+// Encoded index of value, warning when the config has an encoding for the feature but not this value.
+template <typename Describe>
+int lookupCode(const std::string& feature, const std::vector<int>& codes, size_t value, Describe describe) {
+    int code = value < codes.size() ? codes[value] : -1;
+    if (code < 0 && !feature.empty()) {
+        LOG_WARN("[MLFireModel] Unknown category '{}' for feature '{}', using all zeros", describe(), feature);
+    }
+    return code;
+}
+}
+
+void MLFireModel::writePlannedFeatures(const Incident& incident, float* out) const {
+    constexpr auto numericCount = static_cast<size_t>(FeatureSource::NumericCount);
+    float numeric[numericCount] = {};
+
+    utils::CivilTime local = utils::TimeZone::local().toLocal(incident.reportTime);
+    int hour = local.hour;
+    int day_of_week = local.weekday;
+    int month = local.month;
+    numeric[static_cast<size_t>(FeatureSource::Hour)] = static_cast<float>(hour);
+    numeric[static_cast<size_t>(FeatureSource::DayOfWeek)] = static_cast<float>(day_of_week);
+    numeric[static_cast<size_t>(FeatureSource::Month)] = static_cast<float>(month);
+    numeric[static_cast<size_t>(FeatureSource::Quarter)] = static_cast<float>((month - 1) / 3 + 1);
+    numeric[static_cast<size_t>(FeatureSource::DayOfYear)] = static_cast<float>(local.yearDay + 1);
+    numeric[static_cast<size_t>(FeatureSource::IsWeekend)] = (day_of_week == 5 || day_of_week == 6) ? 1.0f : 0.0f;
+    numeric[static_cast<size_t>(FeatureSource::IsNight)] = (hour >= 22 || hour <= 6) ? 1.0f : 0.0f;
+    numeric[static_cast<size_t>(FeatureSource::IsRushHour)] =
+        ((hour >= 7 && hour <= 9) || (hour >= 16 && hour <= 18)) ? 1.0f : 0.0f;
+    numeric[static_cast<size_t>(FeatureSource::IsBusinessHours)] =
+        (hour >= 9 && hour <= 17 && day_of_week < 5) ? 1.0f : 0.0f;
+    numeric[static_cast<size_t>(FeatureSource::Lat)] = static_cast<float>(incident.lat);
+    numeric[static_cast<size_t>(FeatureSource::Lon)] = static_cast<float>(incident.lon);
+    double nashville_center_lat = 36.1627;
+    double nashville_center_lon = -86.7816;
+    numeric[static_cast<size_t>(FeatureSource::DistanceFromCenter)] = static_cast<float>(
+        calculateDistanceFromCenter(incident.lat, incident.lon, nashville_center_lat, nashville_center_lon));
+    if (buildings_ && plan_uses_buildings_) {
+        BuildingIndex::Summary nearby = buildings_->summarize(Location(incident.lat, incident.lon), building_radius_m_);
+        numeric[static_cast<size_t>(FeatureSource::BuildingCount)] = static_cast<float>(nearby.count);
+        numeric[static_cast<size_t>(FeatureSource::BuildingMaxLevels)] = static_cast<float>(nearby.maxLevels);
+        numeric[static_cast<size_t>(FeatureSource::NearestBuildingM)] = static_cast<float>(nearby.nearestMeters);
+    }
+
+    // Shift: Day, Evening, Night. Season: Winter, Spring, Summer, Fall.
+    size_t shift = (hour >= 6 && hour < 14) ? 0 : (hour >= 14 && hour < 22) ? 1 : 2;
+    size_t season = (month == 12 || month <= 2) ? 0 : month <= 5 ? 1 : month <= 8 ? 2 : 3;
+    size_t zone = incident.zoneIndex >= 0 ? static_cast<size_t>(incident.zoneIndex) : std::numeric_limits<size_t>::max();
+    int codes[5] = {
+        lookupCode(shift_codes_.name, shift_codes_.codes, shift, [&]() { return std::array{"Day", "Evening", "Night"}[shift]; }),
+        lookupCode(season_codes_.name, season_codes_.codes, season,
+                   [&]() { return std::array{"Winter", "Spring", "Summer", "Fall"}[season]; }),
+        lookupCode(category_codes_.name, category_codes_.codes, static_cast<size_t>(incident.category),
+                   [&]() { return to_string(incident.category); }),
+        incident.zoneIndex < 0 && !zone_codes_.name.empty() && zone_nan_code_ >= 0
+            ? zone_nan_code_
+            : lookupCode(zone_codes_.name, zone_codes_.codes, zone, [&]() {
+                  return incident.zoneIndex >= 0 ? std::to_string(incident.zoneIndex) + ".0" : std::string("nan");
+              }),
+        lookupCode(type_codes_.name, type_codes_.codes, static_cast<size_t>(incident.incident_type),
+                   [&]() { return to_string(incident.incident_type); }),
+    };
+
+    for (size_t i = 0; i < feature_plan_.size(); ++i) {
+        const FeatureSlot& slot = feature_plan_[i];
+        auto source = static_cast<size_t>(slot.source);
+        if (slot.source >= FeatureSource::BuildingCount && slot.source < FeatureSource::NumericCount && !buildings_) {
+            out[i] = 0.0f;  // without the building cache these features are absent
+        } else if (slot.source < FeatureSource::NumericCount) {
+            float value = numeric[source];
+            out[i] = slot.scaled ? static_cast<float>((value - slot.mean) / slot.scale) : value;
+        } else if (slot.source < FeatureSource::Zero) {
+            out[i] = codes[source - numericCount] == slot.oneHot ? 1.0f : 0.0f;
+        } else {
+            out[i] = 0.0f;
         }
-    } else {
-        LOG_ERROR("[MLFireModel] No feature order available, falling back to manual ordering");
-        // Fallback to the previous manual method if feature_order is not available
-        auto temporal_features = extractTemporalFeatures(incident);
-        auto geographic_features = extractGeographicFeatures(incident);
-        auto categorical_features = extractCategoricalFeatures(incident);
-        
-        all_features.insert(all_features.end(), temporal_features.begin(), temporal_features.end());
-        all_features.insert(all_features.end(), geographic_features.begin(), geographic_features.end());
-        all_features.insert(all_features.end(), categorical_features.begin(), categorical_features.end());
     }
-    
-    LOG_DEBUG("[MLFireModel] Extracted {} total features (expected: {})", 
-              all_features.size(), expected_input_features_);
-    
-    // Validate feature count
-    if (static_cast<int>(all_features.size()) != expected_input_features_) {
-        LOG_ERROR("[MLFireModel] Feature count mismatch! Got {}, expected {}", 
-                  all_features.size(), expected_input_features_);
+}
+
+void MLFireModel::extractFeatures(const Incident& incident, std::vector<float>& features) {
+    // 1. Use the feature plan compiled from the JSON feature order
+    if (!feature_order_.empty()) {
+        features.resize(feature_plan_.size());
+        writePlannedFeatures(incident, features.data());
+        return;
     }
+
+    LOG_ERROR("[MLFireModel] No feature order available, falling back to manual ordering");
+    // 2. Fallback to the previous manual method if feature_order is not available
+    features.clear();
+    auto temporal_features = extractTemporalFeatures(incident);
+    auto geographic_features = extractGeographicFeatures(incident);
+    auto categorical_features = extractCategoricalFeatures(incident);
     
-    return all_features;
+    features.insert(features.end(), temporal_features.begin(), temporal_features.end());
+    features.insert(features.end(), geographic_features.begin(), geographic_features.end());
+    features.insert(features.end(), categorical_features.begin(), categorical_features.end());
+    
+    LOG_DEBUG("[MLFireModel] Extracted {} total features (expected: {})", 
+              features.size(), expected_input_features_);
 }
 
 void MLFireModel::validateFeatureOrder() const {
@@ -1,11 +1,38 @@
 #include "models/onnx_predictor.h"
+#include "config/EnvLoader.h"
+#include "utils/error.h"
 #include "utils/logger.h"
+#include <algorithm>
 #include <cstring>
 
-ONNXPredictor::ONNXPredictor() {
+OnnxPredictorOptions OnnxPredictorOptions::fromEnv() {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    OnnxPredictorOptions options;
+    if (!env) return options;
+    std::string level = env->get("ONNX_GRAPH_OPTIMIZATION", "ALL");
+    if (level == "DISABLE") {
+        options.graphOptimization = ORT_DISABLE_ALL;
+    } else if (level == "BASIC") {
+        options.graphOptimization = ORT_ENABLE_BASIC;
+    } else if (level == "EXTENDED") {
+        options.graphOptimization = ORT_ENABLE_EXTENDED;
+    } else if (level == "ALL") {
+        options.graphOptimization = ORT_ENABLE_ALL;
+    } else {
+        throw InvalidValueError("Unknown ONNX_GRAPH_OPTIMIZATION: " + level);
+    }
+    options.intraOpThreads = std::max(0, std::stoi(env->get("ONNX_INTRA_OP_THREADS", "1")));
+    options.interOpThreads = std::max(0, std::stoi(env->get("ONNX_INTER_OP_THREADS", "0")));
+    return options;
+}
+
+ONNXPredictor::ONNXPredictor(const OnnxPredictorOptions& options)
+    : memory_info_(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
     env_ = std::make_unique<Ort::Env>(ORT_LOGGING_LEVEL_WARNING, "FireSimulator");
     session_options_ = std::make_unique<Ort::SessionOptions>();
-    session_options_->SetIntraOpNumThreads(1);
+    session_options_->SetIntraOpNumThreads(options.intraOpThreads);
+    session_options_->SetInterOpNumThreads(options.interOpThreads);
+    session_options_->SetGraphOptimizationLevel(options.graphOptimization);
 }
 
 ONNXPredictor::~ONNXPredictor() {
@@ -46,6 +73,8 @@ bool ONNXPredictor::loadModel(const std::string& model_path) {
             char* output_name_copy = new char[output_name_str.length() + 1];
             std::strcpy(output_name_copy, output_name_str.c_str());
             output_names_.push_back(output_name_copy);
+
+            output_dims_ = session_->GetOutputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
         }
         
         LOG_INFO("Loaded ONNX model: {}", model_path);
@@ -58,36 +87,98 @@ bool ONNXPredictor::loadModel(const std::string& model_path) {
     }
 }
 
-float ONNXPredictor::predict(const std::vector<float>& features) {
+std::unique_ptr<ONNXPredictor::Binding> ONNXPredictor::acquireBinding() {
+    {
+        std::lock_guard<std::mutex> lock(bindings_mutex_);
+        if (!bindings_.empty()) {
+            std::unique_ptr<Binding> binding = std::move(bindings_.back());
+            bindings_.pop_back();
+            return binding;
+        }
+    }
+    return std::make_unique<Binding>(*session_);
+}
+
+void ONNXPredictor::releaseBinding(std::unique_ptr<Binding> binding) {
+    std::lock_guard<std::mutex> lock(bindings_mutex_);
+    bindings_.push_back(std::move(binding));
+}
+
+void ONNXPredictor::bind(Binding& binding, size_t rows, size_t width) {
+    if (binding.rows == rows && binding.input.size() == rows * width) {
+        return;
+    }
+    // The output keeps the model's rank with the batch dimension set; other symbolic dimensions are 1.
+    std::vector<int64_t> output_shape = output_dims_.empty() ? std::vector<int64_t>{0, 1} : output_dims_;
+    output_shape[0] = static_cast<int64_t>(rows);
+    size_t output_count = 1;
+    for (int64_t& dim : output_shape) {
+        dim = std::max<int64_t>(dim, 1);
+        output_count *= static_cast<size_t>(dim);
+    }
+    std::vector<int64_t> input_shape = {static_cast<int64_t>(rows), static_cast<int64_t>(width)};
+
+    binding.input.assign(rows * width, 0.0f);
+    binding.output.assign(output_count, 0.0f);
+    binding.input_tensor = Ort::Value::CreateTensor<float>(
+        memory_info_, binding.input.data(), binding.input.size(), input_shape.data(), input_shape.size());
+    binding.output_tensor = Ort::Value::CreateTensor<float>(
+        memory_info_, binding.output.data(), binding.output.size(), output_shape.data(), output_shape.size());
+    binding.io.ClearBoundInputs();
+    binding.io.ClearBoundOutputs();
+    binding.io.BindInput(input_names_[0], binding.input_tensor);
+    binding.io.BindOutput(output_names_[0], binding.output_tensor);
+    binding.rows = rows;
+}
+
+bool ONNXPredictor::run(Binding& binding, const float* features, size_t rows, size_t width, float* predictions) {
     try {
-        // Prepare input tensor
-        std::vector<int64_t> input_shape = {1, static_cast<int64_t>(features.size())};
-        auto memory_info = Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault);
-        
-        Ort::Value input_tensor = Ort::Value::CreateTensor<float>(
-            memory_info, 
-            const_cast<float*>(features.data()), 
-            features.size(), 
-            input_shape.data(), 
-            input_shape.size()
-        );
-        
-        // Run inference
-        auto output_tensors = session_->Run(
-            Ort::RunOptions{nullptr},
-            input_names_.data(),
-            &input_tensor,
-            1,
-            output_names_.data(),
-            1
-        );
-        
-        // Extract result
-        float* output_data = output_tensors[0].GetTensorMutableData<float>();
-        return output_data[0];
-        
+        bind(binding, rows, width);
+        std::copy(features, features + rows * width, binding.input.begin());
+        session_->Run(Ort::RunOptions{nullptr}, binding.io);
+        // First output value of every row.
+        size_t stride = binding.output.size() / rows;
+        for (size_t row = 0; row < rows; ++row) {
+            predictions[row] = binding.output[row * stride];
+        }
+        return true;
     } catch (const std::exception& e) {
-        LOG_ERROR("ONNX prediction failed: {}", e.what());
+        binding.rows = 0;  // rebind from scratch next time
+        LOG_ERROR("ONNX prediction of {} rows failed: {}", rows, e.what());
+        return false;
+    }
+}
+
+float ONNXPredictor::predict(const std::vector<float>& features) {
+    if (!session_ || input_names_.empty() || output_names_.empty()) {
+        LOG_ERROR("ONNX prediction failed: no model loaded");
         return -1.0f;
     }
-}
\ No newline at end of file
+    float prediction = -1.0f;
+    std::unique_ptr<Binding> binding = acquireBinding();
+    run(*binding, features.data(), 1, features.size(), &prediction);
+    releaseBinding(std::move(binding));
+    return prediction;
+}
+
+bool ONNXPredictor::acceptsBatches() const {
+    // A symbolic or -1 leading dimension accepts any number of rows.
+    return !input_dims_.empty() && input_dims_[0] <= 0;
+}
+
+std::vector<float> ONNXPredictor::predictBatch(std::span<const float> features, size_t rows, size_t maxBatchRows) {
+    std::vector<float> predictions(rows, -1.0f);
+    if (rows == 0 || !session_ || input_names_.empty() || output_names_.empty()) {
+        return predictions;
+    }
+    const size_t width = features.size() / rows;
+    const size_t batchRows = acceptsBatches() ? std::max<size_t>(maxBatchRows, 1) : 1;
+
+    std::unique_ptr<Binding> binding = acquireBinding();
+    for (size_t first = 0; first < rows; first += batchRows) {
+        size_t count = std::min(batchRows, rows - first);
+        run(*binding, features.data() + first * width, count, width, predictions.data() + first);
+    }
+    releaseBinding(std::move(binding));
+    return predictions;
+}
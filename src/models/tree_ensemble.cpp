@@ -0,0 +1,394 @@
+#include "models/tree_ensemble.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <limits>
+#include <map>
+#include <sstream>
+#include "utils/error.h"
+#include "utils/logger.h"
+
+namespace {
+// Just enough of the protobuf wire format to walk an ONNX ModelProto.
+class ProtoReader {
+public:
+    explicit ProtoReader(std::string_view data) : data_(data) {}
+
+    bool next() {
+        if (done()) return false;
+        uint64_t tag = varint();
+        field_ = static_cast<uint32_t>(tag >> 3);
+        wire_ = static_cast<uint32_t>(tag & 7);
+        return true;
+    }
+    bool done() const noexcept { return pos_ >= data_.size(); }
+    uint32_t field() const noexcept { return field_; }
+    uint32_t wire() const noexcept { return wire_; }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            uint8_t byte = static_cast<uint8_t>(take(1)[0]);
+            value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0) return value;
+        }
+        throw InvalidValueError("ONNX model has a malformed varint");
+    }
+    float fixed32() {
+        float value;
+        std::memcpy(&value, take(4).data(), 4);
+        return value;
+    }
+    double fixed64() {
+        double value;
+        std::memcpy(&value, take(8).data(), 8);
+        return value;
+    }
+    std::string_view bytes() { return take(static_cast<size_t>(varint())); }
+
+    void skip() {
+        switch (wire_) {
+            case 0: varint(); break;
+            case 1: take(8); break;
+            case 2: bytes(); break;
+            case 5: take(4); break;
+            default: throw InvalidValueError("ONNX model has an unsupported wire type");
+        }
+    }
+
+private:
+    std::string_view data_;
+    size_t pos_ = 0;
+    uint32_t field_ = 0;
+    uint32_t wire_ = 0;
+
+    std::string_view take(size_t n) {
+        if (n > data_.size() - pos_) {
+            throw InvalidValueError("ONNX model is truncated");
+        }
+        std::string_view out = data_.substr(pos_, n);
+        pos_ += n;
+        return out;
+    }
+};
+
+// The AttributeProto fields the regressor uses; tensors are flattened into floats.
+struct Attribute {
+    int64_t i = 0;
+    std::string s;
+    std::vector<int64_t> ints;
+    std::vector<double> floats;
+    std::vector<std::string> strings;
+};
+
+void readInts(ProtoReader& in, std::vector<int64_t>& out) {
+    if (in.wire() == 2) {
+        ProtoReader packed(in.bytes());
+        while (!packed.done()) out.push_back(static_cast<int64_t>(packed.varint()));
+    } else {
+        out.push_back(static_cast<int64_t>(in.varint()));
+    }
+}
+
+template <typename T>
+void readFixed(ProtoReader& in, std::vector<double>& out) {
+    constexpr uint32_t wire = sizeof(T) == 4 ? 5 : 1;
+    auto one = [](ProtoReader& r) { return sizeof(T) == 4 ? static_cast<double>(r.fixed32()) : r.fixed64(); };
+    if (in.wire() == 2) {
+        ProtoReader packed(in.bytes());
+        while (!packed.done()) out.push_back(one(packed));
+    } else if (in.wire() == wire) {
+        out.push_back(one(in));
+    } else {
+        in.skip();
+    }
+}
+
+// TensorProto holding FLOAT (1) or DOUBLE (11) values, as float_data, double_data or raw_data.
+std::vector<double> readTensor(std::string_view message) {
+    constexpr int64_t FLOAT = 1, DOUBLE = 11;
+    int64_t type = 0;
+    std::string_view raw;
+    std::vector<double> values;
+    ProtoReader in(message);
+    while (in.next()) {
+        switch (in.field()) {
+            case 2: type = static_cast<int64_t>(in.varint()); break;
+            case 4: readFixed<float>(in, values); break;
+            case 9: raw = in.bytes(); break;
+            case 10: readFixed<double>(in, values); break;
+            default: in.skip();
+        }
+    }
+    if (type != FLOAT && type != DOUBLE) {
+        throw InvalidValueError("ONNX tree ensemble tensors must be float or double");
+    }
+    size_t width = type == FLOAT ? sizeof(float) : sizeof(double);
+    for (size_t offset = 0; offset + width <= raw.size(); offset += width) {
+        if (type == FLOAT) {
+            float value;
+            std::memcpy(&value, raw.data() + offset, sizeof(value));
+            values.push_back(value);
+        } else {
+            double value;
+            std::memcpy(&value, raw.data() + offset, sizeof(value));
+            values.push_back(value);
+        }
+    }
+    return values;
+}
+
+std::pair<std::string, Attribute> readAttribute(std::string_view message) {
+    std::string name;
+    Attribute attribute;
+    ProtoReader in(message);
+    while (in.next()) {
+        switch (in.field()) {
+            case 1: name = in.bytes(); break;
+            case 2: readFixed<float>(in, attribute.floats); break;
+            case 3: attribute.i = static_cast<int64_t>(in.varint()); break;
+            case 4: attribute.s = in.bytes(); break;
+            case 5: attribute.floats = readTensor(in.bytes()); break;
+            case 7: readFixed<float>(in, attribute.floats); break;
+            case 8: readInts(in, attribute.ints); break;
+            case 9: attribute.strings.emplace_back(in.bytes()); break;
+            default: in.skip();
+        }
+    }
+    return {name, attribute};
+}
+
+// Attributes of the first TreeEnsembleRegressor node in the model's graph.
+std::map<std::string, Attribute> findRegressor(std::string_view model) {
+    ProtoReader in(model);
+    while (in.next()) {
+        if (in.field() != 7 || in.wire() != 2) {  // ModelProto.graph
+            in.skip();
+            continue;
+        }
+        ProtoReader graph(in.bytes());
+        while (graph.next()) {
+            if (graph.field() != 1 || graph.wire() != 2) {  // GraphProto.node
+                graph.skip();
+                continue;
+            }
+            ProtoReader node(graph.bytes());
+            std::string op_type;
+            std::map<std::string, Attribute> attributes;
+            while (node.next()) {
+                if (node.field() == 4) {
+                    op_type = node.bytes();
+                } else if (node.field() == 5) {
+                    attributes.insert(readAttribute(node.bytes()));
+                } else {
+                    node.skip();
+                }
+            }
+            if (op_type == "TreeEnsembleRegressor") {
+                return attributes;
+            }
+            LOG_DEBUG("[TreeEnsemble] Skipping {} node", op_type);
+        }
+    }
+    throw InvalidValueError("ONNX model has no TreeEnsembleRegressor node");
+}
+
+// Largest float f with (double)x <= t exactly when x <= f, or x < t when strict, for every float x.
+float floatBelow(double t, bool strict) {
+    float f = static_cast<float>(t);
+    if (static_cast<double>(f) > t || (strict && static_cast<double>(f) == t)) {
+        f = std::nextafter(f, -std::numeric_limits<float>::infinity());
+    }
+    return f;
+}
+}
+
+TreeEnsemble TreeEnsemble::loadOnnx(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        throw InvalidValueError("Failed to open ONNX model: " + path);
+    }
+    std::ostringstream bytes;
+    bytes << file.rdbuf();
+    return fromOnnx(bytes.str());
+}
+
+TreeEnsemble TreeEnsemble::fromOnnx(std::string_view model) {
+    std::map<std::string, Attribute> attributes = findRegressor(model);
+    auto get = [&](const std::string& name) -> const Attribute& {
+        static const Attribute empty;
+        auto it = attributes.find(name);
+        return it != attributes.end() ? it->second : empty;
+    };
+    auto floatsOf = [&](const std::string& name) -> const std::vector<double>& {
+        const Attribute& direct = get(name);
+        return direct.floats.empty() ? get(name + "_as_tensor").floats : direct.floats;
+    };
+
+    const std::string aggregate = attributes.count("aggregate_function") ? get("aggregate_function").s : "SUM";
+    const std::string post_transform = attributes.count("post_transform") ? get("post_transform").s : "NONE";
+    const int64_t targets = attributes.count("n_targets") ? get("n_targets").i : 1;
+    if (aggregate != "SUM" && aggregate != "AVERAGE") {
+        throw InvalidValueError("Unsupported tree ensemble aggregate_function: " + aggregate);
+    }
+    if (post_transform != "NONE") {
+        throw InvalidValueError("Unsupported tree ensemble post_transform: " + post_transform);
+    }
+    if (targets != 1) {
+        throw InvalidValueError("Only single-target tree ensembles are supported");
+    }
+
+    const auto& tree_ids = get("nodes_treeids").ints;
+    const auto& node_ids = get("nodes_nodeids").ints;
+    const auto& feature_ids = get("nodes_featureids").ints;
+    const auto& modes = get("nodes_modes").strings;
+    const auto& true_ids = get("nodes_truenodeids").ints;
+    const auto& false_ids = get("nodes_falsenodeids").ints;
+    const auto& missing_true = get("nodes_missing_value_tracks_true").ints;
+    const auto& values = floatsOf("nodes_values");
+    const size_t n = tree_ids.size();
+    if (n == 0 || node_ids.size() != n || feature_ids.size() != n || modes.size() != n || true_ids.size() != n
+        || false_ids.size() != n || values.size() != n || (!missing_true.empty() && missing_true.size() != n)) {
+        throw InvalidValueError("Tree ensemble node attributes have mismatched lengths");
+    }
+
+    using Key = std::pair<int64_t, int64_t>;  // (tree id, node id)
+    std::map<Key, size_t> index;
+    std::map<int64_t, int64_t> roots;  // tree id -> smallest node id
+    for (size_t i = 0; i < n; ++i) {
+        if (!index.emplace(Key{tree_ids[i], node_ids[i]}, i).second) {
+            throw InvalidValueError("Tree ensemble repeats a node id");
+        }
+        auto [root, added] = roots.emplace(tree_ids[i], node_ids[i]);
+        if (!added) root->second = std::min(root->second, node_ids[i]);
+    }
+
+    const auto& target_trees = get("target_treeids").ints;
+    const auto& target_nodes = get("target_nodeids").ints;
+    const auto& target_ids = get("target_ids").ints;
+    const auto& weights = floatsOf("target_weights");
+    if (target_nodes.size() != target_trees.size() || weights.size() != target_trees.size()
+        || (!target_ids.empty() && target_ids.size() != target_trees.size())) {
+        throw InvalidValueError("Tree ensemble target attributes have mismatched lengths");
+    }
+    std::map<Key, float> leaf_values;
+    for (size_t i = 0; i < target_trees.size(); ++i) {
+        if (!target_ids.empty() && target_ids[i] != 0) {
+            throw InvalidValueError("Only single-target tree ensembles are supported");
+        }
+        leaf_values[Key{target_trees[i], target_nodes[i]}] += static_cast<float>(weights[i]);
+    }
+
+    TreeEnsemble ensemble;
+    ensemble.average_ = aggregate == "AVERAGE";
+    const auto& base_values = floatsOf("base_values");
+    ensemble.base_value_ = base_values.empty() ? 0.0f : static_cast<float>(base_values[0]);
+
+    // Lay every tree out breadth-first; a node's slot is fixed when it is queued.
+    std::vector<uint8_t> placed(n, 0);
+    for (const auto& [tree, root] : roots) {
+        std::deque<std::pair<size_t, uint32_t>> queue;  // (attribute index, depth)
+        auto place = [&](int64_t node_id, uint32_t depth) {
+            auto it = index.find(Key{tree, node_id});
+            if (it == index.end() || placed[it->second]) {
+                throw InvalidValueError("Tree ensemble tree " + std::to_string(tree) + " is not a tree");
+            }
+            placed[it->second] = 1;
+            queue.emplace_back(it->second, depth);
+            ensemble.nodes_.emplace_back();
+            return static_cast<uint32_t>(ensemble.nodes_.size() - 1);
+        };
+        ensemble.roots_.push_back(place(root, 0));
+        uint32_t depth = 0;
+        for (uint32_t slot = ensemble.roots_.back(); !queue.empty(); ++slot) {
+            auto [i, level] = queue.front();
+            queue.pop_front();
+            const std::string& mode = modes[i];
+            if (mode == "LEAF") {
+                auto leaf = leaf_values.find(Key{tree, node_ids[i]});
+                float value = leaf != leaf_values.end() ? leaf->second : 0.0f;
+                ensemble.nodes_[slot] = Node{0, value, slot, slot};
+                depth = std::max(depth, level);
+                continue;
+            }
+            // LT/LEQ go left on the true branch; GT/GTE are their negations with the branches swapped.
+            bool strict = mode == "BRANCH_LT" || mode == "BRANCH_GTE";
+            bool swapped = mode == "BRANCH_GT" || mode == "BRANCH_GTE";
+            if (!strict && !swapped && mode != "BRANCH_LEQ") {
+                throw InvalidValueError("Unsupported tree ensemble node mode: " + mode);
+            }
+            if (feature_ids[i] < 0 || feature_ids[i] >= static_cast<int64_t>(NAN_LEFT)) {
+                throw InvalidValueError("Tree ensemble has an invalid feature id");
+            }
+            bool nan_true = !missing_true.empty() && missing_true[i] != 0;
+            uint32_t true_slot = place(true_ids[i], level + 1);
+            uint32_t false_slot = place(false_ids[i], level + 1);
+            Node node;
+            node.feature = static_cast<uint32_t>(feature_ids[i]) | (nan_true != swapped ? NAN_LEFT : 0u);
+            node.threshold = floatBelow(values[i], strict);
+            node.left = swapped ? false_slot : true_slot;
+            node.right = swapped ? true_slot : false_slot;
+            ensemble.nodes_[slot] = node;
+            ensemble.feature_count_ = std::max(ensemble.feature_count_, static_cast<size_t>(feature_ids[i]) + 1);
+        }
+        ensemble.depths_.push_back(depth);
+    }
+    ensemble.feature_count_ = std::max<size_t>(ensemble.feature_count_, 1);  // leaves read feature 0
+
+    LOG_INFO("[TreeEnsemble] Imported {} trees, {} nodes, {} features", ensemble.treeCount(),
+             ensemble.nodeCount(), ensemble.featureCount());
+    return ensemble;
+}
+
+void TreeEnsemble::evaluateBlock(const float* rows, size_t width, size_t count, float* out) const {
+    float sums[BLOCK_ROWS] = {};
+    uint32_t at[BLOCK_ROWS];
+    const Node* nodes = nodes_.data();
+    for (size_t tree = 0; tree < roots_.size(); ++tree) {
+        std::fill_n(at, count, roots_[tree]);
+        for (uint32_t level = 0; level < depths_[tree]; ++level) {
+            for (size_t r = 0; r < count; ++r) {
+                const Node& node = nodes[at[r]];
+                float x = rows[r * width + (node.feature & ~NAN_LEFT)];
+                bool left = x <= node.threshold || (std::isnan(x) && (node.feature & NAN_LEFT));
+                at[r] = left ? node.left : node.right;
+            }
+        }
+        for (size_t r = 0; r < count; ++r) {
+            sums[r] += nodes[at[r]].threshold;
+        }
+    }
+    for (size_t r = 0; r < count; ++r) {
+        float score = average_ ? sums[r] / static_cast<float>(roots_.size()) : sums[r];
+        out[r] = score + base_value_;
+    }
+}
+
+float TreeEnsemble::predict(std::span<const float> features) const {
+    if (features.size() < feature_count_) {
+        throw InvalidValueError("Tree ensemble needs " + std::to_string(feature_count_) + " features, got "
+                                + std::to_string(features.size()));
+    }
+    float prediction = base_value_;
+    evaluateBlock(features.data(), features.size(), 1, &prediction);
+    return prediction;
+}
+
+std::vector<float> TreeEnsemble::predictBatch(std::span<const float> features, size_t rows) const {
+    std::vector<float> predictions(rows, 0.0f);
+    if (rows == 0) {
+        return predictions;
+    }
+    const size_t width = features.size() / rows;
+    if (width < feature_count_) {
+        throw InvalidValueError("Tree ensemble needs " + std::to_string(feature_count_) + " features, got "
+                                + std::to_string(width));
+    }
+    for (size_t first = 0; first < rows; first += BLOCK_ROWS) {
+        evaluateBlock(features.data() + first * width, width, std::min(BLOCK_ROWS, rows - first),
+                      predictions.data() + first);
+    }
+    return predictions;
+}
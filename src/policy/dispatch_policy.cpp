@@ -56,7 +56,8 @@ std::vector<int> DispatchPolicy::getSortedIndicesByDuration(const std::vector<do
     std::vector<int> indices(durations.size());
     std::iota(indices.begin(), indices.end(), 0);  // Fill with 0, 1, 2, ...
     
-    std::sort(indices.begin(), indices.end(), 
+    // Stable so ties keep station index order, matching StationOrderIndex.
+    std::stable_sort(indices.begin(), indices.end(), 
               [&durations](int a, int b) { 
                   return durations[a] < durations[b]; 
               });
@@ -65,29 +66,27 @@ std::vector<int> DispatchPolicy::getSortedIndicesByDuration(const std::vector<do
 }
 
 /*
-* @brief Extracts a specific column from a 2D matrix represented as a flat array.
- * @param matrix The flat array representing the matrix.
- * @param width The number of columns in the matrix.
- * @param height The number of rows in the matrix.
+* @brief Extracts a specific column from a station x incident matrix.
+ * @param matrix The in-memory or tiled matrix.
  * @param col_index The index of the column to extract.
  * @return A vector containing the values of the specified column.
  * @note col_index represent the incidents.
  * @note each row represents a station.
 */
-std::vector<double> DispatchPolicy::getColumn(double* matrix, int width, int height, int col_index) const {
-    std::vector<double> column;
-    column.reserve(height); // optional: preallocate memory for performance
-
-    // Use pointer arithmetic for better performance
-    double* col_ptr = matrix + col_index;
-    for (int row = 0; row < height; ++row) {
-        column.push_back(*col_ptr);
-        col_ptr += width;
-    }
-
+std::vector<double> DispatchPolicy::getColumn(const MatrixView& matrix, int col_index) const {
+    std::vector<double> column(matrix.height());
+    matrix.column(col_index, column.data());
     return column;
 }
 
+/*
+* @brief Extracts a specific column from a 2D matrix represented as a flat array.
+ * @param matrix The flat array representing the matrix.
+ * @param width The number of columns in the matrix.
+ * @param height The number of rows in the matrix.
+ * @param col_index The index of the column to extract.
+ * @return A vector containing the values of the specified column.
+*/
 std::vector<int> DispatchPolicy::getColumn(int* matrix, int width, int height, int col_index) const {
     std::vector<int> column;
     column.reserve(height); // optional: preallocate memory for performance
@@ -99,6 +98,50 @@ std::vector<int> DispatchPolicy::getColumn(int* matrix, int width, int height, i
     return column;
 }
 
+/**
+ * @brief Computes how many apparatus of each type the incident still needs.
+ * @param incident The incident being served.
+ * @return Map of apparatus type to outstanding count, only positive entries.
+ */
+std::unordered_map<ApparatusType, int> DispatchPolicy::getRemainingApparatusNeeded(const Incident& incident) const {
+    std::unordered_map<ApparatusType, int> remainingNeeded;
+    for (const auto &[type, required] : incident.requiredApparatusMap) {
+        int currentCount = 0;
+        auto currentIt = incident.currentApparatusMap.find(type);
+        if (currentIt != incident.currentApparatusMap.end()) {
+            currentCount = currentIt->second;
+        }
+
+        int remaining = required - currentCount;
+        if (remaining > 0) {
+            remainingNeeded[type] = remaining;
+        }
+    }
+    return remainingNeeded;
+}
+
+/**
+ * @brief Checks whether the given stations hold enough available apparatus for the incident.
+ * If they do, walking stationOrder in getAction_ never needs a station outside of it.
+ * @param incident The incident being served.
+ * @param state The current simulation state.
+ * @param stationOrder Candidate stations.
+ * @return true if every outstanding apparatus type can be covered by stationOrder.
+ */
+bool DispatchPolicy::canCoverFrom(const Incident& incident, const State& state,
+                                  const std::vector<int>& stationOrder) const {
+    const std::vector<Station>& stations = state.getAllStations();
+    for (const auto& [type, neededCount] : getRemainingApparatusNeeded(incident)) {
+        int available = 0;
+        for (int stationIndex : stationOrder) {
+            available += stations[stationIndex].getAvailableCount(type);
+            if (available >= neededCount) break;
+        }
+        if (available < neededCount) return false;
+    }
+    return true;
+}
+
 // TODO: This is basically the same code as in nearest_dispatch and firebeats_dispatch, only difference is the stationOrder passed in.
 std::vector<Action> DispatchPolicy::getAction_(const Incident &incident, const State &state,
                               const std::vector<int> &stationOrder,
@@ -118,19 +161,7 @@ std::vector<Action> DispatchPolicy::getAction_(const Incident &incident, const S
     }
 
     // Calculate remaining apparatus needed by type
-    std::unordered_map<ApparatusType, int> remainingNeeded;
-    for (const auto &[type, required] : requiredApparatusMap) {
-        int currentCount = 0;
-        auto currentIt = incident.currentApparatusMap.find(type);
-        if (currentIt != incident.currentApparatusMap.end()) {
-            currentCount = currentIt->second;
-        }
-
-        int remaining = required - currentCount;
-        if (remaining > 0) {
-            remainingNeeded[type] = remaining;
-        }
-    }
+    std::unordered_map<ApparatusType, int> remainingNeeded = getRemainingApparatusNeeded(incident);
 
     time_t incidentResolutionTime = incident.resolvedTime;
     const std::vector<Station> &validStations = state.getAllStations();
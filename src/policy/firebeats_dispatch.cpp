@@ -12,13 +12,16 @@
 FireBeatsDispatch::FireBeatsDispatch(const std::string& distanceMatrixPath, 
                                      const std::string& durationMatrixPath,
                                      const std::string& fireBeatsMatrixPath,
-                                     const std::string& zoneIDToNameMapPath)
-    : distanceMatrix_(nullptr), durationMatrix_(nullptr), fireBeatsMatrix_(nullptr) {
+                                     const std::string& zoneIDToNameMapPath,
+                                     size_t matrixCacheTiles)
+    : fireBeatsMatrix_(nullptr) {
         // Validate the URL
         std::ifstream file(distanceMatrixPath);
         if (file) {
-            distanceMatrix_ = load_matrix_binary_flat(distanceMatrixPath, height_, width_);
-            durationMatrix_ = load_matrix_binary_flat(durationMatrixPath, height_, width_);
+            distanceMatrix_ = openMatrix(distanceMatrixPath, matrixCacheTiles);
+            durationMatrix_ = openMatrix(durationMatrixPath, matrixCacheTiles);
+            width_ = durationMatrix_->width();
+            height_ = durationMatrix_->height();
         } else {
             LOG_ERROR("File does not exist, defaulting to using OSRM Table API.");
             throw std::runtime_error("Distance matrix file not found: " + distanceMatrixPath);
@@ -37,11 +40,13 @@ FireBeatsDispatch::FireBeatsDispatch(const std::string& distanceMatrixPath,
     }
 
 FireBeatsDispatch::~FireBeatsDispatch() {
-    delete[] durationMatrix_; // Clean up the matrix if it was allocated
-    delete[] distanceMatrix_; // Clean up the matrix if it was allocated
     delete[] fireBeatsMatrix_; // Clean up the fire beats data if it was allocated
 }
 
+void FireBeatsDispatch::setIncidentOrder(const std::vector<int>& incidentIndices) {
+    durationMatrix_->setAccessPlan(incidentIndices);
+}
+
 // Relies on the preprocessed bin, if its not correct then the key suddenly has the string "Station", that means it failed.
 /*
 Essentially reading a row: run(station) x col: zones(beats) matrix.
@@ -109,8 +114,7 @@ std::vector<Action> FireBeatsDispatch::getAction(const State& state) {
     const Incident& incident = state.getActiveIncidentsConst().at(incidentIndex);
     
     // If matrix is loaded, use it instead of OSRM
-    std::vector<double> durations = getColumn(durationMatrix_, width_, height_, incidentIndex);
-    std::vector<double> distances = getColumn(distanceMatrix_, width_, height_, incidentIndex);
+    std::vector<double> durations = getColumn(*durationMatrix_, incidentIndex);
     
     int zoneIndex = incident.zoneIndex;
     // Check if the zone index is valid
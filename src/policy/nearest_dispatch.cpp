@@ -7,22 +7,48 @@
 #include "utils/helpers.h"
 
 // TODO: This will become confusing, stationID and index are different.
-NearestDispatch::NearestDispatch(const std::string& distanceMatrixPath, const std::string& durationMatrixPath)
-    : distanceMatrix_(nullptr), durationMatrix_(nullptr) {
+NearestDispatch::NearestDispatch(const std::string& distanceMatrixPath,
+                                 const std::string& durationMatrixPath,
+                                 const std::string& stationOrderPath,
+                                 int stationOrderTopK,
+                                 size_t matrixCacheTiles,
+                                 const std::string& travelTimeOraclePath) {
         // Validate the URL
         std::ifstream file(distanceMatrixPath);
         if (file) {
-            distanceMatrix_ = load_matrix_binary_flat(distanceMatrixPath, height_, width_);
-            durationMatrix_ = load_matrix_binary_flat(durationMatrixPath, height_, width_);
+            distanceMatrix_ = openMatrix(distanceMatrixPath, matrixCacheTiles);
+            durationMatrix_ = openMatrix(durationMatrixPath, matrixCacheTiles);
+            width_ = durationMatrix_->width();
+            height_ = durationMatrix_->height();
         } else {
             LOG_ERROR("File does not exist, defaulting to using OSRM Table API.");
             throw std::runtime_error("Distance matrix file not found: " + distanceMatrixPath);
         }
+
+        // Reuse the persisted index only if it was built for this matrix.
+        bool loaded = !stationOrderPath.empty() && stationOrder_.load(stationOrderPath);
+        if (loaded && (stationOrder_.width() != width_ || stationOrder_.height() != height_)) {
+            LOG_WARN("Station order {} does not match the duration matrix, rebuilding.", stationOrderPath);
+            loaded = false;
+        }
+        if (!loaded) {
+            stationOrder_ = StationOrderIndex(*durationMatrix_, stationOrderTopK);
+        }
+        LOG_INFO("Station order index ready with top {} stations for {} incidents.", stationOrder_.k(), stationOrder_.width());
+
+        if (!travelTimeOraclePath.empty() && travelTimeOracle_.load(travelTimeOraclePath)) {
+            if (travelTimeOracle_.stations() != height_) {
+                LOG_WARN("Travel time oracle {} has {} stations, matrix has {}. Ignoring it.",
+                         travelTimeOraclePath, travelTimeOracle_.stations(), height_);
+                travelTimeOracle_ = TravelTimeOracle();
+            } else {
+                LOG_INFO("Travel time oracle loaded with {} cells.", travelTimeOracle_.grid().cellCount());
+            }
+        }
     }
 
-NearestDispatch::~NearestDispatch() {
-    delete[] durationMatrix_; // Clean up the matrix if it was allocated
-    delete[] distanceMatrix_; // Clean up the matrix if it was allocated
+void NearestDispatch::setIncidentOrder(const std::vector<int>& incidentIndices) {
+    durationMatrix_->setAccessPlan(incidentIndices);
 }
 
 // TODO: This is very similar to firebeats except for a couple of lines.
@@ -52,13 +78,25 @@ std::vector<Action> NearestDispatch::getAction(const State& state) {
     }
 
     const Incident& incident = state.getActiveIncidentsConst().at(incidentIndex);
+    if (incidentIndex >= width_) {
+        return getActionFromOracle(incident, state);
+    }
 
-    // If matrix is loaded, use it instead of OSRM
-    std::vector<double> durations = getColumn(durationMatrix_, width_, height_, incidentIndex);
-    std::vector<double> distances = getColumn(distanceMatrix_, width_, height_, incidentIndex);
-    
-    // int nearestStationIndex = findMinIndex(durations);
-    std::vector<int> sortedIndices = getSortedIndicesByDuration(durations);
+    // Walk the precomputed top-K list; durations outside of it are never read.
+    int k = stationOrder_.k();
+    const int32_t* nearest = stationOrder_.stations(incidentIndex);
+    const double* nearestDurations = stationOrder_.durations(incidentIndex);
+    std::vector<int> sortedIndices(nearest, nearest + k);
+    std::vector<double> durations(height_, 0.0);
+    for (int i = 0; i < k; ++i) {
+        durations[nearest[i]] = nearestDurations[i];
+    }
+
+    // Fall back to the full order only when the top-K stations cannot cover the request.
+    if (k < height_ && !canCoverFrom(incident, state, sortedIndices)) {
+        durations = getColumn(*durationMatrix_, incidentIndex);
+        sortedIndices = getSortedIndicesByDuration(durations);
+    }
 
     if (sortedIndices.empty()) {
         LOG_WARN("No valid stations found or all durations are infinite.");
@@ -66,3 +104,19 @@ std::vector<Action> NearestDispatch::getAction(const State& state) {
     
     return getAction_(incident, state, sortedIndices, durations);
 }
+
+/**
+ * @brief Dispatches an incident that has no matrix column using the grid oracle.
+ * @throws InvalidIncidentError if no oracle is loaded or the incident is outside its grid.
+ */
+std::vector<Action> NearestDispatch::getActionFromOracle(const Incident& incident, const State& state) {
+    const double* cellDurations = travelTimeOracle_.durations(incident.getLocation());
+    if (cellDurations == nullptr) {
+        LOG_ERROR("Incident {} is not in the duration matrix and not covered by a travel time oracle.", incident.incident_id);
+        throw InvalidIncidentError("No travel times for incident: " + std::to_string(incident.incident_id));
+    }
+
+    std::vector<double> durations(cellDurations, cellDurations + height_);
+    std::vector<int> sortedIndices = getSortedIndicesByDuration(durations);
+    return getAction_(incident, state, sortedIndices, durations);
+}
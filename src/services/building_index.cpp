@@ -0,0 +1,312 @@
+#include "services/building_index.h"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include "services/osrm_fetcher.h"
+#include "utils/constants.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+constexpr char MAGIC[4] = {'F', 'S', 'B', 'D'};
+constexpr uint32_t VERSION = 1;
+constexpr double METERS_PER_DEGREE = constants::EARTH_RADIUS_KM * 1000.0 * M_PI / 180.0;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t zoom;
+    uint32_t tileCount;
+    uint64_t buildingCount;
+    uint32_t typeCount;
+    uint32_t reserved;
+};
+
+struct BuildingRecord {
+    double lat;
+    double lon;
+    int64_t id;
+    int32_t levels;
+    uint32_t type;  // index into the type table
+};
+
+double greatCircleMeters(const Location& a, const Location& b) {
+    const double toRad = M_PI / 180.0;
+    double dlat = (b.lat - a.lat) * toRad;
+    double dlon = (b.lon - a.lon) * toRad;
+    double h = std::sin(dlat / 2) * std::sin(dlat / 2)
+             + std::cos(a.lat * toRad) * std::cos(b.lat * toRad) * std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 2.0 * constants::EARTH_RADIUS_KM * 1000.0 * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+// Degrees spanned by radiusMeters around center, {dLat, dLon}.
+std::pair<double, double> degreeRadius(const Location& center, double radiusMeters) {
+    double dLat = radiusMeters / METERS_PER_DEGREE;
+    double dLon = dLat / std::max(1e-6, std::cos(center.lat * M_PI / 180.0));
+    return {dLat, dLon};
+}
+
+std::string percentEncode(const std::string& text) {
+    std::string out;
+    for (unsigned char c : text) {
+        if (std::isalnum(c) || c == '-' || c == '_' || c == '.' || c == '~') {
+            out += static_cast<char>(c);
+        } else {
+            out += fmt::format("%{:02X}", c);
+        }
+    }
+    return out;
+}
+
+std::string tileQuery(const std::pair<Location, Location>& bounds) {
+    std::string bbox = fmt::format("({:.7f},{:.7f},{:.7f},{:.7f})",
+                                   bounds.first.lat, bounds.first.lon, bounds.second.lat, bounds.second.lon);
+    return "[out:json][timeout:90];(node[\"building\"]" + bbox + ";way[\"building\"]" + bbox
+         + ";relation[\"building\"]" + bbox + ";);out center;";
+}
+}
+
+std::vector<Building> parseOverpassBuildings(const std::string& response) {
+    std::vector<Building> buildings;
+    json parsed = json::parse(response, nullptr, false);
+    if (parsed.is_discarded() || !parsed.contains("elements")) {
+        LOG_WARN("Overpass response has no elements");
+        return buildings;
+    }
+
+    for (const auto& element : parsed["elements"]) {
+        const json* position = element.contains("center") ? &element["center"] : &element;
+        if (!position->contains("lat") || !position->contains("lon") || !element.contains("tags")) continue;
+        const json& tags = element["tags"];
+        if (!tags.contains("building")) continue;
+
+        Building building;
+        building.id = element.value("id", int64_t{0});
+        building.location = Location((*position)["lat"].get<double>(), (*position)["lon"].get<double>());
+        building.type = tags["building"].get<std::string>();
+        if (tags.contains("building:levels")) {
+            // "3", "2.5", "3;4": leading integer part, anything else counts as one level.
+            try {
+                building.levels = std::max(1, std::stoi(tags["building:levels"].get<std::string>()));
+            } catch (const std::exception&) {
+                building.levels = 1;
+            }
+        }
+        buildings.push_back(std::move(building));
+    }
+    LOG_DEBUG("Parsed {} buildings from {} Overpass elements", buildings.size(), parsed["elements"].size());
+    return buildings;
+}
+
+BuildingIndex::Tile BuildingIndex::tileOf(const Location& location, int zoom) {
+    const double n = std::ldexp(1.0, zoom);
+    double latRad = std::clamp(location.lat, -85.0511, 85.0511) * M_PI / 180.0;
+    double x = (location.lon + 180.0) / 360.0 * n;
+    double y = (1.0 - std::asinh(std::tan(latRad)) / M_PI) / 2.0 * n;
+    auto clampTile = [n](double v) { return static_cast<uint32_t>(std::clamp(std::floor(v), 0.0, n - 1.0)); };
+    return {clampTile(x), clampTile(y)};
+}
+
+std::pair<Location, Location> BuildingIndex::tileBounds(const Tile& tile, int zoom) {
+    const double n = std::ldexp(1.0, zoom);
+    auto lonOf = [n](double x) { return x / n * 360.0 - 180.0; };
+    auto latOf = [n](double y) { return std::atan(std::sinh(M_PI * (1.0 - 2.0 * y / n))) * 180.0 / M_PI; };
+    return {Location(latOf(tile.second + 1.0), lonOf(tile.first)),
+            Location(latOf(tile.second), lonOf(tile.first + 1.0))};
+}
+
+std::vector<BuildingIndex::Tile> BuildingIndex::missingTiles(const std::vector<Location>& locations,
+                                                             double radiusMeters) const {
+    std::set<Tile> missing;
+    for (const auto& location : locations) {
+        auto [dLat, dLon] = degreeRadius(location, radiusMeters);
+        Tile low = tileOf(Location(location.lat - dLat, location.lon - dLon), zoom_);
+        Tile high = tileOf(Location(location.lat + dLat, location.lon + dLon), zoom_);
+        // Tile y grows southwards.
+        for (uint32_t x = low.first; x <= high.first; ++x) {
+            for (uint32_t y = high.second; y <= low.second; ++y) {
+                if (!covers({x, y})) missing.insert({x, y});
+            }
+        }
+    }
+    return {missing.begin(), missing.end()};
+}
+
+void BuildingIndex::addTile(const Tile& tile, const std::vector<Building>& buildings) {
+    if (!tiles_.insert(tile).second) return;
+    for (const auto& building : buildings) {
+        // Ways crossing the edge come back for both tiles, keep the one holding the center.
+        if (tileOf(building.location, zoom_) != tile) continue;
+        rtree_.insert({Point(building.location.lon, building.location.lat), static_cast<uint32_t>(buildings_.size())});
+        buildings_.push_back(building);
+    }
+}
+
+template <typename Visit>
+void BuildingIndex::visitWithin(const Location& center, double radiusMeters, Visit&& visit) const {
+    auto [dLat, dLon] = degreeRadius(center, radiusMeters);
+    Box box(Point(center.lon - dLon, center.lat - dLat), Point(center.lon + dLon, center.lat + dLat));
+    for (auto it = rtree_.qbegin(bgi::intersects(box)); it != rtree_.qend(); ++it) {
+        const Building& building = buildings_[it->second];
+        double meters = greatCircleMeters(center, building.location);
+        if (meters <= radiusMeters) visit(building, meters);
+    }
+}
+
+std::vector<Building> BuildingIndex::within(const Location& center, double radiusMeters) const {
+    std::vector<Building> found;
+    visitWithin(center, radiusMeters, [&](const Building& building, double) { found.push_back(building); });
+    return found;
+}
+
+BuildingIndex::Summary BuildingIndex::summarize(const Location& center, double radiusMeters) const {
+    Summary summary;
+    summary.nearestMeters = radiusMeters;
+    visitWithin(center, radiusMeters, [&](const Building& building, double meters) {
+        ++summary.count;
+        summary.maxLevels = std::max(summary.maxLevels, building.levels);
+        summary.nearestMeters = std::min(summary.nearestMeters, meters);
+    });
+    return summary;
+}
+
+bool BuildingIndex::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        LOG_ERROR("Cannot write building cache {}", path);
+        return false;
+    }
+
+    std::vector<std::string> types;
+    std::unordered_map<std::string, uint32_t> typeIndex;
+    std::vector<BuildingRecord> records;
+    records.reserve(buildings_.size());
+    for (const auto& building : buildings_) {
+        auto [it, inserted] = typeIndex.try_emplace(building.type, static_cast<uint32_t>(types.size()));
+        if (inserted) types.push_back(building.type);
+        records.push_back({building.location.lat, building.location.lon, building.id, building.levels, it->second});
+    }
+
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.zoom = static_cast<uint32_t>(zoom_);
+    header.tileCount = static_cast<uint32_t>(tiles_.size());
+    header.buildingCount = records.size();
+    header.typeCount = static_cast<uint32_t>(types.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (const auto& [x, y] : tiles_) {
+        uint32_t xy[2] = {x, y};
+        out.write(reinterpret_cast<const char*>(xy), sizeof(xy));
+    }
+    for (const auto& type : types) {
+        uint32_t length = static_cast<uint32_t>(type.size());
+        out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+        out.write(type.data(), length);
+    }
+    out.write(reinterpret_cast<const char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(BuildingRecord)));
+    return static_cast<bool>(out);
+}
+
+BuildingIndex BuildingIndex::load(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    FileHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION) {
+        throw InvalidValueError("Not a building cache: " + path);
+    }
+
+    BuildingIndex index(static_cast<int>(header.zoom));
+    for (uint32_t t = 0; t < header.tileCount; ++t) {
+        uint32_t xy[2];
+        if (!in.read(reinterpret_cast<char*>(xy), sizeof(xy))) throw InvalidValueError("Truncated building cache: " + path);
+        index.tiles_.insert({xy[0], xy[1]});
+    }
+    std::vector<std::string> types(header.typeCount);
+    for (auto& type : types) {
+        uint32_t length = 0;
+        if (!in.read(reinterpret_cast<char*>(&length), sizeof(length))) throw InvalidValueError("Truncated building cache: " + path);
+        type.resize(length);
+        if (!in.read(type.data(), length)) throw InvalidValueError("Truncated building cache: " + path);
+    }
+    std::vector<BuildingRecord> records(header.buildingCount);
+    if (!in.read(reinterpret_cast<char*>(records.data()), static_cast<std::streamsize>(records.size() * sizeof(BuildingRecord)))) {
+        throw InvalidValueError("Truncated building cache: " + path);
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(records.size());
+    index.buildings_.reserve(records.size());
+    for (const auto& record : records) {
+        if (record.type >= types.size()) throw InvalidValueError("Corrupt building cache: " + path);
+        entries.emplace_back(Point(record.lon, record.lat), static_cast<uint32_t>(index.buildings_.size()));
+        index.buildings_.push_back({record.id, Location(record.lat, record.lon), record.levels, types[record.type]});
+    }
+    // Range construction bulk-loads (packs) the tree.
+    index.rtree_ = bgi::rtree<Entry, bgi::quadratic<16>>(entries.begin(), entries.end());
+    return index;
+}
+
+BuildingIndex BuildingIndex::openOrFetch(const std::string& path,
+                                         const std::vector<Location>& locations,
+                                         double radiusMeters,
+                                         const std::string& overpassUrl,
+                                         int zoom) {
+    BuildingIndex index(zoom);
+    std::ifstream probe(path, std::ios::binary);
+    if (probe.good()) {
+        probe.close();
+        try {
+            BuildingIndex loaded = load(path);
+            if (loaded.zoom() == zoom) {
+                index = std::move(loaded);
+            } else {
+                LOG_WARN("Building cache {} uses zoom {}, refetching at zoom {}", path, loaded.zoom(), zoom);
+            }
+        } catch (const InvalidValueError& e) {
+            LOG_WARN("{}, refetching buildings", e.what());
+        }
+    }
+
+    std::vector<Tile> missing = index.missingTiles(locations, radiusMeters);
+    if (missing.empty()) {
+        LOG_INFO("Building cache {} covers all {} locations ({} buildings).", path, locations.size(), index.size());
+        return index;
+    }
+
+    std::vector<std::string> urls;
+    for (const auto& tile : missing) {
+        urls.push_back(overpassUrl + "?data=" + percentEncode(tileQuery(tileBounds(tile, zoom))));
+    }
+    // Public Overpass instances allow about two concurrent slots per client.
+    OsrmFetchOptions options = OsrmFetchOptions::fromEnv();
+    options.maxInFlight = std::min<size_t>(options.maxInFlight, 2);
+    options.timeoutMs = std::max(options.timeoutMs, 120000L);
+
+    size_t fetched = 0;
+    try {
+        OsrmFetcher fetcher(options);
+        fetcher.fetchAll(urls, [&](size_t i, const std::string& body) {
+            index.addTile(missing[i], parseOverpassBuildings(body));
+            ++fetched;
+        }, [&](size_t i, long status, const std::string&) {
+            LOG_WARN("Overpass rejected tile {}/{} with status {}", missing[i].first, missing[i].second, status);
+        });
+    } catch (const OSRMError& e) {
+        LOG_WARN("Building download stopped: {}", e.what());
+    }
+
+    LOG_INFO("Fetched {} of {} building tiles, {} buildings cached.", fetched, missing.size(), index.size());
+    if (fetched > 0) {
+        index.save(path);
+    }
+    return index;
+}
@@ -1,10 +1,15 @@
 #include <services/chunks.h>
 #include <fstream>
+#include <algorithm>
 #include <iomanip>
 #include "data/location.h"
 #include "config/EnvLoader.h"
 #include "utils/error.h"
 #include "utils/logger.h"
+#include "services/osrm_fetcher.h"
+#include "services/osrm_table_parser.h"
+#include "services/table_planner.h"
+#include "services/building_index.h"
 
 // libcurl write callback
 size_t WriteCallback(void* contents, size_t size, size_t nmemb, std::string* output) {
@@ -32,107 +37,118 @@ std::string fetch_osrm_response(const std::string& full_url) {
     return response;
 }
 
-// Generate OSRM table queries: all sources with destination chunks
-std::pair<std::vector<std::vector<double>>, std::vector<std::vector<double>>> generate_osrm_table_chunks(
+// Table URL for one tile; indices refer to the tile's own coordinate list (sources first).
+static std::string table_url(const std::string& prefix,
+                             const TableTile& tile,
+                             const UniqueCoordinates& sources,
+                             const UniqueCoordinates& destinations) {
+    std::ostringstream coords_param, sources_param, destinations_param;
+    for (size_t s = tile.sourceBegin; s < tile.sourceEnd; ++s) {
+        coords_param << sources.coordinates[s] << ";";
+        sources_param << (s - tile.sourceBegin) << (s + 1 < tile.sourceEnd ? ";" : "");
+    }
+    for (size_t d = tile.destinationBegin; d < tile.destinationEnd; ++d) {
+        coords_param << destinations.coordinates[d] << (d + 1 < tile.destinationEnd ? ";" : "");
+        destinations_param << (tile.sources() + d - tile.destinationBegin) << (d + 1 < tile.destinationEnd ? ";" : "");
+    }
+    return prefix + coords_param.str() +
+        "?sources=" + sources_param.str() +
+        "&destinations=" + destinations_param.str() +
+        "&annotations=duration,distance";
+}
+
+// Generate OSRM table queries: sources x destinations tiles planned by TablePlanner
+std::pair<FlatMatrix, FlatMatrix> generate_osrm_table_chunks(
     const std::vector<Location>& sources,
     const std::vector<Location>& destinations,
     size_t chunk_size
 ) {
     const std::string base_url = EnvLoader::getInstance()->get("BASE_OSRM_URL", "http://localhost:8080");
-    size_t num_sources = sources.size();
-    size_t num_destinations = destinations.size();
-
-    // Initialize final durations matrix [sources][destinations]
-    std::vector<std::vector<double>> full_distance_matrix(num_sources, std::vector<double>(num_destinations, -1.0));
-    std::vector<std::vector<double>> full_duration_matrix(num_sources, std::vector<double>(num_destinations, -1.0));
-
-    // Precompute source strings
-    std::vector<std::string> source_strs;
-    for (const auto& s : sources) source_strs.push_back(locationToString(s));
-
-    for (size_t i = 0; i < destinations.size(); i += chunk_size) {
-        std::vector<std::string> all_coords = source_strs;
-        std::vector<std::string> chunk_strs;
-        std::vector<size_t> dest_indices;
-
-        // Build destination chunk
-        for (size_t j = i; j < std::min(i + chunk_size, destinations.size()); ++j) {
-            chunk_strs.push_back(locationToString(destinations[j]));
-            all_coords.push_back(chunk_strs.back());
-            dest_indices.push_back(sources.size() + (j - i));
-        }
+    const std::string prefix = base_url + "/table/v1/driving/";
+
+    // Duplicate locations (repeat incident addresses) are routed once.
+    UniqueCoordinates unique_sources = UniqueCoordinates::from(sources);
+    UniqueCoordinates unique_destinations = UniqueCoordinates::from(destinations);
+    size_t num_sources = unique_sources.coordinates.size();
+    size_t num_destinations = unique_destinations.coordinates.size();
+    if (num_sources < sources.size() || num_destinations < destinations.size()) {
+        LOG_INFO("Routing {} unique sources and {} unique destinations ({} and {} locations).",
+                 num_sources, num_destinations, sources.size(), destinations.size());
+    }
 
-        // Build coordinates string
-        std::ostringstream coords_param;
-        for (size_t k = 0; k < all_coords.size(); ++k) {
-            coords_param << all_coords[k];
-            if (k < all_coords.size() - 1)
-                coords_param << ";";
-        }
+    // Rows = unique sources, cols = unique destinations
+    FlatMatrix distance_matrix(static_cast<int>(num_destinations), static_cast<int>(num_sources), -1.0);
+    FlatMatrix duration_matrix(static_cast<int>(num_destinations), static_cast<int>(num_sources), -1.0);
 
-        // Sources: 0..num_sources-1
-        std::ostringstream sources_param;
-        for (size_t s = 0; s < num_sources; ++s)
-            sources_param << s << (s < num_sources - 1 ? ";" : "");
-
-        // Destinations: indices after sources
-        std::ostringstream destinations_param;
-        for (size_t d = 0; d < dest_indices.size(); ++d)
-            destinations_param << dest_indices[d] << (d < dest_indices.size() - 1 ? ";" : "");
-
-        // Build URL
-        std::string full_url = base_url + "/table/v1/driving/" + coords_param.str() +
-            "?sources=" + sources_param.str() +
-            "&destinations=" + destinations_param.str() +
-            "&annotations=duration,distance";
-
-        // Fetch and parse JSON
-        std::string response = fetch_osrm_response(full_url);
-        auto json_resp = json::parse(response);
-
-        if (json_resp["code"] != "Ok") {
-            std::cerr << "OSRM error: " << json_resp["code"] << "\n";
-            continue;
-        }
-        
-        auto durations = json_resp["durations"];
-
-        // Fill values into full_matrix
-        for (size_t row = 0; row < durations.size(); ++row) {
-            for (size_t col = 0; col < durations[row].size(); ++col) {
-                size_t dst_index = i + col;
-                if (durations[row][col].is_null()) {
-                    full_distance_matrix[row][dst_index] = -1.0; // Unreachable
-                    throw OSRMError(
-                        fmt::format("Unreachable route from source {} to destination {}",
-                                    row, dst_index));
-                } else {
-                    full_duration_matrix[row][dst_index] = durations[row][col].get<double>();
-                }
-            }
+    TablePlannerOptions planner_options = TablePlannerOptions::fromEnv();
+    if (chunk_size > 0) {
+        planner_options.initialDestinations = chunk_size;
+    }
+    size_t coordinate_length = 0;
+    for (const auto& c : unique_sources.coordinates) coordinate_length = std::max(coordinate_length, c.size());
+    for (const auto& c : unique_destinations.coordinates) coordinate_length = std::max(coordinate_length, c.size());
+    size_t url_overhead = prefix.size() + std::string("?sources=&destinations=&annotations=duration,distance").size();
+    size_t coordinate_limit = std::min(planner_options.maxCoordinates,
+        TablePlanner::urlCoordinateLimit(planner_options.maxUrlLength, url_overhead, coordinate_length));
+    TablePlanner planner(num_sources, num_destinations, coordinate_limit, planner_options);
+
+    OsrmFetchOptions fetch_options = OsrmFetchOptions::fromEnv();
+    OsrmFetcher fetcher(fetch_options);
+    size_t requests = 0;
+    while (!planner.done()) {
+        // A wave keeps every connection busy twice before the budget is revisited.
+        std::vector<TableTile> wave = planner.nextWave(fetch_options.maxInFlight * 2);
+        std::vector<std::string> urls;
+        urls.reserve(wave.size());
+        for (const auto& tile : wave) {
+            urls.push_back(table_url(prefix, tile, unique_sources, unique_destinations));
         }
 
-        auto distances = json_resp["distances"];
-
-        // Fill values into full_matrix
-        for (size_t row = 0; row < distances.size(); ++row) {
-            for (size_t col = 0; col < distances[row].size(); ++col) {
-                size_t dst_index = i + col;
-                if (distances[row][col].is_null()) {
-                    full_distance_matrix[row][dst_index] = -1.0; // Unreachable
-                    throw OSRMError(
-                        fmt::format("Unreachable route from source {} to destination {}",
-                                    row, dst_index));
-                } else {
-                    full_distance_matrix[row][dst_index] = distances[row][col].get<double>();
-                }
+        std::vector<bool> filled(wave.size(), false);
+        bool rejected = false;
+        fetcher.fetchAll(urls, [&](size_t index, const std::string& response) {
+            const TableTile& tile = wave[index];
+            // Streams values into the matrices, no JSON DOM per chunk.
+            filled[index] = parseOsrmTableResponse(response, distance_matrix, duration_matrix,
+                                                   tile.destinationBegin, tile.sourceBegin);
+            rejected |= !filled[index];
+        }, [&](size_t index, long status, const std::string& response) {
+            // TooBig, URI too long, ...: the rest of the wave still lands.
+            LOG_WARN("OSRM rejected a {}x{} table request (HTTP {}): {}",
+                     wave[index].sources(), wave[index].destinations(), status, response);
+            rejected = true;
+        });
+        requests += wave.size();
+
+        if (rejected) {
+            for (size_t i = wave.size(); i-- > 0;) {
+                if (!filled[i]) planner.requeue(wave[i]);
+            }
+            if (!planner.shrink()) {
+                throw OSRMError("OSRM rejected a table request of a single source and destination");
             }
+        } else {
+            planner.recordLatency(fetcher.lastStats().meanLatencyMs());
         }
+    }
+    LOG_DEBUG("Filled {}x{} table with {} requests.", num_sources, num_destinations, requests);
 
-        LOG_DEBUG("Processed chunk from {} to {}",
-                 i, std::min(i + chunk_size, destinations.size()) - 1);
+    if (num_sources == sources.size() && num_destinations == destinations.size()) {
+        return {std::move(distance_matrix), std::move(duration_matrix)};
     }
-    return {full_distance_matrix, full_duration_matrix};
+
+    // Expand back to one row per source and one column per destination.
+    FlatMatrix full_distance_matrix(static_cast<int>(destinations.size()), static_cast<int>(sources.size()));
+    FlatMatrix full_duration_matrix(static_cast<int>(destinations.size()), static_cast<int>(sources.size()));
+    for (size_t row = 0; row < sources.size(); ++row) {
+        int unique_row = unique_sources.index[row];
+        for (size_t col = 0; col < destinations.size(); ++col) {
+            int unique_col = unique_destinations.index[col];
+            full_distance_matrix(static_cast<int>(row), static_cast<int>(col)) = distance_matrix(unique_row, unique_col);
+            full_duration_matrix(static_cast<int>(row), static_cast<int>(col)) = duration_matrix(unique_row, unique_col);
+        }
+    }
+    return {std::move(full_distance_matrix), std::move(full_duration_matrix)};
 }
 
 void print_matrix(const std::vector<std::vector<double>>& matrix,
@@ -170,10 +186,11 @@ void print_matrix(const std::vector<std::vector<double>>& matrix,
         std::cout << "...\n";
 }
 
-void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
-                         const std::string& filename,
-                         int precision,
-                         bool add_headers) {
+template <typename At>
+static void write_csv_rows(size_t rows, size_t cols, At at,
+                           const std::string& filename,
+                           int precision,
+                           bool add_headers) {
     std::ofstream file(filename);
     if (!file.is_open()) {
         std::cerr << "Failed to open file: " << filename << "\n";
@@ -182,9 +199,6 @@ void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
 
     file << std::fixed << std::setprecision(precision);
 
-    size_t rows = matrix.size();
-    size_t cols = rows > 0 ? matrix[0].size() : 0;
-
     // Column headers
     if (add_headers) {
         file << " ";
@@ -199,7 +213,7 @@ void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
             file << "Src" << i;
 
         for (size_t j = 0; j < cols; ++j) {
-            file  << matrix[i][j];
+            file  << at(i, j);
             if (j < cols - 1)
                 file << ",";
         }
@@ -210,6 +224,25 @@ void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
     std::cout << "Matrix written to: " << filename << "\n";
 }
 
+void write_matrix_to_csv(const std::vector<std::vector<double>>& matrix,
+                         const std::string& filename,
+                         int precision,
+                         bool add_headers) {
+    size_t rows = matrix.size();
+    size_t cols = rows > 0 ? matrix[0].size() : 0;
+    write_csv_rows(rows, cols, [&matrix](size_t i, size_t j) { return matrix[i][j]; },
+                   filename, precision, add_headers);
+}
+
+void write_matrix_to_csv(const MatrixView& matrix,
+                         const std::string& filename,
+                         int precision,
+                         bool add_headers) {
+    write_csv_rows(matrix.height(), matrix.width(), [&matrix](size_t i, size_t j) {
+        return matrix.at(static_cast<int>(i), static_cast<int>(j));
+    }, filename, precision, add_headers);
+}
+
 /*
 * @brief Saves a matrix to a binary file in flat format.
 * The first two integers written to the file represent the width and height of the matrix.
@@ -238,6 +271,21 @@ void save_matrix_binary(const std::vector<std::vector<double>>& matrix,
     out.close();
 }
 
+void save_matrix_binary(const FlatMatrix& matrix, const std::string& filename) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        std::cerr << "Failed to open file for writing: " << filename << "\n";
+        return;
+    }
+
+    int width = matrix.width();
+    int height = matrix.height();
+    out.write(reinterpret_cast<const char*>(&width), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&height), sizeof(int));
+    out.write(reinterpret_cast<const char*>(matrix.data()), sizeof(double) * width * height);
+    out.close();
+}
+
 /*
 * @brief Loads a matrix from a binary file in flat format.
 * The first two integers in the file represent the width and height of the matrix.
@@ -266,110 +314,6 @@ double* load_matrix_binary_flat(const std::string& filename, int& height, int& w
     return matrix;
 }
 
-struct OverpassElement {
-    Location location;
-    bool building;
-    std::string buildingType;
-    std::string name;
-    int64_t id;
-    std::string elementType;
-    std::string tourism;
-    int building_levels;
-};
-
-std::vector<OverpassElement> parseOverpassResponse(const std::string& response) {
-    std::vector<OverpassElement> elements;
-    
-    try {
-        auto json_response = json::parse(response);
-        
-        if (!json_response.contains("elements")) {
-            std::cout << "No elements found in response" << std::endl;
-            return elements;
-        }
-        
-        std::cout << "Found " << json_response["elements"].size() << " elements" << std::endl;
-        
-        for (const auto& element : json_response["elements"]) {
-            OverpassElement overpass_element;
-            
-            // Get basic element info
-            overpass_element.id = element.value("id", 0);
-            overpass_element.elementType = element.value("type", "unknown");
-            
-            // Get coordinates
-            if (element.contains("center")) {
-                // For ways and relations with center output
-                overpass_element.location.lat = element["center"]["lat"];
-                overpass_element.location.lon = element["center"]["lon"];
-            } else if (element.contains("lat") && element.contains("lon")) {
-                // For nodes
-                overpass_element.location.lat = element["lat"];
-                overpass_element.location.lon = element["lon"];
-            } else {
-                std::cout << "Skipping element " << overpass_element.id 
-                          << " - no coordinates found" << std::endl;
-                continue;
-            }
-            
-            // Initialize building info
-            overpass_element.building = false;
-            overpass_element.buildingType = "none";
-            overpass_element.name = "";
-            overpass_element.tourism = "none";
-
-            // Parse tags
-            if (element.contains("tags")) {
-                const auto& tags = element["tags"];
-                
-                // Check for building tag
-                if (tags.contains("building")) {
-                    overpass_element.building = true;
-                    overpass_element.buildingType = tags["building"].get<std::string>();
-                }
-                
-                // Get name if available
-                if (tags.contains("name")) {
-                    overpass_element.name = tags["name"].get<std::string>();
-                }
-
-                // Check for tourism tag
-                if (tags.contains("tourism")) {
-                    overpass_element.tourism = tags["tourism"].get<std::string>();
-                }
-
-                // Check for building:levels tag
-                if (tags.contains("building:levels")) {
-                    try {
-                        overpass_element.building_levels = std::stoi(tags["building:levels"].get<std::string>());
-                    } catch (const std::invalid_argument&) {
-                        overpass_element.building_levels = 1; // Default if parsing fails
-                    }
-                } else {
-                    overpass_element.building_levels = 1; // Default if not present
-                }
-            }
-            
-            elements.push_back(overpass_element);
-            
-            // Log the parsed element
-            std::cout << "Element " << overpass_element.id 
-                      << " (" << overpass_element.elementType << "): "
-                      << overpass_element.name << " | "
-                      << "lat=" << std::fixed << std::setprecision(6) << overpass_element.location.lat
-                      << ", lon=" << overpass_element.location.lon
-                      << ", building=" << overpass_element.buildingType
-                      << ", levels=" << overpass_element.building_levels
-                      << ", tourism=" << overpass_element.tourism << std::endl;
-        }
-        
-    } catch (const json::exception& e) {
-        std::cerr << "JSON parsing error: " << e.what() << std::endl;
-    }
-    
-    return elements;
-}
-
 std::string queryOverpassAPI(Location center, double radius) {
     CURL* curl;
     CURLcode res;
@@ -421,6 +365,6 @@ std::string queryOverpassAPI(Location center, double radius) {
         std::cerr << "Failed to initialize CURL" << std::endl;
     }
 
-    parseOverpassResponse(readBuffer);
+    LOG_INFO("Overpass returned {} buildings", parseOverpassBuildings(readBuffer).size());
     return readBuffer;
 }
\ No newline at end of file
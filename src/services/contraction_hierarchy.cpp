@@ -0,0 +1,521 @@
+#include "services/contraction_hierarchy.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <limits>
+#include <mutex>
+#include <queue>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <tuple>
+#include <unistd.h>
+#include "utils/error.h"
+#include "utils/logger.h"
+#include "utils/parallel.h"
+
+struct ContractionHierarchy::Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t nodes;
+    uint32_t upEdges;
+    uint32_t downEdges;
+    uint32_t reserved;
+    uint64_t fingerprint;
+};
+
+namespace {
+constexpr char MAGIC[4] = {'F', 'S', 'C', 'H'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_BYTES = 32;
+// Witness searches give up after this many settled nodes and add the shortcut instead.
+constexpr size_t WITNESS_SETTLE_LIMIT = 500;
+constexpr double INF = std::numeric_limits<double>::infinity();
+
+size_t align8(size_t bytes) {
+    return (bytes + 7) & ~size_t{7};
+}
+
+// Byte offsets of every array, each 8-byte aligned so doubles can be read in place.
+struct Sections {
+    size_t upOffsets, upHeads, upDurations, upDistances;
+    size_t downOffsets, downHeads, downDurations, downDistances;
+    size_t total;
+
+    Sections(size_t nodes, size_t up, size_t down) {
+        size_t at = HEADER_BYTES;
+        auto take = [&at](size_t bytes) { size_t start = at; at += align8(bytes); return start; };
+        upOffsets = take((nodes + 1) * sizeof(uint32_t));
+        upHeads = take(up * sizeof(uint32_t));
+        upDurations = take(up * sizeof(double));
+        upDistances = take(up * sizeof(double));
+        downOffsets = take((nodes + 1) * sizeof(uint32_t));
+        downHeads = take(down * sizeof(uint32_t));
+        downDurations = take(down * sizeof(double));
+        downDistances = take(down * sizeof(double));
+        total = at;
+    }
+};
+
+struct Csr {
+    std::span<const uint32_t> offsets, heads;
+    std::span<const double> durations, distances;
+};
+
+struct SearchSpace {
+    std::vector<double> time, dist;
+    std::vector<uint32_t> stamp;
+    uint32_t run = 0;
+    std::priority_queue<std::pair<double, uint32_t>, std::vector<std::pair<double, uint32_t>>, std::greater<>> queue;
+
+    explicit SearchSpace(size_t nodes) : time(nodes), dist(nodes), stamp(nodes, 0) {}
+};
+
+/*
+* Dijkstra restricted to the upward arcs of `graph`. A settled node is stalled (neither
+* reported nor expanded) when `opposite` shows a higher node that reaches it faster,
+* its label cannot be part of a shortest path.
+*/
+template <typename OnSettle>
+void upwardSearch(uint32_t root, const Csr& graph, const Csr& opposite, SearchSpace& space, OnSettle&& onSettle) {
+    uint32_t run = ++space.run;
+    space.time[root] = 0.0;
+    space.dist[root] = 0.0;
+    space.stamp[root] = run;
+    space.queue.emplace(0.0, root);
+
+    while (!space.queue.empty()) {
+        auto [t, v] = space.queue.top();
+        space.queue.pop();
+        if (t > space.time[v]) continue;
+
+        bool stalled = false;
+        for (uint32_t e = opposite.offsets[v]; e < opposite.offsets[v + 1]; ++e) {
+            uint32_t w = opposite.heads[e];
+            if (space.stamp[w] == run && space.time[w] + opposite.durations[e] < t) {
+                stalled = true;
+                break;
+            }
+        }
+        if (stalled) continue;
+        onSettle(v, t, space.dist[v]);
+
+        for (uint32_t e = graph.offsets[v]; e < graph.offsets[v + 1]; ++e) {
+            uint32_t w = graph.heads[e];
+            double candidate = t + graph.durations[e];
+            if (space.stamp[w] != run || candidate < space.time[w]) {
+                space.stamp[w] = run;
+                space.time[w] = candidate;
+                space.dist[w] = space.dist[v] + graph.distances[e];
+                space.queue.emplace(candidate, w);
+            }
+        }
+    }
+}
+}
+
+ContractionHierarchy::~ContractionHierarchy() {
+    release();
+}
+
+ContractionHierarchy::ContractionHierarchy(ContractionHierarchy&& other) noexcept {
+    *this = std::move(other);
+}
+
+ContractionHierarchy& ContractionHierarchy::operator=(ContractionHierarchy&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    // Moving the vector keeps its buffer, so the spans stay valid.
+    owned_ = std::move(other.owned_);
+    map_ = std::exchange(other.map_, nullptr);
+    mapSize_ = std::exchange(other.mapSize_, 0);
+    header_ = std::exchange(other.header_, nullptr);
+    upOffsets_ = other.upOffsets_;
+    upHeads_ = other.upHeads_;
+    upDurations_ = other.upDurations_;
+    upDistances_ = other.upDistances_;
+    downOffsets_ = other.downOffsets_;
+    downHeads_ = other.downHeads_;
+    downDurations_ = other.downDurations_;
+    downDistances_ = other.downDistances_;
+    return *this;
+}
+
+void ContractionHierarchy::release() noexcept {
+    if (map_) {
+        munmap(map_, mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+    }
+    owned_.clear();
+    header_ = nullptr;
+}
+
+void ContractionHierarchy::bind(const void* base, size_t size) {
+    static_assert(sizeof(Header) == HEADER_BYTES);
+    if (size < HEADER_BYTES) {
+        throw InvalidValueError("Contraction hierarchy file is truncated");
+    }
+    const auto* header = static_cast<const Header*>(base);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        throw InvalidValueError("Not a contraction hierarchy file (or an unsupported version)");
+    }
+    Sections sections(header->nodes, header->upEdges, header->downEdges);
+    if (size < sections.total) {
+        throw InvalidValueError("Contraction hierarchy file is truncated");
+    }
+
+    const auto* bytes = static_cast<const char*>(base);
+    auto u32 = [bytes](size_t offset, size_t count) {
+        return std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(bytes + offset), count);
+    };
+    auto f64 = [bytes](size_t offset, size_t count) {
+        return std::span<const double>(reinterpret_cast<const double*>(bytes + offset), count);
+    };
+    header_ = header;
+    upOffsets_ = u32(sections.upOffsets, header->nodes + 1);
+    upHeads_ = u32(sections.upHeads, header->upEdges);
+    upDurations_ = f64(sections.upDurations, header->upEdges);
+    upDistances_ = f64(sections.upDistances, header->upEdges);
+    downOffsets_ = u32(sections.downOffsets, header->nodes + 1);
+    downHeads_ = u32(sections.downHeads, header->downEdges);
+    downDurations_ = f64(sections.downDurations, header->downEdges);
+    downDistances_ = f64(sections.downDistances, header->downEdges);
+}
+
+size_t ContractionHierarchy::nodeCount() const noexcept {
+    return header_ ? header_->nodes : 0;
+}
+
+uint64_t ContractionHierarchy::graphFingerprint() const noexcept {
+    return header_ ? header_->fingerprint : 0;
+}
+
+uint64_t ContractionHierarchy::fingerprint(const RoadGraph& graph) {
+    // FNV-1a over the node count and every edge.
+    uint64_t hash = 1469598103934665603ULL;
+    auto mix = [&hash](const void* data, size_t bytes) {
+        const auto* p = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < bytes; ++i) {
+            hash ^= p[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    uint64_t nodes = graph.nodeCount();
+    mix(&nodes, sizeof(nodes));
+    for (uint32_t v = 0; v < graph.nodeCount(); ++v) {
+        uint32_t degree = graph.edgeEnd(v) - graph.edgeBegin(v);
+        mix(&degree, sizeof(degree));
+    }
+    mix(graph.heads().data(), graph.heads().size_bytes());
+    mix(graph.durations().data(), graph.durations().size_bytes());
+    mix(graph.distances().data(), graph.distances().size_bytes());
+    return hash;
+}
+
+ContractionHierarchy ContractionHierarchy::build(const RoadGraph& graph) {
+    const uint32_t n = static_cast<uint32_t>(graph.nodeCount());
+    struct Arc {
+        uint32_t node;
+        double duration;
+        double distance;
+    };
+
+    // Remaining (uncontracted) graph, contracted nodes are erased from their neighbors.
+    std::vector<std::vector<Arc>> out(n), in(n);
+    auto addArc = [&](uint32_t u, uint32_t w, double duration, double distance) {
+        if (u == w) return;
+        for (auto& arc : out[u]) {
+            if (arc.node != w) continue;
+            if (duration < arc.duration) {
+                arc = {w, duration, distance};
+                for (auto& back : in[w]) {
+                    if (back.node == u) back = {u, duration, distance};
+                }
+            }
+            return;
+        }
+        out[u].push_back({w, duration, distance});
+        in[w].push_back({u, duration, distance});
+    };
+    for (uint32_t v = 0; v < n; ++v) {
+        for (uint32_t e = graph.edgeBegin(v); e < graph.edgeEnd(v); ++e) {
+            addArc(v, graph.heads()[e], graph.durations()[e], graph.distances()[e]);
+        }
+    }
+
+    SearchSpace witness(n);
+    std::vector<std::tuple<uint32_t, uint32_t, double, double>> shortcuts;
+
+    // Shortcuts contracting v would need, stored in `added` when given.
+    auto shortcutsFor = [&](uint32_t v, std::vector<std::tuple<uint32_t, uint32_t, double, double>>* added) {
+        int count = 0;
+        for (const Arc& inArc : in[v]) {
+            uint32_t u = inArc.node;
+            double maxCost = -1.0;
+            for (const Arc& outArc : out[v]) {
+                if (outArc.node != u) maxCost = std::max(maxCost, inArc.duration + outArc.duration);
+            }
+            if (maxCost < 0.0) continue;
+
+            // Fastest paths from u that avoid v, bounded by the most expensive path through v.
+            uint32_t run = ++witness.run;
+            witness.time[u] = 0.0;
+            witness.stamp[u] = run;
+            witness.queue.emplace(0.0, u);
+            size_t settled = 0;
+            while (!witness.queue.empty()) {
+                auto [t, x] = witness.queue.top();
+                witness.queue.pop();
+                if (t > witness.time[x]) continue;
+                if (t > maxCost || ++settled > WITNESS_SETTLE_LIMIT) break;
+                for (const Arc& arc : out[x]) {
+                    if (arc.node == v) continue;
+                    double candidate = t + arc.duration;
+                    if (witness.stamp[arc.node] != run || candidate < witness.time[arc.node]) {
+                        witness.stamp[arc.node] = run;
+                        witness.time[arc.node] = candidate;
+                        witness.queue.emplace(candidate, arc.node);
+                    }
+                }
+            }
+            witness.queue = {};
+
+            for (const Arc& outArc : out[v]) {
+                if (outArc.node == u) continue;
+                double via = inArc.duration + outArc.duration;
+                if (witness.stamp[outArc.node] == run && witness.time[outArc.node] <= via) continue;
+                ++count;
+                if (added) added->emplace_back(u, outArc.node, via, inArc.distance + outArc.distance);
+            }
+        }
+        return count;
+    };
+
+    std::vector<int> deletedNeighbors(n, 0);
+    auto priority = [&](uint32_t v) {
+        return shortcutsFor(v, nullptr) - static_cast<int>(in[v].size() + out[v].size()) + deletedNeighbors[v];
+    };
+
+    using Entry = std::pair<int, uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<>> order;
+    for (uint32_t v = 0; v < n; ++v) {
+        order.emplace(priority(v), v);
+    }
+
+    // Arcs of a contracted node all lead to later (higher) nodes.
+    std::vector<std::vector<Arc>> up(n), down(n);
+    size_t shortcutCount = 0;
+    while (!order.empty()) {
+        uint32_t v = order.top().second;
+        order.pop();
+
+        // Lazy update: contract only if v is still the cheapest after recomputing.
+        int current = priority(v);
+        if (!order.empty() && current > order.top().first) {
+            order.emplace(current, v);
+            continue;
+        }
+
+        shortcuts.clear();
+        shortcutsFor(v, &shortcuts);
+        shortcutCount += shortcuts.size();
+
+        up[v] = std::move(out[v]);
+        down[v] = std::move(in[v]);
+        out[v] = {};
+        in[v] = {};
+        for (const Arc& arc : up[v]) {
+            std::erase_if(in[arc.node], [v](const Arc& a) { return a.node == v; });
+            ++deletedNeighbors[arc.node];
+        }
+        for (const Arc& arc : down[v]) {
+            std::erase_if(out[arc.node], [v](const Arc& a) { return a.node == v; });
+            ++deletedNeighbors[arc.node];
+        }
+        for (const auto& [from, to, duration, distance] : shortcuts) {
+            addArc(from, to, duration, distance);
+        }
+    }
+
+    size_t upEdges = 0, downEdges = 0;
+    for (uint32_t v = 0; v < n; ++v) {
+        upEdges += up[v].size();
+        downEdges += down[v].size();
+    }
+
+    Sections sections(n, upEdges, downEdges);
+    ContractionHierarchy ch;
+    ch.owned_.assign(sections.total / sizeof(uint64_t), 0);
+    char* bytes = reinterpret_cast<char*>(ch.owned_.data());
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.nodes = n;
+    header.upEdges = static_cast<uint32_t>(upEdges);
+    header.downEdges = static_cast<uint32_t>(downEdges);
+    header.fingerprint = fingerprint(graph);
+    std::memcpy(bytes, &header, sizeof(header));
+
+    auto write = [bytes, n](const std::vector<std::vector<Arc>>& arcs, size_t offsetsAt, size_t headsAt,
+                            size_t durationsAt, size_t distancesAt) {
+        auto* offsets = reinterpret_cast<uint32_t*>(bytes + offsetsAt);
+        auto* heads = reinterpret_cast<uint32_t*>(bytes + headsAt);
+        auto* durations = reinterpret_cast<double*>(bytes + durationsAt);
+        auto* distances = reinterpret_cast<double*>(bytes + distancesAt);
+        uint32_t at = 0;
+        for (uint32_t v = 0; v < n; ++v) {
+            offsets[v] = at;
+            for (const Arc& arc : arcs[v]) {
+                heads[at] = arc.node;
+                durations[at] = arc.duration;
+                distances[at] = arc.distance;
+                ++at;
+            }
+        }
+        offsets[n] = at;
+    };
+    write(up, sections.upOffsets, sections.upHeads, sections.upDurations, sections.upDistances);
+    write(down, sections.downOffsets, sections.downHeads, sections.downDurations, sections.downDistances);
+    ch.bind(bytes, sections.total);
+
+    LOG_INFO("Contraction hierarchy: {} nodes, {} shortcuts, {} upward and {} downward arcs.",
+             n, shortcutCount, upEdges, downEdges);
+    return ch;
+}
+
+bool ContractionHierarchy::save(const std::string& path) const {
+    if (!header_) return false;
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open contraction hierarchy file for writing: {}", path);
+        return false;
+    }
+    Sections sections(header_->nodes, header_->upEdges, header_->downEdges);
+    out.write(reinterpret_cast<const char*>(header_), static_cast<std::streamsize>(sections.total));
+    return static_cast<bool>(out);
+}
+
+ContractionHierarchy ContractionHierarchy::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw InvalidValueError("Failed to open contraction hierarchy file: " + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw InvalidValueError("Contraction hierarchy file is empty: " + path);
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw InvalidValueError("Failed to map contraction hierarchy file: " + path);
+    }
+
+    ContractionHierarchy ch;
+    ch.map_ = map;
+    ch.mapSize_ = size;
+    ch.bind(map, size);  // the destructor unmaps if this throws
+    return ch;
+}
+
+ContractionHierarchy ContractionHierarchy::openOrBuild(const RoadGraph& graph, const std::string& path) {
+    if (std::ifstream(path)) {
+        try {
+            ContractionHierarchy ch = open(path);
+            if (ch.graphFingerprint() == fingerprint(graph)) {
+                LOG_INFO("Using contraction hierarchy {}", path);
+                return ch;
+            }
+            LOG_WARN("Contraction hierarchy {} was built for another road graph, rebuilding.", path);
+        } catch (const InvalidValueError& e) {
+            LOG_WARN("{}, rebuilding the contraction hierarchy.", e.what());
+        }
+    }
+
+    ContractionHierarchy ch = build(graph);
+    ch.save(path);
+    return ch;
+}
+
+std::pair<FlatMatrix, FlatMatrix> ContractionHierarchy::manyToMany(const std::vector<uint32_t>& sources,
+                                                                   const std::vector<uint32_t>& targets,
+                                                                   size_t threads) const {
+    const size_t n = nodeCount();
+    FlatMatrix distances(static_cast<int>(targets.size()), static_cast<int>(sources.size()), -1.0);
+    FlatMatrix durations(static_cast<int>(targets.size()), static_cast<int>(sources.size()), -1.0);
+    for (uint32_t node : sources) {
+        if (node >= n) throw InvalidValueError("Source node " + std::to_string(node) + " is not in the hierarchy");
+    }
+    for (uint32_t node : targets) {
+        if (node >= n) throw InvalidValueError("Target node " + std::to_string(node) + " is not in the hierarchy");
+    }
+    if (sources.empty() || targets.empty()) {
+        return {std::move(distances), std::move(durations)};
+    }
+
+    const Csr upward{upOffsets_, upHeads_, upDurations_, upDistances_};
+    const Csr downward{downOffsets_, downHeads_, downDurations_, downDistances_};
+
+    // Backward searches: every node a target's search settles gets a bucket entry.
+    struct BucketEntry {
+        uint32_t node;
+        uint32_t target;
+        double duration;
+        double distance;
+    };
+    std::vector<BucketEntry> entries;
+    std::mutex entriesMutex;
+    utils::parallelFor(targets.size(), [&](size_t begin, size_t end) {
+        SearchSpace space(n);
+        std::vector<BucketEntry> local;
+        for (size_t j = begin; j < end; ++j) {
+            upwardSearch(targets[j], downward, upward, space, [&](uint32_t v, double t, double d) {
+                local.push_back({v, static_cast<uint32_t>(j), t, d});
+            });
+        }
+        std::lock_guard<std::mutex> lock(entriesMutex);
+        entries.insert(entries.end(), local.begin(), local.end());
+    }, threads);
+
+    // Bucket CSR by node.
+    std::vector<uint32_t> bucketOffsets(n + 1, 0);
+    for (const auto& entry : entries) ++bucketOffsets[entry.node + 1];
+    for (size_t v = 0; v < n; ++v) bucketOffsets[v + 1] += bucketOffsets[v];
+    std::vector<BucketEntry> buckets(entries.size());
+    {
+        std::vector<uint32_t> next(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for (const auto& entry : entries) buckets[next[entry.node]++] = entry;
+    }
+    entries = {};
+
+    utils::parallelFor(sources.size(), [&](size_t begin, size_t end) {
+        SearchSpace space(n);
+        std::vector<double> bestTime(targets.size()), bestDist(targets.size());
+        for (size_t i = begin; i < end; ++i) {
+            std::fill(bestTime.begin(), bestTime.end(), INF);
+            upwardSearch(sources[i], upward, downward, space, [&](uint32_t v, double t, double d) {
+                for (uint32_t b = bucketOffsets[v]; b < bucketOffsets[v + 1]; ++b) {
+                    const BucketEntry& entry = buckets[b];
+                    double candidate = t + entry.duration;
+                    if (candidate < bestTime[entry.target]) {
+                        bestTime[entry.target] = candidate;
+                        bestDist[entry.target] = d + entry.distance;
+                    }
+                }
+            });
+
+            for (size_t j = 0; j < targets.size(); ++j) {
+                if (bestTime[j] == INF) {
+                    throw InvalidValueError(fmt::format("Unreachable route from node {} to node {}", sources[i], targets[j]));
+                }
+                durations(static_cast<int>(i), static_cast<int>(j)) = bestTime[j];
+                distances(static_cast<int>(i), static_cast<int>(j)) = bestDist[j];
+            }
+        }
+    }, threads);
+
+    return {std::move(distances), std::move(durations)};
+}
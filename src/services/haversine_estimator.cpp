@@ -0,0 +1,214 @@
+#include "services/haversine_estimator.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <nlohmann/json.hpp>
+#include "utils/constants.h"
+#include "utils/logger.h"
+#include "utils/parallel.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+constexpr double DEG_TO_RAD = M_PI / 180.0;
+constexpr double EARTH_RADIUS_M = constants::EARTH_RADIUS_KM * 1000.0;
+
+// Rational approximation of asin from fdlibm, evaluated without branches so loops using it vectorize.
+inline double asinPositive(double x) {
+    constexpr double pS0 = 1.66666666666666657415e-01;
+    constexpr double pS1 = -3.25565818622400915405e-01;
+    constexpr double pS2 = 2.01212532134862925881e-01;
+    constexpr double pS3 = -4.00555345006794114027e-02;
+    constexpr double pS4 = 7.91534994289814532176e-04;
+    constexpr double pS5 = 3.47933107596021167570e-05;
+    constexpr double qS1 = -2.40339491173441421878e+00;
+    constexpr double qS2 = 2.02094576023350569471e+00;
+    constexpr double qS3 = -6.88283971605453293030e-01;
+    constexpr double qS4 = 7.70381505559019352791e-02;
+
+    // Small arguments use asin(x) directly, large ones asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)).
+    // Both branches are computed and selected so the compiler can if-convert the loop.
+    bool small = x < 0.5;
+    double zLarge = (1.0 - x) * 0.5;
+    double rootLarge = std::sqrt(zLarge);
+    double z = small ? x * x : zLarge;
+    double s = small ? x : rootLarge;
+    double p = z * (pS0 + z * (pS1 + z * (pS2 + z * (pS3 + z * (pS4 + z * pS5)))));
+    double q = 1.0 + z * (qS1 + z * (qS2 + z * (qS3 + z * qS4)));
+    double r = s + s * (p / q);
+    return small ? r : M_PI_2 - 2.0 * r;
+}
+
+void toUnitVectors(const std::vector<Location>& locations,
+                   std::vector<double>& x, std::vector<double>& y, std::vector<double>& z) {
+    x.resize(locations.size());
+    y.resize(locations.size());
+    z.resize(locations.size());
+    for (size_t i = 0; i < locations.size(); ++i) {
+        double lat = locations[i].lat * DEG_TO_RAD;
+        double lon = locations[i].lon * DEG_TO_RAD;
+        x[i] = std::cos(lat) * std::cos(lon);
+        y[i] = std::cos(lat) * std::sin(lon);
+        z[i] = std::sin(lat);
+    }
+}
+
+} // namespace
+
+HaversineEstimator::HaversineEstimator(const std::vector<Location>& sources,
+                                       const std::vector<Location>& destinations,
+                                       const std::vector<int>& destinationZones,
+                                       const EstimatorCalibration& calibration)
+    : circuity_(calibration.circuity) {
+    toUnitVectors(sources, sx_, sy_, sz_);
+    toUnitVectors(destinations, dx_, dy_, dz_);
+
+    invSpeed_.resize(destinations.size());
+    for (size_t j = 0; j < destinations.size(); ++j) {
+        int zone = j < destinationZones.size() ? destinationZones[j] : -1;
+        invSpeed_[j] = 1.0 / calibration.speedForZone(zone);
+    }
+}
+
+/*
+* @brief Haversine distance via the chord between unit vectors: sqrt(hav(theta)) = chord / 2.
+*/
+void HaversineEstimator::greatCircleRow(size_t source, double* meters) const {
+    const double x = sx_[source], y = sy_[source], z = sz_[source];
+    const double* __restrict dx = dx_.data();
+    const double* __restrict dy = dy_.data();
+    const double* __restrict dz = dz_.data();
+    const size_t n = dx_.size();
+
+    for (size_t j = 0; j < n; ++j) {
+        double ex = dx[j] - x;
+        double ey = dy[j] - y;
+        double ez = dz[j] - z;
+        double halfChord = 0.5 * std::sqrt(ex * ex + ey * ey + ez * ez);
+        meters[j] = 2.0 * EARTH_RADIUS_M * asinPositive(std::min(halfChord, 1.0));
+    }
+}
+
+void HaversineEstimator::estimateRow(size_t source, double* distances, double* durations) const {
+    greatCircleRow(source, distances);
+    const double* __restrict invSpeed = invSpeed_.data();
+    const size_t n = dx_.size();
+    for (size_t j = 0; j < n; ++j) {
+        distances[j] *= circuity_;
+        durations[j] = distances[j] * invSpeed[j];
+    }
+}
+
+std::pair<FlatMatrix, FlatMatrix> HaversineEstimator::estimateMatrices(size_t numThreads) const {
+    int width = static_cast<int>(destinations());
+    int height = static_cast<int>(sources());
+    FlatMatrix distances(width, height);
+    FlatMatrix durations(width, height);
+    utils::parallelFor(sources(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            size_t row = i * destinations();
+            estimateRow(i, distances.data() + row, durations.data() + row);
+        }
+    }, numThreads);
+    return {std::move(distances), std::move(durations)};
+}
+
+EstimatorCalibration EstimatorCalibration::fit(const std::vector<Location>& sources,
+                                               const std::vector<Location>& destinations,
+                                               const std::vector<int>& destinationZones,
+                                               const MatrixView& distances,
+                                               const MatrixView& durations) {
+    // Pairs closer than this are dominated by snapping to the road network.
+    constexpr double MIN_GREAT_CIRCLE_M = 200.0;
+
+    HaversineEstimator raw(sources, destinations);
+    std::vector<double> greatCircle(destinations.size());
+    std::vector<double> ratios;
+    double totalDistance = 0.0, totalDuration = 0.0;
+    std::unordered_map<int, std::pair<double, double>> zoneTotals;
+
+    for (size_t i = 0; i < sources.size(); ++i) {
+        raw.greatCircleRow(i, greatCircle.data());
+        for (size_t j = 0; j < destinations.size(); ++j) {
+            double road = distances.at(static_cast<int>(i), static_cast<int>(j));
+            double seconds = durations.at(static_cast<int>(i), static_cast<int>(j));
+            if (road <= 0.0 || seconds <= 0.0) continue;
+
+            if (greatCircle[j] >= MIN_GREAT_CIRCLE_M) {
+                ratios.push_back(road / greatCircle[j]);
+            }
+            totalDistance += road;
+            totalDuration += seconds;
+            int zone = j < destinationZones.size() ? destinationZones[j] : -1;
+            if (zone >= 0) {
+                zoneTotals[zone].first += road;
+                zoneTotals[zone].second += seconds;
+            }
+        }
+    }
+
+    EstimatorCalibration calibration;
+    if (!ratios.empty()) {
+        auto mid = ratios.begin() + ratios.size() / 2;
+        std::nth_element(ratios.begin(), mid, ratios.end());
+        calibration.circuity = *mid;
+    }
+    if (totalDuration > 0.0) {
+        calibration.defaultSpeedMps = totalDistance / totalDuration;
+    }
+    for (const auto& [zone, totals] : zoneTotals) {
+        if (totals.second > 0.0) {
+            calibration.zoneSpeedMps[zone] = totals.first / totals.second;
+        }
+    }
+    LOG_INFO("Calibrated estimator: circuity {:.3f}, default speed {:.2f} m/s, {} zones.",
+             calibration.circuity, calibration.defaultSpeedMps, calibration.zoneSpeedMps.size());
+    return calibration;
+}
+
+double EstimatorCalibration::speedForZone(int zone) const {
+    auto it = zoneSpeedMps.find(zone);
+    return it != zoneSpeedMps.end() ? it->second : defaultSpeedMps;
+}
+
+bool EstimatorCalibration::save(const std::string& filename) const {
+    json j;
+    j["circuity"] = circuity;
+    j["default_speed_mps"] = defaultSpeedMps;
+    j["zone_speed_mps"] = json::object();
+    for (const auto& [zone, speed] : zoneSpeedMps) {
+        j["zone_speed_mps"][std::to_string(zone)] = speed;
+    }
+
+    std::ofstream out(filename);
+    if (!out) {
+        LOG_ERROR("Failed to open estimator calibration file for writing: {}", filename);
+        return false;
+    }
+    out << j.dump(2);
+    return static_cast<bool>(out);
+}
+
+bool EstimatorCalibration::load(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in) {
+        return false;
+    }
+
+    try {
+        json j = json::parse(in);
+        EstimatorCalibration loaded;
+        loaded.circuity = j.at("circuity").get<double>();
+        loaded.defaultSpeedMps = j.at("default_speed_mps").get<double>();
+        json zones = j.value("zone_speed_mps", json::object());
+        for (const auto& [zone, speed] : zones.items()) {
+            loaded.zoneSpeedMps[std::stoi(zone)] = speed.get<double>();
+        }
+        *this = std::move(loaded);
+    } catch (const std::exception& e) {
+        LOG_ERROR("Invalid estimator calibration in {}: {}", filename, e.what());
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,366 @@
+#include "services/input_snapshot.h"
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "config/EnvLoader.h"
+#include "utils/datetime.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+struct InputSnapshot::Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t stations;
+    uint32_t incidents;
+    uint32_t apparatuses;
+    uint32_t nameBytes;
+    uint64_t sources[SourceCount];
+};
+
+namespace {
+constexpr char MAGIC[4] = {'F', 'S', 'I', 'N'};
+constexpr uint32_t VERSION = 1;
+constexpr size_t HEADER_BYTES = 24 + 8 * InputSnapshot::SourceCount;
+
+size_t align8(size_t bytes) {
+    return (bytes + 7) & ~size_t{7};
+}
+
+// Byte offsets of every column, each 8-byte aligned so it can be read in place.
+struct Sections {
+    size_t stationIds, stationTrucks, stationAmbulances, stationLons, stationLats, nameOffsets, names;
+    size_t incidentIds, incidentLats, incidentLons, reportTimes, zones, types, levels, categories;
+    size_t apparatusStations, apparatusTypes;
+    size_t total;
+
+    Sections(size_t stations, size_t incidents, size_t apparatuses, size_t nameBytes) {
+        size_t at = HEADER_BYTES;
+        auto take = [&at](size_t bytes) { size_t start = at; at += align8(bytes); return start; };
+        stationIds = take(stations * sizeof(int32_t));
+        stationTrucks = take(stations * sizeof(int32_t));
+        stationAmbulances = take(stations * sizeof(int32_t));
+        stationLons = take(stations * sizeof(double));
+        stationLats = take(stations * sizeof(double));
+        nameOffsets = take((stations + 1) * sizeof(uint32_t));
+        names = take(nameBytes);
+        incidentIds = take(incidents * sizeof(int32_t));
+        incidentLats = take(incidents * sizeof(double));
+        incidentLons = take(incidents * sizeof(double));
+        reportTimes = take(incidents * sizeof(int64_t));
+        zones = take(incidents * sizeof(int32_t));
+        types = take(incidents);
+        levels = take(incidents);
+        categories = take(incidents);
+        apparatusStations = take(apparatuses * sizeof(int32_t));
+        apparatusTypes = take(apparatuses);
+        total = at;
+    }
+};
+
+// Word-at-a-time multiply-xor hash, the tail bytes are zero-padded into a last word.
+uint64_t hashBytes(const unsigned char* data, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ size;
+    auto mix = [&hash](uint64_t word) {
+        hash ^= word;
+        hash *= 0xFF51AFD7ED558CCDULL;
+        hash ^= hash >> 32;
+    };
+    size_t i = 0;
+    for (; i + 8 <= size; i += 8) {
+        uint64_t word;
+        std::memcpy(&word, data + i, 8);
+        mix(word);
+    }
+    uint64_t tail = 0;
+    if (i < size) std::memcpy(&tail, data + i, size - i);
+    mix(tail);
+    return hash;
+}
+
+// Report times depend on the zone they were parsed in, sample its offsets over the data's years.
+uint64_t timeZoneHash() {
+    const utils::TimeZone& zone = utils::TimeZone::local();
+    std::vector<int32_t> offsets;
+    for (int year = 1990; year < 2040; ++year) {
+        for (int month : {1, 7}) {
+            utils::CivilTime civil;
+            civil.year = year;
+            civil.month = month;
+            civil.hour = 12;
+            offsets.push_back(zone.utcOffset(zone.fromLocal(civil)));
+        }
+    }
+    return hashBytes(reinterpret_cast<const unsigned char*>(offsets.data()), offsets.size() * sizeof(int32_t));
+}
+}
+
+InputSnapshot::~InputSnapshot() {
+    release();
+}
+
+InputSnapshot::InputSnapshot(InputSnapshot&& other) noexcept {
+    *this = std::move(other);
+}
+
+InputSnapshot& InputSnapshot::operator=(InputSnapshot&& other) noexcept {
+    if (this == &other) return *this;
+    release();
+    map_ = other.map_;
+    mapSize_ = other.mapSize_;
+    sources_ = other.sources_;
+    stationIds_ = other.stationIds_;
+    stationTrucks_ = other.stationTrucks_;
+    stationAmbulances_ = other.stationAmbulances_;
+    stationLons_ = other.stationLons_;
+    stationLats_ = other.stationLats_;
+    nameOffsets_ = other.nameOffsets_;
+    names_ = other.names_;
+    incidentIds_ = other.incidentIds_;
+    incidentLats_ = other.incidentLats_;
+    incidentLons_ = other.incidentLons_;
+    reportTimes_ = other.reportTimes_;
+    zones_ = other.zones_;
+    types_ = other.types_;
+    levels_ = other.levels_;
+    categories_ = other.categories_;
+    apparatusStations_ = other.apparatusStations_;
+    apparatusTypes_ = other.apparatusTypes_;
+    other.map_ = nullptr;
+    other.mapSize_ = 0;
+    other.release();
+    return *this;
+}
+
+void InputSnapshot::release() noexcept {
+    if (map_) {
+        munmap(map_, mapSize_);
+        map_ = nullptr;
+        mapSize_ = 0;
+    }
+    sources_ = {};
+    stationIds_ = stationTrucks_ = stationAmbulances_ = {};
+    stationLons_ = stationLats_ = {};
+    nameOffsets_ = {};
+    names_ = {};
+    incidentIds_ = zones_ = {};
+    incidentLats_ = incidentLons_ = {};
+    reportTimes_ = {};
+    types_ = levels_ = categories_ = {};
+    apparatusStations_ = {};
+    apparatusTypes_ = {};
+}
+
+uint64_t InputSnapshot::hashFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return 0;
+    struct stat info {};
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return 0;
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    if (size == 0) {
+        ::close(fd);
+        return hashBytes(nullptr, 0);
+    }
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) return 0;
+    madvise(map, size, MADV_SEQUENTIAL);
+    uint64_t hash = hashBytes(static_cast<const unsigned char*>(map), size);
+    munmap(map, size);
+    return hash;
+}
+
+InputSnapshot::SourceHashes InputSnapshot::sourceHashesFromEnv() {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    SourceHashes hashes{};
+    hashes[StationsCsv] = hashFile(env->get("STATIONS_CSV_PATH", ""));
+    hashes[IncidentsCsv] = hashFile(env->get("INCIDENTS_CSV_PATH", ""));
+    hashes[ApparatusCsv] = hashFile(env->get("APPARATUS_CSV_PATH", ""));
+    hashes[BoundsGeojson] = hashFile(env->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson"));
+    hashes[BeatsGeojson] = hashFile(env->get("BEATS_SHAPEFILE_PATH", "../data/beats_shpfile.geojson"));
+    hashes[LocalTimeZone] = timeZoneHash();
+    return hashes;
+}
+
+bool InputSnapshot::save(const std::string& path, const SourceHashes& sources, const std::vector<Station>& stations,
+                         const std::vector<Incident>& incidents, const std::vector<Apparatus>& apparatuses) {
+    std::string names;
+    std::vector<uint32_t> nameOffsets;
+    nameOffsets.reserve(stations.size() + 1);
+    for (const auto& station : stations) {
+        nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+        names += station.getFacilityName();
+    }
+    nameOffsets.push_back(static_cast<uint32_t>(names.size()));
+
+    Sections sections(stations.size(), incidents.size(), apparatuses.size(), names.size());
+    std::vector<uint64_t> words(sections.total / sizeof(uint64_t), 0);
+    char* bytes = reinterpret_cast<char*>(words.data());
+
+    Header header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.stations = static_cast<uint32_t>(stations.size());
+    header.incidents = static_cast<uint32_t>(incidents.size());
+    header.apparatuses = static_cast<uint32_t>(apparatuses.size());
+    header.nameBytes = static_cast<uint32_t>(names.size());
+    std::memcpy(header.sources, sources.data(), sizeof(header.sources));
+    std::memcpy(bytes, &header, sizeof(header));
+
+    auto column = [bytes]<typename T>(size_t offset, size_t i, T value) {
+        std::memcpy(bytes + offset + i * sizeof(T), &value, sizeof(T));
+    };
+    for (size_t i = 0; i < stations.size(); ++i) {
+        const Station& station = stations[i];
+        column(sections.stationIds, i, static_cast<int32_t>(station.getStationId()));
+        column(sections.stationTrucks, i, static_cast<int32_t>(station.getNumFireTrucks()));
+        column(sections.stationAmbulances, i, static_cast<int32_t>(station.getNumAmbulances()));
+        column(sections.stationLons, i, station.getLon());
+        column(sections.stationLats, i, station.getLat());
+    }
+    std::memcpy(bytes + sections.nameOffsets, nameOffsets.data(), nameOffsets.size() * sizeof(uint32_t));
+    std::memcpy(bytes + sections.names, names.data(), names.size());
+    for (size_t i = 0; i < incidents.size(); ++i) {
+        const Incident& incident = incidents[i];
+        column(sections.incidentIds, i, static_cast<int32_t>(incident.incident_id));
+        column(sections.incidentLats, i, incident.lat);
+        column(sections.incidentLons, i, incident.lon);
+        column(sections.reportTimes, i, static_cast<int64_t>(incident.reportTime));
+        column(sections.zones, i, static_cast<int32_t>(incident.zoneIndex));
+        column(sections.types, i, static_cast<uint8_t>(incident.incident_type));
+        column(sections.levels, i, static_cast<uint8_t>(incident.incident_level));
+        column(sections.categories, i, static_cast<uint8_t>(incident.category));
+    }
+    for (size_t i = 0; i < apparatuses.size(); ++i) {
+        column(sections.apparatusStations, i, static_cast<int32_t>(apparatuses[i].getStationIndex()));
+        column(sections.apparatusTypes, i, static_cast<uint8_t>(apparatuses[i].getType()));
+    }
+
+    // Written next to the target and renamed, a run that is killed never leaves a torn snapshot.
+    std::string partial = path + ".partial";
+    {
+        std::ofstream out(partial, std::ios::binary);
+        if (!out) {
+            LOG_ERROR("Failed to open input snapshot for writing: {}", path);
+            return false;
+        }
+        out.write(bytes, static_cast<std::streamsize>(sections.total));
+        if (!out) {
+            LOG_ERROR("Failed to write input snapshot: {}", path);
+            return false;
+        }
+    }
+    if (std::rename(partial.c_str(), path.c_str()) != 0) {
+        LOG_ERROR("Failed to replace input snapshot: {}", path);
+        std::remove(partial.c_str());
+        return false;
+    }
+    return true;
+}
+
+void InputSnapshot::bind(const void* base, size_t size) {
+    static_assert(sizeof(Header) == HEADER_BYTES);
+    if (size < HEADER_BYTES) {
+        throw InvalidValueError("Input snapshot is truncated");
+    }
+    const auto* header = static_cast<const Header*>(base);
+    if (std::memcmp(header->magic, MAGIC, sizeof(MAGIC)) != 0 || header->version != VERSION) {
+        throw InvalidValueError("Not an input snapshot (or an unsupported version)");
+    }
+    Sections sections(header->stations, header->incidents, header->apparatuses, header->nameBytes);
+    if (size < sections.total) {
+        throw InvalidValueError("Input snapshot is truncated");
+    }
+
+    const auto* bytes = static_cast<const char*>(base);
+    auto span = [bytes]<typename T>(std::span<const T>& out, size_t offset, size_t count) {
+        out = std::span<const T>(reinterpret_cast<const T*>(bytes + offset), count);
+    };
+    std::memcpy(sources_.data(), header->sources, sizeof(header->sources));
+    span(stationIds_, sections.stationIds, header->stations);
+    span(stationTrucks_, sections.stationTrucks, header->stations);
+    span(stationAmbulances_, sections.stationAmbulances, header->stations);
+    span(stationLons_, sections.stationLons, header->stations);
+    span(stationLats_, sections.stationLats, header->stations);
+    span(nameOffsets_, sections.nameOffsets, header->stations + 1);
+    span(names_, sections.names, header->nameBytes);
+    span(incidentIds_, sections.incidentIds, header->incidents);
+    span(incidentLats_, sections.incidentLats, header->incidents);
+    span(incidentLons_, sections.incidentLons, header->incidents);
+    span(reportTimes_, sections.reportTimes, header->incidents);
+    span(zones_, sections.zones, header->incidents);
+    span(types_, sections.types, header->incidents);
+    span(levels_, sections.levels, header->incidents);
+    span(categories_, sections.categories, header->incidents);
+    span(apparatusStations_, sections.apparatusStations, header->apparatuses);
+    span(apparatusTypes_, sections.apparatusTypes, header->apparatuses);
+    if (nameOffsets_.back() > header->nameBytes) {
+        throw InvalidValueError("Input snapshot has corrupt station names");
+    }
+}
+
+InputSnapshot InputSnapshot::open(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw InvalidValueError("Failed to open input snapshot: " + path);
+    }
+    struct stat info {};
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        throw InvalidValueError("Input snapshot is empty: " + path);
+    }
+    size_t size = static_cast<size_t>(info.st_size);
+    void* map = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (map == MAP_FAILED) {
+        throw InvalidValueError("Failed to map input snapshot: " + path);
+    }
+
+    InputSnapshot snapshot;
+    snapshot.map_ = map;
+    snapshot.mapSize_ = size;
+    snapshot.bind(map, size);  // the destructor unmaps if this throws
+    return snapshot;
+}
+
+std::vector<Station> InputSnapshot::stations() const {
+    std::vector<Station> stations;
+    stations.reserve(stationCount());
+    for (size_t i = 0; i < stationCount(); ++i) {
+        Station station(static_cast<int>(i), stationIds_[i], stationTrucks_[i], stationAmbulances_[i],
+                        stationLons_[i], stationLats_[i]);
+        station.setFacilityName(std::string(names_.data() + nameOffsets_[i], nameOffsets_[i + 1] - nameOffsets_[i]));
+        stations.push_back(std::move(station));
+    }
+    return stations;
+}
+
+std::vector<Incident> InputSnapshot::incidents() const {
+    std::vector<Incident> incidents;
+    incidents.reserve(incidentCount());
+    for (size_t i = 0; i < incidentCount(); ++i) {
+        Incident& incident = incidents.emplace_back(static_cast<int>(i), incidentIds_[i], incidentLats_[i],
+                                                    incidentLons_[i], static_cast<IncidentType>(types_[i]),
+                                                    static_cast<IncidentLevel>(levels_[i]),
+                                                    static_cast<time_t>(reportTimes_[i]),
+                                                    static_cast<IncidentCategory>(categories_[i]));
+        incident.zoneIndex = zones_[i];
+    }
+    return incidents;
+}
+
+std::vector<Apparatus> InputSnapshot::apparatuses() const {
+    std::vector<Apparatus> apparatuses;
+    apparatuses.reserve(apparatusCount());
+    for (size_t i = 0; i < apparatusCount(); ++i) {
+        apparatuses.emplace_back(static_cast<int>(i), apparatusStations_[i],
+                                 static_cast<ApparatusType>(apparatusTypes_[i]));
+    }
+    return apparatuses;
+}
@@ -0,0 +1,273 @@
+#include "services/matrix_store.h"
+#include <algorithm>
+#include <cstring>
+#include "utils/error.h"
+#include "utils/logger.h"
+
+/*
+* @brief Loads a flat matrix written by save_matrix_binary.
+* @param filename The path to the binary file.
+* @throws std::runtime_error if the file cannot be read.
+*/
+FlatMatrix FlatMatrix::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open matrix file: " + filename);
+    }
+
+    int width = 0, height = 0;
+    in.read(reinterpret_cast<char*>(&width), sizeof(int));
+    in.read(reinterpret_cast<char*>(&height), sizeof(int));
+    if (!in || width < 0 || height < 0) {
+        throw std::runtime_error("Invalid matrix header in " + filename);
+    }
+
+    FlatMatrix matrix(width, height);
+    in.read(reinterpret_cast<char*>(matrix.data()), sizeof(double) * matrix.data_.size());
+    if (!in) {
+        throw std::runtime_error("Matrix file is truncated: " + filename);
+    }
+    return matrix;
+}
+
+void FlatMatrix::column(int col, double* out) const {
+    const double* ptr = data_.data() + col;
+    for (int row = 0; row < height_; ++row) {
+        out[row] = *ptr;
+        ptr += width_;
+    }
+}
+
+TiledMatrixStore::TiledMatrixStore(const std::string& filename, size_t cacheTiles, size_t readAheadCols)
+    : filename_(filename), capacity_(std::max<size_t>(cacheTiles, 1)), readAheadCols_(readAheadCols) {
+    file_.open(filename, std::ios::binary);
+    if (!file_) {
+        throw std::runtime_error("Failed to open tiled matrix file: " + filename);
+    }
+
+    char magic[4];
+    uint32_t version = 0;
+    file_.read(magic, sizeof(magic));
+    file_.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    file_.read(reinterpret_cast<char*>(&width_), sizeof(int));
+    file_.read(reinterpret_cast<char*>(&height_), sizeof(int));
+    file_.read(reinterpret_cast<char*>(&tileCols_), sizeof(int));
+    if (!file_ || std::memcmp(magic, MAGIC, sizeof(magic)) != 0 || version != VERSION
+        || width_ < 0 || height_ < 0 || tileCols_ <= 0) {
+        throw std::runtime_error("Invalid tiled matrix header in " + filename);
+    }
+    dataOffset_ = file_.tellg();
+
+    prefetcher_ = std::thread(&TiledMatrixStore::prefetchLoop, this);
+    LOG_INFO("Opened tiled matrix {} ({}x{}, {} columns per tile, {} cached tiles).",
+             filename, width_, height_, tileCols_, capacity_);
+}
+
+TiledMatrixStore::~TiledMatrixStore() {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        stop_ = true;
+    }
+    pendingCv_.notify_all();
+    if (prefetcher_.joinable()) prefetcher_.join();
+}
+
+double TiledMatrixStore::at(int row, int col) const {
+    Tile tile = getTile(col / tileCols_);
+    size_t offset = static_cast<size_t>(col % tileCols_) * height_ + row;
+    return (*tile)[offset];
+}
+
+void TiledMatrixStore::column(int col, double* out) const {
+    Tile tile = getTile(col / tileCols_);
+    const double* begin = tile->data() + static_cast<size_t>(col % tileCols_) * height_;
+    std::copy(begin, begin + height_, out);
+    scheduleReadAhead(col);
+}
+
+void TiledMatrixStore::setAccessPlan(const std::vector<int>& cols) {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    plan_ = cols;
+    planPos_.assign(width_, -1);
+    for (size_t i = 0; i < plan_.size(); ++i) {
+        int col = plan_[i];
+        if (col >= 0 && col < width_ && planPos_[col] < 0) {
+            planPos_[col] = static_cast<int>(i);
+        }
+    }
+}
+
+void TiledMatrixStore::prefetch(const std::vector<int>& cols) const {
+    bool scheduled = false;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        for (int col : cols) {
+            if (col < 0 || col >= width_) continue;
+            int tile = col / tileCols_;
+            if (cache_.count(tile) || !queued_.insert(tile).second) continue;
+            pending_.push_back(tile);
+            scheduled = true;
+        }
+    }
+    if (scheduled) pendingCv_.notify_one();
+}
+
+size_t TiledMatrixStore::cachedTiles() const {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return cache_.size();
+}
+
+size_t TiledMatrixStore::cacheMisses() const {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    return misses_;
+}
+
+TiledMatrixStore::Tile TiledMatrixStore::getTile(int tile) const {
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        auto it = cache_.find(tile);
+        if (it != cache_.end()) {
+            lru_.splice(lru_.begin(), lru_, it->second.second);
+            return it->second.first;
+        }
+        ++misses_;
+    }
+    return insertTile(tile, readTile(tile));
+}
+
+TiledMatrixStore::Tile TiledMatrixStore::readTile(int tile) const {
+    int firstCol = tile * tileCols_;
+    if (tile < 0 || firstCol >= width_) {
+        throw std::out_of_range("Tile " + std::to_string(tile) + " out of range in " + filename_);
+    }
+    int cols = std::min(tileCols_, width_ - firstCol);
+    auto data = std::make_shared<std::vector<double>>(static_cast<size_t>(cols) * height_);
+
+    std::lock_guard<std::mutex> lock(ioMutex_);
+    std::streamoff offset = dataOffset_ + static_cast<std::streamoff>(firstCol) * height_ * sizeof(double);
+    file_.clear();
+    file_.seekg(offset);
+    file_.read(reinterpret_cast<char*>(data->data()), sizeof(double) * data->size());
+    if (!file_) {
+        throw std::runtime_error("Tiled matrix file is truncated: " + filename_);
+    }
+    return data;
+}
+
+// Inserts a freshly read tile unless another thread got there first, evicting the least recently used.
+TiledMatrixStore::Tile TiledMatrixStore::insertTile(int tile, Tile data) const {
+    std::lock_guard<std::mutex> lock(cacheMutex_);
+    auto it = cache_.find(tile);
+    if (it != cache_.end()) {
+        lru_.splice(lru_.begin(), lru_, it->second.second);
+        return it->second.first;
+    }
+
+    while (cache_.size() >= capacity_) {
+        cache_.erase(lru_.back());
+        lru_.pop_back();
+    }
+    lru_.push_front(tile);
+    cache_.emplace(tile, std::make_pair(data, lru_.begin()));
+    return data;
+}
+
+// Queues the tiles of the next columns in the access plan, or the next tile when no plan is set.
+void TiledMatrixStore::scheduleReadAhead(int col) const {
+    if (readAheadCols_ == 0) return;
+
+    std::vector<int> upcoming;
+    {
+        std::lock_guard<std::mutex> lock(cacheMutex_);
+        if (planPos_.empty()) {
+            upcoming.push_back((col / tileCols_ + 1) * tileCols_);
+        } else if (planPos_[col] >= 0) {
+            size_t begin = static_cast<size_t>(planPos_[col]) + 1;
+            size_t end = std::min(plan_.size(), begin + readAheadCols_);
+            int lastTile = col / tileCols_;
+            for (size_t i = begin; i < end; ++i) {
+                int tile = plan_[i] / tileCols_;
+                if (tile != lastTile) {
+                    upcoming.push_back(plan_[i]);
+                    lastTile = tile;
+                }
+            }
+        }
+    }
+    prefetch(upcoming);
+}
+
+void TiledMatrixStore::prefetchLoop() {
+    while (true) {
+        int tile;
+        {
+            std::unique_lock<std::mutex> lock(cacheMutex_);
+            pendingCv_.wait(lock, [this] { return stop_ || !pending_.empty(); });
+            if (stop_) return;
+            tile = pending_.front();
+            pending_.pop_front();
+            queued_.erase(tile);
+            if (cache_.count(tile)) continue;
+        }
+
+        try {
+            insertTile(tile, readTile(tile));
+        } catch (const std::exception& e) {
+            LOG_WARN("Prefetch of tile {} failed: {}", tile, e.what());
+        }
+    }
+}
+
+std::unique_ptr<MatrixView> openMatrix(const std::string& filename, size_t cacheTiles) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Failed to open matrix file: " + filename);
+    }
+
+    char magic[4] = {};
+    in.read(magic, sizeof(magic));
+    if (in && std::memcmp(magic, TiledMatrixStore::MAGIC, sizeof(magic)) == 0) {
+        return std::make_unique<TiledMatrixStore>(filename, cacheTiles);
+    }
+    return std::make_unique<FlatMatrix>(FlatMatrix::load(filename));
+}
+
+template <typename At>
+static bool writeTiled(int width, int height, At at, const std::string& filename, int tileCols) {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open tiled matrix file for writing: {}", filename);
+        return false;
+    }
+    if (tileCols <= 0) {
+        throw InvalidValueError("Tile width must be positive, got " + std::to_string(tileCols));
+    }
+
+    out.write(TiledMatrixStore::MAGIC, sizeof(TiledMatrixStore::MAGIC));
+    out.write(reinterpret_cast<const char*>(&TiledMatrixStore::VERSION), sizeof(uint32_t));
+    out.write(reinterpret_cast<const char*>(&width), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&height), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&tileCols), sizeof(int));
+
+    // Tiles are consecutive column ranges, so writing column by column yields the tile layout.
+    std::vector<double> column(height);
+    for (int col = 0; col < width; ++col) {
+        at(col, column.data());
+        out.write(reinterpret_cast<const char*>(column.data()), sizeof(double) * height);
+    }
+    return static_cast<bool>(out);
+}
+
+bool writeTiledMatrix(const MatrixView& matrix, const std::string& filename, int tileCols) {
+    return writeTiled(matrix.width(), matrix.height(), [&matrix](int col, double* out) {
+        matrix.column(col, out);
+    }, filename, tileCols);
+}
+
+bool writeTiledMatrix(const std::vector<std::vector<double>>& matrix, const std::string& filename, int tileCols) {
+    int height = static_cast<int>(matrix.size());
+    int width = height > 0 ? static_cast<int>(matrix[0].size()) : 0;
+    return writeTiled(width, height, [&matrix](int col, double* out) {
+        for (size_t row = 0; row < matrix.size(); ++row) out[row] = matrix[row][col];
+    }, filename, tileCols);
+}
@@ -0,0 +1,176 @@
+#include "services/native_router.h"
+#include <cmath>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include "utils/constants.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+#include "utils/parallel.h"
+
+namespace {
+double greatCircleMeters(const Location& a, const Location& b) {
+    const double toRad = M_PI / 180.0;
+    double dlat = (b.lat - a.lat) * toRad;
+    double dlon = (b.lon - a.lon) * toRad;
+    double h = std::sin(dlat / 2) * std::sin(dlat / 2)
+             + std::cos(a.lat * toRad) * std::cos(b.lat * toRad) * std::sin(dlon / 2) * std::sin(dlon / 2);
+    return 2.0 * constants::EARTH_RADIUS_KM * 1000.0 * std::asin(std::min(1.0, std::sqrt(h)));
+}
+
+// Equirectangular projection around the graph's mean latitude, so R-tree nearest is metric enough.
+Point project(const Location& location, double lonScale) {
+    return Point(location.lon * lonScale, location.lat);
+}
+}
+
+NativeRouter::NativeRouter(RoadGraph graph, const NativeRouterOptions& options)
+    : graph_(std::move(graph)), options_(options) {
+    if (graph_.nodeCount() == 0) {
+        throw InvalidValueError("Native router needs a non-empty road graph");
+    }
+    if (options_.snapSpeedMps <= 0.0) {
+        throw InvalidValueError("Native router snap speed must be positive");
+    }
+
+    double meanLat = 0.0;
+    for (const auto& node : graph_.nodes()) meanLat += node.lat;
+    meanLat /= static_cast<double>(graph_.nodeCount());
+    lonScale_ = std::cos(meanLat * M_PI / 180.0);
+
+    std::vector<uint8_t> component = graph_.largestComponent();
+    std::vector<NodeEntry> entries;
+    for (uint32_t v = 0; v < graph_.nodeCount(); ++v) {
+        if (component[v]) {
+            entries.emplace_back(project(graph_.node(v), lonScale_), v);
+        }
+    }
+    // Range construction bulk-loads (packs) the tree.
+    rtree_ = bgi::rtree<NodeEntry, bgi::quadratic<16>>(entries.begin(), entries.end());
+}
+
+void NativeRouter::useHierarchy(ContractionHierarchy hierarchy) {
+    if (hierarchy.graphFingerprint() != ContractionHierarchy::fingerprint(graph_)) {
+        throw MismatchError("Contraction hierarchy does not match the road graph");
+    }
+    hierarchy_ = std::make_unique<ContractionHierarchy>(std::move(hierarchy));
+}
+
+NativeRouter::Snap NativeRouter::snap(const Location& location) const {
+    std::vector<NodeEntry> nearest;
+    rtree_.query(bgi::nearest(project(location, lonScale_), 1), std::back_inserter(nearest));
+    uint32_t node = nearest.front().second;
+    return {node, greatCircleMeters(location, graph_.node(node))};
+}
+
+std::pair<FlatMatrix, FlatMatrix> NativeRouter::tableMatrices(const std::vector<Location>& sources,
+                                                              const std::vector<Location>& destinations) const {
+    FlatMatrix distances(static_cast<int>(destinations.size()), static_cast<int>(sources.size()), -1.0);
+    FlatMatrix durations(static_cast<int>(destinations.size()), static_cast<int>(sources.size()), -1.0);
+    if (sources.empty() || destinations.empty()) {
+        return {std::move(distances), std::move(durations)};
+    }
+
+    std::vector<Snap> sourceSnaps(sources.size());
+    std::vector<Snap> destinationSnaps(destinations.size());
+    utils::parallelFor(sources.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) sourceSnaps[i] = snap(sources[i]);
+    }, options_.threads);
+    utils::parallelFor(destinations.size(), [&](size_t begin, size_t end) {
+        for (size_t j = begin; j < end; ++j) destinationSnaps[j] = snap(destinations[j]);
+    }, options_.threads);
+
+    const double snapSecondsPerMeter = 1.0 / options_.snapSpeedMps;
+    if (hierarchy_) {
+        // Route between distinct snapped nodes only, then add the legs per location.
+        std::vector<uint32_t> sourceNodes, targetNodes;
+        std::unordered_map<uint32_t, int> targetColumn;
+        for (const auto& s : sourceSnaps) sourceNodes.push_back(s.node);
+        for (const auto& s : destinationSnaps) {
+            if (targetColumn.try_emplace(s.node, static_cast<int>(targetNodes.size())).second) {
+                targetNodes.push_back(s.node);
+            }
+        }
+        auto [nodeDistances, nodeDurations] = hierarchy_->manyToMany(sourceNodes, targetNodes, options_.threads);
+        utils::parallelFor(destinations.size(), [&](size_t begin, size_t end) {
+            for (size_t i = 0; i < sources.size(); ++i) {
+                int row = static_cast<int>(i);
+                for (size_t j = begin; j < end; ++j) {
+                    int col = targetColumn.at(destinationSnaps[j].node);
+                    double leg = sourceSnaps[i].meters + destinationSnaps[j].meters;
+                    distances(row, static_cast<int>(j)) = nodeDistances(row, col) + leg;
+                    durations(row, static_cast<int>(j)) = nodeDurations(row, col) + leg * snapSecondsPerMeter;
+                }
+            }
+        }, options_.threads);
+        LOG_INFO("Native router filled {}x{} matrices from the contraction hierarchy.", sources.size(), destinations.size());
+        return {std::move(distances), std::move(durations)};
+    }
+
+    const size_t n = graph_.nodeCount();
+    std::vector<uint8_t> isTarget(n, 0);
+    size_t targetCount = 0;
+    for (const auto& s : destinationSnaps) {
+        if (!isTarget[s.node]) {
+            isTarget[s.node] = 1;
+            ++targetCount;
+        }
+    }
+
+    auto heads = graph_.heads();
+    auto edgeDistances = graph_.distances();
+    auto edgeDurations = graph_.durations();
+
+    utils::parallelFor(sources.size(), [&](size_t begin, size_t end) {
+        // Labels are valid when stamp == run, so they are never cleared between sources.
+        std::vector<double> time(n), dist(n);
+        std::vector<uint32_t> stamp(n, 0), settled(n, 0);
+        using QueueEntry = std::pair<double, uint32_t>;
+        std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<>> queue;
+
+        for (size_t i = begin; i < end; ++i) {
+            uint32_t run = static_cast<uint32_t>(i - begin + 1);
+            uint32_t root = sourceSnaps[i].node;
+            time[root] = 0.0;
+            dist[root] = 0.0;
+            stamp[root] = run;
+            queue.emplace(0.0, root);
+
+            size_t remaining = targetCount;
+            while (!queue.empty() && remaining > 0) {
+                auto [t, v] = queue.top();
+                queue.pop();
+                if (settled[v] == run) continue;
+                settled[v] = run;
+                if (isTarget[v]) --remaining;
+
+                for (uint32_t e = graph_.edgeBegin(v); e < graph_.edgeEnd(v); ++e) {
+                    uint32_t w = heads[e];
+                    double candidate = t + edgeDurations[e];
+                    if (stamp[w] != run || candidate < time[w]) {
+                        stamp[w] = run;
+                        time[w] = candidate;
+                        dist[w] = dist[v] + edgeDistances[e];
+                        queue.emplace(candidate, w);
+                    }
+                }
+            }
+            queue = {};
+
+            const double sourceLeg = sourceSnaps[i].meters;
+            for (size_t j = 0; j < destinations.size(); ++j) {
+                const Snap& target = destinationSnaps[j];
+                if (settled[target.node] != run) {
+                    throw InvalidValueError(fmt::format("Unreachable route from source {} to destination {}", i, j));
+                }
+                double leg = sourceLeg + target.meters;
+                int row = static_cast<int>(i), col = static_cast<int>(j);
+                distances(row, col) = dist[target.node] + leg;
+                durations(row, col) = time[target.node] + leg * snapSecondsPerMeter;
+            }
+        }
+    }, options_.threads);
+
+    LOG_INFO("Native router filled {}x{} matrices over {} nodes.", sources.size(), destinations.size(), n);
+    return {std::move(distances), std::move(durations)};
+}
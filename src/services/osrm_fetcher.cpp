@@ -0,0 +1,158 @@
+#include "services/osrm_fetcher.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <map>
+#include "config/EnvLoader.h"
+#include "services/chunks.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+OsrmFetchOptions OsrmFetchOptions::fromEnv() {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    OsrmFetchOptions options;
+    if (!env) return options;
+    options.maxInFlight = std::max<size_t>(1, std::stoul(env->get("OSRM_MAX_IN_FLIGHT", "4")));
+    options.timeoutMs = std::stol(env->get("OSRM_TIMEOUT_MS", "60000"));
+    options.maxRetries = std::stoi(env->get("OSRM_MAX_RETRIES", "3"));
+    options.retryBackoffMs = std::stol(env->get("OSRM_RETRY_BACKOFF_MS", "250"));
+    return options;
+}
+
+OsrmFetcher::OsrmFetcher(const OsrmFetchOptions& options)
+    : options_(options), slots_(std::max<size_t>(options.maxInFlight, 1)) {
+    multi_ = curl_multi_init();
+    if (!multi_) {
+        throw OSRMError("Failed to initialize curl multi handle");
+    }
+    long maxConnections = static_cast<long>(slots_.size());
+    curl_multi_setopt(multi_, CURLMOPT_MAX_HOST_CONNECTIONS, maxConnections);
+    curl_multi_setopt(multi_, CURLMOPT_MAX_TOTAL_CONNECTIONS, maxConnections);
+
+    for (auto& slot : slots_) {
+        slot.handle = curl_easy_init();
+        if (!slot.handle) {
+            throw OSRMError("Failed to initialize curl handle");
+        }
+        curl_easy_setopt(slot.handle, CURLOPT_WRITEFUNCTION, WriteCallback);
+        curl_easy_setopt(slot.handle, CURLOPT_WRITEDATA, &slot.body);
+        curl_easy_setopt(slot.handle, CURLOPT_PRIVATE, &slot);
+        curl_easy_setopt(slot.handle, CURLOPT_TIMEOUT_MS, options_.timeoutMs);
+        curl_easy_setopt(slot.handle, CURLOPT_CONNECTTIMEOUT_MS, options_.connectTimeoutMs);
+        curl_easy_setopt(slot.handle, CURLOPT_TCP_KEEPALIVE, 1L);
+        curl_easy_setopt(slot.handle, CURLOPT_NOSIGNAL, 1L);
+        curl_easy_setopt(slot.handle, CURLOPT_ACCEPT_ENCODING, "");  // let OSRM gzip large tables
+    }
+}
+
+OsrmFetcher::~OsrmFetcher() {
+    for (auto& slot : slots_) {
+        if (!slot.handle) continue;
+        release(slot);
+        curl_easy_cleanup(slot.handle);
+    }
+    curl_multi_cleanup(multi_);
+}
+
+void OsrmFetcher::release(Slot& slot) {
+    if (slot.busy) {
+        curl_multi_remove_handle(multi_, slot.handle);
+        slot.busy = false;
+    }
+}
+
+void OsrmFetcher::fetchAll(const std::vector<std::string>& urls, const ResponseHandler& onResponse,
+                           const RejectionHandler& onRejected) {
+    using Clock = std::chrono::steady_clock;
+
+    std::deque<size_t> ready;
+    for (size_t i = 0; i < urls.size(); ++i) ready.push_back(i);
+    std::multimap<Clock::time_point, size_t> retries;
+    std::vector<int> attempts(urls.size(), 0);
+    size_t completed = 0;
+    stats_ = {};
+
+    try {
+        while (completed < urls.size()) {
+            auto now = Clock::now();
+            while (!retries.empty() && retries.begin()->first <= now) {
+                ready.push_back(retries.begin()->second);
+                retries.erase(retries.begin());
+            }
+
+            for (auto& slot : slots_) {
+                if (slot.busy || ready.empty()) continue;
+                slot.index = ready.front();
+                ready.pop_front();
+                slot.body.clear();
+                slot.busy = true;
+                curl_easy_setopt(slot.handle, CURLOPT_URL, urls[slot.index].c_str());
+                curl_multi_add_handle(multi_, slot.handle);
+            }
+
+            int running = 0;
+            curl_multi_perform(multi_, &running);
+
+            CURLMsg* msg;
+            int queued = 0;
+            while ((msg = curl_multi_info_read(multi_, &queued))) {
+                if (msg->msg != CURLMSG_DONE) continue;
+
+                char* priv = nullptr;
+                curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &priv);
+                Slot* slot = reinterpret_cast<Slot*>(priv);
+                CURLcode res = msg->data.result;
+                long httpCode = 0;
+                curl_easy_getinfo(slot->handle, CURLINFO_RESPONSE_CODE, &httpCode);
+                release(*slot);
+
+                size_t index = slot->index;
+                if (res == CURLE_OK && httpCode >= 200 && httpCode < 300) {
+                    curl_off_t totalUs = 0;
+                    curl_easy_getinfo(slot->handle, CURLINFO_TOTAL_TIME_T, &totalUs);
+                    double latencyMs = static_cast<double>(totalUs) / 1000.0;
+                    ++stats_.responses;
+                    stats_.totalLatencyMs += latencyMs;
+                    stats_.maxLatencyMs = std::max(stats_.maxLatencyMs, latencyMs);
+                    onResponse(index, slot->body);
+                    ++completed;
+                    continue;
+                }
+
+                bool retryable = res != CURLE_OK || httpCode >= 500 || httpCode == 429;
+                std::string reason = res != CURLE_OK ? curl_easy_strerror(res) : "HTTP " + std::to_string(httpCode);
+                if (!retryable && onRejected) {
+                    onRejected(index, httpCode, slot->body);
+                    ++completed;
+                    continue;
+                }
+                if (!retryable) {
+                    throw OSRMRequestRejectedError(fmt::format("OSRM request {} rejected: {} {}",
+                                                               index, reason, slot->body), httpCode);
+                }
+                if (attempts[index] >= options_.maxRetries) {
+                    throw OSRMError(fmt::format("OSRM request {} failed after {} attempts: {}",
+                                                index, attempts[index] + 1, reason));
+                }
+
+                long delay = options_.retryBackoffMs << attempts[index];
+                ++attempts[index];
+                LOG_WARN("OSRM request {} failed ({}), retry {} in {} ms.", index, reason, attempts[index], delay);
+                retries.emplace(Clock::now() + std::chrono::milliseconds(delay), index);
+            }
+
+            if (completed == urls.size()) break;
+
+            // Sleep until there is socket activity or the next retry is due.
+            int waitMs = ready.empty() ? 100 : 0;
+            if (!retries.empty()) {
+                auto untilRetry = std::chrono::duration_cast<std::chrono::milliseconds>(retries.begin()->first - Clock::now());
+                waitMs = static_cast<int>(std::clamp<long>(untilRetry.count(), 0, waitMs));
+            }
+            curl_multi_poll(multi_, nullptr, 0, waitMs, nullptr);
+        }
+    } catch (...) {
+        for (auto& slot : slots_) release(slot);
+        throw;
+    }
+}
@@ -0,0 +1,132 @@
+#include "services/osrm_table_parser.h"
+#include <nlohmann/json.hpp>
+#include "utils/error.h"
+#include "utils/logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+
+// Depth 1 is the response object, 2 an annotation array, 3 one source row.
+class TableSaxHandler : public nlohmann::json_sax<json> {
+public:
+    TableSaxHandler(FlatMatrix& distances, FlatMatrix& durations, size_t destinationOffset, size_t sourceOffset)
+        : distances_(distances), durations_(durations),
+          destinationOffset_(destinationOffset), sourceOffset_(sourceOffset) {}
+
+    std::string code;
+    std::string error;
+    bool malformed = false;
+
+    bool null() override {
+        if (target_ && depth_ == 3) {
+            error = fmt::format("Unreachable route from source {} to destination {}",
+                                sourceOffset_ + row_, destinationOffset_ + col_);
+            return false;
+        }
+        return true;
+    }
+
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t value) override { return store(static_cast<double>(value)); }
+    bool number_unsigned(number_unsigned_t value) override { return store(static_cast<double>(value)); }
+    bool number_float(number_float_t value, const string_t&) override { return store(value); }
+
+    bool string(string_t& value) override {
+        if (depth_ == 1 && key_ == "code") code = value;
+        return true;
+    }
+
+    bool binary(binary_t&) override { return true; }
+
+    bool start_object(std::size_t) override {
+        ++depth_;
+        return true;
+    }
+
+    bool key(string_t& value) override {
+        if (depth_ == 1) key_ = value;
+        return true;
+    }
+
+    bool end_object() override {
+        --depth_;
+        return true;
+    }
+
+    bool start_array(std::size_t) override {
+        ++depth_;
+        if (depth_ == 2) {
+            target_ = key_ == "durations" ? &durations_ : key_ == "distances" ? &distances_ : nullptr;
+            row_ = 0;
+        } else if (depth_ == 3 && target_) {
+            col_ = 0;
+        }
+        return true;
+    }
+
+    bool end_array() override {
+        if (depth_ == 2) {
+            target_ = nullptr;
+        } else if (depth_ == 3 && target_) {
+            ++row_;
+        }
+        --depth_;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        malformed = true;
+        return false;
+    }
+
+private:
+    FlatMatrix& distances_;
+    FlatMatrix& durations_;
+    size_t destinationOffset_;
+    size_t sourceOffset_;
+
+    int depth_ = 0;
+    std::string key_;
+    FlatMatrix* target_ = nullptr;
+    size_t row_ = 0;
+    size_t col_ = 0;
+
+    bool store(double value) {
+        if (!target_ || depth_ != 3) return true;
+        size_t row = sourceOffset_ + row_;
+        size_t col = destinationOffset_ + col_;
+        if (row >= static_cast<size_t>(target_->height()) || col >= static_cast<size_t>(target_->width())) {
+            error = fmt::format("OSRM table entry ({}, {}) is outside the {}x{} matrix",
+                                row, col, target_->height(), target_->width());
+            return false;
+        }
+        (*target_)(static_cast<int>(row), static_cast<int>(col)) = value;
+        ++col_;
+        return true;
+    }
+};
+
+} // namespace
+
+bool parseOsrmTableResponse(const std::string& body,
+                            FlatMatrix& distances,
+                            FlatMatrix& durations,
+                            size_t destinationOffset,
+                            size_t sourceOffset) {
+    TableSaxHandler handler(distances, durations, destinationOffset, sourceOffset);
+    bool ok = json::sax_parse(body, &handler);
+    if (!ok) {
+        if (handler.malformed) {
+            throw std::runtime_error("Malformed OSRM table response: " + handler.error);
+        }
+        throw OSRMError(handler.error);
+    }
+
+    if (handler.code != "Ok") {
+        LOG_ERROR("OSRM error: {}", handler.code);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,177 @@
+#include "services/road_graph.h"
+#include <algorithm>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <unordered_map>
+#include "utils/error.h"
+#include "utils/logger.h"
+
+RoadGraph::RoadGraph(std::vector<Location> nodes, const std::vector<Edge>& edges)
+    : nodes_(std::move(nodes)), offsets_(nodes_.size() + 1, 0) {
+    if (nodes_.size() >= std::numeric_limits<uint32_t>::max()) {
+        throw InvalidValueError("Road graph has too many nodes: " + std::to_string(nodes_.size()));
+    }
+
+    // Counting sort by tail node.
+    for (const auto& edge : edges) {
+        if (edge.from >= nodes_.size() || edge.to >= nodes_.size()) {
+            throw InvalidValueError("Road graph edge references node " + std::to_string(std::max(edge.from, edge.to))
+                                    + " of " + std::to_string(nodes_.size()));
+        }
+        ++offsets_[edge.from + 1];
+    }
+    for (size_t v = 0; v < nodes_.size(); ++v) {
+        offsets_[v + 1] += offsets_[v];
+    }
+
+    heads_.resize(edges.size());
+    distances_.resize(edges.size());
+    durations_.resize(edges.size());
+    std::vector<uint32_t> next(offsets_.begin(), offsets_.end() - 1);
+    for (const auto& edge : edges) {
+        uint32_t slot = next[edge.from]++;
+        heads_[slot] = edge.to;
+        distances_[slot] = edge.distance;
+        durations_[slot] = edge.duration;
+    }
+}
+
+RoadGraph RoadGraph::loadCsv(const std::string& nodesPath, const std::string& edgesPath) {
+    std::ifstream nodesFile(nodesPath);
+    if (!nodesFile.is_open()) {
+        throw InvalidValueError("Failed to open road graph nodes file: " + nodesPath);
+    }
+    std::ifstream edgesFile(edgesPath);
+    if (!edgesFile.is_open()) {
+        throw InvalidValueError("Failed to open road graph edges file: " + edgesPath);
+    }
+
+    std::vector<Location> nodes;
+    std::unordered_map<int64_t, uint32_t> ids;
+    std::string line;
+    size_t lineNumber = 1;
+    std::getline(nodesFile, line);  // header
+    while (std::getline(nodesFile, line)) {
+        ++lineNumber;
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        std::string id, lat, lon;
+        std::getline(ss, id, ',');
+        std::getline(ss, lat, ',');
+        std::getline(ss, lon, ',');
+        try {
+            ids.emplace(std::stoll(id), static_cast<uint32_t>(nodes.size()));
+            nodes.emplace_back(std::stod(lat), std::stod(lon));
+        } catch (const std::exception&) {
+            throw InvalidValueError(nodesPath + ":" + std::to_string(lineNumber) + ": invalid node line: " + line);
+        }
+    }
+
+    std::vector<Edge> edges;
+    lineNumber = 1;
+    std::getline(edgesFile, line);  // header
+    while (std::getline(edgesFile, line)) {
+        ++lineNumber;
+        if (line.empty()) continue;
+        std::istringstream ss(line);
+        std::string from, to, distance, duration;
+        std::getline(ss, from, ',');
+        std::getline(ss, to, ',');
+        std::getline(ss, distance, ',');
+        std::getline(ss, duration, ',');
+        std::unordered_map<int64_t, uint32_t>::const_iterator tail, head;
+        Edge edge{};
+        try {
+            tail = ids.find(std::stoll(from));
+            head = ids.find(std::stoll(to));
+            edge.distance = std::stod(distance);
+            edge.duration = std::stod(duration);
+        } catch (const std::exception&) {
+            throw InvalidValueError(edgesPath + ":" + std::to_string(lineNumber) + ": invalid edge line: " + line);
+        }
+        if (tail == ids.end() || head == ids.end()) {
+            throw InvalidValueError(edgesPath + ":" + std::to_string(lineNumber) + ": unknown node in edge: " + line);
+        }
+        edge.from = tail->second;
+        edge.to = head->second;
+        edges.push_back(edge);
+    }
+
+    LOG_INFO("Loaded road graph with {} nodes and {} edges.", nodes.size(), edges.size());
+    return RoadGraph(std::move(nodes), edges);
+}
+
+std::vector<uint8_t> RoadGraph::largestComponent() const {
+    const uint32_t n = static_cast<uint32_t>(nodes_.size());
+    std::vector<uint8_t> mask(n, 0);
+    if (n == 0) return mask;
+
+    // Kosaraju, iteratively: finish order on the graph, then components on the reverse graph.
+    std::vector<uint32_t> order;
+    order.reserve(n);
+    std::vector<uint8_t> visited(n, 0);
+    std::vector<std::pair<uint32_t, uint32_t>> stack;
+    for (uint32_t root = 0; root < n; ++root) {
+        if (visited[root]) continue;
+        visited[root] = 1;
+        stack.emplace_back(root, offsets_[root]);
+        while (!stack.empty()) {
+            auto& [v, e] = stack.back();
+            if (e < offsets_[v + 1]) {
+                uint32_t w = heads_[e++];
+                if (!visited[w]) {
+                    visited[w] = 1;
+                    stack.emplace_back(w, offsets_[w]);
+                }
+            } else {
+                order.push_back(v);
+                stack.pop_back();
+            }
+        }
+    }
+
+    std::vector<uint32_t> reverseOffsets(n + 1, 0);
+    for (uint32_t head : heads_) ++reverseOffsets[head + 1];
+    for (uint32_t v = 0; v < n; ++v) reverseOffsets[v + 1] += reverseOffsets[v];
+    std::vector<uint32_t> reverseHeads(heads_.size());
+    std::vector<uint32_t> next(reverseOffsets.begin(), reverseOffsets.end() - 1);
+    for (uint32_t v = 0; v < n; ++v) {
+        for (uint32_t e = offsets_[v]; e < offsets_[v + 1]; ++e) {
+            reverseHeads[next[heads_[e]]++] = v;
+        }
+    }
+
+    constexpr uint32_t NONE = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> component(n, NONE);
+    std::vector<uint32_t> sizes;
+    std::vector<uint32_t> pending;
+    for (auto it = order.rbegin(); it != order.rend(); ++it) {
+        if (component[*it] != NONE) continue;
+        uint32_t id = static_cast<uint32_t>(sizes.size());
+        sizes.push_back(0);
+        component[*it] = id;
+        pending.push_back(*it);
+        while (!pending.empty()) {
+            uint32_t v = pending.back();
+            pending.pop_back();
+            ++sizes[id];
+            for (uint32_t e = reverseOffsets[v]; e < reverseOffsets[v + 1]; ++e) {
+                uint32_t w = reverseHeads[e];
+                if (component[w] == NONE) {
+                    component[w] = id;
+                    pending.push_back(w);
+                }
+            }
+        }
+    }
+
+    uint32_t largest = static_cast<uint32_t>(std::max_element(sizes.begin(), sizes.end()) - sizes.begin());
+    for (uint32_t v = 0; v < n; ++v) {
+        mask[v] = component[v] == largest;
+    }
+    if (sizes[largest] < n) {
+        LOG_INFO("Road graph: largest strongly connected component has {} of {} nodes.", sizes[largest], n);
+    }
+    return mask;
+}
@@ -0,0 +1,181 @@
+#include "services/route_geometry.h"
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+#include <unordered_set>
+#include <nlohmann/json.hpp>
+#include <fmt/format.h>
+#include "utils/datetime.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+using json = nlohmann::json;
+
+namespace {
+RouteGeometry routeFromJson(const json& route) {
+    RouteGeometry geometry;
+    geometry.duration = route.at("duration").get<double>();
+    geometry.distance = route.at("distance").get<double>();
+    for (const auto& point : route.at("coordinates")) {
+        geometry.coordinates.emplace_back(point.at(0).get<double>(), point.at(1).get<double>());
+    }
+    return geometry;
+}
+
+// routes.json has always carried local wall-clock time written as if it were UTC
+// (process_csv.py parsed the naive report timestamps), keep that so viewers line up.
+double wallClockSeconds(std::time_t t) {
+    return static_cast<double>(t + utils::TimeZone::local().utcOffset(t));
+}
+}
+
+RouteGeometryCache::RouteGeometryCache(std::string path) : path_(std::move(path)) {
+    if (path_.empty()) return;
+    std::ifstream file(path_);
+    if (!file.is_open()) return;
+
+    std::string line;
+    size_t skipped = 0;
+    while (std::getline(file, line)) {
+        if (line.empty()) continue;
+        json entry = json::parse(line, nullptr, false);
+        if (entry.is_discarded() || !entry.contains("key")) {
+            ++skipped;
+            continue;
+        }
+        try {
+            routes_.insert_or_assign(entry["key"].get<std::string>(), routeFromJson(entry));
+        } catch (const json::exception&) {
+            ++skipped;
+        }
+    }
+    if (skipped > 0) {
+        LOG_WARN("Skipped {} unreadable lines of route cache {}", skipped, path_);
+    }
+    LOG_INFO("Loaded {} cached routes from {}", routes_.size(), path_);
+}
+
+std::string RouteGeometryCache::key(const Location& from, const Location& to) {
+    return locationToString(from) + ";" + locationToString(to);
+}
+
+const RouteGeometry* RouteGeometryCache::find(const Location& from, const Location& to) const {
+    auto it = routes_.find(key(from, to));
+    return it == routes_.end() ? nullptr : &it->second;
+}
+
+size_t RouteGeometryCache::fetchMissing(const std::vector<std::pair<Location, Location>>& pairs,
+                                        const std::string& baseUrl,
+                                        const OsrmFetchOptions& options) {
+    std::vector<std::string> keys, urls;
+    std::unordered_set<std::string> queued;
+    for (const auto& [from, to] : pairs) {
+        std::string pairKey = key(from, to);
+        if (routes_.count(pairKey) || !queued.insert(pairKey).second) continue;
+        urls.push_back(baseUrl + "/route/v1/driving/" + pairKey + "?geometries=geojson&overview=full");
+        keys.push_back(std::move(pairKey));
+    }
+    if (urls.empty()) {
+        LOG_INFO("All {} route pairs are cached.", pairs.size());
+        return 0;
+    }
+
+    std::ofstream out;
+    if (!path_.empty()) {
+        out.open(path_, std::ios::app);
+        if (!out.is_open()) {
+            LOG_WARN("Cannot append to route cache {}, routes are kept for this run only", path_);
+        }
+    }
+
+    size_t added = 0, rejected = 0;
+    OsrmFetcher fetcher(options);
+    fetcher.fetchAll(urls, [&](size_t index, const std::string& body) {
+        json response = json::parse(body, nullptr, false);
+        if (response.is_discarded() || response.value("code", "") != "Ok" || response["routes"].empty()) {
+            ++rejected;
+            return;
+        }
+        const json& route = response["routes"][0];
+        json entry = {
+            {"key", keys[index]},
+            {"duration", route.at("duration")},
+            {"distance", route.at("distance")},
+            {"coordinates", route.at("geometry").at("coordinates")}
+        };
+        routes_.insert_or_assign(keys[index], routeFromJson(entry));
+        if (out.is_open()) out << entry.dump() << '\n';
+        ++added;
+    }, [&](size_t index, long status, const std::string&) {
+        LOG_DEBUG("OSRM rejected route {} with status {}", keys[index], status);
+        ++rejected;
+    });
+
+    if (rejected > 0) {
+        LOG_WARN("OSRM returned no route for {} of {} pairs", rejected, urls.size());
+    }
+    LOG_INFO("Fetched {} routes ({} pairs, {} were cached) in {:.1f} ms mean latency.",
+             added, pairs.size(), pairs.size() - urls.size(), fetcher.lastStats().meanLatencyMs());
+    return added;
+}
+
+size_t writeRoutesGeoJson(const std::vector<RouteTrip>& trips,
+                          const RouteGeometryCache& cache,
+                          const std::string& path) {
+    std::vector<const RouteTrip*> sorted;
+    sorted.reserve(trips.size());
+    for (const auto& trip : trips) sorted.push_back(&trip);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const RouteTrip* a, const RouteTrip* b) {
+        return std::tie(a->incidentId, a->stationId, a->direction, a->departure)
+             < std::tie(b->incidentId, b->stationId, b->direction, b->departure);
+    });
+
+    std::ofstream file(path);
+    if (!file.is_open()) {
+        throw InvalidValueError("Cannot write routes GeoJSON to " + path);
+    }
+
+    std::string buffer;
+    size_t features = 0, missing = 0;
+    file << R"({"type": "FeatureCollection", "features": [)";
+    for (size_t begin = 0; begin < sorted.size();) {
+        const RouteTrip& first = *sorted[begin];
+        size_t end = begin;
+        while (end < sorted.size() && sorted[end]->incidentId == first.incidentId
+               && sorted[end]->stationId == first.stationId && sorted[end]->direction == first.direction) {
+            ++end;
+        }
+
+        buffer.clear();
+        double timestamp = wallClockSeconds(first.departure);
+        for (size_t t = begin; t < end; ++t) {
+            const RouteGeometry* route = cache.find(sorted[t]->from, sorted[t]->to);
+            if (route == nullptr || route->coordinates.empty()) {
+                ++missing;
+                continue;
+            }
+            double secondsPerPoint = route->duration / static_cast<double>(route->coordinates.size());
+            for (const auto& [lon, lat] : route->coordinates) {
+                timestamp += secondsPerPoint;
+                fmt::format_to(std::back_inserter(buffer), "{}[{}, {}, 0, {}]",
+                               buffer.empty() ? "" : ", ", lon, lat, static_cast<long long>(timestamp));
+            }
+        }
+        if (!buffer.empty()) {
+            file << (features ? ", " : "")
+                 << fmt::format(R"({{"type": "Feature", "geometry": {{"type": "LineString", "coordinates": [{}]}}, )"
+                                R"("properties": {{"station_id": "{}", "incident_id": "{}", "direction": "{}"}}}})",
+                                buffer, first.stationId, first.incidentId, first.direction);
+            ++features;
+        }
+        begin = end;
+    }
+    file << "]}";
+
+    if (missing > 0) {
+        LOG_WARN("{} trips have no route and were left out of {}", missing, path);
+    }
+    LOG_INFO("Wrote {} route features to {}", features, path);
+    return features;
+}
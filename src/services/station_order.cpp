@@ -0,0 +1,81 @@
+#include "services/station_order.h"
+#include <fstream>
+#include "utils/logger.h"
+
+StationOrderIndex::StationOrderIndex(const double* durationMatrix, int width, int height, int k, size_t numThreads) {
+    build(width, height, k, [durationMatrix, width](int row, int col) {
+        return durationMatrix[static_cast<size_t>(row) * width + col];
+    }, numThreads);
+}
+
+StationOrderIndex::StationOrderIndex(const std::vector<std::vector<double>>& durationMatrix, int k, size_t numThreads) {
+    int height = static_cast<int>(durationMatrix.size());
+    int width = height > 0 ? static_cast<int>(durationMatrix[0].size()) : 0;
+    build(width, height, k, [&durationMatrix](int row, int col) {
+        return durationMatrix[row][col];
+    }, numThreads);
+}
+
+StationOrderIndex::StationOrderIndex(const MatrixView& durationMatrix, int k, size_t numThreads) {
+    buildFromColumns(durationMatrix.width(), durationMatrix.height(), k, [&durationMatrix](int col, double* out) {
+        durationMatrix.column(col, out);
+    }, numThreads);
+}
+
+/*
+* @brief Saves the index next to the matrices, using the same int header convention.
+* @param filename The path to the binary file.
+* @return true on success.
+*/
+bool StationOrderIndex::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open station order file for writing: {}", filename);
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&width_), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&height_), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&k_), sizeof(int));
+    out.write(reinterpret_cast<const char*>(stations_.data()), sizeof(int32_t) * stations_.size());
+    out.write(reinterpret_cast<const char*>(durations_.data()), sizeof(double) * durations_.size());
+    return static_cast<bool>(out);
+}
+
+/*
+* @brief Loads an index written by save().
+* @param filename The path to the binary file.
+* @return true on success, false if the file is missing or truncated.
+*/
+bool StationOrderIndex::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    int width = 0, height = 0, k = 0;
+    in.read(reinterpret_cast<char*>(&width), sizeof(int));
+    in.read(reinterpret_cast<char*>(&height), sizeof(int));
+    in.read(reinterpret_cast<char*>(&k), sizeof(int));
+    if (!in || width < 0 || height < 0 || k < 0 || k > height) {
+        LOG_ERROR("Invalid station order header in {}", filename);
+        return false;
+    }
+
+    size_t entries = static_cast<size_t>(width) * k;
+    std::vector<int32_t> stations(entries);
+    std::vector<double> durations(entries);
+    in.read(reinterpret_cast<char*>(stations.data()), sizeof(int32_t) * entries);
+    in.read(reinterpret_cast<char*>(durations.data()), sizeof(double) * entries);
+    if (!in) {
+        LOG_ERROR("Station order file {} is truncated", filename);
+        return false;
+    }
+
+    width_ = width;
+    height_ = height;
+    k_ = k;
+    stations_ = std::move(stations);
+    durations_ = std::move(durations);
+    return true;
+}
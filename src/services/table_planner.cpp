@@ -0,0 +1,132 @@
+#include "services/table_planner.h"
+#include <algorithm>
+#include <unordered_map>
+#include "config/EnvLoader.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+namespace {
+// One source and one destination.
+constexpr size_t MIN_BUDGET = 2;
+
+size_t digits(size_t value) {
+    size_t count = 1;
+    while (value >= 10) {
+        value /= 10;
+        ++count;
+    }
+    return count;
+}
+}
+
+TablePlannerOptions TablePlannerOptions::fromEnv() {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    TablePlannerOptions options;
+    if (!env) return options;
+    options.maxCoordinates = std::stoul(env->get("OSRM_MAX_TABLE_SIZE", "1000"));
+    options.maxUrlLength = std::stoul(env->get("OSRM_MAX_URL_LENGTH", "8192"));
+    options.targetLatencyMs = std::stol(env->get("OSRM_TARGET_LATENCY_MS", "2000"));
+    return options;
+}
+
+UniqueCoordinates UniqueCoordinates::from(const std::vector<Location>& locations) {
+    UniqueCoordinates unique;
+    std::unordered_map<std::string, int> seen;
+    unique.index.reserve(locations.size());
+    for (const auto& location : locations) {
+        std::string coordinate = locationToString(location);
+        auto [it, inserted] = seen.try_emplace(coordinate, static_cast<int>(unique.coordinates.size()));
+        if (inserted) {
+            unique.coordinates.push_back(std::move(coordinate));
+        }
+        unique.index.push_back(it->second);
+    }
+    return unique;
+}
+
+TablePlanner::TablePlanner(size_t sources, size_t destinations, size_t coordinateLimit, const TablePlannerOptions& options)
+    : sources_(sources), destinations_(destinations), limit_(coordinateLimit),
+      targetLatencyMs_(options.targetLatencyMs) {
+    if (limit_ < MIN_BUDGET) {
+        throw InvalidValueError("OSRM table limit of " + std::to_string(limit_)
+                                + " coordinates cannot hold a source and a destination");
+    }
+
+    budget_ = limit_;
+    if (options.initialDestinations > 0) {
+        size_t tileSources = std::min(sources_, std::max<size_t>(1, limit_ / 2));
+        budget_ = std::clamp(tileSources + options.initialDestinations, MIN_BUDGET, limit_);
+    }
+
+    if (sources_ > 0 && destinations_ > 0) {
+        pending_.push_back({0, sources_, 0, destinations_});
+    }
+}
+
+size_t TablePlanner::urlCoordinateLimit(size_t maxUrlLength, size_t overhead, size_t coordinateLength) {
+    if (maxUrlLength <= overhead) {
+        return 0;
+    }
+    size_t available = maxUrlLength - overhead;
+
+    // Every coordinate costs "lon,lat;" plus "index;" in sources or destinations.
+    for (size_t indexDigits = 1;; ++indexDigits) {
+        size_t count = available / (coordinateLength + indexDigits + 2);
+        if (count == 0 || digits(count - 1) <= indexDigits) {
+            return count;
+        }
+    }
+}
+
+std::pair<size_t, size_t> TablePlanner::tileShape() const {
+    size_t tileSources = std::min(sources_, std::max<size_t>(1, budget_ / 2));
+    size_t tileDestinations = std::max<size_t>(1, budget_ - tileSources);
+    return {tileSources, tileDestinations};
+}
+
+std::vector<TableTile> TablePlanner::nextWave(size_t maxTiles) {
+    auto [tileSources, tileDestinations] = tileShape();
+    std::vector<TableTile> tiles;
+    while (tiles.size() < maxTiles && !pending_.empty()) {
+        TableTile area = pending_.front();
+        pending_.pop_front();
+
+        size_t sourceEnd = std::min(area.sourceEnd, area.sourceBegin + tileSources);
+        size_t destinationEnd = std::min(area.destinationEnd, area.destinationBegin + tileDestinations);
+        tiles.push_back({area.sourceBegin, sourceEnd, area.destinationBegin, destinationEnd});
+
+        // Finish the current source strip before moving down to the next one.
+        if (sourceEnd < area.sourceEnd) {
+            pending_.push_front({sourceEnd, area.sourceEnd, area.destinationBegin, area.destinationEnd});
+        }
+        if (destinationEnd < area.destinationEnd) {
+            pending_.push_front({area.sourceBegin, sourceEnd, destinationEnd, area.destinationEnd});
+        }
+    }
+    return tiles;
+}
+
+void TablePlanner::requeue(const TableTile& tile) {
+    pending_.push_front(tile);
+}
+
+void TablePlanner::recordLatency(double meanLatencyMs) {
+    size_t previous = budget_;
+    if (meanLatencyMs > targetLatencyMs_) {
+        budget_ = std::max(MIN_BUDGET, budget_ * 3 / 4);
+    } else if (meanLatencyMs < targetLatencyMs_ / 2.0) {
+        budget_ = std::min(limit_, budget_ + budget_ / 2);
+    }
+    if (budget_ != previous) {
+        LOG_DEBUG("OSRM table budget {} -> {} coordinates (mean latency {:.0f} ms).", previous, budget_, meanLatencyMs);
+    }
+}
+
+bool TablePlanner::shrink() {
+    if (budget_ <= MIN_BUDGET) {
+        return false;
+    }
+    budget_ = std::max(MIN_BUDGET, budget_ / 2);
+    LOG_WARN("OSRM rejected a table request, lowering the budget to {} coordinates.", budget_);
+    return true;
+}
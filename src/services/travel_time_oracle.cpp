@@ -0,0 +1,157 @@
+#include "services/travel_time_oracle.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include "services/chunks.h"
+#include "utils/constants.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+
+GridSpec GridSpec::fromBounds(double minLat, double minLon, double maxLat, double maxLon, double cellSizeMeters) {
+    if (cellSizeMeters <= 0.0 || maxLat < minLat || maxLon < minLon) {
+        throw InvalidValueError("Invalid grid bounds or cell size");
+    }
+
+    // Meters to degrees on a sphere, longitude shrinks with the cosine of the latitude.
+    const double metersPerDegree = constants::EARTH_RADIUS_KM * 1000.0 * M_PI / 180.0;
+    double midLat = (minLat + maxLat) / 2.0;
+
+    GridSpec grid;
+    grid.minLat = minLat;
+    grid.minLon = minLon;
+    grid.cellLat = cellSizeMeters / metersPerDegree;
+    grid.cellLon = cellSizeMeters / (metersPerDegree * std::cos(midLat * M_PI / 180.0));
+    grid.rows = std::max(1, static_cast<int>(std::ceil((maxLat - minLat) / grid.cellLat)));
+    grid.cols = std::max(1, static_cast<int>(std::ceil((maxLon - minLon) / grid.cellLon)));
+    return grid;
+}
+
+int GridSpec::cellIndex(double lat, double lon) const noexcept {
+    double r = std::floor((lat - minLat) / cellLat);
+    double c = std::floor((lon - minLon) / cellLon);
+    if (r < 0 || c < 0 || r >= rows || c >= cols) {
+        return -1;
+    }
+    return static_cast<int>(r) * cols + static_cast<int>(c);
+}
+
+Location GridSpec::cellCenter(int cell) const noexcept {
+    int r = cell / cols;
+    int c = cell % cols;
+    return Location(minLat + (r + 0.5) * cellLat, minLon + (c + 0.5) * cellLon);
+}
+
+TravelTimeOracle::TravelTimeOracle(const GridSpec& grid, const std::vector<std::vector<double>>& stationToCell)
+    : grid_(grid), stations_(static_cast<int>(stationToCell.size())) {
+    size_t cells = static_cast<size_t>(grid_.cellCount());
+    for (const auto& row : stationToCell) {
+        if (row.size() != cells) {
+            throw MismatchError("Station to cell matrix has " + std::to_string(row.size())
+                                + " columns, grid has " + std::to_string(cells) + " cells");
+        }
+    }
+
+    // Transpose to cell-major so a lookup reads one contiguous block.
+    durations_.resize(cells * stations_);
+    for (size_t cell = 0; cell < cells; ++cell) {
+        for (int station = 0; station < stations_; ++station) {
+            durations_[cell * stations_ + station] = stationToCell[station][cell];
+        }
+    }
+}
+
+TravelTimeOracle::TravelTimeOracle(const GridSpec& grid, const MatrixView& stationToCell)
+    : grid_(grid), stations_(stationToCell.height()) {
+    if (stationToCell.width() != grid_.cellCount()) {
+        throw MismatchError("Station to cell matrix has " + std::to_string(stationToCell.width())
+                            + " columns, grid has " + std::to_string(grid_.cellCount()) + " cells");
+    }
+
+    // A matrix column is exactly one cell's block.
+    durations_.resize(static_cast<size_t>(grid_.cellCount()) * stations_);
+    for (int cell = 0; cell < grid_.cellCount(); ++cell) {
+        stationToCell.column(cell, durations_.data() + static_cast<size_t>(cell) * stations_);
+    }
+}
+
+TravelTimeOracle TravelTimeOracle::buildFromOSRM(const std::vector<Location>& stations, const GridSpec& grid, size_t chunkSize) {
+    std::vector<Location> centers;
+    centers.reserve(grid.cellCount());
+    for (int cell = 0; cell < grid.cellCount(); ++cell) {
+        centers.emplace_back(grid.cellCenter(cell));
+    }
+
+    LOG_INFO("Building travel time oracle: {} stations x {} cells ({}x{}).",
+             stations.size(), centers.size(), grid.rows, grid.cols);
+    auto result = generate_osrm_table_chunks(stations, centers, chunkSize);
+    return TravelTimeOracle(grid, result.second);
+}
+
+const double* TravelTimeOracle::durations(const Location& location) const noexcept {
+    int cell = grid_.cellIndex(location.lat, location.lon);
+    if (cell < 0 || durations_.empty()) {
+        return nullptr;
+    }
+    return cellDurations(cell);
+}
+
+/*
+* @brief Saves the oracle, using the same int header convention as the matrix files.
+* @param filename The path to the binary file.
+* @return true on success.
+*/
+bool TravelTimeOracle::save(const std::string& filename) const {
+    std::ofstream out(filename, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open travel time oracle file for writing: {}", filename);
+        return false;
+    }
+
+    out.write(reinterpret_cast<const char*>(&grid_.rows), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&grid_.cols), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&stations_), sizeof(int));
+    out.write(reinterpret_cast<const char*>(&grid_.minLat), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&grid_.minLon), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&grid_.cellLat), sizeof(double));
+    out.write(reinterpret_cast<const char*>(&grid_.cellLon), sizeof(double));
+    out.write(reinterpret_cast<const char*>(durations_.data()), sizeof(double) * durations_.size());
+    return static_cast<bool>(out);
+}
+
+/*
+* @brief Loads an oracle written by save().
+* @param filename The path to the binary file.
+* @return true on success, false if the file is missing or truncated.
+*/
+bool TravelTimeOracle::load(const std::string& filename) {
+    std::ifstream in(filename, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+
+    GridSpec grid;
+    int stations = 0;
+    in.read(reinterpret_cast<char*>(&grid.rows), sizeof(int));
+    in.read(reinterpret_cast<char*>(&grid.cols), sizeof(int));
+    in.read(reinterpret_cast<char*>(&stations), sizeof(int));
+    in.read(reinterpret_cast<char*>(&grid.minLat), sizeof(double));
+    in.read(reinterpret_cast<char*>(&grid.minLon), sizeof(double));
+    in.read(reinterpret_cast<char*>(&grid.cellLat), sizeof(double));
+    in.read(reinterpret_cast<char*>(&grid.cellLon), sizeof(double));
+    if (!in || grid.rows <= 0 || grid.cols <= 0 || stations < 0 || grid.cellLat <= 0.0 || grid.cellLon <= 0.0) {
+        LOG_ERROR("Invalid travel time oracle header in {}", filename);
+        return false;
+    }
+
+    std::vector<double> durations(static_cast<size_t>(grid.cellCount()) * stations);
+    in.read(reinterpret_cast<char*>(durations.data()), sizeof(double) * durations.size());
+    if (!in) {
+        LOG_ERROR("Travel time oracle file {} is truncated", filename);
+        return false;
+    }
+
+    grid_ = grid;
+    stations_ = stations;
+    durations_ = std::move(durations);
+    return true;
+}
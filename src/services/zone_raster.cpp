@@ -0,0 +1,218 @@
+#include "services/zone_raster.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include "utils/logger.h"
+#include "utils/parallel.h"
+
+namespace {
+constexpr char MAGIC[4] = {'F', 'S', 'Z', 'R'};
+constexpr uint32_t VERSION = 1;
+constexpr unsigned MAX_LEVELS = 12;
+
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t side;
+    uint32_t polygonCount;
+    uint64_t sourceHash;
+    double minX, minY, cellX, cellY, margin;
+    uint32_t mixedCount;
+    uint32_t mixedPolygonCount;
+};
+
+template <typename T>
+bool readArray(std::ifstream& in, std::vector<T>& values, size_t count) {
+    values.resize(count);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()),
+                                     static_cast<std::streamsize>(count * sizeof(T))));
+}
+
+template <typename T>
+void writeArray(std::ofstream& out, const std::vector<T>& values) {
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+}
+
+ZoneRaster::ZoneRaster(std::vector<Polygon> polygons, unsigned levels)
+    : polygons_(std::move(polygons)) {
+    if (polygons_.empty()) {
+        return;
+    }
+    side_ = size_t{1} << std::min(levels, MAX_LEVELS);
+
+    Box extent;
+    bg::envelope(polygons_.front(), extent);
+    for (const auto& polygon : polygons_) {
+        Box box;
+        bg::envelope(polygon, box);
+        bg::expand(extent, box);
+    }
+    double scale = std::max({1.0, std::abs(extent.min_corner().x()), std::abs(extent.min_corner().y()),
+                             std::abs(extent.max_corner().x()), std::abs(extent.max_corner().y())});
+    margin_ = scale * 1e-9;
+    minX_ = extent.min_corner().x() - margin_;
+    minY_ = extent.min_corner().y() - margin_;
+    cellX_ = (extent.max_corner().x() + margin_ - minX_) / static_cast<double>(side_);
+    cellY_ = (extent.max_corner().y() + margin_ - minY_) / static_cast<double>(side_);
+
+    cells_.assign(side_ * side_, NONE);
+    mixedBegin_.assign(1, 0);
+    std::vector<uint32_t> all(polygons_.size());
+    for (uint32_t i = 0; i < all.size(); ++i) all[i] = i;
+    classify(0, 0, side_, all);
+    LOG_INFO("Zone raster: {}x{} cells, {} mixed, over {} zones.", side_, side_, mixedCellCount(), polygons_.size());
+}
+
+Box ZoneRaster::cellBox(size_t col, size_t row, size_t size) const {
+    return Box(Point(minX_ + static_cast<double>(col) * cellX_ - margin_,
+                     minY_ + static_cast<double>(row) * cellY_ - margin_),
+               Point(minX_ + static_cast<double>(col + size) * cellX_ + margin_,
+                     minY_ + static_cast<double>(row + size) * cellY_ + margin_));
+}
+
+void ZoneRaster::classify(size_t col, size_t row, size_t size, const std::vector<uint32_t>& candidates) {
+    Box box = cellBox(col, row, size);
+    std::vector<uint32_t> touching;
+    for (uint32_t candidate : candidates) {
+        if (bg::intersects(box, polygons_[candidate])) touching.push_back(candidate);
+    }
+    if (touching.empty()) {
+        return;  // cells start as NONE
+    }
+    if (touching.size() == 1) {
+        Polygon square;
+        bg::convert(box, square);
+        if (bg::covered_by(square, polygons_[touching.front()])) {
+            for (size_t r = row; r < row + size; ++r) {
+                std::fill_n(cells_.begin() + static_cast<std::ptrdiff_t>(r * side_ + col), size,
+                            static_cast<int32_t>(touching.front()));
+            }
+            return;
+        }
+    }
+    if (size == 1) {
+        cells_[row * side_ + col] = -static_cast<int32_t>(mixedCellCount()) - 2;
+        mixedPolygons_.insert(mixedPolygons_.end(), touching.begin(), touching.end());
+        mixedBegin_.push_back(static_cast<uint32_t>(mixedPolygons_.size()));
+        return;
+    }
+    size_t half = size / 2;
+    classify(col, row, half, touching);
+    classify(col + half, row, half, touching);
+    classify(col, row + half, half, touching);
+    classify(col + half, row + half, half, touching);
+}
+
+std::optional<size_t> ZoneRaster::locate(const Point& point) const {
+    double x = point.x(), y = point.y();
+    double maxX = minX_ + cellX_ * static_cast<double>(side_);
+    double maxY = minY_ + cellY_ * static_cast<double>(side_);
+    // Also false for NaN; the extent is padded, nothing outside it is covered.
+    if (side_ == 0 || !(x >= minX_ && x <= maxX && y >= minY_ && y <= maxY)) {
+        return std::nullopt;
+    }
+    size_t col = std::min(static_cast<size_t>((x - minX_) / cellX_), side_ - 1);
+    size_t row = std::min(static_cast<size_t>((y - minY_) / cellY_), side_ - 1);
+    int32_t cell = cells_[row * side_ + col];
+    if (cell >= 0) {
+        return static_cast<size_t>(cell);
+    }
+    if (cell == NONE) {
+        return std::nullopt;
+    }
+    size_t mixed = static_cast<size_t>(-(cell + 2));
+    for (uint32_t i = mixedBegin_[mixed]; i < mixedBegin_[mixed + 1]; ++i) {
+        if (bg::covered_by(point, polygons_[mixedPolygons_[i]])) {
+            return mixedPolygons_[i];
+        }
+    }
+    return std::nullopt;
+}
+
+std::vector<std::optional<size_t>> ZoneRaster::locate(const std::vector<Point>& points, size_t threads) const {
+    std::vector<std::optional<size_t>> result(points.size());
+    utils::parallelFor(points.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            result[i] = locate(points[i]);
+        }
+    }, threads);
+    return result;
+}
+
+bool ZoneRaster::save(const std::string& path, uint64_t sourceHash) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        LOG_ERROR("Failed to open zone raster for writing: {}", path);
+        return false;
+    }
+    FileHeader header{};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.side = static_cast<uint32_t>(side_);
+    header.polygonCount = static_cast<uint32_t>(polygons_.size());
+    header.sourceHash = sourceHash;
+    header.minX = minX_;
+    header.minY = minY_;
+    header.cellX = cellX_;
+    header.cellY = cellY_;
+    header.margin = margin_;
+    header.mixedCount = static_cast<uint32_t>(mixedCellCount());
+    header.mixedPolygonCount = static_cast<uint32_t>(mixedPolygons_.size());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    writeArray(out, cells_);
+    writeArray(out, mixedBegin_);
+    writeArray(out, mixedPolygons_);
+    return static_cast<bool>(out);
+}
+
+bool ZoneRaster::load(const std::string& path, uint64_t sourceHash) {
+    std::ifstream in(path, std::ios::binary);
+    FileHeader header{};
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))
+        || std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION
+        || header.sourceHash != sourceHash || header.polygonCount != polygons_.size()) {
+        return false;
+    }
+    if (!readArray(in, cells_, size_t{header.side} * header.side)
+        || !readArray(in, mixedBegin_, size_t{header.mixedCount} + 1)
+        || !readArray(in, mixedPolygons_, header.mixedPolygonCount)
+        || mixedBegin_.back() != header.mixedPolygonCount) {
+        return false;
+    }
+    for (uint32_t polygon : mixedPolygons_) {
+        if (polygon >= polygons_.size()) return false;
+    }
+    for (int32_t cell : cells_) {
+        if (cell >= static_cast<int64_t>(polygons_.size()) || -static_cast<int64_t>(cell) - 2 >= header.mixedCount) {
+            return false;
+        }
+    }
+    side_ = header.side;
+    minX_ = header.minX;
+    minY_ = header.minY;
+    cellX_ = header.cellX;
+    cellY_ = header.cellY;
+    margin_ = header.margin;
+    return true;
+}
+
+ZoneRaster ZoneRaster::openOrBuild(const std::string& path, std::vector<Polygon> polygons, uint64_t sourceHash,
+                                   unsigned levels) {
+    if (!path.empty() && std::ifstream(path)) {
+        ZoneRaster raster;
+        raster.polygons_ = polygons;
+        if (raster.load(path, sourceHash) && raster.side_ == (size_t{1} << std::min(levels, MAX_LEVELS))) {
+            LOG_INFO("Using zone raster {}", path);
+            return raster;
+        }
+        LOG_INFO("Zone raster {} was built from other zones, rebuilding.", path);
+    }
+
+    ZoneRaster raster(std::move(polygons), levels);
+    if (!path.empty()) {
+        raster.save(path, sourceHash);
+    }
+    return raster;
+}
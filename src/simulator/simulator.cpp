@@ -1,7 +1,9 @@
 #include "simulator/simulator.h"
 #include "simulator/action.h"
 #include "utils/helpers.h"
+#include "utils/datetime.h"
 #include "utils/logger.h"
+#include "services/route_geometry.h"
 
 std::vector<ApparatusType> apparatusTypes = {
     ApparatusType::Engine,
@@ -108,12 +110,16 @@ void Simulator::writeReportToCSV() {
             continue; // Skip this incident
         }
         // TODO: Fix apparatus count and add type.
+        char reported[19], responded[19], resolved[19];
+        utils::formatDateTime(incident.reportTime, reported);
+        utils::formatDateTime(incident.timeRespondedTo, responded);
+        utils::formatDateTime(incident.resolvedTime, resolved);
         csv << std::fixed << std::setprecision(6);
         csv << incident.incidentIndex << ","
             << incident.incident_id << ","
-            << utils::formatTime(incident.reportTime) << ","
-            << utils::formatTime(incident.timeRespondedTo) << ","
-            << utils::formatTime(incident.resolvedTime);
+            << std::string_view(reported, 19) << ","
+            << std::string_view(responded, 19) << ","
+            << std::string_view(resolved, 19);
 
          // Output required and received for each apparatus type
          for (const auto& type : apparatusTypes) {
@@ -162,8 +168,10 @@ void Simulator::writeActions() {
 
         // Get the incident for dispatch time
         const Incident& incident = activeIncidents.at(action.payload.incidentIndex);
+        char responded[19];
+        utils::formatDateTime(incident.timeRespondedTo, responded);
         fmt::format_to(std::back_inserter(metrics), "{},{},{}", 
-            utils::formatTime(incident.timeRespondedTo), station.getStationIndex(), station.getFacilityName());
+            std::string_view(responded, 19), station.getStationIndex(), station.getFacilityName());
 
         for (const auto& type : apparatusTypes) {
             int dispatched = 0;
@@ -183,3 +191,33 @@ void Simulator::writeActions() {
     }
     station_csv.close();
 }
+
+void Simulator::writeRoutes() {
+    auto env = EnvLoader::getInstance();
+    std::unordered_map<int, Incident>& activeIncidents = state_.getActiveIncidents();
+    activeIncidents.insert(state_.doneIncidents_.begin(), state_.doneIncidents_.end());
+
+    std::vector<RouteTrip> trips;
+    std::vector<std::pair<Location, Location>> pairs;
+    for (size_t i = 0; i < action_history_.size(); ++i) {
+        const auto& action = action_history_[i];
+        if (action.type != StationActionType::Dispatch) continue;
+        const Station& station = station_history_[i];
+        const Incident& incident = activeIncidents.at(action.payload.incidentIndex);
+        // Same incidents as the incident report.
+        if (incident.resolvedTime < 0 || incident.resolvedTime > 2147483647) continue;
+
+        Location stationLocation = station.getLocation();
+        Location incidentLocation(incident.lat, incident.lon);
+        trips.push_back({incident.incident_id, station.getStationIndex(), "to_fire",
+                         incident.timeRespondedTo, stationLocation, incidentLocation});
+        trips.push_back({incident.incident_id, station.getStationIndex(), "from_fire",
+                         incident.resolvedTime, incidentLocation, stationLocation});
+        pairs.emplace_back(stationLocation, incidentLocation);
+        pairs.emplace_back(incidentLocation, stationLocation);
+    }
+
+    RouteGeometryCache cache(env->get("ROUTE_CACHE_PATH", "../logs/route_cache.jsonl"));
+    cache.fetchMissing(pairs, env->get("BASE_OSRM_URL", "http://localhost:8080"));
+    writeRoutesGeoJson(trips, cache, env->get("ROUTES_GEOJSON_PATH", "../logs/routes.json"));
+}
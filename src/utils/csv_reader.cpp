@@ -0,0 +1,86 @@
+#include "utils/csv_reader.h"
+#include <algorithm>
+#include <charconv>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace utils {
+namespace {
+// Below this a file is parsed on one thread, spawning workers would cost more.
+constexpr size_t MIN_CHUNK_BYTES = 1 << 16;
+
+std::string_view trimLeft(std::string_view token) {
+    size_t start = token.find_first_not_of(" \t");
+    return start == std::string_view::npos ? std::string_view{} : token.substr(start);
+}
+}
+
+bool parseInt(std::string_view token, int& value) {
+    token = trimLeft(token);
+    if (!token.empty() && token.front() == '+') token.remove_prefix(1);
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() && result.ptr != token.data();
+}
+
+bool parseDouble(std::string_view token, double& value) {
+    token = trimLeft(token);
+    if (!token.empty() && token.front() == '+') token.remove_prefix(1);
+    auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    return result.ec == std::errc() && result.ptr != token.data();
+}
+
+CsvFile::CsvFile(const std::string& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return;
+    struct stat info {};
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        return;
+    }
+    size_ = static_cast<size_t>(info.st_size);
+    if (size_ > 0) {
+        void* map = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (map == MAP_FAILED) {
+            ::close(fd);
+            size_ = 0;
+            return;
+        }
+        ::madvise(map, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(map);
+    }
+    ::close(fd);
+    open_ = true;
+
+    std::string_view all(data_, size_);
+    size_t newline = all.find('\n');
+    header_ = all.substr(0, newline);
+    if (!header_.empty() && header_.back() == '\r') header_.remove_suffix(1);
+    body_ = newline == std::string_view::npos ? std::string_view{} : all.substr(newline + 1);
+}
+
+CsvFile::~CsvFile() {
+    if (data_ != nullptr) {
+        ::munmap(const_cast<char*>(data_), size_);
+    }
+}
+
+std::vector<std::string_view> CsvFile::split(size_t count) const {
+    count = std::max<size_t>(1, std::min(count, body_.size() / MIN_CHUNK_BYTES));
+    std::vector<std::string_view> chunks;
+    size_t begin = 0;
+    for (size_t c = 1; c <= count && begin < body_.size(); ++c) {
+        size_t end = c == count ? body_.size() : std::max(begin, body_.size() * c / count);
+        if (end < body_.size()) {
+            size_t newline = body_.find('\n', end);
+            end = newline == std::string_view::npos ? body_.size() : newline + 1;
+        }
+        chunks.push_back(body_.substr(begin, end - begin));
+        begin = end;
+    }
+    if (chunks.empty()) chunks.push_back(body_);
+    return chunks;
+}
+
+} // namespace utils
@@ -0,0 +1,192 @@
+#include "utils/datetime.h"
+#include <algorithm>
+#include <charconv>
+
+namespace utils {
+namespace {
+constexpr std::time_t SECONDS_PER_DAY = 86400;
+
+// Howard Hinnant's proleptic Gregorian day counts, day 0 = 1970-01-01.
+long long daysFromCivil(long long y, int m, int d) {
+    y -= m <= 2;
+    long long era = (y >= 0 ? y : y - 399) / 400;
+    long long yoe = y - era * 400;
+    long long doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    long long doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+void civilFromDays(long long z, int& year, int& month, int& day) {
+    z += 719468;
+    long long era = (z >= 0 ? z : z - 146096) / 146097;
+    long long doe = z - era * 146097;
+    long long yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    long long doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    long long mp = (5 * doy + 2) / 153;
+    day = static_cast<int>(doy - (153 * mp + 2) / 5 + 1);
+    month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+long long floorDiv(long long a, long long b) {
+    return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+}
+
+int libcOffset(std::time_t t) {
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    return static_cast<int>(tm.tm_gmtoff);
+}
+
+CivilTime libcLocal(std::time_t t) {
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    return {tm.tm_year + 1900, tm.tm_mon + 1, tm.tm_mday, tm.tm_hour, tm.tm_min, tm.tm_sec, tm.tm_wday, tm.tm_yday};
+}
+
+std::time_t libcMktime(const CivilTime& local) {
+    std::tm tm{};
+    tm.tm_year = local.year - 1900;
+    tm.tm_mon = local.month - 1;
+    tm.tm_mday = local.day;
+    tm.tm_hour = local.hour;
+    tm.tm_min = local.minute;
+    tm.tm_sec = local.second;
+    tm.tm_isdst = -1;
+    return std::mktime(&tm);
+}
+
+char* writeDigits(char* out, int value, int width) {
+    for (int i = width - 1; i >= 0; --i) {
+        out[i] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    }
+    return out + width;
+}
+}
+
+TimeZone TimeZone::current() {
+    tzset();
+    TimeZone zone;
+    zone.first_ = static_cast<std::time_t>(daysFromCivil(1950, 1, 1)) * SECONDS_PER_DAY;
+    zone.last_ = static_cast<std::time_t>(daysFromCivil(2080, 1, 1)) * SECONDS_PER_DAY;
+
+    // Daily samples find every change, bisection then pins it to the second.
+    int offset = libcOffset(zone.first_);
+    zone.offsets_.push_back(offset);
+    for (std::time_t t = zone.first_ + SECONDS_PER_DAY; t < zone.last_; t += SECONDS_PER_DAY) {
+        int next = libcOffset(t);
+        if (next == offset) continue;
+        std::time_t low = t - SECONDS_PER_DAY, high = t;  // offset at low, next at high
+        while (high - low > 1) {
+            std::time_t mid = low + (high - low) / 2;
+            (libcOffset(mid) == offset ? low : high) = mid;
+        }
+        zone.transitions_.push_back(high);
+        zone.offsets_.push_back(next);
+        offset = next;
+    }
+
+    zone.distinctOffsets_ = zone.offsets_;
+    std::sort(zone.distinctOffsets_.begin(), zone.distinctOffsets_.end());
+    zone.distinctOffsets_.erase(std::unique(zone.distinctOffsets_.begin(), zone.distinctOffsets_.end()),
+                                zone.distinctOffsets_.end());
+    return zone;
+}
+
+const TimeZone& TimeZone::local() {
+    static const TimeZone zone = current();
+    return zone;
+}
+
+int TimeZone::utcOffset(std::time_t t) const {
+    if (t < first_ || t >= last_) return libcOffset(t);
+    size_t i = static_cast<size_t>(std::upper_bound(transitions_.begin(), transitions_.end(), t) - transitions_.begin());
+    return offsets_[i];
+}
+
+CivilTime TimeZone::toLocal(std::time_t t) const {
+    if (t < first_ || t >= last_) return libcLocal(t);
+    long long local = static_cast<long long>(t) + utcOffset(t);
+    long long days = floorDiv(local, SECONDS_PER_DAY);
+    long long seconds = local - days * SECONDS_PER_DAY;
+
+    CivilTime civil;
+    civilFromDays(days, civil.year, civil.month, civil.day);
+    civil.hour = static_cast<int>(seconds / 3600);
+    civil.minute = static_cast<int>(seconds / 60 % 60);
+    civil.second = static_cast<int>(seconds % 60);
+    civil.weekday = static_cast<int>(((days + 4) % 7 + 7) % 7);  // 1970-01-01 was a Thursday
+    civil.yearDay = static_cast<int>(days - daysFromCivil(civil.year, 1, 1));
+    return civil;
+}
+
+std::time_t TimeZone::fromLocal(const CivilTime& local) const {
+    // Out-of-range fields are normalized by mktime, leave them to it.
+    if (local.month < 1 || local.month > 12 || local.day < 1 || local.day > 31 || local.hour < 0 || local.hour > 23
+        || local.minute < 0 || local.minute > 59 || local.second < 0 || local.second > 59) {
+        return libcMktime(local);
+    }
+    long long wall = daysFromCivil(local.year, local.month, local.day) * SECONDS_PER_DAY
+                   + local.hour * 3600 + local.minute * 60 + local.second;
+    if (wall < first_ + SECONDS_PER_DAY || wall >= last_ - SECONDS_PER_DAY) {
+        return libcMktime(local);
+    }
+
+    // Repeated wall times (clocks set back) resolve to their first occurrence.
+    bool found = false;
+    std::time_t earliest = 0;
+    for (int offset : distinctOffsets_) {
+        std::time_t t = static_cast<std::time_t>(wall - offset);
+        if (utcOffset(t) == offset && (!found || t < earliest)) {
+            earliest = t;
+            found = true;
+        }
+    }
+    if (found) return earliest;
+
+    // Skipped wall times (clocks set forward) are read with the offset before the jump,
+    // 02:30 becomes 03:30 daylight time. Changes are far more than 12 hours apart.
+    int before = utcOffset(static_cast<std::time_t>(wall - distinctOffsets_.front() - SECONDS_PER_DAY / 2));
+    return static_cast<std::time_t>(wall - before);
+}
+
+bool parseDateTime(std::string_view text, std::time_t& out, const TimeZone& zone) {
+    CivilTime civil;
+    int* fields[] = {&civil.year, &civil.month, &civil.day, &civil.hour, &civil.minute, &civil.second};
+    const char separators[] = {'-', '-', ' ', ':', ':'};
+    for (size_t f = 0; f < 6; ++f) {
+        auto result = std::from_chars(text.data(), text.data() + text.size(), *fields[f]);
+        if (result.ec != std::errc() || result.ptr == text.data()) return false;
+        text.remove_prefix(static_cast<size_t>(result.ptr - text.data()));
+        if (f < 5) {
+            if (text.empty() || text.front() != separators[f]) return false;
+            text.remove_prefix(1);
+        }
+    }
+    out = zone.fromLocal(civil);
+    return true;
+}
+
+void formatDateTime(std::time_t t, char* out, const TimeZone& zone) {
+    CivilTime civil = zone.toLocal(t);
+    out = writeDigits(out, civil.year, 4);
+    *out++ = '-';
+    out = writeDigits(out, civil.month, 2);
+    *out++ = '-';
+    out = writeDigits(out, civil.day, 2);
+    *out++ = ' ';
+    out = writeDigits(out, civil.hour, 2);
+    *out++ = ':';
+    out = writeDigits(out, civil.minute, 2);
+    *out++ = ':';
+    writeDigits(out, civil.second, 2);
+}
+
+std::string formatDateTime(std::time_t t, const TimeZone& zone) {
+    std::string text(19, '\0');
+    formatDateTime(t, text.data(), zone);
+    return text;
+}
+
+} // namespace utils
@@ -1,3 +1,5 @@
+#include <array>
+#include <memory>
 #include <string>
 #include <unordered_set>
 #include <vector>
@@ -7,11 +9,39 @@
 #include "utils/error.h"
 #include "utils/logger.h"
 #include "utils/constants.h"
+#include "utils/csv_reader.h"
+#include "utils/datetime.h"
+#include "utils/task_graph.h"
 #include "data/apparatus.h"
 #include "services/queries.h"
 #include "services/chunks.h"
+#include "services/matrix_store.h"
+#include "services/building_index.h"
+#include "services/haversine_estimator.h"
+#include "services/input_snapshot.h"
+#include "services/native_router.h"
+#include "services/station_order.h"
+#include "services/travel_time_oracle.h"
+#include "services/zone_raster.h"
 
 namespace loader {
+/**
+ * @brief Lists incident indices in the order the simulator will pop them.
+ * @param events Copy of the initial event queue, drained here.
+ * @return Incident indices of the Incident events, earliest first.
+ */
+std::vector<int> upcomingIncidentIndices(EventQueue events) {
+    std::vector<int> indices;
+    indices.reserve(events.size());
+    while (!events.empty()) {
+        if (events.top().event_type == EventType::Incident) {
+            indices.push_back(events.top().incidentIndex);
+        }
+        events.pop();
+    }
+    return indices;
+}
+
 EventQueue generateEvents(const std::vector<Incident>& incidents) {
     std::vector<Event> container;
     container.reserve(incidents.size());  // Preallocate memory for efficiency
@@ -27,265 +57,173 @@ EventQueue generateEvents(const std::vector<Incident>& incidents) {
     return events;
 }
 
-int parseIntToken(const std::string& token, int defaultValue = 0) {
-    LOG_DEBUG("Parsing token: '{}' (length: {})", token, token.length());
-    
-    if (token.empty()) {
-        LOG_DEBUG("Token is empty, returning default: {}", defaultValue);
-        return defaultValue;
-    }
-    
-    try {
-        int result = std::stoi(token);
-        LOG_DEBUG("Successfully parsed: {}", result);
-        return result;
-    } catch (const std::exception& e) {
-        // LOG_ERROR("Failed to parse token '{}': {}, using default {}", token, e.what(), defaultValue);
-        return defaultValue;
-    }
+int parseIntToken(std::string_view token, int defaultValue = 0) {
+    int result = defaultValue;
+    return utils::parseInt(token, result) ? result : defaultValue;
+}
+
+namespace {
+struct StationRow {
+    int stationId;
+    std::string name;
+    double lat;
+    double lon;
+    bool inBounds;
+};
+
+struct IncidentRow {
+    int id;
+    double lat;
+    double lon;
+    IncidentType type;
+    IncidentLevel level;
+    time_t reportTime;
+    IncidentCategory category;
+    bool inBounds;
+};
+
+struct ApparatusRow {
+    int stationId;
+    std::array<int, 12> counts;  // Engine, Truck, Rescue, Hazard, Squad, Fast, Medic, Brush, Boat, UTV, Reach, Chief
+};
+
+IncidentLevel parseIncidentLevel(std::string_view level) {
+    return INCIDENT_LEVEL_NAMES.parse(level).value_or(IncidentLevel::Invalid);
+}
+}
+
+PreparedPolygon loadBounds() {
+    return PreparedPolygon(loadPolygonFromGeoJSON(
+        EnvLoader::getInstance()->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson")));
 }
 
 std::vector<Station> loadStationsFromCSV() {
+    return loadStationsFromCSV(loadBounds());
+}
+
+std::vector<Station> loadStationsFromCSV(const PreparedPolygon& bounds) {
     std::string filename = EnvLoader::getInstance()->get("STATIONS_CSV_PATH", "");
     // TODO: Add error checking
-    std::string bounds_path = EnvLoader::getInstance()->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson");
 
     LOG_INFO("Loading stations from CSV file: {}", filename);
-    std::vector<Location> polygon = loadPolygonFromGeoJSON(bounds_path);
 
     std::vector<Station> stations;
-    std::ifstream file(filename);
-    std::string line;
-
-    if (!file.is_open()) {
+    utils::CsvFile file(filename);
+    if (!file.isOpen()) {
         LOG_ERROR("Failed to open file: {}", filename);
         return stations;
     }
 
-    // Skip header line
-    std::getline(file, line);
+    std::vector<StationRow> rows = file.parseLines<StationRow>([&](std::string_view line) {
+        utils::CsvFields fields(line);
+        StationRow row;
+        // OBJECTID
+        std::string_view token = fields.next();
+        if (!utils::parseInt(token, row.stationId)) {
+            throw InvalidStationError("Invalid station ID in CSV file: " + std::string(token));
+        }
+        row.name = std::string(fields.next());  // Facility Name
+        fields.skip(5);                         // Address, City, State, Zip Code, GLOBALID
+        // x, y
+        if (!utils::parseDouble(fields.next(), row.lat) || !utils::parseDouble(fields.next(), row.lon)) {
+            throw InvalidStationError("Invalid coordinates for station " + std::to_string(row.stationId));
+        }
+        row.inBounds = bounds.contains(Location(row.lon, row.lat));
+        return row;
+    });
 
     int ignoredCount = 0; // Count of ignored stations
     int index = 0;
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string token;
-
-        // Skip OBJECTID
-        // How to ensure that these are string that can be converted to int?
-        std::getline(ss, token, ',');
-        int station_id = -1;
-        try {
-            station_id = std::stoi(token);
-        } catch (...) {
-            LOG_ERROR("Invalid station ID: {}", token);
-            throw InvalidStationError("Invalid station ID in CSV file: " + token);
-        }
-
-        // Skip Facility Name
-        std::getline(ss, token, ',');
-        std::string name = token;
-
-        // Skip Address
-        std::getline(ss, token, ',');
-
-        // Skip City
-        std::getline(ss, token, ',');
-
-        // Skip State
-        std::getline(ss, token, ',');
-
-        // Skip Zip Code
-        std::getline(ss, token, ',');
-
-        // Skip GLOBALID
-        std::getline(ss, token, ',');
-
-        // x
-        std::getline(ss, token, ',');
-        double lat = std::stod(token);
-
-        // y
-        std::getline(ss, token, ',');
-        double lon = std::stod(token);
-
+    for (const auto& row : rows) {
         int num_fire_trucks = constants::DEFAULT_NUM_FIRE_TRUCKS; // Default value, can be updated later
         int num_ambulances = constants::DEFAULT_NUM_AMBULANCES;  // Default value, can be updated later
 
-        if (isPointInPolygon(polygon, Location(lon, lat))) {
+        if (row.inBounds) {
             Station station(index,
-                            station_id,
+                            row.stationId,
                             num_fire_trucks,
                             num_ambulances,
-                            lon,
-                            lat);
-            station.setFacilityName(name);
+                            row.lon,
+                            row.lat);
+            station.setFacilityName(row.name);
             stations.emplace_back(station);
-            LOG_DEBUG("Loaded station: {}", station_id);
+            LOG_DEBUG("Loaded station: {}", row.stationId);
             index++;
         } else {
-            LOG_DEBUG("Station {} is out of bounds and will be ignored.", station_id);
+            LOG_DEBUG("Station {} is out of bounds and will be ignored.", row.stationId);
             ignoredCount++;
         }
     }
 
-    file.close();
     LOG_INFO("Loaded {} stations from CSV file.", stations.size());
     LOG_WARN("Ignored {} stations that are out of bounds.", ignoredCount);
     return stations;
 }
 
-IncidentCategory stringToIncidentCategory(const std::string& str) {
-    if (str == "One") return IncidentCategory::One;
-    if (str == "OneB") return IncidentCategory::OneB;
-    if (str == "OneBM") return IncidentCategory::OneBM;
-    if (str == "OneC") return IncidentCategory::OneC;
-    if (str == "OneD") return IncidentCategory::OneD;
-    if (str == "OneE") return IncidentCategory::OneE;
-    if (str == "OneEM") return IncidentCategory::OneEM;
-    if (str == "OneF") return IncidentCategory::OneF;
-    if (str == "OneG") return IncidentCategory::OneG;
-    if (str == "OneH") return IncidentCategory::OneH;
-    if (str == "OneJ") return IncidentCategory::OneJ;
-    if (str == "Two") return IncidentCategory::Two;
-    if (str == "TwoM") return IncidentCategory::TwoM;
-    if (str == "TwoMF") return IncidentCategory::TwoMF;
-    if (str == "TwoA") return IncidentCategory::TwoA;
-    if (str == "TwoB") return IncidentCategory::TwoB;
-    if (str == "TwoC") return IncidentCategory::TwoC;
-    if (str == "Three") return IncidentCategory::Three;
-    if (str == "ThreeF") return IncidentCategory::ThreeF;
-    if (str == "ThreeM") return IncidentCategory::ThreeM;
-    if (str == "ThreeA") return IncidentCategory::ThreeA;
-    if (str == "ThreeB") return IncidentCategory::ThreeB;
-    if (str == "ThreeC") return IncidentCategory::ThreeC;
-    if (str == "ThreeCM") return IncidentCategory::ThreeCM;
-    if (str == "ThreeD") return IncidentCategory::ThreeD;
-    if (str == "Four") return IncidentCategory::Four;
-    if (str == "FourM") return IncidentCategory::FourM;
-    if (str == "FourA") return IncidentCategory::FourA;
-    if (str == "FourB") return IncidentCategory::FourB;
-    if (str == "FourC") return IncidentCategory::FourC;
-    if (str == "Five") return IncidentCategory::Five;
-    if (str == "FiveA") return IncidentCategory::FiveA;
-    if (str == "Six") return IncidentCategory::Six;
-    if (str == "Seven") return IncidentCategory::Seven;
-    if (str == "SevenB") return IncidentCategory::SevenB;
-    if (str == "SevenBM") return IncidentCategory::SevenBM;
-    if (str == "Eight") return IncidentCategory::Eight;
-    if (str == "EightA") return IncidentCategory::EightA;
-    if (str == "EightB") return IncidentCategory::EightB;
-    if (str == "EightC") return IncidentCategory::EightC;
-    if (str == "EightD") return IncidentCategory::EightD;
-    if (str == "EightE") return IncidentCategory::EightE;
-    if (str == "EightF") return IncidentCategory::EightF;
-    if (str == "EightG") return IncidentCategory::EightG;
-    if (str == "Nine") return IncidentCategory::Nine;
-    if (str == "Ten") return IncidentCategory::Ten;
-    if (str == "Eleven") return IncidentCategory::Eleven;
-    if (str == "ElevenA") return IncidentCategory::ElevenA;
-    if (str == "ElevenB") return IncidentCategory::ElevenB;
-    if (str == "Thirteen") return IncidentCategory::Thirteen;
-    if (str == "Fourteen") return IncidentCategory::Fourteen;
-    if (str == "Fifteen") return IncidentCategory::Fifteen;
-    if (str == "Sixteen") return IncidentCategory::Sixteen;
-    if (str == "Eighteen") return IncidentCategory::Eighteen;
-    return IncidentCategory::Invalid;
+std::vector<Incident> loadIncidentsFromCSV() {
+    return loadIncidentsFromCSV(loadBounds());
 }
 
-std::vector<Incident> loadIncidentsFromCSV() {
+std::vector<Incident> loadIncidentsFromCSV(const PreparedPolygon& bounds) {
     std::string filename = EnvLoader::getInstance()->get("INCIDENTS_CSV_PATH", "");
-    std::string bounds_path = EnvLoader::getInstance()->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson");
     LOG_INFO("Loading incidents from CSV file: {}", filename);
-    std::vector<Location> polygon = loadPolygonFromGeoJSON(bounds_path);
     std::vector<Incident> incidents;
-    std::ifstream file(filename);
+    utils::CsvFile file(filename);
 
-    if (!file.is_open()) {
+    if (!file.isOpen()) {
         LOG_ERROR("Failed to open file: {}", filename);
         return incidents;
     }
 
-    std::string line;
-    std::getline(file, line);  // Skip header
-
-    std::unordered_set<int> seenIDs; // To track unique incident IDs
-
-    int ignoredCount = 0; // Count of ignored incidents
-    int index = 0;
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        ss.precision(6); // Set precision for floating-point numbers
-        std::string token;
-
-        int id;
-        double lat, lon;
-        std::string type, level, datetime_str, category;
+    // Rows are parsed and bounds-checked in parallel, indices and duplicates are settled in file order below.
+    std::vector<IncidentRow> rows = file.parseLines<IncidentRow>([&](std::string_view line) {
+        utils::CsvFields fields(line);
+        IncidentRow row;
 
-        std::getline(ss, token, ',');
-        try {
-            id = std::stoi(token);
-        } catch (...) {
-            LOG_ERROR("Invalid incident ID: {}", token);
-            throw InvalidIncidentError("Invalid incident ID in CSV file: " + token);
+        std::string_view token = fields.next();
+        if (!utils::parseInt(token, row.id)) {
+            throw InvalidIncidentError("Invalid incident ID in CSV file: " + std::string(token));
+        }
+        if (!utils::parseDouble(fields.next(), row.lat) || !utils::parseDouble(fields.next(), row.lon)) {
+            throw InvalidIncidentError("Invalid coordinates for incident " + std::to_string(row.id));
         }
 
-        std::getline(ss, token, ',');
-        lat = std::stod(token);
+        std::string_view type = fields.next();
+        std::string_view level = fields.next();
+        std::string_view datetime_str = fields.next();
+        std::string_view category = fields.next();
 
-        std::getline(ss, token, ',');
-        lon = std::stod(token);
+        // Parse datetime string to Unix time
+        if (!utils::parseDateTime(datetime_str, row.reportTime)) {
+            throw std::runtime_error("Invalid datetime format: " + std::string(datetime_str));
+        }
 
-        std::getline(ss, type, ',');
-        std::getline(ss, level, ',');
-        std::getline(ss, datetime_str, ',');
-        std::getline(ss, category, ',' ); 
+        row.inBounds = bounds.contains(Location(row.lon, row.lat));
+        if (row.inBounds) {
+            row.level = parseIncidentLevel(level);
+            row.type = mapIncidentType(type);
+            row.category = stringToIncidentCategory(category);
+        }
+        return row;
+    });
 
+    std::unordered_set<int> seenIDs; // To track unique incident IDs
+    seenIDs.reserve(rows.size());
+    incidents.reserve(rows.size());
 
-        // Parse datetime string to Unix time
-        std::tm tm = {};
-        std::istringstream datetime_ss(datetime_str);
-        datetime_ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
-
-        if (datetime_ss.fail()) {
-            std::cerr << "Failed to parse datetime: " << datetime_str << '\n';
-            throw std::runtime_error("Invalid datetime format: " + datetime_str);
-            // continue;
+    int ignoredCount = 0; // Count of ignored incidents
+    int index = 0;
+    for (const auto& row : rows) {
+        if (!row.inBounds) {
+            ignoredCount++;
+            continue;
         }
-        tm.tm_isdst = -1;  // Let mktime() determine DST
-        time_t unix_time = std::mktime(&tm);
-
-        if (isPointInPolygon(polygon, Location(lon, lat))) {
-            IncidentLevel ilevel = IncidentLevel::Invalid; // Default to Invalid
-            if (level == constants::INCIDENT_LEVEL_LOW) {
-                ilevel = IncidentLevel::Low;
-            } else if (level == constants::INCIDENT_LEVEL_MODERATE) {
-                ilevel = IncidentLevel::Moderate;
-            } else if (level == constants::INCIDENT_LEVEL_HIGH) {
-                ilevel = IncidentLevel::High;
-            } else if (level == constants::INCIDENT_LEVEL_CRITICAL) {
-                ilevel = IncidentLevel::Critical;
-            } else {
-                ilevel = IncidentLevel::Invalid; // Handle invalid levels
-            }
-
-            IncidentType itype = mapIncidentType(type); // Use the new mapping function
-            IncidentCategory icategory = stringToIncidentCategory(category);
-
-            if (seenIDs.count(id)) {
-                // LOG_WARN("Incident ID {} is duplicated and will be ignored.", id);
-                ignoredCount++;
-                continue; // Skip if ID is already seen
-            } else {
-                seenIDs.insert(id);
-                incidents.emplace_back(index, id, lat, lon, itype, ilevel, unix_time, icategory);
-                index++;
-            }
-        } else {
-            // LOG_DEBUG("Incident {} is out of bounds and will be ignored.", id);
+        if (!seenIDs.insert(row.id).second) {
             ignoredCount++;
+            continue; // Skip if ID is already seen
         }
-        
+        incidents.emplace_back(index, row.id, row.lat, row.lon, row.type, row.level, row.reportTime, row.category);
+        index++;
     }
     LOG_INFO("Total incidents: {}", incidents.size() + ignoredCount);
     LOG_INFO("Loaded {} incidents from CSV file.", incidents.size());
@@ -303,194 +241,60 @@ This would allow us to loop through the independently from the stations (if need
 */
 std::vector<Apparatus> loadApparatusFromCSV() {
     std::string filename = EnvLoader::getInstance()->get("APPARATUS_CSV_PATH", "");
-    std::string bounds_path = EnvLoader::getInstance()->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson");
 
     LOG_INFO("Loading apparatuses from CSV file: {}", filename);
-    std::vector<Location> polygon = loadPolygonFromGeoJSON(bounds_path);
 
     std::vector<Apparatus> apparatuses;
-    std::ifstream file(filename);
-    std::string line;
-
-    if (!file.is_open()) {
+    utils::CsvFile file(filename);
+    if (!file.isOpen()) {
         LOG_ERROR("Failed to open file: {}", filename);
         return apparatuses;
     }
 
-    // Skip header line
-    std::getline(file, line);
-
-    int index = 0;
-    while (std::getline(file, line)) {
-        std::istringstream ss(line);
-        std::string token;
-
+    std::vector<ApparatusRow> rows = file.parseLines<ApparatusRow>([](std::string_view line) {
+        utils::CsvFields fields(line);
+        ApparatusRow row;
         // StationID
-        // How to ensure that these are string that can be converted to int?
-        std::getline(ss, token, ',');
-        int station_id = -1;
-        try {
-            station_id = std::stoi(token);
-        } catch (...) {
-            LOG_ERROR("Invalid station ID: {}", token);
-            throw InvalidStationError("Invalid station ID in CSV file: " + token);
+        std::string_view token = fields.next();
+        if (!utils::parseInt(token, row.stationId)) {
+            throw InvalidStationError("Invalid station ID in CSV file: " + std::string(token));
         }
-    
-        // Skip Facility Name/Stations
-        std::getline(ss, token, ',');
-    
-        // // Skip Station Name
-        std::getline(ss, token, ',');
-
-        // // Engine_ID (its jus count)
-        std::getline(ss, token, ',');
-        int engine_count = parseIntToken(token);
-
-        // Truck
-        std::getline(ss, token, ',');
-        int truck_count = parseIntToken(token);
-
-        // Rescue
-        std::getline(ss, token, ',');
-        int rescue_count = parseIntToken(token);
-
-        // Hazard
-        std::getline(ss, token, ',');
-        int hazard_count = parseIntToken(token);
-
-        // Squad
-        std::getline(ss, token, ',');
-        int squad_count = parseIntToken(token);
-
-        // Fast
-        std::getline(ss, token, ',');
-        int fast_count = parseIntToken(token);
-
-        // Medic
-        std::getline(ss, token, ',');
-        int medic_count = parseIntToken(token);
-
-        // Brush
-        std::getline(ss, token, ',');
-        int brush_count = parseIntToken(token);
-
-        // Boat
-        std::getline(ss, token, ',');
-        int boat_count = parseIntToken(token);
-
-        // UTV
-        std::getline(ss, token, ',');
-        int utv_count = parseIntToken(token);
-
-        // REACH
-        std::getline(ss, token, ',');
-        int reach_count = parseIntToken(token);
-
-        // Chief
-        std::getline(ss, token, ',');
-        int chief_count = parseIntToken(token);
-
-        LOG_DEBUG("Station Index: {}, Chief Count: {}", station_id, chief_count);
-
-        // Loop through each apparatus type and create instances
-        for (int i = 0; i < engine_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Engine);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < truck_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Truck);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < rescue_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Rescue);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < hazard_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Hazard);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < squad_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Squad);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < fast_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Fast);
-            apparatuses.emplace_back(a);
+        fields.skip(2);  // Facility Name/Stations, Station Name
+        for (int& count : row.counts) {
+            count = parseIntToken(fields.next());
         }
+        return row;
+    });
 
-        for (int i = 0; i < medic_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Medic);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < brush_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Brush);
-            apparatuses.emplace_back(a);
-        }
+    // Same order as the CSV columns
+    constexpr std::array<ApparatusType, 12> columnTypes = {
+        ApparatusType::Engine, ApparatusType::Truck, ApparatusType::Rescue, ApparatusType::Hazard,
+        ApparatusType::Squad, ApparatusType::Fast, ApparatusType::Medic, ApparatusType::Brush,
+        ApparatusType::Boat, ApparatusType::UTV, ApparatusType::Reach, ApparatusType::Chief};
 
-        for (int i = 0; i < boat_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Boat);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < utv_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::UTV);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < reach_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Reach);
-            apparatuses.emplace_back(a);
-        }
-
-        for (int i = 0; i < chief_count; i++) {
-            Apparatus a = Apparatus(index++, station_id, ApparatusType::Chief);
-            apparatuses.emplace_back(a);
+    int index = 0;
+    for (const auto& row : rows) {
+        LOG_DEBUG("Station Index: {}, Chief Count: {}", row.stationId, row.counts.back());
+        // Loop through each apparatus type and create instances
+        for (size_t column = 0; column < columnTypes.size(); ++column) {
+            for (int i = 0; i < row.counts[column]; i++) {
+                apparatuses.emplace_back(index++, row.stationId, columnTypes[column]);
+            }
         }
     }
 
-    file.close();
-    // LOG_INFO("Loaded {} stations from CSV file.", stations.size());
-    // LOG_WARN("Ignored {} stations that are out of bounds.", ignoredCount);
     return apparatuses;
 }
 
 
-// TODO: Add checking if the binary files already exist, if so, load them instead of generating them again.
-void preComputingMatrices(std::vector<Station>& stations, 
-                          std::vector<Incident>& incidents,
-                          std::vector<Apparatus>& apparatuses,
-                          size_t chunk_size) {
-    LOG_INFO("Starting Precomputation...");
-    //spdlog::stopwatch sw;
-    // Additional logic can be added here
-    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
-    std::string stations_path = env->get("STATIONS_CSV_PATH", "../data/stations.csv");
-    std::string incidents_path = env->get("INCIDENTS_CSV_PATH", "../data/incidents.csv");
-    std::string matrix_csv_path = env->get("MATRIX_CSV_PATH", "../logs/matrix.csv");
-    std::string distance_matrix_path = env->get("DISTANCE_MATRIX_PATH", "../logs/distance_matrix.bin");
-    std::string duration_matrix_path = env->get("DURATION_MATRIX_PATH", "../logs/duration_matrix.bin");
-    std::string beats_shapefile_path = env->get("BEATS_SHAPEFILE_PATH", "../data/beats_shpfile.geojson");
-    std::string osrmUrl_ = env->get("BASE_OSRM_URL", "http://router.project-osrm.org");
-
-    if (checkOSRM(osrmUrl_)) {
-        LOG_INFO("OSRM server is reachable and working correctly.");
-    } else {
-        LOG_ERROR("OSRM server is not reachable.");
-        throw OSRMError();
-    }
-
-    stations = loadStationsFromCSV();
-    incidents = loadIncidentsFromCSV();
-    apparatuses = loadApparatusFromCSV();
-
-    // START Adding zones per incident (maybe costly?)
-    std::vector<std::pair<int, Polygon>> polygonWithZoneID = loadServiceZonesFromGeojson(beats_shapefile_path);
+/**
+ * @brief Sets zoneIndex of every incident to the service zone (beat) containing it.
+ * ZONE_ASSIGNMENT=RASTER looks incidents up in a ZoneRaster cached at ZONE_RASTER_PATH
+ * under the beats file hash, RTREE tests the polygons whose envelopes hold each incident.
+ */
+void assignServiceZones(std::vector<Incident>& incidents) {
+    std::string beats_path = EnvLoader::getInstance()->get("BEATS_SHAPEFILE_PATH", "../data/beats_shpfile.geojson");
+    std::vector<std::pair<int, Polygon>> polygonWithZoneID = loadServiceZonesFromGeojson(beats_path);
     std::vector<Polygon> polygons;
     polygons.reserve(polygonWithZoneID.size());
     for (const auto& pair : polygonWithZoneID) {
@@ -501,7 +305,15 @@ void preComputingMatrices(std::vector<Station>& stations,
     for (auto& incident : incidents) {
         points.emplace_back(Point(incident.lon, incident.lat));
     }
-    auto results = getPointToPolygonIndices(points, polygons);
+    std::vector<std::optional<size_t>> results;
+    if (EnvLoader::getInstance()->get("ZONE_ASSIGNMENT", "RASTER") == "RTREE") {
+        results = getPointToPolygonIndices(points, polygons);
+    } else {
+        ZoneRaster raster = ZoneRaster::openOrBuild(
+            EnvLoader::getInstance()->get("ZONE_RASTER_PATH", "../logs/zone_raster.bin"),
+            std::move(polygons), InputSnapshot::hashFile(beats_path));
+        results = raster.locate(points);
+    }
     int notThere = 0;
     for (size_t i = 0; i < results.size(); ++i) {
         if (results[i]) {
@@ -513,38 +325,285 @@ void preComputingMatrices(std::vector<Station>& stations,
     }
     LOG_ERROR("There are {} incidents that are not in any service zone.", notThere);
     LOG_ERROR("There are {} incidents in service zones.", results.size() - notThere);
-    // END Adding zones per incident (maybe costly?)
+}
+
+namespace {
+/**
+ * @brief The input loading stages as tasks of a TaskGraph, writing into the caller's vectors.
+ * The snapshot is probed first; when it is current every later stage is a no-op. Otherwise
+ * the bounds polygon is parsed once and the three CSVs load concurrently.
+ */
+struct InputTasks {
+    InputTasks(std::vector<Station>& stations, std::vector<Incident>& incidents, std::vector<Apparatus>& apparatuses)
+        : stations(stations), incidents(incidents), apparatuses(apparatuses) {}
+
+    std::vector<Station>& stations;
+    std::vector<Incident>& incidents;
+    std::vector<Apparatus>& apparatuses;
+
+    std::string snapshotPath;
+    InputSnapshot::SourceHashes sources{};
+    bool fromSnapshot = false;
+    PreparedPolygon bounds;
+
+    utils::TaskGraph::TaskId stationsLoaded = 0, incidentsLoaded = 0, apparatusLoaded = 0, zonesAssigned = 0;
+
+    void addTo(utils::TaskGraph& graph) {
+        snapshotPath = EnvLoader::getInstance()->get("INPUT_SNAPSHOT_PATH", "../logs/inputs.bin");
+        auto snapshot = graph.add("input snapshot", [this]() { openSnapshot(); });
+        auto boundsParsed = graph.add("bounds", [this]() {
+            if (!fromSnapshot) bounds = loadBounds();
+        }, {snapshot});
+        stationsLoaded = graph.add("stations", [this]() {
+            if (!fromSnapshot) stations = loadStationsFromCSV(bounds);
+        }, {boundsParsed});
+        incidentsLoaded = graph.add("incidents", [this]() {
+            if (!fromSnapshot) incidents = loadIncidentsFromCSV(bounds);
+        }, {boundsParsed});
+        apparatusLoaded = graph.add("apparatus", [this]() {
+            if (!fromSnapshot) apparatuses = loadApparatusFromCSV();
+        }, {snapshot});
+        zonesAssigned = graph.add("zones", [this]() {
+            if (!fromSnapshot) assignServiceZones(incidents);
+        }, {incidentsLoaded});
+        graph.add("save snapshot", [this]() {
+            if (!fromSnapshot && !snapshotPath.empty()
+                && InputSnapshot::save(snapshotPath, sources, stations, incidents, apparatuses)) {
+                LOG_INFO("Compiled input snapshot {}", snapshotPath);
+            }
+        }, {stationsLoaded, zonesAssigned, apparatusLoaded});
+    }
+
+    void openSnapshot() {
+        sources = InputSnapshot::sourceHashesFromEnv();
+        if (snapshotPath.empty() || !std::ifstream(snapshotPath)) return;
+        try {
+            InputSnapshot snapshot = InputSnapshot::open(snapshotPath);
+            if (snapshot.sourceHashes() != sources) {
+                LOG_INFO("Input snapshot {} is out of date, reloading the CSV files.", snapshotPath);
+                return;
+            }
+            stations = snapshot.stations();
+            incidents = snapshot.incidents();
+            apparatuses = snapshot.apparatuses();
+            fromSnapshot = true;
+            LOG_INFO("Loaded {} stations, {} incidents and {} apparatus from input snapshot {}",
+                     stations.size(), incidents.size(), apparatuses.size(), snapshotPath);
+        } catch (const InvalidValueError& e) {
+            LOG_WARN("{}, reloading the CSV files.", e.what());
+        }
+    }
+};
+}
+
+/**
+ * @brief Stations, incidents (zones assigned) and apparatus, from INPUT_SNAPSHOT_PATH when
+ * it was compiled from the current CSVs and shapes, otherwise loaded and compiled anew.
+ */
+void loadInputs(std::vector<Station>& stations,
+                std::vector<Incident>& incidents,
+                std::vector<Apparatus>& apparatuses) {
+    utils::TaskGraph graph;
+    InputTasks inputs(stations, incidents, apparatuses);
+    inputs.addTo(graph);
+    graph.run();
+    graph.logTimings("Loading inputs");
+}
+
+/**
+ * @brief Builds the grid travel time oracle over the bounds polygon, unless it already exists.
+ * Lets policies dispatch incidents that are not part of the duration matrix.
+ * @param router Routes the cell centers locally when set, OSRM otherwise.
+ */
+void buildTravelTimeOracle(const std::vector<Station>& stations, size_t chunk_size, const NativeRouter* router) {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    std::string oracle_path = env->get("TRAVEL_TIME_ORACLE_PATH", "../logs/travel_time_oracle.bin");
+    std::string bounds_path = env->get("BOUNDS_GEOJSON_PATH", "../data/bounds.geojson");
+    double cell_size_m = std::stod(env->get("ORACLE_CELL_SIZE_M", "500"));
+
+    if (oracle_path.empty() || std::ifstream(oracle_path)) {
+        return;
+    }
+    if (!std::ifstream(bounds_path)) {
+        LOG_WARN("Bounds file {} not found, skipping travel time oracle.", bounds_path);
+        return;
+    }
+
+    // loadPolygonFromGeoJSON stores longitude in Location::lat.
+    std::vector<Location> polygon = loadPolygonFromGeoJSON(bounds_path);
+    double minLat = 90.0, maxLat = -90.0, minLon = 180.0, maxLon = -180.0;
+    for (const auto& vertex : polygon) {
+        minLon = std::min(minLon, vertex.lat);
+        maxLon = std::max(maxLon, vertex.lat);
+        minLat = std::min(minLat, vertex.lon);
+        maxLat = std::max(maxLat, vertex.lon);
+    }
 
     std::vector<Location> sources;
-    sources.reserve(stations.size());  // Preallocate memory for efficiency
+    sources.reserve(stations.size());
     for (const auto& station : stations) {
         sources.emplace_back(station.getLocation());
     }
-    std::vector<Location> destinations;
-    destinations.reserve(incidents.size());  // Preallocate memory for efficiency
-    for (const auto& incident : incidents) {
-        destinations.emplace_back(incident.getLocation());
+
+    GridSpec grid = GridSpec::fromBounds(minLat, minLon, maxLat, maxLon, cell_size_m);
+    if (!router) {
+        TravelTimeOracle::buildFromOSRM(sources, grid, chunk_size).save(oracle_path);
+        return;
+    }
+
+    std::vector<Location> centers;
+    centers.reserve(grid.cellCount());
+    for (int cell = 0; cell < grid.cellCount(); ++cell) {
+        centers.emplace_back(grid.cellCenter(cell));
     }
-    bool matrixNotExist = true;
-    if (matrixNotExist) {
+    TravelTimeOracle(grid, router->tableMatrices(sources, centers).second).save(oracle_path);
+}
+
+/**
+ * @brief Loads the inputs and writes the matrices, station order and oracle the policies read.
+ *
+ * Runs as a task graph: the router health check (or road graph preparation) overlaps input
+ * loading, and the matrix request starts as soon as stations and incidents are loaded, while
+ * zones are still being assigned and the input snapshot written. Stage timings are logged.
+ */
+void preComputingMatrices(std::vector<Station>& stations, 
+                          std::vector<Incident>& incidents,
+                          std::vector<Apparatus>& apparatuses,
+                          size_t chunk_size) {
+    LOG_INFO("Starting Precomputation...");
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    std::string matrix_csv_path = env->get("MATRIX_CSV_PATH", "../logs/matrix.csv");
+    std::string distance_matrix_path = env->get("DISTANCE_MATRIX_PATH", "../logs/distance_matrix.bin");
+    std::string duration_matrix_path = env->get("DURATION_MATRIX_PATH", "../logs/duration_matrix.bin");
+    std::string station_order_path = env->get("STATION_ORDER_PATH", "../logs/station_order.bin");
+    int station_order_top_k = std::stoi(env->get("STATION_ORDER_TOP_K", "5"));
+    std::string matrix_storage = env->get("MATRIX_STORAGE", "FLAT");
+    int matrix_tile_cols = std::stoi(env->get("MATRIX_TILE_COLS", "4096"));
+    std::string matrix_fallback = env->get("MATRIX_FALLBACK", "NONE");
+    std::string calibration_path = env->get("ESTIMATOR_CALIBRATION_PATH", "../logs/estimator_calibration.json");
+    std::string osrmUrl_ = env->get("BASE_OSRM_URL", "http://router.project-osrm.org");
+    std::string router_name = env->get("ROUTER", "OSRM");
+
+    utils::TaskGraph graph;
+    InputTasks inputs(stations, incidents, apparatuses);
+    inputs.addTo(graph);
+
+    // ROUTER=NATIVE routes on a local road graph and never talks to OSRM.
+    std::unique_ptr<NativeRouter> native_router;
+    bool osrm_available = false;
+    auto router = graph.add("router", [&]() {
+        if (router_name == "NATIVE") {
+            native_router = std::make_unique<NativeRouter>(RoadGraph::loadCsv(
+                env->get("ROAD_GRAPH_NODES_PATH", "../data/road_nodes.csv"),
+                env->get("ROAD_GRAPH_EDGES_PATH", "../data/road_edges.csv")));
+            // Preprocessed once and memory-mapped on later runs.
+            std::string ch_path = env->get("ROAD_GRAPH_CH_PATH", "../logs/road_graph.ch");
+            if (!ch_path.empty()) {
+                native_router->useHierarchy(ContractionHierarchy::openOrBuild(native_router->graph(), ch_path));
+            }
+            return;
+        }
+        osrm_available = checkOSRM(osrmUrl_);
+        if (osrm_available) {
+            LOG_INFO("OSRM server is reachable and working correctly.");
+        } else if (matrix_fallback == "HAVERSINE") {
+            LOG_WARN("OSRM server is not reachable, estimating matrices from great-circle distances.");
+        } else {
+            LOG_ERROR("OSRM server is not reachable.");
+            throw OSRMError();
+        }
+    });
+
+    std::vector<Location> sources;
+    std::vector<Location> destinations;
+    std::pair<FlatMatrix, FlatMatrix> result;
+    bool routed = false;
+    auto matrices = graph.add("matrices", [&]() {
+        sources.reserve(stations.size());  // Preallocate memory for efficiency
+        for (const auto& station : stations) {
+            sources.emplace_back(station.getLocation());
+        }
+        destinations.reserve(incidents.size());  // Preallocate memory for efficiency
+        for (const auto& incident : incidents) {
+            destinations.emplace_back(incident.getLocation());
+        }
         LOG_INFO("Distance and Duration matrix files do not exist. Generating new matrices...");
-    } else {
-        LOG_INFO("Distance and Duration matrix files already exist. Skipping matrix generation.");
-        return;
+        if (native_router || osrm_available) {
+            result = native_router ? native_router->tableMatrices(sources, destinations)
+                                   : generate_osrm_table_chunks(sources, destinations, chunk_size);
+            routed = true;
+        }
+    }, {router, inputs.stationsLoaded, inputs.incidentsLoaded});
+
+    // Zones are only needed from here on: to calibrate the estimator, or to run it.
+    auto calibrated = graph.add("calibration", [&]() {
+        std::vector<int> zones;
+        zones.reserve(incidents.size());
+        for (const auto& incident : incidents) {
+            zones.push_back(incident.zoneIndex);
+        }
+        if (routed) {
+            // Keep the estimator calibrated against the latest OSRM run.
+            EstimatorCalibration::fit(sources, destinations, zones, result.first, result.second).save(calibration_path);
+            return;
+        }
+        EstimatorCalibration calibration;
+        if (!calibration.load(calibration_path)) {
+            LOG_WARN("No estimator calibration at {}, using default circuity and speed.", calibration_path);
+        }
+        result = HaversineEstimator(sources, destinations, zones, calibration).estimateMatrices();
+    }, {matrices, inputs.zonesAssigned});
+
+    auto written = graph.add("write matrices", [&]() {
+        const FlatMatrix& full_distance_matrix = result.first;
+        const FlatMatrix& full_duration_matrix = result.second;
+
+        std::cout << full_duration_matrix.height() << " sources, " 
+                  << full_duration_matrix.width() << " destinations.\n";
+        // For readability
+        write_matrix_to_csv(full_duration_matrix, matrix_csv_path, 2, false);
+        if (matrix_storage == "TILED") {
+            // Policies page these in through the tile cache instead of loading them whole.
+            writeTiledMatrix(full_duration_matrix, duration_matrix_path, matrix_tile_cols);
+            writeTiledMatrix(full_distance_matrix, distance_matrix_path, matrix_tile_cols);
+        } else {
+            save_matrix_binary(full_duration_matrix, duration_matrix_path);
+            save_matrix_binary(full_distance_matrix, distance_matrix_path);
+        }
+
+        // Nearest-station order per incident, built once here instead of sorted on every policy call.
+        StationOrderIndex station_order(full_duration_matrix, station_order_top_k);
+        station_order.save(station_order_path);
+    }, {calibrated});
+
+    // After the matrices, so the two never compete for OSRM's connections.
+    graph.add("travel time oracle", [&]() {
+        if (native_router || osrm_available) {
+            buildTravelTimeOracle(stations, chunk_size, native_router.get());
+        }
+    }, {written});
+
+    graph.run();
+    graph.logTimings("Preprocessing");
+}
+
+std::shared_ptr<const BuildingIndex> loadBuildingIndex(const std::vector<Incident>& incidents) {
+    std::shared_ptr<EnvLoader> env = EnvLoader::getInstance();
+    std::string cache_path = env->get("BUILDING_CACHE_PATH", "../logs/buildings.bin");
+    if (cache_path.empty()) {
+        return nullptr;
     }
-    auto result = generate_osrm_table_chunks(sources, destinations, chunk_size);
-    const std::vector<std::vector<double>>& full_distance_matrix = result.first;
-    const std::vector<std::vector<double>>& full_duration_matrix = result.second;
-
-    std::cout << full_duration_matrix.size() << " sources, " 
-              << full_duration_matrix[0].size() << " destinations.\n";
-    // print_matrix(full_duration_matrix, 5, 5);
-    // For readability
-    write_matrix_to_csv(full_duration_matrix, matrix_csv_path, 2, false);
-    save_matrix_binary(full_duration_matrix, duration_matrix_path);
-    save_matrix_binary(full_distance_matrix, distance_matrix_path);
-   // LOG_INFO("Preprocessing completed successfully in {:.3} s.", sw);
+
+    std::vector<Location> locations;
+    locations.reserve(incidents.size());
+    for (const auto& incident : incidents) {
+        locations.emplace_back(incident.lat, incident.lon);
+    }
+    return std::make_shared<const BuildingIndex>(BuildingIndex::openOrFetch(
+        cache_path, locations,
+        std::stod(env->get("BUILDING_RADIUS_M", "50")),
+        env->get("OVERPASS_URL", "https://overpass.private.coffee/api/interpreter/"),
+        std::stoi(env->get("BUILDING_TILE_ZOOM", "15"))));
 }
 
 } // namespace loader
-
@@ -0,0 +1,111 @@
+#include "utils/task_graph.h"
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include "utils/error.h"
+#include "utils/logger.h"
+
+namespace utils {
+
+TaskGraph::TaskId TaskGraph::add(std::string name, std::function<void()> task, std::vector<TaskId> dependencies) {
+    TaskId id = tasks_.size();
+    for (TaskId dependency : dependencies) {
+        if (dependency >= id) {
+            throw InvalidValueError("Task " + name + " depends on a task that was not added before it");
+        }
+    }
+    std::sort(dependencies.begin(), dependencies.end());
+    dependencies.erase(std::unique(dependencies.begin(), dependencies.end()), dependencies.end());
+    for (TaskId dependency : dependencies) {
+        tasks_[dependency].dependents.push_back(id);
+    }
+    tasks_.push_back({std::move(name), std::move(task), {}, dependencies.size()});
+    return id;
+}
+
+void TaskGraph::run(size_t threads) {
+    using Clock = std::chrono::steady_clock;
+    const size_t n = tasks_.size();
+    timings_.assign(n, {});
+    for (size_t i = 0; i < n; ++i) timings_[i].name = tasks_[i].name;
+    if (n == 0) return;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<TaskId> ready;
+    std::vector<size_t> pending(n);
+    std::vector<bool> skipped(n, false);
+    std::exception_ptr error;
+    size_t finished = 0;
+    for (TaskId id = 0; id < n; ++id) {
+        pending[id] = tasks_[id].dependencyCount;
+        if (pending[id] == 0) ready.push_back(id);
+    }
+
+    const Clock::time_point start = Clock::now();
+    auto seconds = [start](Clock::time_point t) { return std::chrono::duration<double>(t - start).count(); };
+    auto worker = [&]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            wake.wait(lock, [&]() { return !ready.empty() || finished == n; });
+            if (ready.empty()) return;
+            TaskId id = ready.front();
+            ready.pop_front();
+            bool skip = skipped[id];
+            lock.unlock();
+
+            Clock::time_point began = Clock::now();
+            std::exception_ptr failure;
+            if (!skip) {
+                try {
+                    tasks_[id].run();
+                } catch (...) {
+                    failure = std::current_exception();
+                }
+            }
+            Clock::time_point ended = Clock::now();
+
+            lock.lock();
+            timings_[id].startSeconds = seconds(began);
+            timings_[id].seconds = skip ? 0.0 : seconds(ended) - seconds(began);
+            timings_[id].skipped = skip;
+            if (failure && !error) error = failure;
+            // Skipped tasks still pass through the queue so their dependents are released (and skipped) too.
+            for (TaskId dependent : tasks_[id].dependents) {
+                if (skip || failure) skipped[dependent] = true;
+                if (--pending[dependent] == 0) ready.push_back(dependent);
+            }
+            ++finished;
+            wake.notify_all();
+        }
+    };
+
+    size_t count = std::min(threads > 0 ? threads : n, n);
+    std::vector<std::thread> workers;
+    workers.reserve(count - 1);
+    for (size_t t = 0; t + 1 < count; ++t) workers.emplace_back(worker);
+    worker();
+    for (auto& thread : workers) thread.join();
+    wallSeconds_ = seconds(Clock::now());
+
+    if (error) std::rethrow_exception(error);
+}
+
+void TaskGraph::logTimings(const std::string& title) const {
+    double busy = 0.0;
+    for (const auto& timing : timings_) busy += timing.seconds;
+    LOG_INFO("{} took {:.3f} s ({:.3f} s of task time):", title, wallSeconds_, busy);
+    for (const auto& timing : timings_) {
+        if (timing.skipped) {
+            LOG_INFO("  {:<22} skipped", timing.name);
+        } else {
+            LOG_INFO("  {:<22} {:>8.3f} s  (from {:.3f} s)", timing.name, timing.seconds, timing.startSeconds);
+        }
+    }
+}
+
+} // namespace utils
@@ -1,20 +1,18 @@
 #include "utils/util.h"
+#include "utils/datetime.h"
 #include <ctime>
 #include <cmath>
 
 int extractHour(const std::time_t& timestamp) {
-    std::tm* timeinfo = std::localtime(&timestamp);
-    return timeinfo->tm_hour;
+    return utils::TimeZone::local().toLocal(timestamp).hour;
 }
 
 int extractDayOfWeek(const std::time_t& timestamp) {
-    std::tm* timeinfo = std::localtime(&timestamp);
-    return timeinfo->tm_wday; // 0=Sunday, 1=Monday, ..., 6=Saturday
+    return utils::TimeZone::local().toLocal(timestamp).weekday; // 0=Sunday, 1=Monday, ..., 6=Saturday
 }
 
 int extractMonth(const std::time_t& timestamp) {
-    std::tm* timeinfo = std::localtime(&timestamp);
-    return timeinfo->tm_mon + 1; // tm_mon is 0-based, we want 1-12
+    return utils::TimeZone::local().toLocal(timestamp).month; // 1-12
 }
 
 int extractQuarter(const std::time_t& timestamp) {
@@ -23,8 +21,7 @@ int extractQuarter(const std::time_t& timestamp) {
 }
 
 int extractDayOfYear(const std::time_t& timestamp) {
-    std::tm* timeinfo = std::localtime(&timestamp);
-    return timeinfo->tm_yday + 1; // tm_yday is 0-based, we want 1-366
+    return utils::TimeZone::local().toLocal(timestamp).yearDay + 1; // yearDay is 0-based, we want 1-366
 }
 
 int extractSeason(const std::time_t& timestamp) {
@@ -51,9 +48,9 @@ int extractShift(int hour) {
 }
 
 bool isHoliday(const std::time_t& timestamp) {
-    std::tm* timeinfo = std::localtime(&timestamp);
-    int month = timeinfo->tm_mon + 1;
-    int day = timeinfo->tm_mday;
+    utils::CivilTime local = utils::TimeZone::local().toLocal(timestamp);
+    int month = local.month;
+    int day = local.day;
     
     // Simple holiday detection for major US holidays
     // New Year's Day
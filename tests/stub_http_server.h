@@ -0,0 +1,109 @@
+#pragma once
+
+// Minimal keep-alive HTTP/1.1 server on 127.0.0.1 for testing HTTP clients without a network.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class StubHttpServer {
+public:
+    // Maps a request target (path + query) to {status code, body}.
+    using Handler = std::function<std::pair<int, std::string>(const std::string& target)>;
+
+    explicit StubHttpServer(Handler handler) : handler_(std::move(handler)) {
+        listenFd_ = ::socket(AF_INET, SOCK_STREAM, 0);
+        int reuse = 1;
+        ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        addr.sin_port = 0;
+        ::bind(listenFd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr));
+        ::listen(listenFd_, 16);
+
+        socklen_t len = sizeof(addr);
+        ::getsockname(listenFd_, reinterpret_cast<sockaddr*>(&addr), &len);
+        port_ = ntohs(addr.sin_port);
+
+        acceptThread_ = std::thread([this] { acceptLoop(); });
+    }
+
+    ~StubHttpServer() {
+        stopping_ = true;
+        ::shutdown(listenFd_, SHUT_RDWR);
+        ::close(listenFd_);
+        acceptThread_.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            for (int fd : clientFds_) ::shutdown(fd, SHUT_RDWR);
+        }
+        for (auto& t : clientThreads_) t.join();
+        for (int fd : clientFds_) ::close(fd);
+    }
+
+    std::string baseUrl() const { return "http://127.0.0.1:" + std::to_string(port_); }
+    int connections() const { return connections_; }
+    int requests() const { return requests_; }
+
+private:
+    Handler handler_;
+    int listenFd_ = -1;
+    int port_ = 0;
+    std::atomic<bool> stopping_{false};
+    std::atomic<int> connections_{0};
+    std::atomic<int> requests_{0};
+    std::mutex mutex_;
+    std::vector<int> clientFds_;
+    std::vector<std::thread> clientThreads_;
+    std::thread acceptThread_;
+
+    void acceptLoop() {
+        while (!stopping_) {
+            int fd = ::accept(listenFd_, nullptr, nullptr);
+            if (fd < 0) return;
+            ++connections_;
+            std::lock_guard<std::mutex> lock(mutex_);
+            clientFds_.push_back(fd);
+            clientThreads_.emplace_back([this, fd] { serve(fd); });
+        }
+    }
+
+    void serve(int fd) {
+        std::string buffer;
+        char chunk[4096];
+        while (true) {
+            size_t end;
+            while ((end = buffer.find("\r\n\r\n")) == std::string::npos) {
+                ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+                if (n <= 0) return;
+                buffer.append(chunk, static_cast<size_t>(n));
+            }
+            std::string head = buffer.substr(0, end);
+            buffer.erase(0, end + 4);
+
+            // "GET <target> HTTP/1.1"
+            size_t first = head.find(' ');
+            size_t second = head.find(' ', first + 1);
+            std::string target = head.substr(first + 1, second - first - 1);
+            ++requests_;
+
+            auto [status, body] = handler_(target);
+            std::string response = "HTTP/1.1 " + std::to_string(status) + " Stub\r\n"
+                "Content-Type: application/json\r\n"
+                "Content-Length: " + std::to_string(body.size()) + "\r\n"
+                "Connection: keep-alive\r\n\r\n" + body;
+            if (::send(fd, response.data(), response.size(), MSG_NOSIGNAL) < 0) return;
+        }
+    }
+};
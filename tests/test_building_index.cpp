@@ -0,0 +1,151 @@
+/*
+Unit tests for the tile-cached building index.
+1. Overpass elements are parsed into buildings, centers and levels included.
+2. Tiles are fetched once, saved, and later runs answer radius queries offline.
+3. Radius queries and summaries match a brute-force scan.
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <nlohmann/json.hpp>
+
+#include "services/building_index.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+#include "stub_http_server.h"
+
+using json = nlohmann::json;
+
+namespace {
+std::string percentDecode(const std::string& text) {
+    std::string out;
+    for (size_t i = 0; i < text.size(); ++i) {
+        if (text[i] == '%' && i + 2 < text.size()) {
+            out += static_cast<char>(std::stoi(text.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else {
+            out += text[i];
+        }
+    }
+    return out;
+}
+
+// A building every 0.001 degrees, with 1 to 5 levels.
+std::vector<Building> syntheticBuildings() {
+    std::vector<Building> buildings;
+    for (int r = 0; r < 40; ++r) {
+        for (int c = 0; c < 40; ++c) {
+            buildings.push_back({r * 40 + c + 1, Location(36.14 + r * 0.001, -86.80 + c * 0.001),
+                                 1 + (r + c) % 5, c % 2 ? "house" : "retail"});
+        }
+    }
+    return buildings;
+}
+
+// Answers an Overpass bbox query with the synthetic buildings inside it, as ways with centers.
+std::pair<int, std::string> overpassResponse(const std::string& target) {
+    std::string query = percentDecode(target.substr(target.find("data=") + 5));
+    size_t open = query.find('(', query.find("node"));
+    double s, w, n, e;
+    std::sscanf(query.c_str() + open, "(%lf,%lf,%lf,%lf)", &s, &w, &n, &e);
+
+    json elements = json::array();
+    for (const auto& b : syntheticBuildings()) {
+        if (b.location.lat < s || b.location.lat > n || b.location.lon < w || b.location.lon > e) continue;
+        elements.push_back({{"type", "way"}, {"id", b.id},
+                            {"center", {{"lat", b.location.lat}, {"lon", b.location.lon}}},
+                            {"tags", {{"building", b.type}, {"building:levels", std::to_string(b.levels)}}}});
+    }
+    return {200, json{{"elements", elements}}.dump()};
+}
+
+double meters(const Location& a, const Location& b) {
+    const double toRad = M_PI / 180.0;
+    double h = std::pow(std::sin((b.lat - a.lat) * toRad / 2), 2)
+             + std::cos(a.lat * toRad) * std::cos(b.lat * toRad) * std::pow(std::sin((b.lon - a.lon) * toRad / 2), 2);
+    return 2.0 * 6371000.0 * std::asin(std::sqrt(h));
+}
+}
+
+class BuildingIndexTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+        std::remove(path_.c_str());
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+        std::remove(path_.c_str());
+    }
+
+    const std::string path_ = "test_buildings.bin";
+    const std::vector<Location> incidents_ = {Location(36.150, -86.790), Location(36.165, -86.775), Location(36.1555, -86.7855)};
+};
+
+TEST_F(BuildingIndexTest, ParsesOverpassElements) {
+    std::string response = R"({"elements": [
+        {"type": "node", "id": 1, "lat": 36.1, "lon": -86.7, "tags": {"building": "house"}},
+        {"type": "way", "id": 2, "center": {"lat": 36.2, "lon": -86.8}, "tags": {"building": "office", "building:levels": "4"}},
+        {"type": "way", "id": 3, "tags": {"building": "yes"}},
+        {"type": "node", "id": 4, "lat": 36.3, "lon": -86.9, "tags": {"amenity": "cafe"}},
+        {"type": "way", "id": 5, "center": {"lat": 36.4, "lon": -86.6}, "tags": {"building": "yes", "building:levels": "two"}}
+    ]})";
+    std::vector<Building> buildings = parseOverpassBuildings(response);
+    ASSERT_EQ(buildings.size(), 3u);
+    EXPECT_EQ(buildings[0].type, "house");
+    EXPECT_EQ(buildings[0].levels, 1);
+    EXPECT_DOUBLE_EQ(buildings[1].location.lat, 36.2);
+    EXPECT_EQ(buildings[1].levels, 4);
+    EXPECT_EQ(buildings[2].id, 5);
+    EXPECT_EQ(buildings[2].levels, 1);
+}
+
+TEST_F(BuildingIndexTest, FetchesTilesOnceAndLoadsOffline) {
+    StubHttpServer server(overpassResponse);
+    BuildingIndex fetched = BuildingIndex::openOrFetch(path_, incidents_, 200.0, server.baseUrl() + "/api/interpreter", 15);
+    int requests = server.requests();
+    EXPECT_GT(requests, 0);
+    EXPECT_EQ(static_cast<size_t>(requests), fetched.tileCount());
+    EXPECT_TRUE(fetched.missingTiles(incidents_, 200.0).empty());
+
+    BuildingIndex reloaded = BuildingIndex::openOrFetch(path_, incidents_, 200.0, server.baseUrl() + "/api/interpreter", 15);
+    EXPECT_EQ(server.requests(), requests);
+    EXPECT_EQ(reloaded.size(), fetched.size());
+    EXPECT_EQ(reloaded.tileCount(), fetched.tileCount());
+
+    for (const auto& incident : incidents_) {
+        EXPECT_EQ(reloaded.within(incident, 200.0).size(), fetched.within(incident, 200.0).size());
+    }
+}
+
+TEST_F(BuildingIndexTest, RadiusQueriesMatchBruteForce) {
+    BuildingIndex index(15);
+    std::vector<Building> all = syntheticBuildings();
+    for (const auto& tile : index.missingTiles(incidents_, 300.0)) {
+        index.addTile(tile, all);
+    }
+
+    for (const auto& incident : incidents_) {
+        int expectedCount = 0, expectedLevels = 0;
+        double expectedNearest = 300.0;
+        for (const auto& b : all) {
+            double d = meters(incident, b.location);
+            if (d > 300.0) continue;
+            ++expectedCount;
+            expectedLevels = std::max(expectedLevels, b.levels);
+            expectedNearest = std::min(expectedNearest, d);
+        }
+        BuildingIndex::Summary summary = index.summarize(incident, 300.0);
+        EXPECT_GT(summary.count, 0);
+        EXPECT_EQ(summary.count, expectedCount);
+        EXPECT_EQ(summary.maxLevels, expectedLevels);
+        EXPECT_NEAR(summary.nearestMeters, expectedNearest, 1e-3);
+    }
+}
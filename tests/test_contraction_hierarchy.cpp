@@ -0,0 +1,125 @@
+/*
+Unit tests for the contraction hierarchy.
+1. Many-to-many tables match plain Dijkstra on a random grid.
+2. A saved hierarchy is memory-mapped back with identical answers.
+3. Hierarchies built for another graph or truncated files are rejected.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include "services/contraction_hierarchy.h"
+#include "services/native_router.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+namespace {
+constexpr int SIDE = 20;
+
+// SIDE x SIDE grid with asymmetric random durations and distances, no ties.
+RoadGraph randomGrid(unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> duration(10.0, 100.0), distance(100.0, 1000.0);
+
+    std::vector<Location> nodes;
+    for (int r = 0; r < SIDE; ++r) {
+        for (int c = 0; c < SIDE; ++c) nodes.emplace_back(36.0 + r * 0.005, -86.8 + c * 0.005);
+    }
+    std::vector<RoadGraph::Edge> edges;
+    for (uint32_t r = 0; r < SIDE; ++r) {
+        for (uint32_t c = 0; c < SIDE; ++c) {
+            uint32_t v = r * SIDE + c;
+            if (c + 1 < SIDE) {
+                edges.push_back({v, v + 1, distance(rng), duration(rng)});
+                edges.push_back({v + 1, v, distance(rng), duration(rng)});
+            }
+            if (r + 1 < SIDE) {
+                edges.push_back({v, v + SIDE, distance(rng), duration(rng)});
+                edges.push_back({v + SIDE, v, distance(rng), duration(rng)});
+            }
+        }
+    }
+    return RoadGraph(std::move(nodes), edges);
+}
+}
+
+class ContractionHierarchyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+
+        for (uint32_t v = 0; v < SIDE * SIDE; v += 37) sources_.push_back(v);
+        for (uint32_t v = 0; v < SIDE * SIDE; v += 3) targets_.push_back(v);
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+        std::remove(path_.c_str());
+    }
+
+    void expectMatchesDijkstra(const ContractionHierarchy& ch, const RoadGraph& graph) {
+        std::vector<Location> sourceLocations, targetLocations;
+        for (uint32_t v : sources_) sourceLocations.push_back(graph.node(v));
+        for (uint32_t v : targets_) targetLocations.push_back(graph.node(v));
+        auto [expectedDistances, expectedDurations] = NativeRouter(graph).tableMatrices(sourceLocations, targetLocations);
+
+        auto [distances, durations] = ch.manyToMany(sources_, targets_, 2);
+        ASSERT_EQ(durations.height(), static_cast<int>(sources_.size()));
+        ASSERT_EQ(durations.width(), static_cast<int>(targets_.size()));
+        for (int i = 0; i < durations.height(); ++i) {
+            for (int j = 0; j < durations.width(); ++j) {
+                EXPECT_NEAR(durations.at(i, j), expectedDurations.at(i, j), 1e-6);
+                EXPECT_NEAR(distances.at(i, j), expectedDistances.at(i, j), 1e-6);
+            }
+        }
+    }
+
+    std::vector<uint32_t> sources_, targets_;
+    const std::string path_ = "test_road_graph.ch";
+};
+
+TEST_F(ContractionHierarchyTest, MatchesDijkstra) {
+    RoadGraph graph = randomGrid(7);
+    ContractionHierarchy ch = ContractionHierarchy::build(graph);
+    EXPECT_EQ(ch.nodeCount(), graph.nodeCount());
+    expectMatchesDijkstra(ch, graph);
+}
+
+TEST_F(ContractionHierarchyTest, MapsSavedFile) {
+    RoadGraph graph = randomGrid(11);
+    ASSERT_TRUE(ContractionHierarchy::build(graph).save(path_));
+
+    ContractionHierarchy mapped = ContractionHierarchy::open(path_);
+    EXPECT_EQ(mapped.graphFingerprint(), ContractionHierarchy::fingerprint(graph));
+    expectMatchesDijkstra(mapped, graph);
+
+    NativeRouter router(graph);
+    EXPECT_NO_THROW(router.useHierarchy(std::move(mapped)));
+}
+
+TEST_F(ContractionHierarchyTest, RejectsForeignOrTruncatedFiles) {
+    RoadGraph graph = randomGrid(3);
+    RoadGraph other = randomGrid(4);
+    ContractionHierarchy::build(other).save(path_);
+
+    NativeRouter router(graph);
+    EXPECT_THROW(router.useHierarchy(ContractionHierarchy::open(path_)), MismatchError);
+
+    // openOrBuild replaces the stale file with one for this graph.
+    ContractionHierarchy rebuilt = ContractionHierarchy::openOrBuild(graph, path_);
+    EXPECT_EQ(ContractionHierarchy::open(path_).graphFingerprint(), ContractionHierarchy::fingerprint(graph));
+
+    {
+        std::ofstream truncated(path_, std::ios::binary | std::ios::trunc);
+        truncated << "FSCH";
+    }
+    EXPECT_THROW(ContractionHierarchy::open(path_), InvalidValueError);
+}
@@ -0,0 +1,124 @@
+/*
+Unit tests for the memory-mapped parallel CSV reader and the loaders built on it.
+1. Fields and numbers split like the getline / stoi / stod code they replace.
+2. Parallel chunked parsing returns every line in file order, CRLF or not.
+3. Incidents keep file-order indices and drop later duplicates whatever the thread count.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "utils/csv_reader.h"
+#include "utils/loaders.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+using json = nlohmann::json;
+
+class CsvReaderTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+        std::remove(path_.c_str());
+    }
+
+    const std::string path_ = "test_csv_reader.csv";
+};
+
+TEST_F(CsvReaderTest, SplitsFieldsLikeGetline) {
+    utils::CsvFields fields("12,Station 4,,-86.7");
+    EXPECT_EQ(fields.next(), "12");
+    EXPECT_EQ(fields.next(), "Station 4");
+    EXPECT_EQ(fields.next(), "");
+    EXPECT_EQ(fields.next(), "-86.7");
+    EXPECT_EQ(fields.next(), "");
+
+    int i = 0;
+    double d = 0.0;
+    EXPECT_TRUE(utils::parseInt(" 42abc", i));
+    EXPECT_EQ(i, 42);
+    EXPECT_TRUE(utils::parseInt("3.0", i));
+    EXPECT_EQ(i, 3);
+    EXPECT_FALSE(utils::parseInt("", i));
+    EXPECT_FALSE(utils::parseInt("x1", i));
+    EXPECT_TRUE(utils::parseDouble("36.1627", d));
+    EXPECT_DOUBLE_EQ(d, 36.1627);
+    EXPECT_TRUE(utils::parseDouble("+1e3", d));
+    EXPECT_DOUBLE_EQ(d, 1000.0);
+}
+
+TEST_F(CsvReaderTest, ParallelChunksKeepFileOrder) {
+    const int rows = 200000;
+    {
+        std::ofstream out(path_, std::ios::binary);
+        out << "id,value\r\n";
+        for (int r = 0; r < rows; ++r) {
+            out << r << "," << r * 0.5 << (r % 3 ? "\n" : "\r\n");
+            if (r % 1000 == 0) out << "\n";  // blank lines are skipped
+        }
+    }
+
+    utils::CsvFile file(path_);
+    ASSERT_TRUE(file.isOpen());
+    EXPECT_EQ(file.header(), "id,value");
+    auto parse = [](std::string_view line) {
+        utils::CsvFields fields(line);
+        std::pair<int, double> row;
+        utils::parseInt(fields.next(), row.first);
+        utils::parseDouble(fields.next(), row.second);
+        return row;
+    };
+    auto parallel = file.parseLines<std::pair<int, double>>(parse, 8);
+    auto serial = file.parseLines<std::pair<int, double>>(parse, 1);
+    ASSERT_EQ(parallel.size(), static_cast<size_t>(rows));
+    EXPECT_EQ(parallel, serial);
+    for (int r = 0; r < rows; ++r) {
+        ASSERT_EQ(parallel[r].first, r);
+        ASSERT_DOUBLE_EQ(parallel[r].second, r * 0.5);
+    }
+
+    EXPECT_FALSE(utils::CsvFile("missing_file.csv").isOpen());
+}
+
+TEST_F(CsvReaderTest, IncidentsAreIndexedInFileOrder) {
+    {
+        std::ofstream out(path_);
+        out << "incident_id,lat,lon,incident_type,incident_level,datetime,category\n";
+        for (int r = 0; r < 50000; ++r) {
+            // Every 7th row repeats an earlier ID and must be dropped.
+            int id = r % 7 == 6 ? r - 3 : r;
+            out << id << ",36." << r % 1000 << ",-86.7,Fire,High,2024-03-10 0" << r % 10 << ":30:00,One\n";
+        }
+    }
+    EnvLoader::cleanup();
+    EnvLoader::init(json{{"INCIDENTS_CSV_PATH", path_}, {"BOUNDS_GEOJSON_PATH", "missing_bounds.geojson"}}.dump(), "json");
+
+    std::vector<Incident> incidents = loader::loadIncidentsFromCSV();
+    ASSERT_EQ(incidents.size(), 50000u - 50000u / 7);
+    for (size_t i = 0; i < incidents.size(); ++i) {
+        ASSERT_EQ(incidents[i].incidentIndex, static_cast<int>(i));
+    }
+    EXPECT_EQ(incidents[6].incident_id, 7);
+    EXPECT_EQ(incidents[0].category, IncidentCategory::One);
+
+    std::tm tm = {};
+    tm.tm_year = 124;
+    tm.tm_mon = 2;
+    tm.tm_mday = 10;
+    tm.tm_hour = 3;
+    tm.tm_min = 30;
+    tm.tm_isdst = -1;
+    EXPECT_EQ(incidents[3].reportTime, std::mktime(&tm));
+}
@@ -0,0 +1,98 @@
+/*
+Unit tests for the transition-table time zone and the timestamp parser/formatter.
+1. Formatting and broken-down fields match localtime + put_time in several zones.
+2. Parsing matches get_time + mktime for every quarter hour of a year, DST gaps and overlaps included.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdlib>
+#include <ctime>
+#include <iomanip>
+#include <random>
+#include <sstream>
+
+#include "utils/datetime.h"
+
+namespace {
+std::string libcFormat(std::time_t t) {
+    std::ostringstream oss;
+    std::tm tm{};
+    localtime_r(&t, &tm);
+    oss << std::put_time(&tm, "%Y-%m-%d %H:%M:%S");
+    return oss.str();
+}
+
+std::time_t libcParse(const std::string& text) {
+    std::tm tm{};
+    std::istringstream ss(text);
+    ss >> std::get_time(&tm, "%Y-%m-%d %H:%M:%S");
+    tm.tm_isdst = -1;
+    return std::mktime(&tm);
+}
+}
+
+class DateTimeTest : public ::testing::TestWithParam<const char*> {
+protected:
+    void SetUp() override {
+        const char* tz = std::getenv("TZ");
+        hadTz_ = tz != nullptr;
+        if (hadTz_) savedTz_ = tz;
+        setenv("TZ", GetParam(), 1);
+        tzset();
+    }
+
+    void TearDown() override {
+        if (hadTz_) {
+            setenv("TZ", savedTz_.c_str(), 1);
+        } else {
+            unsetenv("TZ");
+        }
+        tzset();
+    }
+
+    bool hadTz_ = false;
+    std::string savedTz_;
+};
+
+TEST_P(DateTimeTest, FormatsLikeLocaltime) {
+    utils::TimeZone zone = utils::TimeZone::current();
+    std::mt19937_64 rng(5);
+    std::uniform_int_distribution<std::time_t> instant(-1000000000LL, 4000000000LL);
+    for (int i = 0; i < 200000; ++i) {
+        std::time_t t = instant(rng);
+        ASSERT_EQ(utils::formatDateTime(t, zone), libcFormat(t)) << "t = " << t;
+
+        std::tm tm{};
+        localtime_r(&t, &tm);
+        utils::CivilTime civil = zone.toLocal(t);
+        ASSERT_EQ(civil.weekday, tm.tm_wday);
+        ASSERT_EQ(civil.yearDay, tm.tm_yday);
+        ASSERT_EQ(zone.utcOffset(t), tm.tm_gmtoff);
+    }
+}
+
+TEST_P(DateTimeTest, ParsesLikeMktime) {
+    utils::TimeZone zone = utils::TimeZone::current();
+    std::time_t start = libcParse("2024-01-01 00:00:00");
+    for (std::time_t wall = 0; wall < 366 * 86400; wall += 900) {
+        // Walk wall-clock strings, not instants, so skipped and repeated hours are hit.
+        std::time_t shifted = start + wall;
+        std::tm tm{};
+        gmtime_r(&shifted, &tm);
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &tm);
+
+        std::time_t parsed = 0;
+        ASSERT_TRUE(utils::parseDateTime(text, parsed, zone));
+        ASSERT_EQ(parsed, libcParse(text)) << text;
+    }
+
+    std::time_t parsed = 0;
+    EXPECT_TRUE(utils::parseDateTime("2024-07-04 12:30:00.000", parsed, zone));
+    EXPECT_EQ(parsed, libcParse("2024-07-04 12:30:00"));
+    EXPECT_FALSE(utils::parseDateTime("2024/07/04 12:30:00", parsed, zone));
+    EXPECT_FALSE(utils::parseDateTime("", parsed, zone));
+}
+
+INSTANTIATE_TEST_SUITE_P(Zones, DateTimeTest,
+                         ::testing::Values("UTC", "America/Chicago", "Australia/Sydney", "CST6CDT,M3.2.0,M11.1.0"));
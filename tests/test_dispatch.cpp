@@ -350,4 +350,43 @@ TEST_F(NearestDispatchIntegrationTest, LoadsRealMatrixFiles) {
     // This test verifies that the constructor can load real matrix files
     EXPECT_NE(dispatch_, nullptr);
     // Additional tests with real data can be added here
-}
\ No newline at end of file
+}
+TEST_F(NearestDispatchTest, FallsBackToFullOrderWhenTopKExhausted) {
+    // Only the single nearest station is precomputed per incident.
+    dispatch_ = std::make_unique<NearestDispatch>(distanceMatrixPath_, durationMatrixPath_, "", 1);
+    State state = createMockState(0);
+    state.getStation(0).dispatchApparatus(ApparatusType::Engine, 2);
+
+    std::vector<Action> actions = dispatch_->getAction(state);
+
+    ASSERT_FALSE(actions.empty());
+    EXPECT_EQ(actions[0].type, StationActionType::Dispatch);
+    EXPECT_EQ(actions[0].payload.stationIndex, 1);
+    EXPECT_DOUBLE_EQ(actions[0].payload.travelTime, 90.0);
+}
+
+TEST_F(NearestDispatchTest, UsesTravelTimeOracleForIncidentsOutsideMatrix) {
+    // 1x2 grid, incident falls in cell 1 where station 2 is nearest.
+    const std::string oraclePath = "test_travel_time_oracle.bin";
+    GridSpec grid{36.16, -86.79, 0.01, 0.01, 1, 2};
+    TravelTimeOracle oracle(grid, {{100.0, 300.0}, {100.0, 200.0}, {100.0, 45.0}});
+    ASSERT_TRUE(oracle.save(oraclePath));
+    dispatch_ = std::make_unique<NearestDispatch>(distanceMatrixPath_, durationMatrixPath_, "", 5, 64, oraclePath);
+    std::remove(oraclePath.c_str());
+
+    // Synthetic incident with no matrix column.
+    Incident synthetic(3, 204, 36.165, -86.775, IncidentType::BuildingFire, IncidentLevel::Low,
+                       std::time(nullptr), IncidentCategory::One);
+    synthetic.resolvedTime = synthetic.reportTime + 1800;
+    synthetic.setRequiredApparatusMap({{ApparatusType::Engine, 1}});
+    State state = createMockState(-1);
+    state.getActiveIncidents().insert({3, synthetic});
+    state.inProgressIncidentIndices.push_back(3);
+
+    std::vector<Action> actions = dispatch_->getAction(state);
+
+    ASSERT_FALSE(actions.empty());
+    EXPECT_EQ(actions[0].type, StationActionType::Dispatch);
+    EXPECT_EQ(actions[0].payload.stationIndex, 2);
+    EXPECT_DOUBLE_EQ(actions[0].payload.travelTime, 45.0);
+}
@@ -0,0 +1,64 @@
+/*
+Unit tests for the enum name registries.
+1. Every value's name parses back to the value, for all five registries; unknown or near-miss names do not parse.
+2. Incident type descriptions match case-insensitively and fall back to the keyword patterns, categories and levels
+   stay case-sensitive, and values outside the enum print their old fallbacks.
+*/
+
+#include <gtest/gtest.h>
+#include <string>
+
+#include "enums.h"
+
+namespace {
+template <typename E, typename Registry>
+void expectRoundTrip(const Registry& registry) {
+    for (size_t i = 0; i < registry.size(); ++i) {
+        auto value = static_cast<E>(i);
+        std::string_view name = registry.name(value);
+        ASSERT_EQ(registry.parse(name), value) << name;
+        ASSERT_FALSE(registry.parse(std::string(name) + "x")) << name;
+        ASSERT_NE(registry.parse(name.substr(0, name.size() - 1)), value) << name;
+    }
+    EXPECT_FALSE(registry.parse(""));
+}
+}
+
+// Lookups are usable in constant expressions.
+static_assert(INCIDENT_CATEGORY_NAMES.parse("ThreeCM") == IncidentCategory::ThreeCM);
+static_assert(INCIDENT_TYPE_NAMES.name(IncidentType::LockOut) == "Lock-out");
+static_assert(APPARATUS_TYPE_NAMES.size() == static_cast<size_t>(ApparatusType::Invalid) + 1);
+
+TEST(EnumRegistryTest, NamesRoundTrip) {
+    expectRoundTrip<IncidentLevel>(INCIDENT_LEVEL_NAMES);
+    expectRoundTrip<IncidentCategory>(INCIDENT_CATEGORY_NAMES);
+    expectRoundTrip<IncidentType>(INCIDENT_TYPE_NAMES);
+    expectRoundTrip<IncidentStatus>(INCIDENT_STATUS_NAMES);
+    expectRoundTrip<ApparatusType>(APPARATUS_TYPE_NAMES);
+    EXPECT_EQ(INCIDENT_CATEGORY_NAMES.size(), 55u);
+
+    EXPECT_EQ(stringToIncidentCategory("EightG"), IncidentCategory::EightG);
+    EXPECT_EQ(stringToIncidentCategory("Seventeen"), IncidentCategory::Invalid);
+    EXPECT_EQ(to_string(IncidentCategory::OneBM), "OneBM");
+    EXPECT_EQ(std::string(to_string(ApparatusType::UTV)), "UTV");
+    EXPECT_EQ(std::string(to_string(IncidentStatus::isBeingResolved)), "isBeingResolved");
+    EXPECT_EQ(to_string(IncidentLevel::Critical), "Critical");
+}
+
+TEST(EnumRegistryTest, KeepsCaseRulesAndFallbacks) {
+    EXPECT_EQ(mapIncidentType("Building fire"), IncidentType::BuildingFire);
+    EXPECT_EQ(mapIncidentType("GAS LEAK (NATURAL GAS OR LPG)"), IncidentType::GasLeak);
+    EXPECT_EQ(mapIncidentType("co detector activation, no co"), IncidentType::CODetectorActivation);
+    EXPECT_EQ(mapIncidentType("Cancelled en route"), IncidentType::Cancelled);
+    EXPECT_EQ(mapIncidentType("Trash container fire"), IncidentType::OutsideRubbishFire);
+    EXPECT_EQ(mapIncidentType("Invalid"), IncidentType::Other);
+    EXPECT_EQ(mapIncidentType(""), IncidentType::Other);
+
+    EXPECT_EQ(stringToIncidentCategory("one"), IncidentCategory::Invalid);
+    EXPECT_FALSE(INCIDENT_LEVEL_NAMES.parse("low"));
+
+    EXPECT_EQ(to_string(static_cast<IncidentCategory>(200)), "Unknown");
+    EXPECT_EQ(to_string(static_cast<IncidentType>(200)), "Unknown");
+    EXPECT_EQ(std::string(to_string(static_cast<ApparatusType>(200))), "Invalid");
+    EXPECT_EQ(std::string(to_string(static_cast<IncidentStatus>(200))), "Invalid");
+}
@@ -0,0 +1,151 @@
+/*
+Unit tests for DepartmentFireModel resolution time sampling.
+1. The default NORMAL sampler reproduces a fresh std::normal_distribution per draw, for known categories, a category
+   with an empty std column and the count-weighted fallback of an unknown category.
+2. The QUANTILE sampler stays within each category's min and max and matches its quartiles, falls back to the normal
+   for rows without quantiles, and mixes the known categories by count for an unknown one.
+3. With counter streams an incident's draws do not depend on the order incidents are resolved in, and change
+   with the replication.
+*/
+
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <vector>
+
+#include "models/fire.h"
+#include "config/EnvLoader.h"
+#include "simulator/state.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class DepartmentFireModelTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+        // Integer statistics keep the weighted fallback exact in any summation order.
+        std::ofstream out(path_);
+        out << "Enum,count,mean,std,min,25%,50%,75%,max\n"
+            << "One,30,600,120,60,500,600,700,1800\n"
+            << "Two,10,1200,300,300,1000,1150,1400,3600\n"
+            << "Three,20,900,,100,800,900,1000,2000\n"
+            << "Four,40,300,60,,,,,\n";
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+
+    Incident incident(IncidentCategory category) {
+        return Incident(0, 0, 36.16, -86.78, IncidentType::BuildingFire, IncidentLevel::Low, 0, category);
+    }
+
+    std::string path_ = "test_resolution_stats.csv";
+};
+
+TEST_F(DepartmentFireModelTest, NormalSamplerKeepsTheDrawSequence) {
+    DepartmentFireModel model(7, "missing_requirements.csv", path_);
+    State state;
+
+    // Mean and standard deviation as the CSV gives them; the unknown category uses the weighted moments.
+    double fallback_mean = (600.0 * 30 + 1200.0 * 10 + 900.0 * 20 + 300.0 * 40) / 100;
+    double fallback_variance = (120.0 * 120 * 30 + 300.0 * 300 * 10 + 0.0 * 20 + 60.0 * 60 * 40) / 100;
+    std::vector<std::pair<IncidentCategory, std::pair<double, double>>> cases = {
+        {IncidentCategory::One, {600.0, 120.0}},
+        {IncidentCategory::Two, {1200.0, 300.0}},
+        {IncidentCategory::Four, {300.0, 60.0}},
+        {IncidentCategory::Eighteen, {fallback_mean, std::sqrt(fallback_variance)}},
+    };
+    std::mt19937 rng(7);
+    for (int draw = 0; draw < 4000; ++draw) {
+        const auto& [category, params] = cases[draw % cases.size()];
+        std::normal_distribution<double> fresh(params.first, params.second);
+        double expected = std::max(fresh(rng), 1.0);
+        ASSERT_EQ(model.computeResolutionTime(state, incident(category)), expected) << draw;
+    }
+}
+
+TEST_F(DepartmentFireModelTest, QuantileSamplerFollowsTheQuartiles) {
+    EnvLoader::cleanup();
+    EnvLoader::init(json{{"RESOLUTION_SAMPLER", "QUANTILE"}}.dump(), "json");
+    DepartmentFireModel model(11, "missing_requirements.csv", path_);
+    State state;
+
+    const int draws = 40000;
+    std::vector<double> one, four, unknown;
+    for (int i = 0; i < draws; ++i) {
+        one.push_back(model.computeResolutionTime(state, incident(IncidentCategory::One)));
+        four.push_back(model.computeResolutionTime(state, incident(IncidentCategory::Four)));
+        unknown.push_back(model.computeResolutionTime(state, incident(IncidentCategory::Eighteen)));
+    }
+    auto quantile = [](std::vector<double> values, double p) {
+        size_t k = static_cast<size_t>(p * static_cast<double>(values.size() - 1));
+        std::nth_element(values.begin(), values.begin() + static_cast<std::ptrdiff_t>(k), values.end());
+        return values[k];
+    };
+    EXPECT_GE(*std::min_element(one.begin(), one.end()), 60.0);
+    EXPECT_LE(*std::max_element(one.begin(), one.end()), 1800.0);
+    EXPECT_NEAR(quantile(one, 0.25), 500.0, 10.0);
+    EXPECT_NEAR(quantile(one, 0.50), 600.0, 10.0);
+    EXPECT_NEAR(quantile(one, 0.75), 700.0, 10.0);
+
+    // No quantiles in the CSV: the category's normal.
+    double mean = 0.0;
+    for (double value : four) mean += value / draws;
+    EXPECT_NEAR(mean, 300.0, 2.0);
+    EXPECT_LT(*std::min_element(four.begin(), four.end()), 150.0);
+
+    // An unknown category draws from the known ones by count: Two (10 of 100) alone reaches past 2000.
+    double above = static_cast<double>(std::count_if(unknown.begin(), unknown.end(), [](double v) { return v > 2000.0; }));
+    EXPECT_NEAR(above / draws, 0.1 * (3600.0 - 2000.0) / (3600.0 - 1400.0) * 0.25, 0.005);
+
+    EnvLoader::cleanup();
+    EnvLoader::init(json{{"RESOLUTION_SAMPLER", "ZIGGURAT"}}.dump(), "json");
+    EXPECT_THROW(DepartmentFireModel(1, "missing_requirements.csv", path_), InvalidValueError);
+}
+
+TEST_F(DepartmentFireModelTest, CounterStreamsIgnoreResolutionOrder) {
+    State state;
+    std::vector<Incident> incidents;
+    for (int i = 0; i < 200; ++i) {
+        Incident item = incident(i % 5 == 4 ? IncidentCategory::Eighteen : static_cast<IncidentCategory>(i % 4 * 11));
+        item.incidentIndex = i;
+        incidents.push_back(item);
+    }
+    auto run = [&](uint32_t replication, bool reversed, size_t warmup) {
+        DepartmentFireModel model(7, "missing_requirements.csv", path_);
+        model.useCounterStreams(7, replication);
+        // Draws for other callers or incidents without an index use the model's own generator.
+        Incident unindexed = incident(IncidentCategory::One);
+        unindexed.incidentIndex = -1;
+        for (size_t i = 0; i < warmup; ++i) model.computeResolutionTime(state, unindexed);
+        std::vector<double> first(incidents.size()), second(incidents.size());
+        for (size_t k = 0; k < incidents.size(); ++k) {
+            size_t i = reversed ? incidents.size() - 1 - k : k;
+            first[i] = model.computeResolutionTime(state, incidents[i]);
+        }
+        for (size_t k = 0; k < incidents.size(); ++k) {
+            second[k] = model.computeResolutionTime(state, incidents[k]);
+        }
+        return std::pair{first, second};
+    };
+    auto [forward, forwardAgain] = run(0, false, 0);
+    auto [backward, backwardAgain] = run(0, true, 17);
+    EXPECT_EQ(forward, backward);
+    EXPECT_EQ(forwardAgain, backwardAgain);
+    EXPECT_NE(forward, forwardAgain);  // a second draw for an incident continues its stream
+
+    auto [other, otherAgain] = run(1, false, 0);
+    size_t same = 0;
+    for (size_t i = 0; i < forward.size(); ++i) same += forward[i] == other[i];
+    EXPECT_EQ(same, 0u);
+}
@@ -0,0 +1,130 @@
+/*
+Unit tests for the prepared bounds polygon and the bulk point-to-polygon lookup.
+1. PreparedPolygon gives windingNumber's answer for random, vertex, on-edge and same-longitude points,
+   on a detailed boundary and on a self-intersecting ring whose winding exceeds one.
+2. Axis-aligned rings with points exactly on their edges and corners, and degenerate input.
+3. getPointToPolygonIndices gives the covering polygon found by brute force, for any thread count,
+   with unsorted, duplicate and non-finite points.
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <iomanip>
+#include <random>
+
+#include "data/geometry.h"
+
+namespace {
+// Like loadPolygonFromGeoJSON, longitude goes in Location::lat.
+std::vector<Location> starBoundary(size_t vertices, std::mt19937_64& rng) {
+    std::uniform_real_distribution<double> jitter(-0.002, 0.002);
+    std::vector<Location> ring;
+    for (size_t i = 0; i < vertices; ++i) {
+        double angle = 2.0 * M_PI * static_cast<double>(i) / static_cast<double>(vertices);
+        double r = 0.2 + 0.05 * std::sin(7 * angle) + jitter(rng);
+        ring.emplace_back(-86.78 + r * std::cos(angle), 36.16 + r * std::sin(angle));
+    }
+    ring.push_back(ring.front());
+    return ring;
+}
+
+void expectSameAsWindingNumber(const std::vector<Location>& ring, std::mt19937_64& rng, size_t targetCells = 0) {
+    PreparedPolygon prepared(ring, targetCells);
+    std::vector<Location> probes;
+    std::uniform_real_distribution<double> lat(-87.2, -86.3), lon(35.8, 36.5), unit(0.0, 1.0);
+    for (int i = 0; i < 20000; ++i) probes.emplace_back(lat(rng), lon(rng));
+    for (size_t i = 0; i + 1 < ring.size(); ++i) {
+        const Location& a = ring[i];
+        const Location& b = ring[i + 1];
+        probes.push_back(a);
+        probes.emplace_back((a.lat + b.lat) / 2, (a.lon + b.lon) / 2);
+        double t = unit(rng);
+        probes.emplace_back(a.lat + t * (b.lat - a.lat), a.lon + t * (b.lon - a.lon));
+        // Same sweep coordinate as a vertex, the half-open crossing rule decides these.
+        probes.emplace_back(lat(rng), a.lon);
+        probes.emplace_back(std::nextafter(a.lat, 0.0), a.lon);
+    }
+    for (const auto& point : probes) {
+        ASSERT_EQ(prepared.windingNumber(point), windingNumber(ring, point))
+            << std::setprecision(17) << point.lat << "," << point.lon;
+        ASSERT_EQ(prepared.contains(point), isPointInPolygon(ring, point));
+    }
+}
+}
+
+TEST(PreparedPolygonTest, MatchesWindingNumber) {
+    std::mt19937_64 rng(11);
+    std::vector<Location> boundary = starBoundary(1500, rng);
+    PreparedPolygon prepared(boundary);
+    EXPECT_GE(prepared.columns() * prepared.rows(), 4000u);
+    EXPECT_LT(prepared.boundaryCellCount(), prepared.columns() * prepared.rows() / 4);
+    expectSameAsWindingNumber(boundary, rng);
+    expectSameAsWindingNumber(boundary, rng, 16);
+
+    // Random vertices: a self-intersecting ring with windings of 2 and more.
+    std::uniform_real_distribution<double> lat(-87.0, -86.5), lon(36.0, 36.3);
+    std::vector<Location> tangle;
+    for (int i = 0; i < 300; ++i) tangle.emplace_back(lat(rng), lon(rng));
+    tangle.push_back(tangle.front());
+    expectSameAsWindingNumber(tangle, rng);
+}
+
+TEST(PreparedPolygonTest, HandlesAxisAlignedAndDegenerateRings) {
+    // A U shape on a 0.25 degree lattice, exactly representable.
+    std::vector<Location> u = {{0, 0}, {3, 0}, {3, 2}, {2, 2}, {2, 1}, {1, 1}, {1, 2}, {0, 2}, {0, 0}};
+    PreparedPolygon prepared(u, 9);
+    for (double x = -1.0; x <= 4.0; x += 0.25) {
+        for (double y = -1.0; y <= 3.0; y += 0.25) {
+            ASSERT_EQ(prepared.windingNumber({x, y}), windingNumber(u, {x, y})) << x << "," << y;
+        }
+    }
+    EXPECT_TRUE(prepared.contains({0.5, 1.5}));
+    EXPECT_FALSE(prepared.contains({1.5, 1.5}));
+    EXPECT_FALSE(prepared.contains({3.0, 1.0}));  // on an edge counts as outside
+
+    EXPECT_FALSE(PreparedPolygon().contains({0.0, 0.0}));
+    EXPECT_FALSE(PreparedPolygon({{1.0, 1.0}}).contains({1.0, 1.0}));
+    EXPECT_FALSE(prepared.contains({std::nan(""), 1.0}));
+}
+
+TEST(PointToPolygonIndicesTest, MatchesBruteForceAcrossThreads) {
+    // Separated diamonds, so every covered point has exactly one answer.
+    std::vector<Polygon> polygons;
+    for (int i = 0; i < 20; ++i) {
+        for (int j = 0; j < 20; ++j) {
+            double x = -87.0 + 0.01 * i, y = 36.0 + 0.01 * j;
+            Polygon diamond;
+            bg::append(diamond.outer(), Point(x + 0.004, y));
+            bg::append(diamond.outer(), Point(x, y + 0.004));
+            bg::append(diamond.outer(), Point(x - 0.004, y));
+            bg::append(diamond.outer(), Point(x, y - 0.004));
+            bg::correct(diamond);
+            polygons.push_back(diamond);
+        }
+    }
+
+    std::mt19937_64 rng(3);
+    std::uniform_real_distribution<double> lon(-87.02, -86.79), lat(35.98, 36.21);
+    std::vector<Point> points;
+    for (int i = 0; i < 30000; ++i) points.emplace_back(lon(rng), lat(rng));
+    points.emplace_back(-87.0 + 0.004, 36.0);  // a vertex
+    points.emplace_back(-87.0 + 0.002, 36.002);  // on an edge
+    points.push_back(points.front());
+    points.emplace_back(std::nan(""), 36.1);
+
+    std::vector<std::optional<size_t>> expected;
+    for (const auto& point : points) {
+        std::optional<size_t> covering;
+        for (size_t k = 0; k < polygons.size() && !covering; ++k) {
+            if (bg::covered_by(point, polygons[k])) covering = k;
+        }
+        expected.push_back(covering);
+    }
+    EXPECT_EQ(expected[30000], std::optional<size_t>(0));
+    EXPECT_EQ(expected[30001], std::optional<size_t>(0));
+    for (size_t threads : {1, 3, 8}) {
+        EXPECT_EQ(getPointToPolygonIndices(points, polygons, threads), expected) << threads << " threads";
+    }
+    EXPECT_TRUE(getPointToPolygonIndices({}, polygons).empty());
+    EXPECT_EQ(getPointToPolygonIndices(points, {}).size(), points.size());
+}
@@ -0,0 +1,92 @@
+/*
+Unit tests for the haversine matrix estimator.
+1. Great-circle distances match the scalar haversine in utils, including near-antipodal pairs.
+2. Calibration fitted on estimated matrices recovers the circuity and zone speeds used to make them.
+3. Calibration survives a save/load round trip.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+#include "services/haversine_estimator.h"
+#include "utils/util.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class HaversineEstimatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+
+    const std::vector<Location> stations_ = {
+        Location(36.1608, -86.7809),
+        Location(36.2100, -86.6900),
+        Location(-36.0, 93.0)
+    };
+    const std::vector<Location> incidents_ = {
+        Location(36.1609, -86.7810),
+        Location(36.0500, -86.9000),
+        Location(36.3000, -86.6000),
+        Location(36.1700, -86.7500)
+    };
+};
+
+TEST_F(HaversineEstimatorTest, MatchesScalarHaversine) {
+    HaversineEstimator estimator(stations_, incidents_);
+    std::vector<double> meters(incidents_.size());
+
+    // utils::haversineDistance works in miles with a 3959 mi radius, compare central angles.
+    for (size_t i = 0; i < stations_.size(); ++i) {
+        estimator.greatCircleRow(i, meters.data());
+        for (size_t j = 0; j < incidents_.size(); ++j) {
+            double expected = haversineDistance(stations_[i].lat, stations_[i].lon,
+                                                incidents_[j].lat, incidents_[j].lon) / 3959.0;
+            EXPECT_NEAR(meters[j] / 6371000.0, expected, 1e-9) << i << "," << j;
+        }
+    }
+}
+
+TEST_F(HaversineEstimatorTest, CalibrationRecoversCircuityAndZoneSpeeds) {
+    std::vector<Location> stations(stations_.begin(), stations_.begin() + 2);
+    std::vector<int> zones = {3, 3, 7, -1};
+    EstimatorCalibration truth;
+    truth.circuity = 1.42;
+    truth.defaultSpeedMps = 12.0;
+    truth.zoneSpeedMps = {{3, 10.0}, {7, 15.0}};
+
+    auto matrices = HaversineEstimator(stations, incidents_, zones, truth).estimateMatrices(1);
+    EstimatorCalibration fitted = EstimatorCalibration::fit(stations, incidents_, zones,
+                                                            matrices.first, matrices.second);
+
+    EXPECT_NEAR(fitted.circuity, 1.42, 1e-9);
+    EXPECT_NEAR(fitted.speedForZone(3), 10.0, 1e-9);
+    EXPECT_NEAR(fitted.speedForZone(7), 15.0, 1e-9);
+}
+
+TEST_F(HaversineEstimatorTest, CalibrationSaveAndLoadRoundTrip) {
+    const std::string path = "test_estimator_calibration.json";
+    EstimatorCalibration calibration;
+    calibration.circuity = 1.25;
+    calibration.defaultSpeedMps = 11.5;
+    calibration.zoneSpeedMps = {{2, 9.5}};
+    ASSERT_TRUE(calibration.save(path));
+
+    EstimatorCalibration loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+
+    EXPECT_DOUBLE_EQ(loaded.circuity, 1.25);
+    EXPECT_DOUBLE_EQ(loaded.speedForZone(2), 9.5);
+    EXPECT_DOUBLE_EQ(loaded.speedForZone(5), 11.5);
+}
@@ -0,0 +1,166 @@
+/*
+Unit tests for the columnar input snapshot.
+1. A snapshot maps back to the same stations, incidents (zones included) and apparatus the CSV loaders produce.
+2. loadInputs compiles the snapshot once, serves later runs from it and recompiles when a source changes.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <nlohmann/json.hpp>
+
+#include "services/input_snapshot.h"
+#include "utils/loaders.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+using json = nlohmann::json;
+
+class InputSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+
+        writeIncidents(400);
+        {
+            std::ofstream out(stationsPath_);
+            out << "OBJECTID,Facility Name,Address,City,State,Zip Code,GLOBALID,x,y\n";
+            out << "1,Station 1,1 Main St,Nashville,TN,37201,{A},36.16,-86.78\n";
+            out << "2,,2 Main St,Nashville,TN,37201,{B},36.12,-86.72\n";
+        }
+        {
+            std::ofstream out(apparatusPath_);
+            out << "StationID,Facility Name,Station Name,Engine,Truck,Rescue,Hazard,Squad,Fast,Medic,Brush,Boat,UTV,Reach,Chief\n";
+            out << "1,Station 1,S1,2,1,0,0,0,0,1,0,0,0,0,1\n";
+            out << "2,Station 2,S2,1,0,0,0,0,0,2,0,1,0,0,0\n";
+        }
+        {
+            // Two beats split at longitude -86.75.
+            auto beat = [](int zone, double west, double east) {
+                return json{{"type", "Feature"},
+                            {"properties", {{"ZONE_ID", zone}}},
+                            {"geometry", {{"type", "Polygon"},
+                                          {"coordinates", {{{west, 36.0}, {east, 36.0}, {east, 36.3},
+                                                            {west, 36.3}, {west, 36.0}}}}}}};
+            };
+            std::ofstream out(beatsPath_);
+            out << json{{"type", "FeatureCollection"},
+                        {"features", {beat(3, -86.9, -86.75), beat(8, -86.75, -86.6)}}}.dump();
+        }
+
+        EnvLoader::cleanup();
+        EnvLoader::init(json{{"STATIONS_CSV_PATH", stationsPath_},
+                             {"INCIDENTS_CSV_PATH", incidentsPath_},
+                             {"APPARATUS_CSV_PATH", apparatusPath_},
+                             {"BOUNDS_GEOJSON_PATH", "missing_bounds.geojson"},
+                             {"BEATS_SHAPEFILE_PATH", beatsPath_},
+                             {"INPUT_SNAPSHOT_PATH", snapshotPath_}}.dump(), "json");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+        for (const std::string& path : {stationsPath_, incidentsPath_, apparatusPath_, beatsPath_, snapshotPath_}) {
+            std::remove(path.c_str());
+        }
+    }
+
+    void writeIncidents(int rows) {
+        std::ofstream out(incidentsPath_);
+        out << "incident_id,lat,lon,incident_type,incident_level,datetime,category\n";
+        for (int r = 0; r < rows; ++r) {
+            out << 1000 + r << ",36.1" << r % 10 << ",-86." << 62 + r % 30 << ",Fire,High,2024-03-"
+                << 10 + r % 5 << " 0" << r % 10 << ":30:00," << (r % 2 ? "Two" : "OneB") << "\n";
+        }
+    }
+
+    static void expectSameInputs(const std::vector<Station>& stations, const std::vector<Incident>& incidents,
+                                 const std::vector<Apparatus>& apparatuses, const std::vector<Station>& expectedStations,
+                                 const std::vector<Incident>& expectedIncidents,
+                                 const std::vector<Apparatus>& expectedApparatuses) {
+        ASSERT_EQ(stations.size(), expectedStations.size());
+        for (size_t i = 0; i < stations.size(); ++i) {
+            EXPECT_EQ(stations[i].getStationIndex(), expectedStations[i].getStationIndex());
+            EXPECT_EQ(stations[i].getStationId(), expectedStations[i].getStationId());
+            EXPECT_EQ(stations[i].getFacilityName(), expectedStations[i].getFacilityName());
+            EXPECT_EQ(stations[i].getNumFireTrucks(), expectedStations[i].getNumFireTrucks());
+            EXPECT_EQ(stations[i].getNumAmbulances(), expectedStations[i].getNumAmbulances());
+            EXPECT_DOUBLE_EQ(stations[i].getLat(), expectedStations[i].getLat());
+            EXPECT_DOUBLE_EQ(stations[i].getLon(), expectedStations[i].getLon());
+        }
+        ASSERT_EQ(incidents.size(), expectedIncidents.size());
+        for (size_t i = 0; i < incidents.size(); ++i) {
+            ASSERT_EQ(incidents[i].incidentIndex, expectedIncidents[i].incidentIndex);
+            ASSERT_EQ(incidents[i].incident_id, expectedIncidents[i].incident_id);
+            ASSERT_DOUBLE_EQ(incidents[i].lat, expectedIncidents[i].lat);
+            ASSERT_DOUBLE_EQ(incidents[i].lon, expectedIncidents[i].lon);
+            ASSERT_EQ(incidents[i].reportTime, expectedIncidents[i].reportTime);
+            ASSERT_EQ(incidents[i].zoneIndex, expectedIncidents[i].zoneIndex);
+            ASSERT_EQ(incidents[i].incident_type, expectedIncidents[i].incident_type);
+            ASSERT_EQ(incidents[i].incident_level, expectedIncidents[i].incident_level);
+            ASSERT_EQ(incidents[i].category, expectedIncidents[i].category);
+        }
+        ASSERT_EQ(apparatuses.size(), expectedApparatuses.size());
+        for (size_t i = 0; i < apparatuses.size(); ++i) {
+            EXPECT_EQ(apparatuses[i].getId(), expectedApparatuses[i].getId());
+            EXPECT_EQ(apparatuses[i].getStationIndex(), expectedApparatuses[i].getStationIndex());
+            EXPECT_EQ(apparatuses[i].getType(), expectedApparatuses[i].getType());
+        }
+    }
+
+    const std::string stationsPath_ = "test_snapshot_stations.csv";
+    const std::string incidentsPath_ = "test_snapshot_incidents.csv";
+    const std::string apparatusPath_ = "test_snapshot_apparatus.csv";
+    const std::string beatsPath_ = "test_snapshot_beats.geojson";
+    const std::string snapshotPath_ = "test_snapshot_inputs.bin";
+};
+
+TEST_F(InputSnapshotTest, RoundTripsLoadedInputs) {
+    std::vector<Station> stations = loader::loadStationsFromCSV();
+    std::vector<Incident> incidents = loader::loadIncidentsFromCSV();
+    std::vector<Apparatus> apparatuses = loader::loadApparatusFromCSV();
+    loader::assignServiceZones(incidents);
+    ASSERT_EQ(incidents.size(), 400u);
+    EXPECT_EQ(incidents[0].zoneIndex, 8);   // -86.62
+    EXPECT_EQ(incidents[20].zoneIndex, 3);  // -86.82
+
+    InputSnapshot::SourceHashes sources = InputSnapshot::sourceHashesFromEnv();
+    ASSERT_TRUE(InputSnapshot::save(snapshotPath_, sources, stations, incidents, apparatuses));
+
+    InputSnapshot snapshot = InputSnapshot::open(snapshotPath_);
+    EXPECT_EQ(snapshot.sourceHashes(), sources);
+    EXPECT_EQ(snapshot.incidentCount(), incidents.size());
+    EXPECT_EQ(snapshot.zoneIndices()[20], 3);
+    EXPECT_EQ(snapshot.reportTimes()[7], incidents[7].reportTime);
+    expectSameInputs(snapshot.stations(), snapshot.incidents(), snapshot.apparatuses(), stations, incidents,
+                     apparatuses);
+
+    std::ofstream(snapshotPath_, std::ios::binary | std::ios::trunc) << "FSIN";
+    EXPECT_THROW(InputSnapshot::open(snapshotPath_), InvalidValueError);
+}
+
+TEST_F(InputSnapshotTest, RecompilesWhenASourceChanges) {
+    std::vector<Station> stations, cachedStations;
+    std::vector<Incident> incidents, cachedIncidents;
+    std::vector<Apparatus> apparatuses, cachedApparatuses;
+    loader::loadInputs(stations, incidents, apparatuses);
+    ASSERT_TRUE(std::ifstream(snapshotPath_));
+    InputSnapshot::SourceHashes compiled = InputSnapshot::open(snapshotPath_).sourceHashes();
+
+    loader::loadInputs(cachedStations, cachedIncidents, cachedApparatuses);
+    expectSameInputs(cachedStations, cachedIncidents, cachedApparatuses, stations, incidents, apparatuses);
+
+    writeIncidents(150);
+    EXPECT_NE(InputSnapshot::sourceHashesFromEnv()[InputSnapshot::IncidentsCsv], compiled[InputSnapshot::IncidentsCsv]);
+    loader::loadInputs(cachedStations, cachedIncidents, cachedApparatuses);
+    EXPECT_EQ(cachedIncidents.size(), 150u);
+    InputSnapshot::SourceHashes recompiled = InputSnapshot::open(snapshotPath_).sourceHashes();
+    EXPECT_NE(recompiled[InputSnapshot::IncidentsCsv], compiled[InputSnapshot::IncidentsCsv]);
+    EXPECT_EQ(recompiled[InputSnapshot::StationsCsv], compiled[InputSnapshot::StationsCsv]);
+    EXPECT_EQ(InputSnapshot::open(snapshotPath_).incidentCount(), 150u);
+}
@@ -0,0 +1,113 @@
+/*
+Unit tests for the tiled matrix store.
+1. A tiled file returns the same values as the flat matrix it was written from.
+2. The tile cache never holds more tiles than its capacity.
+3. openMatrix picks the right reader from the file header.
+4. Tiles of upcoming incidents in the access plan are prefetched.
+*/
+
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#include "services/chunks.h"
+#include "services/matrix_store.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class MatrixStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+
+        // 3 stations x 10 incidents, value encodes (station, incident).
+        matrix_.assign(height_, std::vector<double>(width_));
+        for (int row = 0; row < height_; ++row) {
+            for (int col = 0; col < width_; ++col) {
+                matrix_[row][col] = row * 100.0 + col;
+            }
+        }
+    }
+
+    void TearDown() override {
+        std::remove(tiledPath_.c_str());
+        std::remove(flatPath_.c_str());
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+
+    const int width_ = 10;
+    const int height_ = 3;
+    const std::string tiledPath_ = "test_tiled_matrix.bin";
+    const std::string flatPath_ = "test_flat_matrix.bin";
+    std::vector<std::vector<double>> matrix_;
+};
+
+TEST_F(MatrixStoreTest, TiledMatchesSourceMatrix) {
+    ASSERT_TRUE(writeTiledMatrix(matrix_, tiledPath_, 4));
+    TiledMatrixStore store(tiledPath_, 2);
+
+    ASSERT_EQ(store.width(), width_);
+    ASSERT_EQ(store.height(), height_);
+    std::vector<double> column(height_);
+    for (int col = 0; col < width_; ++col) {
+        store.column(col, column.data());
+        for (int row = 0; row < height_; ++row) {
+            EXPECT_DOUBLE_EQ(column[row], matrix_[row][col]);
+            EXPECT_DOUBLE_EQ(store.at(row, col), matrix_[row][col]);
+        }
+    }
+}
+
+TEST_F(MatrixStoreTest, CacheRespectsCapacity) {
+    ASSERT_TRUE(writeTiledMatrix(matrix_, tiledPath_, 2));
+    TiledMatrixStore store(tiledPath_, 2, 0);
+
+    for (int col = 0; col < width_; ++col) {
+        store.at(0, col);
+        EXPECT_LE(store.cachedTiles(), 2u);
+    }
+    EXPECT_EQ(store.cacheMisses(), 5u);
+
+    // Tile 4 (cols 8-9) is still cached, tile 0 was evicted.
+    store.at(0, 9);
+    EXPECT_EQ(store.cacheMisses(), 5u);
+    store.at(0, 0);
+    EXPECT_EQ(store.cacheMisses(), 6u);
+}
+
+TEST_F(MatrixStoreTest, OpenMatrixDetectsFormat) {
+    save_matrix_binary(matrix_, flatPath_);
+    ASSERT_TRUE(writeTiledMatrix(matrix_, tiledPath_, 3));
+
+    auto flat = openMatrix(flatPath_);
+    auto tiled = openMatrix(tiledPath_);
+    EXPECT_NE(dynamic_cast<FlatMatrix*>(flat.get()), nullptr);
+    EXPECT_NE(dynamic_cast<TiledMatrixStore*>(tiled.get()), nullptr);
+    for (int col = 0; col < width_; ++col) {
+        EXPECT_DOUBLE_EQ(flat->at(2, col), tiled->at(2, col));
+    }
+}
+
+TEST_F(MatrixStoreTest, PrefetchesUpcomingIncidents) {
+    ASSERT_TRUE(writeTiledMatrix(matrix_, tiledPath_, 2));
+    TiledMatrixStore store(tiledPath_, 8, 1);
+    store.setAccessPlan({0, 9, 4});
+
+    std::vector<double> column(height_);
+    store.column(0, column.data());
+
+    // Column 9 is next in the plan, its tile should arrive without being read.
+    for (int i = 0; i < 100 && store.cachedTiles() < 2; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_EQ(store.cachedTiles(), 2u);
+    store.at(1, 9);
+    EXPECT_EQ(store.cacheMisses(), 1u);
+}
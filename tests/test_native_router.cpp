@@ -0,0 +1,117 @@
+/*
+Unit tests for the native road graph router.
+1. Locations snap to the largest strongly connected component.
+2. Durations are fastest paths and distances follow those paths.
+3. Edge lists load from CSV and unknown nodes are rejected.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+
+#include "services/native_router.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+namespace {
+// 3x3 grid 0.01 deg apart, node = row * 3 + col. Streets take 100 s per 1000 m block,
+// row 0 is a highway: 10 s per block but 2000 m long. Node 9 hangs off node 8 by a one-way edge.
+RoadGraph gridGraph() {
+    std::vector<Location> nodes;
+    for (int r = 0; r < 3; ++r) {
+        for (int c = 0; c < 3; ++c) nodes.emplace_back(36.00 + r * 0.01, -86.80 + c * 0.01);
+    }
+    nodes.emplace_back(36.05, -86.78);
+
+    std::vector<RoadGraph::Edge> edges;
+    auto road = [&](uint32_t a, uint32_t b, double distance, double duration) {
+        edges.push_back({a, b, distance, duration});
+        edges.push_back({b, a, distance, duration});
+    };
+    for (uint32_t r = 0; r < 3; ++r) {
+        for (uint32_t c = 0; c < 3; ++c) {
+            uint32_t v = r * 3 + c;
+            if (c < 2) road(v, v + 1, r == 0 ? 2000.0 : 1000.0, r == 0 ? 10.0 : 100.0);
+            if (r < 2) road(v, v + 3, 1000.0, 100.0);
+        }
+    }
+    edges.push_back({8, 9, 3000.0, 300.0});
+    return RoadGraph(std::move(nodes), edges);
+}
+}
+
+class NativeRouterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+};
+
+TEST_F(NativeRouterTest, SnapsToLargestComponent) {
+    NativeRouter router(gridGraph());
+
+    NativeRouter::Snap stranded = router.snap(Location(36.05, -86.78));
+    EXPECT_EQ(stranded.node, 8u);
+    EXPECT_NEAR(stranded.meters, 3336.0, 5.0);
+
+    NativeRouter::Snap onNode = router.snap(Location(36.01, -86.79));
+    EXPECT_EQ(onNode.node, 4u);
+    EXPECT_NEAR(onNode.meters, 0.0, 1e-6);
+}
+
+TEST_F(NativeRouterTest, DistancesFollowFastestPath) {
+    NativeRouter router(gridGraph());
+    std::vector<Location> sources = {Location(36.01, -86.80), Location(36.00, -86.80)};
+    std::vector<Location> destinations = {Location(36.00, -86.78), Location(36.01, -86.78), Location(36.01, -86.80)};
+
+    auto [distances, durations] = router.tableMatrices(sources, destinations);
+    ASSERT_EQ(durations.width(), 3);
+    ASSERT_EQ(durations.height(), 2);
+
+    // 3 -> 0 -> 1 -> 2 over the highway beats the 3000 m street route 3 -> 4 -> 5 -> 2.
+    EXPECT_NEAR(durations.at(0, 0), 120.0, 1e-6);
+    EXPECT_NEAR(distances.at(0, 0), 5000.0, 1e-6);
+    EXPECT_NEAR(durations.at(0, 1), 200.0, 1e-6);
+    EXPECT_NEAR(distances.at(0, 1), 2000.0, 1e-6);
+    EXPECT_NEAR(durations.at(0, 2), 0.0, 1e-6);
+    EXPECT_NEAR(durations.at(1, 0), 20.0, 1e-6);
+    EXPECT_NEAR(durations.at(1, 1), 120.0, 1e-6);
+    EXPECT_NEAR(distances.at(1, 1), 5000.0, 1e-6);
+}
+
+TEST_F(NativeRouterTest, LoadsCsvEdgeList) {
+    const std::string nodesPath = "test_road_nodes.csv";
+    const std::string edgesPath = "test_road_edges.csv";
+    {
+        std::ofstream nodes(nodesPath);
+        nodes << "id,lat,lon\n9000000001,36.0,-86.8\n9000000002,36.0,-86.79\n";
+        std::ofstream edges(edgesPath);
+        edges << "from,to,distance_m,duration_s\n9000000001,9000000002,900.5,60\n9000000002,9000000001,900.5,75\n";
+    }
+
+    RoadGraph graph = RoadGraph::loadCsv(nodesPath, edgesPath);
+    EXPECT_EQ(graph.nodeCount(), 2u);
+    EXPECT_EQ(graph.edgeCount(), 2u);
+    EXPECT_EQ(graph.edgeEnd(0) - graph.edgeBegin(0), 1u);
+    EXPECT_EQ(graph.heads()[graph.edgeBegin(1)], 0u);
+    EXPECT_DOUBLE_EQ(graph.durations()[graph.edgeBegin(1)], 75.0);
+
+    {
+        std::ofstream edges(edgesPath, std::ios::app);
+        edges << "9000000002,42,10,10\n";
+    }
+    EXPECT_THROW(RoadGraph::loadCsv(nodesPath, edgesPath), InvalidValueError);
+
+    std::remove(nodesPath.c_str());
+    std::remove(edgesPath.c_str());
+}
@@ -0,0 +1,148 @@
+/*
+Unit tests for concurrent OSRM fetching against a local stub server.
+1. Every URL is fetched once and connections are reused across requests.
+2. Server errors are retried with backoff, exhausted retries throw OSRMError.
+3. generate_osrm_table_chunks writes every chunk into the right matrix columns.
+*/
+
+#include <gtest/gtest.h>
+#include <map>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "services/chunks.h"
+#include "services/osrm_fetcher.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+#include "stub_http_server.h"
+
+namespace {
+std::vector<std::string> split(const std::string& s, char delim) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, delim)) parts.push_back(part);
+    return parts;
+}
+
+std::string queryParam(const std::string& target, const std::string& key) {
+    size_t pos = target.find(key + "=");
+    if (pos == std::string::npos) return "";
+    pos += key.size() + 1;
+    return target.substr(pos, target.find('&', pos) - pos);
+}
+
+// OSRM-like table answer: duration = destination longitude * 10 + source row, distance = 2 * duration.
+std::pair<int, std::string> tableResponse(const std::string& target) {
+    std::string path = target.substr(0, target.find('?'));
+    std::vector<std::string> coords = split(path.substr(path.rfind('/') + 1), ';');
+    std::vector<std::string> sources = split(queryParam(target, "sources"), ';');
+    std::vector<std::string> destinations = split(queryParam(target, "destinations"), ';');
+
+    json durations = json::array(), distances = json::array();
+    for (size_t row = 0; row < sources.size(); ++row) {
+        json durationRow = json::array(), distanceRow = json::array();
+        for (const auto& d : destinations) {
+            double lon = std::stod(coords[std::stoi(d)]);
+            durationRow.push_back(lon * 10.0 + row);
+            distanceRow.push_back(2.0 * (lon * 10.0 + row));
+        }
+        durations.push_back(durationRow);
+        distances.push_back(distanceRow);
+    }
+    return {200, json{{"code", "Ok"}, {"durations", durations}, {"distances", distances}}.dump()};
+}
+}
+
+class OsrmFetcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+};
+
+TEST_F(OsrmFetcherTest, FetchesAllUrlsAndReusesConnections) {
+    StubHttpServer server([](const std::string& target) {
+        return std::make_pair(200, target.substr(1));
+    });
+    std::vector<std::string> urls;
+    for (int i = 0; i < 12; ++i) urls.push_back(server.baseUrl() + "/" + std::to_string(i));
+
+    OsrmFetchOptions options;
+    options.maxInFlight = 3;
+    OsrmFetcher fetcher(options);
+    std::map<size_t, std::string> bodies;
+    fetcher.fetchAll(urls, [&](size_t index, const std::string& body) { bodies[index] = body; });
+
+    ASSERT_EQ(bodies.size(), urls.size());
+    for (size_t i = 0; i < urls.size(); ++i) EXPECT_EQ(bodies[i], std::to_string(i));
+    EXPECT_EQ(server.requests(), 12);
+    EXPECT_LE(server.connections(), 3);
+}
+
+TEST_F(OsrmFetcherTest, RetriesServerErrors) {
+    std::mutex mutex;
+    std::map<std::string, int> hits;
+    StubHttpServer server([&](const std::string& target) {
+        std::lock_guard<std::mutex> lock(mutex);
+        int hit = ++hits[target];
+        return hit == 1 ? std::make_pair(503, std::string("busy")) : std::make_pair(200, std::string("ok"));
+    });
+
+    OsrmFetchOptions options;
+    options.maxInFlight = 2;
+    options.retryBackoffMs = 1;
+    OsrmFetcher fetcher(options);
+    int successes = 0;
+    fetcher.fetchAll({server.baseUrl() + "/a", server.baseUrl() + "/b"},
+                     [&](size_t, const std::string& body) { successes += body == "ok"; });
+
+    EXPECT_EQ(successes, 2);
+    EXPECT_EQ(server.requests(), 4);
+}
+
+TEST_F(OsrmFetcherTest, ThrowsWhenRetriesExhausted) {
+    StubHttpServer server([](const std::string&) {
+        return std::make_pair(500, std::string("down"));
+    });
+
+    OsrmFetchOptions options;
+    options.maxRetries = 2;
+    options.retryBackoffMs = 1;
+    OsrmFetcher fetcher(options);
+    EXPECT_THROW(fetcher.fetchAll({server.baseUrl() + "/x"}, [](size_t, const std::string&) {}), OSRMError);
+    EXPECT_EQ(server.requests(), 3);
+}
+
+TEST_F(OsrmFetcherTest, TableChunksFillFlatMatrix) {
+    StubHttpServer server(tableResponse);
+    EnvLoader::init(json{{"BASE_OSRM_URL", server.baseUrl()}, {"OSRM_MAX_IN_FLIGHT", 2}}.dump(), "json");
+
+    std::vector<Location> sources = {Location(36.0, 1.0), Location(36.0, 2.0)};
+    std::vector<Location> destinations;
+    for (int i = 0; i < 5; ++i) destinations.emplace_back(36.1, 10.0 + i);
+
+    auto [distances, durations] = generate_osrm_table_chunks(sources, destinations, 2);
+
+    ASSERT_EQ(durations.width(), 5);
+    ASSERT_EQ(durations.height(), 2);
+    EXPECT_EQ(server.requests(), 3);
+    for (int row = 0; row < 2; ++row) {
+        for (int col = 0; col < 5; ++col) {
+            double expected = (10.0 + col) * 10.0 + row;
+            EXPECT_DOUBLE_EQ(durations.at(row, col), expected);
+            EXPECT_DOUBLE_EQ(distances.at(row, col), 2.0 * expected);
+        }
+    }
+}
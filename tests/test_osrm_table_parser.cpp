@@ -0,0 +1,70 @@
+/*
+Unit tests for streaming OSRM table responses into flat matrices.
+1. Durations and distances land at the chunk's offset; waypoint arrays are ignored.
+2. Unreachable (null) entries throw OSRMError.
+3. Non-"Ok" responses are reported without touching the matrices.
+*/
+
+#include <gtest/gtest.h>
+
+#include "services/osrm_table_parser.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class OsrmTableParserTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+
+    // 2 sources x 5 destinations, -1 until filled.
+    FlatMatrix distances_{5, 2};
+    FlatMatrix durations_{5, 2};
+};
+
+TEST_F(OsrmTableParserTest, WritesChunkAtOffset) {
+    const std::string body = R"({
+        "code": "Ok",
+        "sources": [{"location": [-86.1, 36.1], "name": ""}, {"location": [-86.2, 36.2], "name": ""}],
+        "durations": [[10.5, 20], [30, 40.25]],
+        "destinations": [{"location": [-86.3, 36.3]}, {"location": [-86.4, 36.4]}],
+        "distances": [[100, 200.5], [300, 400]]
+    })";
+
+    ASSERT_TRUE(parseOsrmTableResponse(body, distances_, durations_, 3));
+
+    EXPECT_DOUBLE_EQ(durations_.at(0, 3), 10.5);
+    EXPECT_DOUBLE_EQ(durations_.at(0, 4), 20.0);
+    EXPECT_DOUBLE_EQ(durations_.at(1, 3), 30.0);
+    EXPECT_DOUBLE_EQ(durations_.at(1, 4), 40.25);
+    EXPECT_DOUBLE_EQ(distances_.at(0, 4), 200.5);
+    EXPECT_DOUBLE_EQ(distances_.at(1, 3), 300.0);
+    EXPECT_DOUBLE_EQ(durations_.at(0, 0), -1.0);
+}
+
+TEST_F(OsrmTableParserTest, ThrowsOnUnreachablePair) {
+    const std::string body = R"({"code": "Ok", "durations": [[1, null]], "distances": [[1, 2]]})";
+    EXPECT_THROW(parseOsrmTableResponse(body, distances_, durations_, 0), OSRMError);
+}
+
+TEST_F(OsrmTableParserTest, ThrowsWhenChunkExceedsMatrix) {
+    const std::string body = R"({"code": "Ok", "durations": [[1, 2, 3]]})";
+    EXPECT_THROW(parseOsrmTableResponse(body, distances_, durations_, 3), OSRMError);
+}
+
+TEST_F(OsrmTableParserTest, ReportsErrorCodes) {
+    const std::string body = R"({"code": "InvalidQuery", "message": "Too many table coordinates"})";
+    EXPECT_FALSE(parseOsrmTableResponse(body, distances_, durations_, 0));
+    EXPECT_DOUBLE_EQ(durations_.at(0, 0), -1.0);
+    EXPECT_THROW(parseOsrmTableResponse("{\"code\": ", distances_, durations_, 0), std::runtime_error);
+}
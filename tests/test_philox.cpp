@@ -0,0 +1,56 @@
+/*
+Unit tests for the counter-based generator behind per-incident fire model streams.
+1. Philox4x32-10 reproduces the Random123 known-answer vectors, also at compile time.
+2. CounterRng streams reopened at any draw number continue the same sequence, and streams of other incidents,
+   replications or seeds differ.
+*/
+
+#include <gtest/gtest.h>
+#include <random>
+#include <set>
+#include <vector>
+
+#include "utils/philox.h"
+
+using utils::CounterRng;
+using utils::Philox4x32;
+
+static_assert(Philox4x32::generate({0, 0, 0, 0}, {0, 0})
+              == Philox4x32::Counter{0x6627e8d5u, 0xe169c58du, 0xbc57ac4cu, 0x9b00dbd8u});
+static_assert(std::uniform_random_bit_generator<CounterRng>);
+
+TEST(PhiloxTest, MatchesKnownAnswers) {
+    EXPECT_EQ(Philox4x32::generate({0xffffffffu, 0xffffffffu, 0xffffffffu, 0xffffffffu}, {0xffffffffu, 0xffffffffu}),
+              (Philox4x32::Counter{0x408f276du, 0x41c83b0eu, 0xa20bc7c6u, 0x6d5451fdu}));
+    EXPECT_EQ(Philox4x32::generate({0x243f6a88u, 0x85a308d3u, 0x13198a2eu, 0x03707344u}, {0xa4093822u, 0x299f31d0u}),
+              (Philox4x32::Counter{0xd16cfe09u, 0x94fdccebu, 0x5001e420u, 0x24126ea1u}));
+}
+
+TEST(PhiloxTest, StreamsAreAddressedByCounter) {
+    CounterRng stream(42, 3, 1234);
+    std::vector<uint32_t> values;
+    for (int i = 0; i < 64; ++i) values.push_back(stream());
+    EXPECT_EQ(stream.position(), 64u);
+    for (uint64_t start : {1u, 2u, 4u, 7u, 33u}) {
+        CounterRng reopened(42, 3, 1234, start);
+        for (uint64_t i = start; i < values.size(); ++i) {
+            ASSERT_EQ(reopened(), values[i]) << start << " " << i;
+        }
+    }
+    // The words of block 0 are the Philox output for counter (0, incident).
+    auto block = Philox4x32::generate({0, 0, 1234, 0}, {42, 3});
+    EXPECT_EQ(std::vector<uint32_t>(values.begin(), values.begin() + 4), std::vector<uint32_t>(block.begin(), block.end()));
+
+    std::set<uint32_t> firsts;
+    for (auto [seed, replication, incident] : {std::tuple{42u, 3u, 1234u}, {42u, 3u, 1235u}, {42u, 4u, 1234u},
+                                               {43u, 3u, 1234u}, {42u, 3u, 0u}}) {
+        firsts.insert(CounterRng(seed, replication, incident)());
+    }
+    EXPECT_EQ(firsts.size(), 5u);
+
+    CounterRng uniform(1, 0, 0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    double mean = 0.0;
+    for (int i = 0; i < 100000; ++i) mean += unit(uniform) / 100000;
+    EXPECT_NEAR(mean, 0.5, 0.005);
+}
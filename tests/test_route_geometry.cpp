@@ -0,0 +1,122 @@
+/*
+Unit tests for the route geometry cache and the routes GeoJSON export.
+1. Each distinct pair is fetched once, persisted, and served from the file on the next run.
+2. Trips are grouped per incident, station and direction with timestamps spread over the points.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <nlohmann/json.hpp>
+
+#include "services/route_geometry.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+#include "stub_http_server.h"
+
+using json = nlohmann::json;
+
+namespace {
+// OSRM-like route answer: a straight two-point line taking 100 s, no route out of longitude 0.
+std::pair<int, std::string> routeResponse(const std::string& target) {
+    std::string path = target.substr(0, target.find('?'));
+    std::string coords = path.substr(path.rfind('/') + 1);
+    std::string from = coords.substr(0, coords.find(';'));
+    std::string to = coords.substr(coords.find(';') + 1);
+    double fromLon = std::stod(from), fromLat = std::stod(from.substr(from.find(',') + 1));
+    double toLon = std::stod(to), toLat = std::stod(to.substr(to.find(',') + 1));
+    if (fromLon == 0.0) {
+        return {400, R"({"code": "NoRoute"})"};
+    }
+    json route = {{"duration", 100.0}, {"distance", 1000.0},
+                  {"geometry", {{"type", "LineString"}, {"coordinates", {{fromLon, fromLat}, {toLon, toLat}}}}}};
+    return {200, json{{"code", "Ok"}, {"routes", {route}}}.dump()};
+}
+
+long long wallClock(std::time_t t) {
+    std::tm tm = *std::localtime(&t);
+    return static_cast<long long>(timegm(&tm));
+}
+}
+
+class RouteGeometryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+        std::remove(cachePath_.c_str());
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+        std::remove(cachePath_.c_str());
+        std::remove(geojsonPath_.c_str());
+    }
+
+    const std::string cachePath_ = "test_route_cache.jsonl";
+    const std::string geojsonPath_ = "test_routes.json";
+    const Location station_{36.1, -86.8};
+    const Location incident_{36.2, -86.7};
+};
+
+TEST_F(RouteGeometryTest, FetchesEachPairOnceAndPersists) {
+    StubHttpServer server(routeResponse);
+    Location unroutable(36.3, 0.0);
+    std::vector<std::pair<Location, Location>> pairs = {
+        {station_, incident_}, {incident_, station_}, {station_, incident_}, {unroutable, station_}};
+
+    RouteGeometryCache cache(cachePath_);
+    EXPECT_EQ(cache.fetchMissing(pairs, server.baseUrl()), 2u);
+    EXPECT_EQ(server.requests(), 3);
+    ASSERT_NE(cache.find(station_, incident_), nullptr);
+    EXPECT_EQ(cache.find(unroutable, station_), nullptr);
+    EXPECT_DOUBLE_EQ(cache.find(station_, incident_)->distance, 1000.0);
+
+    // A later run only asks for what is still missing.
+    RouteGeometryCache reloaded(cachePath_);
+    EXPECT_EQ(reloaded.size(), 2u);
+    EXPECT_EQ(reloaded.fetchMissing(pairs, server.baseUrl()), 0u);
+    EXPECT_EQ(server.requests(), 4);
+    ASSERT_NE(reloaded.find(incident_, station_), nullptr);
+    EXPECT_DOUBLE_EQ(reloaded.find(incident_, station_)->coordinates.front().first, incident_.lon);
+}
+
+TEST_F(RouteGeometryTest, WritesChainedFeatures) {
+    StubHttpServer server(routeResponse);
+    RouteGeometryCache cache;
+    cache.fetchMissing({{station_, incident_}, {incident_, station_}}, server.baseUrl());
+
+    const std::time_t dispatched = 1700000000, resolved = 1700003600;
+    std::vector<RouteTrip> trips = {
+        {7, 3, "from_fire", resolved, incident_, station_},
+        {7, 3, "to_fire", dispatched + 60, station_, incident_},
+        {7, 3, "to_fire", dispatched, station_, incident_},
+        {2, 5, "to_fire", dispatched, Location(36.3, 0.0), station_},  // no route
+    };
+    EXPECT_EQ(writeRoutesGeoJson(trips, cache, geojsonPath_), 2u);
+
+    std::ifstream file(geojsonPath_);
+    json geojson = json::parse(file);
+    ASSERT_EQ(geojson["features"].size(), 2u);
+
+    const json& from = geojson["features"][0];
+    EXPECT_EQ(from["properties"]["direction"], "from_fire");
+    EXPECT_EQ(from["properties"]["station_id"], "3");
+    EXPECT_EQ(from["properties"]["incident_id"], "7");
+    ASSERT_EQ(from["geometry"]["coordinates"].size(), 2u);
+    EXPECT_DOUBLE_EQ(from["geometry"]["coordinates"][0][0].get<double>(), incident_.lon);
+    EXPECT_EQ(from["geometry"]["coordinates"][1][3].get<long long>(), wallClock(resolved) + 100);
+
+    // Both dispatches of the same pair are chained from the earliest one.
+    const json& to = geojson["features"][1];
+    EXPECT_EQ(to["properties"]["direction"], "to_fire");
+    ASSERT_EQ(to["geometry"]["coordinates"].size(), 4u);
+    for (size_t k = 0; k < 4; ++k) {
+        EXPECT_EQ(to["geometry"]["coordinates"][k][3].get<long long>(), wallClock(dispatched) + 50 * static_cast<long long>(k + 1));
+    }
+}
@@ -0,0 +1,75 @@
+/*
+Unit tests for the precomputed nearest-station index.
+1. Each incident keeps its K closest stations sorted by duration.
+2. Ties are broken by station index so the order is deterministic.
+3. The index survives a save/load round trip.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+#include "services/station_order.h"
+
+namespace {
+// 4 stations x 3 incidents, row-major like the duration matrix files.
+const std::vector<double> kDurations = {
+    300.0, 60.0,  90.0,
+    120.0, 60.0,  30.0,
+    60.0,  200.0, 45.0,
+    240.0, 10.0,  90.0
+};
+}
+
+TEST(StationOrderIndexTest, KeepsNearestStationsSorted) {
+    StationOrderIndex index(kDurations.data(), 3, 4, 2, 2);
+
+    ASSERT_EQ(index.k(), 2);
+    EXPECT_EQ(index.stations(0)[0], 2);
+    EXPECT_EQ(index.stations(0)[1], 1);
+    EXPECT_DOUBLE_EQ(index.durations(0)[0], 60.0);
+    EXPECT_DOUBLE_EQ(index.durations(0)[1], 120.0);
+
+    EXPECT_EQ(index.stations(2)[0], 1);
+    EXPECT_EQ(index.stations(2)[1], 2);
+}
+
+TEST(StationOrderIndexTest, BreaksTiesByStationIndex) {
+    StationOrderIndex index(kDurations.data(), 3, 4, 3, 1);
+
+    // Incident 1: station 3 (10s), then stations 0 and 1 tie at 60s.
+    EXPECT_EQ(index.stations(1)[0], 3);
+    EXPECT_EQ(index.stations(1)[1], 0);
+    EXPECT_EQ(index.stations(1)[2], 1);
+}
+
+TEST(StationOrderIndexTest, ClampsKToStationCount) {
+    StationOrderIndex index(kDurations.data(), 3, 4, 10);
+    EXPECT_EQ(index.k(), 4);
+}
+
+TEST(StationOrderIndexTest, SaveAndLoadRoundTrip) {
+    const std::string path = "test_station_order.bin";
+    StationOrderIndex built(kDurations.data(), 3, 4, 2);
+    ASSERT_TRUE(built.save(path));
+
+    StationOrderIndex loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+
+    EXPECT_EQ(loaded.width(), 3);
+    EXPECT_EQ(loaded.height(), 4);
+    EXPECT_EQ(loaded.k(), 2);
+    for (int incident = 0; incident < 3; ++incident) {
+        for (int i = 0; i < 2; ++i) {
+            EXPECT_EQ(loaded.stations(incident)[i], built.stations(incident)[i]);
+            EXPECT_DOUBLE_EQ(loaded.durations(incident)[i], built.durations(incident)[i]);
+        }
+    }
+}
+
+TEST(StationOrderIndexTest, LoadFailsForMissingFile) {
+    StationOrderIndex index;
+    EXPECT_FALSE(index.load("does_not_exist_station_order.bin"));
+    EXPECT_TRUE(index.empty());
+}
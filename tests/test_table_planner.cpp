@@ -0,0 +1,150 @@
+/*
+Unit tests for planning OSRM table requests.
+1. Tiles cover sources x destinations exactly once within the coordinate limit.
+2. The URL length limit caps the coordinates per request.
+3. The budget follows latency and halves on rejections.
+4. Duplicate locations are routed once and TooBig rejections shrink the requests.
+*/
+
+#include <gtest/gtest.h>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#include "services/chunks.h"
+#include "services/table_planner.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+#include "stub_http_server.h"
+
+namespace {
+std::vector<std::string> split(const std::string& s, char delim) {
+    std::vector<std::string> parts;
+    std::stringstream ss(s);
+    std::string part;
+    while (std::getline(ss, part, delim)) parts.push_back(part);
+    return parts;
+}
+
+std::string queryParam(const std::string& target, const std::string& key) {
+    size_t pos = target.find(key + "=");
+    if (pos == std::string::npos) return "";
+    pos += key.size() + 1;
+    return target.substr(pos, target.find('&', pos) - pos);
+}
+}
+
+class TablePlannerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+};
+
+TEST_F(TablePlannerTest, TilesCoverTableExactlyOnce) {
+    const size_t sources = 50, destinations = 333, limit = 60;
+    TablePlanner planner(sources, destinations, limit, TablePlannerOptions{});
+    std::vector<int> covered(sources * destinations, 0);
+
+    while (!planner.done()) {
+        for (const auto& tile : planner.nextWave(4)) {
+            EXPECT_LE(tile.sources() + tile.destinations(), limit);
+            for (size_t s = tile.sourceBegin; s < tile.sourceEnd; ++s) {
+                for (size_t d = tile.destinationBegin; d < tile.destinationEnd; ++d) {
+                    ++covered[s * destinations + d];
+                }
+            }
+        }
+        planner.recordLatency(0.0);
+    }
+
+    for (int count : covered) ASSERT_EQ(count, 1);
+}
+
+TEST_F(TablePlannerTest, UrlLengthLimitsCoordinates) {
+    // 8092 characters left, 20 + ';' per coordinate plus a three digit index and ';'.
+    EXPECT_EQ(TablePlanner::urlCoordinateLimit(8192, 100, 20), 323u);
+    EXPECT_EQ(TablePlanner::urlCoordinateLimit(50, 100, 20), 0u);
+    EXPECT_THROW(TablePlanner(1, 1, 1, TablePlannerOptions{}), InvalidValueError);
+}
+
+TEST_F(TablePlannerTest, BudgetFollowsLatencyAndRejections) {
+    TablePlannerOptions options;
+    options.targetLatencyMs = 100;
+    TablePlanner planner(10, 1000, 400, options);
+    EXPECT_EQ(planner.budget(), 400u);
+
+    planner.recordLatency(500.0);
+    EXPECT_EQ(planner.budget(), 300u);
+    planner.recordLatency(75.0);
+    EXPECT_EQ(planner.budget(), 300u);
+    planner.recordLatency(10.0);
+    EXPECT_EQ(planner.budget(), 400u);
+
+    EXPECT_TRUE(planner.shrink());
+    EXPECT_EQ(planner.budget(), 200u);
+    EXPECT_EQ(planner.tileShape(), std::make_pair(size_t{10}, size_t{190}));
+    while (planner.shrink()) {}
+    EXPECT_EQ(planner.budget(), 2u);
+}
+
+TEST_F(TablePlannerTest, RoutesDuplicatesOnceAndShrinksOnTooBig) {
+    // Rejects requests above 6 coordinates; duration = destination lon * 10 + source lon.
+    std::mutex mutex;
+    std::multiset<std::pair<std::string, std::string>> routed;
+    StubHttpServer server([&](const std::string& target) {
+        std::string path = target.substr(0, target.find('?'));
+        std::vector<std::string> coords = split(path.substr(path.rfind('/') + 1), ';');
+        if (coords.size() > 6) {
+            return std::make_pair(400, std::string(R"({"code":"TooBig","message":"Too many table coordinates"})"));
+        }
+
+        json durations = json::array(), distances = json::array();
+        for (const auto& s : split(queryParam(target, "sources"), ';')) {
+            json durationRow = json::array(), distanceRow = json::array();
+            for (const auto& d : split(queryParam(target, "destinations"), ';')) {
+                double value = std::stod(coords[std::stoi(d)]) * 10.0 + std::stod(coords[std::stoi(s)]);
+                durationRow.push_back(value);
+                distanceRow.push_back(2.0 * value);
+                std::lock_guard<std::mutex> lock(mutex);
+                routed.emplace(coords[std::stoi(s)], coords[std::stoi(d)]);
+            }
+            durations.push_back(durationRow);
+            distances.push_back(distanceRow);
+        }
+        return std::make_pair(200, json{{"code", "Ok"}, {"durations", durations}, {"distances", distances}}.dump());
+    });
+    EnvLoader::init(json{{"BASE_OSRM_URL", server.baseUrl()}, {"OSRM_MAX_IN_FLIGHT", 2},
+                         {"OSRM_MAX_TABLE_SIZE", 20}}.dump(), "json");
+
+    std::vector<Location> sources = {Location(36.0, 1.0), Location(36.0, 2.0), Location(36.0, 3.0)};
+    std::vector<Location> destinations;
+    for (int i = 0; i < 20; ++i) destinations.emplace_back(36.1, 10.0 + i % 10);
+
+    auto [distances, durations] = generate_osrm_table_chunks(sources, destinations);
+
+    ASSERT_EQ(durations.width(), 20);
+    ASSERT_EQ(durations.height(), 3);
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 20; ++col) {
+            double expected = (10.0 + col % 10) * 10.0 + (row + 1.0);
+            EXPECT_DOUBLE_EQ(durations.at(row, col), expected);
+            EXPECT_DOUBLE_EQ(distances.at(row, col), 2.0 * expected);
+        }
+    }
+    // Every unique pair was answered exactly once.
+    EXPECT_EQ(routed.size(), 30u);
+    std::set<std::pair<std::string, std::string>> unique(routed.begin(), routed.end());
+    EXPECT_EQ(unique.size(), 30u);
+}
@@ -0,0 +1,88 @@
+/*
+Unit tests for the task graph behind preprocessing.
+1. Tasks run after their dependencies, independent tasks run at the same time, every task is timed.
+2. A failing task skips its dependents only, and its exception reaches the caller.
+*/
+
+#include <gtest/gtest.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "utils/task_graph.h"
+#include "utils/error.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class TaskGraphTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+};
+
+TEST_F(TaskGraphTest, RunsTasksAfterTheirDependencies) {
+    std::mutex mutex;
+    std::vector<std::string> order;
+    auto record = [&](const std::string& name) {
+        std::lock_guard<std::mutex> lock(mutex);
+        order.push_back(name);
+    };
+
+    // The two loaders wait for each other, so they only finish if they run side by side.
+    std::atomic<int> arrived{0};
+    auto meet = [&]() {
+        arrived++;
+        auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (arrived.load() < 2 && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::yield();
+        }
+    };
+
+    utils::TaskGraph graph;
+    auto bounds = graph.add("bounds", [&]() { record("bounds"); });
+    auto stations = graph.add("stations", [&]() { meet(); record("stations"); }, {bounds});
+    auto incidents = graph.add("incidents", [&]() { meet(); record("incidents"); }, {bounds});
+    graph.add("matrices", [&]() { record("matrices"); }, {stations, incidents, stations});
+    graph.run();
+
+    EXPECT_EQ(arrived.load(), 2);
+    ASSERT_EQ(order.size(), 4u);
+    EXPECT_EQ(order.front(), "bounds");
+    EXPECT_EQ(order.back(), "matrices");
+
+    ASSERT_EQ(graph.timings().size(), 4u);
+    EXPECT_EQ(graph.timings()[2].name, "incidents");
+    EXPECT_GE(graph.timings()[3].startSeconds, graph.timings()[1].startSeconds + graph.timings()[1].seconds);
+    EXPECT_GE(graph.wallSeconds(), graph.timings()[3].startSeconds);
+    graph.logTimings("Test graph");
+
+    EXPECT_THROW(graph.add("cycle", []() {}, {graph.size()}), InvalidValueError);
+}
+
+TEST_F(TaskGraphTest, FailureSkipsOnlyDependents) {
+    std::atomic<int> ran{0};
+    utils::TaskGraph graph;
+    auto failing = graph.add("router", []() { throw std::runtime_error("router down"); });
+    auto matrices = graph.add("matrices", [&]() { ran += 100; }, {failing});
+    graph.add("write", [&]() { ran += 100; }, {matrices});
+    graph.add("inputs", [&]() { ran += 1; });
+
+    EXPECT_THROW(graph.run(2), std::runtime_error);
+    EXPECT_EQ(ran.load(), 1);
+    EXPECT_FALSE(graph.timings()[0].skipped);
+    EXPECT_TRUE(graph.timings()[1].skipped);
+    EXPECT_TRUE(graph.timings()[2].skipped);
+    EXPECT_FALSE(graph.timings()[3].skipped);
+}
@@ -0,0 +1,74 @@
+/*
+Unit tests for the grid travel time oracle.
+1. Points snap to the grid cell that contains them, points outside the grid are rejected.
+2. Lookups return the station durations of the cell.
+3. The oracle survives a save/load round trip.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <vector>
+
+#include "services/travel_time_oracle.h"
+
+namespace {
+// 2 rows x 3 cols of 0.01 degree cells starting at (36.10, -86.90).
+const GridSpec kGrid{36.10, -86.90, 0.01, 0.01, 2, 3};
+
+// 2 stations x 6 cells, value encodes (station, cell).
+std::vector<std::vector<double>> stationToCell() {
+    std::vector<std::vector<double>> matrix(2, std::vector<double>(6));
+    for (int station = 0; station < 2; ++station) {
+        for (int cell = 0; cell < 6; ++cell) {
+            matrix[station][cell] = station * 1000.0 + cell;
+        }
+    }
+    return matrix;
+}
+}
+
+TEST(TravelTimeOracleTest, SnapsPointsToCells) {
+    EXPECT_EQ(kGrid.cellIndex(36.105, -86.895), 0);
+    EXPECT_EQ(kGrid.cellIndex(36.105, -86.875), 2);
+    EXPECT_EQ(kGrid.cellIndex(36.115, -86.885), 4);
+    EXPECT_EQ(kGrid.cellIndex(36.095, -86.895), -1);
+    EXPECT_EQ(kGrid.cellIndex(36.105, -86.860), -1);
+
+    Location center = kGrid.cellCenter(4);
+    EXPECT_NEAR(center.lat, 36.115, 1e-9);
+    EXPECT_NEAR(center.lon, -86.885, 1e-9);
+}
+
+TEST(TravelTimeOracleTest, FromBoundsCoversTheBox) {
+    GridSpec grid = GridSpec::fromBounds(36.0, -87.0, 36.3, -86.5, 500.0);
+    EXPECT_GE(grid.minLat + grid.rows * grid.cellLat, 36.3);
+    EXPECT_GE(grid.minLon + grid.cols * grid.cellLon, -86.5);
+    EXPECT_GE(grid.cellIndex(36.299, -86.501), 0);
+}
+
+TEST(TravelTimeOracleTest, ReturnsCellDurations) {
+    TravelTimeOracle oracle(kGrid, stationToCell());
+    ASSERT_EQ(oracle.stations(), 2);
+
+    const double* durations = oracle.durations(Location(36.115, -86.885));
+    ASSERT_NE(durations, nullptr);
+    EXPECT_DOUBLE_EQ(durations[0], 4.0);
+    EXPECT_DOUBLE_EQ(durations[1], 1004.0);
+    EXPECT_EQ(oracle.durations(Location(35.0, -86.885)), nullptr);
+}
+
+TEST(TravelTimeOracleTest, SaveAndLoadRoundTrip) {
+    const std::string path = "test_travel_time_oracle_roundtrip.bin";
+    TravelTimeOracle built(kGrid, stationToCell());
+    ASSERT_TRUE(built.save(path));
+
+    TravelTimeOracle loaded;
+    ASSERT_TRUE(loaded.load(path));
+    std::remove(path.c_str());
+
+    EXPECT_EQ(loaded.grid().rows, 2);
+    EXPECT_EQ(loaded.grid().cols, 3);
+    for (int cell = 0; cell < 6; ++cell) {
+        EXPECT_DOUBLE_EQ(loaded.cellDurations(cell)[1], built.cellDurations(cell)[1]);
+    }
+}
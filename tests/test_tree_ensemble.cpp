@@ -0,0 +1,284 @@
+/*
+Unit tests for the native tree ensemble evaluator.
+1. Random ensembles serialized as ONNX TreeEnsembleRegressor nodes, with shuffled node order, every branch mode,
+   NaN routing and float or double thresholds, predict exactly what walking the ONNX attributes predicts, one row at
+   a time and in batches across block boundaries.
+2. Models it cannot evaluate (post transforms, several targets, other node modes, truncated bytes) are rejected.
+*/
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstring>
+#include <map>
+#include <random>
+#include <string>
+
+#include "models/tree_ensemble.h"
+#include "config/EnvLoader.h"
+#include "utils/error.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+namespace {
+// Protobuf writer for the few ONNX messages the importer reads.
+struct Proto {
+    std::string bytes;
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            bytes.push_back(static_cast<char>((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        bytes.push_back(static_cast<char>(value));
+    }
+    Proto& tag(uint32_t field, uint32_t wire) { varint(field << 3 | wire); return *this; }
+    Proto& integer(uint32_t field, int64_t value) { tag(field, 0).varint(static_cast<uint64_t>(value)); return *this; }
+    Proto& message(uint32_t field, const std::string& value) {
+        tag(field, 2).varint(value.size());
+        bytes += value;
+        return *this;
+    }
+    Proto& packedFloats(uint32_t field, const std::vector<double>& values) {
+        std::string packed;
+        for (double value : values) {
+            float f = static_cast<float>(value);
+            packed.append(reinterpret_cast<const char*>(&f), sizeof(f));
+        }
+        return message(field, packed);
+    }
+    Proto& packedInts(uint32_t field, const std::vector<int64_t>& values) {
+        Proto packed;
+        for (int64_t value : values) packed.varint(static_cast<uint64_t>(value));
+        return message(field, packed.bytes);
+    }
+};
+
+struct Attributes {
+    std::vector<int64_t> tree_ids, node_ids, feature_ids, true_ids, false_ids, missing_true;
+    std::vector<std::string> modes;
+    std::vector<double> values;
+    std::vector<int64_t> target_trees, target_nodes;
+    std::vector<double> weights;
+    double base = 0.0;
+    std::string aggregate = "SUM";
+    std::string post_transform = "NONE";
+    int64_t targets = 1;
+    bool double_thresholds = false;
+
+    std::string onnx() const {
+        Proto node;
+        node.message(1, "input").message(2, "variable").message(4, "TreeEnsembleRegressor").message(7, "ai.onnx.ml");
+        auto ints = [&](const char* name, const std::vector<int64_t>& v) {
+            node.message(5, Proto().message(1, name).packedInts(8, v).integer(20, 7).bytes);
+        };
+        auto floats = [&](const char* name, const std::vector<double>& v) {
+            node.message(5, Proto().message(1, name).packedFloats(7, v).integer(20, 6).bytes);
+        };
+        ints("nodes_treeids", tree_ids);
+        ints("nodes_nodeids", node_ids);
+        ints("nodes_featureids", feature_ids);
+        ints("nodes_truenodeids", true_ids);
+        ints("nodes_falsenodeids", false_ids);
+        ints("nodes_missing_value_tracks_true", missing_true);
+        Proto modes_attribute;
+        modes_attribute.message(1, "nodes_modes");
+        for (const auto& mode : modes) modes_attribute.message(9, mode);
+        node.message(5, modes_attribute.integer(20, 8).bytes);
+        if (double_thresholds) {
+            std::string raw(values.size() * sizeof(double), '\0');
+            std::memcpy(raw.data(), values.data(), raw.size());
+            Proto tensor;
+            tensor.integer(1, static_cast<int64_t>(values.size())).integer(2, 11).message(9, raw);
+            node.message(5, Proto().message(1, "nodes_values_as_tensor").message(5, tensor.bytes).integer(20, 4).bytes);
+        } else {
+            floats("nodes_values", values);
+        }
+        ints("target_treeids", target_trees);
+        ints("target_nodeids", target_nodes);
+        ints("target_ids", std::vector<int64_t>(target_trees.size(), 0));
+        floats("target_weights", weights);
+        floats("base_values", {base});
+        node.message(5, Proto().message(1, "aggregate_function").message(4, aggregate).integer(20, 3).bytes);
+        node.message(5, Proto().message(1, "post_transform").message(4, post_transform).integer(20, 3).bytes);
+        node.message(5, Proto().message(1, "n_targets").integer(3, targets).integer(20, 2).bytes);
+
+        Proto graph;
+        graph.message(1, Proto().message(1, "raw").message(2, "input").message(4, "Identity").bytes);
+        graph.message(1, node.bytes).message(2, "tree_ensemble");
+        Proto model;
+        model.integer(1, 8).message(2, "test").message(7, graph.bytes);
+        return model.bytes;
+    }
+
+    // Walks the attributes the way ONNX Runtime does: float inputs, float or double thresholds, float sums.
+    float reference(const float* row) const {
+        std::map<std::pair<int64_t, int64_t>, size_t> index;
+        std::map<int64_t, int64_t> roots;
+        for (size_t i = 0; i < tree_ids.size(); ++i) {
+            index[{tree_ids[i], node_ids[i]}] = i;
+            auto [root, added] = roots.emplace(tree_ids[i], node_ids[i]);
+            if (!added) root->second = std::min(root->second, node_ids[i]);
+        }
+        float sum = 0.0f;
+        for (const auto& [tree, root] : roots) {
+            size_t i = index.at({tree, root});
+            while (modes[i] != "LEAF") {
+                double x = row[feature_ids[i]];
+                double t = double_thresholds ? values[i] : static_cast<double>(static_cast<float>(values[i]));
+                bool taken = modes[i] == "BRANCH_LEQ" ? x <= t : modes[i] == "BRANCH_LT" ? x < t
+                           : modes[i] == "BRANCH_GTE" ? x >= t : x > t;
+                if (std::isnan(x)) taken = missing_true[i] != 0;
+                i = index.at({tree, taken ? true_ids[i] : false_ids[i]});
+            }
+            for (size_t k = 0; k < target_trees.size(); ++k) {
+                if (target_trees[k] == tree && target_nodes[k] == node_ids[i]) sum += static_cast<float>(weights[k]);
+            }
+        }
+        if (aggregate == "AVERAGE") sum /= static_cast<float>(roots.size());
+        return sum + static_cast<float>(base);
+    }
+};
+
+const char* const BRANCH_MODES[] = {"BRANCH_LEQ", "BRANCH_LT", "BRANCH_GTE", "BRANCH_GT"};
+
+// Random trees over `width` features, node ids numbered depth-first and the node list shuffled.
+Attributes randomEnsemble(std::mt19937_64& rng, size_t trees, size_t width, const std::vector<double>& grid) {
+    Attributes a;
+    std::uniform_int_distribution<int> coin(0, 1), mode(0, 3), depth(1, 5);
+    std::uniform_int_distribution<size_t> feature(0, width - 1), threshold(0, grid.size() - 1);
+    std::normal_distribution<double> weight(0.0, 100.0);
+    for (size_t t = 0; t < trees; ++t) {
+        int64_t tree = static_cast<int64_t>(trees - t) * 3;  // out of order
+        int64_t next_id = 0;
+        int max_depth = depth(rng);
+        auto grow = [&](auto& self, int level) -> int64_t {
+            int64_t id = next_id++;
+            size_t i = a.tree_ids.size();
+            a.tree_ids.push_back(tree);
+            a.node_ids.push_back(id);
+            a.feature_ids.push_back(0);
+            a.true_ids.push_back(0);
+            a.false_ids.push_back(0);
+            a.missing_true.push_back(coin(rng));
+            a.values.push_back(0.0);
+            if (level == max_depth || (level > 0 && coin(rng) && coin(rng))) {
+                a.modes.push_back("LEAF");
+                a.target_trees.push_back(tree);
+                a.target_nodes.push_back(id);
+                a.weights.push_back(weight(rng));
+                return id;
+            }
+            a.modes.push_back(BRANCH_MODES[mode(rng)]);
+            a.feature_ids[i] = static_cast<int64_t>(feature(rng));
+            a.values[i] = grid[threshold(rng)];
+            int64_t true_id = self(self, level + 1);
+            int64_t false_id = self(self, level + 1);
+            a.true_ids[i] = true_id;
+            a.false_ids[i] = false_id;
+            return id;
+        };
+        grow(grow, 0);
+    }
+    // Shuffle the node list as a converter is free to order it.
+    std::vector<size_t> perm(a.tree_ids.size());
+    for (size_t i = 0; i < perm.size(); ++i) perm[i] = i;
+    std::shuffle(perm.begin(), perm.end(), rng);
+    Attributes shuffled = a;
+    for (size_t i = 0; i < perm.size(); ++i) {
+        size_t k = perm[i];
+        shuffled.tree_ids[i] = a.tree_ids[k];
+        shuffled.node_ids[i] = a.node_ids[k];
+        shuffled.feature_ids[i] = a.feature_ids[k];
+        shuffled.true_ids[i] = a.true_ids[k];
+        shuffled.false_ids[i] = a.false_ids[k];
+        shuffled.missing_true[i] = a.missing_true[k];
+        shuffled.modes[i] = a.modes[k];
+        shuffled.values[i] = a.values[k];
+    }
+    shuffled.base = weight(rng);
+    return shuffled;
+}
+}
+
+class TreeEnsembleTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+};
+
+TEST_F(TreeEnsembleTest, MatchesTheOnnxSemantics) {
+    std::mt19937_64 rng(11);
+    const size_t width = 7;
+    // Thresholds and inputs share values, so equal comparisons are exercised; the doubles fall between floats.
+    std::vector<double> grid = {-2.5, -1.0, -0.1, 0.0, 0.3, 1.0 / 3.0, 0.7, 2.0, 1e-8, 1.0 + 1e-9};
+    std::vector<float> inputs;
+    for (double value : grid) {
+        inputs.push_back(static_cast<float>(value));
+        inputs.push_back(std::nextafter(static_cast<float>(value), 10.0f));
+        inputs.push_back(std::nextafter(static_cast<float>(value), -10.0f));
+    }
+    inputs.push_back(std::nanf(""));
+
+    for (int variant = 0; variant < 4; ++variant) {
+        Attributes a = randomEnsemble(rng, 40, width, grid);
+        a.double_thresholds = variant % 2 == 1;
+        a.aggregate = variant < 2 ? "SUM" : "AVERAGE";
+        TreeEnsemble ensemble = TreeEnsemble::fromOnnx(a.onnx());
+        EXPECT_EQ(ensemble.treeCount(), 40u);
+        EXPECT_EQ(ensemble.nodeCount(), a.tree_ids.size());
+        EXPECT_LE(ensemble.featureCount(), width);
+
+        const size_t rows = 301;  // not a multiple of the block size
+        std::uniform_int_distribution<size_t> pick(0, inputs.size() - 1);
+        std::vector<float> matrix(rows * width);
+        for (float& value : matrix) value = inputs[pick(rng)];
+        std::vector<float> batch = ensemble.predictBatch(matrix, rows);
+        ASSERT_EQ(batch.size(), rows);
+        for (size_t r = 0; r < rows; ++r) {
+            std::span<const float> row(matrix.data() + r * width, width);
+            float expected = a.reference(row.data());
+            ASSERT_EQ(batch[r], expected) << "variant " << variant << " row " << r;
+            ASSERT_EQ(ensemble.predict(row), expected);
+        }
+    }
+}
+
+TEST_F(TreeEnsembleTest, RejectsWhatItCannotEvaluate) {
+    std::mt19937_64 rng(3);
+    Attributes a = randomEnsemble(rng, 3, 4, {0.0, 1.0});
+    ASSERT_NO_THROW(TreeEnsemble::fromOnnx(a.onnx()));
+
+    Attributes transformed = a;
+    transformed.post_transform = "PROBIT";
+    EXPECT_THROW(TreeEnsemble::fromOnnx(transformed.onnx()), InvalidValueError);
+
+    Attributes multi = a;
+    multi.targets = 2;
+    EXPECT_THROW(TreeEnsemble::fromOnnx(multi.onnx()), InvalidValueError);
+
+    Attributes equality = a;
+    for (auto& mode : equality.modes) {
+        if (mode != "LEAF") { mode = "BRANCH_EQ"; break; }
+    }
+    EXPECT_THROW(TreeEnsemble::fromOnnx(equality.onnx()), InvalidValueError);
+
+    std::string bytes = a.onnx();
+    EXPECT_THROW(TreeEnsemble::fromOnnx(std::string_view(bytes).substr(0, bytes.size() / 2)), InvalidValueError);
+    EXPECT_THROW(TreeEnsemble::fromOnnx(""), InvalidValueError);
+    EXPECT_THROW(TreeEnsemble::loadOnnx("no_such_model.onnx"), InvalidValueError);
+
+    TreeEnsemble ensemble = TreeEnsemble::fromOnnx(a.onnx());
+    std::vector<float> narrow(ensemble.featureCount() - 1, 0.0f);
+    if (!narrow.empty()) {
+        EXPECT_THROW(ensemble.predict(narrow), InvalidValueError);
+    }
+}
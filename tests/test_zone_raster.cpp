@@ -0,0 +1,130 @@
+/*
+Unit tests for the zone raster behind incident zone assignment.
+1. The raster finds a covering beat wherever the R-tree lookup does, and none elsewhere, on jittered beats with a hole,
+   for random points and points on shared borders and corners.
+2. openOrBuild saves the raster, reloads it for the same beats hash and rebuilds it when the hash changes.
+*/
+
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <random>
+
+#include "services/zone_raster.h"
+#include "data/geometry.h"
+#include "config/EnvLoader.h"
+#include "utils/logger.h"
+#include <spdlog/spdlog.h>
+
+class ZoneRasterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        EnvLoader::init("../.env");
+        utils::Logger::init("boilerplate_app");
+        utils::Logger::setLevel("info");
+    }
+
+    void TearDown() override {
+        std::remove(path_.c_str());
+        spdlog::drop("boilerplate_app");
+        spdlog::shutdown();
+        EnvLoader::cleanup();
+    }
+
+    // An n x n block of quadrilateral beats whose shared corners are jittered, like beats sharing borders.
+    std::vector<Polygon> beats(size_t n, std::mt19937_64& rng) {
+        std::uniform_real_distribution<double> jitter(-0.004, 0.004);
+        std::vector<std::vector<Point>> corners(n + 1, std::vector<Point>(n + 1));
+        for (size_t i = 0; i <= n; ++i) {
+            for (size_t j = 0; j <= n; ++j) {
+                bool edge = i == 0 || j == 0 || i == n || j == n;
+                corners[i][j] = Point(-86.9 + 0.02 * static_cast<double>(i) + (edge ? 0.0 : jitter(rng)),
+                                      36.0 + 0.02 * static_cast<double>(j) + (edge ? 0.0 : jitter(rng)));
+            }
+        }
+        std::vector<Polygon> polygons;
+        for (size_t i = 0; i < n; ++i) {
+            for (size_t j = 0; j < n; ++j) {
+                Polygon polygon;
+                bg::append(polygon.outer(), corners[i][j]);
+                bg::append(polygon.outer(), corners[i + 1][j]);
+                bg::append(polygon.outer(), corners[i + 1][j + 1]);
+                bg::append(polygon.outer(), corners[i][j + 1]);
+                bg::correct(polygon);
+                polygons.push_back(polygon);
+                corners_.push_back(corners[i][j]);
+            }
+        }
+        // Punch a hole in the first beat.
+        Point c = corners[0][0];
+        polygons.front().inners().resize(1);
+        for (auto [dx, dy] : {std::pair{0.004, 0.004}, {0.008, 0.004}, {0.008, 0.008}, {0.004, 0.008}}) {
+            bg::append(polygons.front().inners()[0], Point(c.x() + dx, c.y() + dy));
+        }
+        bg::correct(polygons.front());
+        return polygons;
+    }
+
+    std::string path_ = "test_zone_raster.bin";
+    std::vector<Point> corners_;
+};
+
+TEST_F(ZoneRasterTest, AgreesWithRTreeLookup) {
+    std::mt19937_64 rng(5);
+    std::vector<Polygon> polygons = beats(12, rng);
+    ZoneRaster raster(polygons, 7);
+    EXPECT_EQ(raster.side(), 128u);
+    EXPECT_GT(raster.mixedCellCount(), 0u);
+    EXPECT_LT(raster.mixedCellCount(), raster.side() * raster.side() / 2);
+
+    std::vector<Point> points;
+    std::uniform_real_distribution<double> lon(-86.95, -86.6), lat(35.95, 36.3), unit(0.0, 1.0);
+    for (int i = 0; i < 50000; ++i) points.emplace_back(lon(rng), lat(rng));
+    points.insert(points.end(), corners_.begin(), corners_.end());
+    for (const auto& polygon : polygons) {
+        const auto& ring = polygon.outer();
+        for (size_t k = 0; k + 1 < ring.size(); ++k) {
+            double t = unit(rng);
+            points.emplace_back(ring[k].x() + t * (ring[k + 1].x() - ring[k].x()),
+                                ring[k].y() + t * (ring[k + 1].y() - ring[k].y()));
+        }
+    }
+    points.emplace_back(-86.9 + 0.006, 36.0 + 0.006);  // inside the hole
+
+    auto expected = getPointToPolygonIndices(points, polygons);
+    auto found = raster.locate(points, 4);
+    ASSERT_EQ(found.size(), points.size());
+    for (size_t i = 0; i < points.size(); ++i) {
+        ASSERT_EQ(found[i].has_value(), expected[i].has_value()) << i;
+        // On shared borders either beat is a valid answer.
+        if (found[i]) {
+            ASSERT_TRUE(bg::covered_by(points[i], polygons[*found[i]])) << i;
+        }
+        ASSERT_EQ(found[i], raster.locate(points[i]));
+    }
+    EXPECT_FALSE(raster.locate(points.back()));
+    EXPECT_FALSE(raster.locate(Point(std::nan(""), 36.1)));
+    EXPECT_FALSE(ZoneRaster().locate(Point(-86.8, 36.1)));
+}
+
+TEST_F(ZoneRasterTest, PersistsUnderTheSourceHash) {
+    std::mt19937_64 rng(9);
+    std::vector<Polygon> polygons = beats(6, rng);
+    ZoneRaster built = ZoneRaster::openOrBuild(path_, polygons, 42, 6);
+    ASSERT_TRUE(std::ifstream(path_).good());
+
+    ZoneRaster loaded = ZoneRaster::openOrBuild(path_, polygons, 42, 6);
+    EXPECT_EQ(loaded.side(), built.side());
+    EXPECT_EQ(loaded.mixedCellCount(), built.mixedCellCount());
+    std::uniform_real_distribution<double> lon(-86.95, -86.7), lat(35.95, 36.15);
+    for (int i = 0; i < 5000; ++i) {
+        Point point(lon(rng), lat(rng));
+        ASSERT_EQ(loaded.locate(point), built.locate(point));
+    }
+
+    // Different beats under a new hash: the file is rebuilt, not reused.
+    std::vector<Polygon> other(polygons.begin(), polygons.begin() + 4);
+    ZoneRaster rebuilt = ZoneRaster::openOrBuild(path_, other, 43, 6);
+    EXPECT_FALSE(rebuilt.locate(bg::return_centroid<Point>(polygons[10])));
+    EXPECT_EQ(ZoneRaster::openOrBuild(path_, other, 43, 6).mixedCellCount(), rebuilt.mixedCellCount());
+}